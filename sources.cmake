@@ -2,6 +2,8 @@ set(SOURCES
 src/ciphers/aes/aes.c
 src/ciphers/aes/aes_desc.c
 src/ciphers/aes/aes_tab.c
+src/ciphers/aes/aes_vaes.c
+src/ciphers/aes/aesbs.c
 src/ciphers/aes/aesni.c
 src/ciphers/anubis.c
 src/ciphers/blowfish.c
@@ -41,6 +43,7 @@ src/encauth/chachapoly/chacha20poly1305_done.c
 src/encauth/chachapoly/chacha20poly1305_encrypt.c
 src/encauth/chachapoly/chacha20poly1305_init.c
 src/encauth/chachapoly/chacha20poly1305_memory.c
+src/encauth/chachapoly/chacha20poly1305_memory_batch.c
 src/encauth/chachapoly/chacha20poly1305_setiv.c
 src/encauth/chachapoly/chacha20poly1305_setiv_rfc7905.c
 src/encauth/chachapoly/chacha20poly1305_test.c
@@ -56,12 +59,17 @@ src/encauth/gcm/gcm_add_aad.c
 src/encauth/gcm/gcm_add_iv.c
 src/encauth/gcm/gcm_done.c
 src/encauth/gcm/gcm_gf_mult.c
+src/encauth/gcm/gcm_htable.c
 src/encauth/gcm/gcm_init.c
 src/encauth/gcm/gcm_memory.c
+src/encauth/gcm/gcm_memory_batch.c
 src/encauth/gcm/gcm_mult_h.c
+src/encauth/gcm/gcm_pclmul.c
 src/encauth/gcm/gcm_process.c
 src/encauth/gcm/gcm_reset.c
 src/encauth/gcm/gcm_test.c
+src/encauth/gcmsiv/gcm_siv_memory.c
+src/encauth/gcmsiv/gcm_siv_test.c
 src/encauth/ocb/ocb_decrypt.c
 src/encauth/ocb/ocb_decrypt_verify_memory.c
 src/encauth/ocb/ocb_done_decrypt.c
@@ -83,15 +91,27 @@ src/encauth/ocb3/ocb3_encrypt_authenticate_memory.c
 src/encauth/ocb3/ocb3_encrypt_last.c
 src/encauth/ocb3/ocb3_init.c
 src/encauth/ocb3/ocb3_int_ntz.c
+src/encauth/ocb3/ocb3_int_process_blocks.c
 src/encauth/ocb3/ocb3_int_xor_blocks.c
+src/encauth/ocb3/ocb3_memory_batch.c
+src/encauth/ocb3/ocb3_reset.c
 src/encauth/ocb3/ocb3_test.c
 src/hashes/blake2b.c
+src/hashes/blake2b_avx2.c
+src/hashes/blake2bp.c
 src/hashes/blake2s.c
+src/hashes/blake2s_simd.c
+src/hashes/blake2sp.c
+src/hashes/blake3.c
+src/hashes/blake3_simd.c
 src/hashes/chc/chc.c
 src/hashes/helper/hash_file.c
 src/hashes/helper/hash_filehandle.c
 src/hashes/helper/hash_memory.c
+src/hashes/helper/hash_memory_batch.c
 src/hashes/helper/hash_memory_multi.c
+src/hashes/helper/hash_tree.c
+src/hashes/helper/hash_tree_memory.c
 src/hashes/md2.c
 src/hashes/md4.c
 src/hashes/md5.c
@@ -100,14 +120,22 @@ src/hashes/rmd160.c
 src/hashes/rmd256.c
 src/hashes/rmd320.c
 src/hashes/sha1.c
+src/hashes/sha1_shani.c
 src/hashes/sha2/sha224.c
 src/hashes/sha2/sha256.c
+src/hashes/sha2/sha256_mb_avx2.c
+src/hashes/sha2/sha256_shani.c
 src/hashes/sha2/sha384.c
 src/hashes/sha2/sha512.c
 src/hashes/sha2/sha512_224.c
 src/hashes/sha2/sha512_256.c
+src/hashes/sha2/sha512_mb_avx2.c
+src/hashes/sha2/sha512_simd.c
 src/hashes/sha3.c
+src/hashes/sha3_kt.c
+src/hashes/sha3_parallelhash.c
 src/hashes/sha3_test.c
+src/hashes/sha3_x4_avx2.c
 src/hashes/tiger.c
 src/hashes/whirl/whirl.c
 src/hashes/whirl/whirltab.c
@@ -130,11 +158,21 @@ src/mac/blake2/blake2bmac_file.c
 src/mac/blake2/blake2bmac_memory.c
 src/mac/blake2/blake2bmac_memory_multi.c
 src/mac/blake2/blake2bmac_test.c
+src/mac/blake2/blake2bpmac.c
+src/mac/blake2/blake2bpmac_file.c
+src/mac/blake2/blake2bpmac_memory.c
+src/mac/blake2/blake2bpmac_memory_multi.c
+src/mac/blake2/blake2bpmac_test.c
 src/mac/blake2/blake2smac.c
 src/mac/blake2/blake2smac_file.c
 src/mac/blake2/blake2smac_memory.c
 src/mac/blake2/blake2smac_memory_multi.c
 src/mac/blake2/blake2smac_test.c
+src/mac/blake2/blake2spmac.c
+src/mac/blake2/blake2spmac_file.c
+src/mac/blake2/blake2spmac_memory.c
+src/mac/blake2/blake2spmac_memory_multi.c
+src/mac/blake2/blake2spmac_test.c
 src/mac/f9/f9_done.c
 src/mac/f9/f9_file.c
 src/mac/f9/f9_init.c
@@ -169,6 +207,7 @@ src/mac/pmac/pmac_process.c
 src/mac/pmac/pmac_shift_xor.c
 src/mac/pmac/pmac_test.c
 src/mac/poly1305/poly1305.c
+src/mac/poly1305/poly1305_avx2.c
 src/mac/poly1305/poly1305_file.c
 src/mac/poly1305/poly1305_memory.c
 src/mac/poly1305/poly1305_memory_multi.c
@@ -199,6 +238,7 @@ src/misc/bcrypt/bcrypt.c
 src/misc/burn_stack.c
 src/misc/compare_testvector.c
 src/misc/copy_or_zeromem.c
+src/misc/cpu_features.c
 src/misc/crc32.c
 src/misc/crypt/crypt.c
 src/misc/crypt/crypt_argchk.c
@@ -232,6 +272,7 @@ src/misc/crypt/crypt_unregister_cipher.c
 src/misc/crypt/crypt_unregister_hash.c
 src/misc/crypt/crypt_unregister_prng.c
 src/misc/error_to_string.c
+src/misc/file_process.c
 src/misc/hkdf/hkdf.c
 src/misc/hkdf/hkdf_test.c
 src/misc/mem_neq.c
@@ -494,7 +535,11 @@ src/stream/chacha/chacha_ivctr64.c
 src/stream/chacha/chacha_keystream.c
 src/stream/chacha/chacha_memory.c
 src/stream/chacha/chacha_setup.c
+src/stream/chacha/chacha_simd.c
 src/stream/chacha/chacha_test.c
+src/stream/chacha/xchacha20_memory.c
+src/stream/chacha/xchacha20_setup.c
+src/stream/chacha/xchacha20_test.c
 src/stream/rabbit/rabbit.c
 src/stream/rabbit/rabbit_memory.c
 src/stream/rc4/rc4_stream.c
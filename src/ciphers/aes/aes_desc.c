@@ -20,13 +20,68 @@
 #define AES_TEST  aes_test
 #define AES_KS    aes_keysize
 
+#if defined(LTC_AES_NI) || defined(LTC_AES_BITSLICE)
+#define AES_ACCEL_ECB_ENC s_aes_accel_ecb_encrypt
+#define AES_ACCEL_ECB_DEC s_aes_accel_ecb_decrypt
+#define AES_ACCEL_CBC_ENC s_aes_accel_cbc_encrypt
+#define AES_ACCEL_CBC_DEC s_aes_accel_cbc_decrypt
+#define AES_ACCEL_CTR_ENC s_aes_accel_ctr_encrypt
+#define AES_ACCEL_XTS_ENC s_aes_accel_xts_encrypt
+#define AES_ACCEL_XTS_DEC s_aes_accel_xts_decrypt
+static int s_aes_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+static int s_aes_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey);
+static int s_aes_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+static int s_aes_accel_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+static int s_aes_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+static int s_aes_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                                   const symmetric_key *skey1, const symmetric_key *skey2);
+static int s_aes_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                                   const symmetric_key *skey1, const symmetric_key *skey2);
+#else
+#define AES_ACCEL_ECB_ENC NULL
+#define AES_ACCEL_ECB_DEC NULL
+#define AES_ACCEL_CBC_ENC NULL
+#define AES_ACCEL_CBC_DEC NULL
+#define AES_ACCEL_CTR_ENC NULL
+#define AES_ACCEL_XTS_ENC NULL
+#define AES_ACCEL_XTS_DEC NULL
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_CCM_MODE)
+#define AES_ACCEL_CCM_MEMORY s_aes_accel_ccm_memory
+static int s_aes_accel_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                                  symmetric_key       *uskey,
+                                  const unsigned char *nonce,  unsigned long noncelen,
+                                  const unsigned char *header, unsigned long headerlen,
+                                        unsigned char *pt,     unsigned long ptlen,
+                                        unsigned char *ct,
+                                        unsigned char *tag,    unsigned long *taglen,
+                                                  int  direction);
+#else
+#define AES_ACCEL_CCM_MEMORY NULL
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_GCM_MODE)
+#define AES_ACCEL_GCM_MEMORY s_aes_accel_gcm_memory
+static int s_aes_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                                  const unsigned char *IV,     unsigned long IVlen,
+                                  const unsigned char *adata,  unsigned long adatalen,
+                                        unsigned char *pt,     unsigned long ptlen,
+                                        unsigned char *ct,
+                                        unsigned char *tag,    unsigned long *taglen,
+                                                  int direction);
+#else
+#define AES_ACCEL_GCM_MEMORY NULL
+#endif
+
 const struct ltc_cipher_descriptor aes_desc =
 {
     "aes",
     6,
     16, 32, 16, 10,
     AES_SETUP, AES_ENC, AES_DEC, AES_TEST, AES_DONE, AES_KS,
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    AES_ACCEL_ECB_ENC, AES_ACCEL_ECB_DEC, AES_ACCEL_CBC_ENC, AES_ACCEL_CBC_DEC, AES_ACCEL_CTR_ENC,
+    NULL, NULL, AES_ACCEL_CCM_MEMORY, AES_ACCEL_GCM_MEMORY, NULL, NULL, NULL, AES_ACCEL_XTS_ENC, AES_ACCEL_XTS_DEC
 };
 
 #else
@@ -37,42 +92,62 @@ const struct ltc_cipher_descriptor aes_desc =
 #define AES_TEST  aes_enc_test
 #define AES_KS    aes_enc_keysize
 
+#if defined(LTC_AES_NI) || defined(LTC_AES_BITSLICE)
+#define AES_ACCEL_ECB_ENC s_aes_accel_ecb_encrypt
+#define AES_ACCEL_CBC_ENC s_aes_accel_cbc_encrypt
+#define AES_ACCEL_CTR_ENC s_aes_accel_ctr_encrypt
+static int s_aes_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+static int s_aes_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+static int s_aes_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+#else
+#define AES_ACCEL_ECB_ENC NULL
+#define AES_ACCEL_CBC_ENC NULL
+#define AES_ACCEL_CTR_ENC NULL
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_CCM_MODE)
+#define AES_ACCEL_CCM_MEMORY s_aes_accel_ccm_memory
+static int s_aes_accel_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                                  symmetric_key       *uskey,
+                                  const unsigned char *nonce,  unsigned long noncelen,
+                                  const unsigned char *header, unsigned long headerlen,
+                                        unsigned char *pt,     unsigned long ptlen,
+                                        unsigned char *ct,
+                                        unsigned char *tag,    unsigned long *taglen,
+                                                  int  direction);
+#else
+#define AES_ACCEL_CCM_MEMORY NULL
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_GCM_MODE)
+#define AES_ACCEL_GCM_MEMORY s_aes_accel_gcm_memory
+static int s_aes_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                                  const unsigned char *IV,     unsigned long IVlen,
+                                  const unsigned char *adata,  unsigned long adatalen,
+                                        unsigned char *pt,     unsigned long ptlen,
+                                        unsigned char *ct,
+                                        unsigned char *tag,    unsigned long *taglen,
+                                                  int direction);
+#else
+#define AES_ACCEL_GCM_MEMORY NULL
+#endif
+
 const struct ltc_cipher_descriptor aes_enc_desc =
 {
     "aes",
     6,
     16, 32, 16, 10,
     AES_SETUP, AES_ENC, NULL, NULL, AES_DONE, AES_KS,
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    AES_ACCEL_ECB_ENC, NULL, AES_ACCEL_CBC_ENC, NULL, AES_ACCEL_CTR_ENC,
+    NULL, NULL, AES_ACCEL_CCM_MEMORY, AES_ACCEL_GCM_MEMORY, NULL, NULL, NULL, NULL, NULL
 };
 
 #endif
 
-/* Code partially borrowed from https://software.intel.com/content/www/us/en/develop/articles/intel-sha-extensions.html */
 #if defined(LTC_AES_NI)
 static LTC_INLINE int s_aesni_is_supported(void)
 {
-   static int initialized = 0, is_supported = 0;
-
-   if (initialized == 0) {
-      int a, b, c, d;
-
-      /* Look for CPUID.1.0.ECX[19] (SSE4.1) and CPUID.1.0.ECX[25] (AES-NI)
-       * EAX = 1, ECX = 0
-       */
-      a = 1;
-      c = 0;
-
-      __asm__ volatile ("cpuid"
-           :"=a"(a), "=b"(b), "=c"(c), "=d"(d)
-           :"a"(a), "c"(c)
-          );
-
-      is_supported = ((c >> 19) & 1) && ((c >> 25) & 1);
-      initialized = 1;
-   }
-
-   return is_supported;
+   return (ltc_cpu_features() & (LTC_CPU_SSE41 | LTC_CPU_AES)) == (LTC_CPU_SSE41 | LTC_CPU_AES);
 }
 
 #ifndef ENCRYPT_ONLY
@@ -81,6 +156,22 @@ int aesni_is_supported(void)
    return s_aesni_is_supported();
 }
 #endif
+#endif
+
+#if defined(LTC_AES_BITSLICE)
+/* once the bitsliced code is selected, every call has to use it,
+ * the tables are only the last resort without SSSE3 */
+static LTC_INLINE int s_aesbs_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_SSSE3) != 0;
+}
+
+#ifndef ENCRYPT_ONLY
+int aesbs_is_supported(void)
+{
+   return s_aesbs_is_supported();
+}
+#endif
 #endif
 
  /**
@@ -97,6 +188,11 @@ int AES_SETUP(const unsigned char *key, int keylen, int num_rounds, symmetric_ke
    if (s_aesni_is_supported()) {
       return aesni_setup(key, keylen, num_rounds, skey);
    }
+#endif
+#ifdef LTC_AES_BITSLICE
+   if (s_aesbs_is_supported()) {
+      return aesbs_setup(key, keylen, num_rounds, skey);
+   }
 #endif
    /* Last resort, software AES */
    return rijndael_setup(key, keylen, num_rounds, skey);
@@ -115,6 +211,11 @@ int AES_ENC(const unsigned char *pt, unsigned char *ct, const symmetric_key *ske
    if (s_aesni_is_supported()) {
       return aesni_ecb_encrypt(pt, ct, skey);
    }
+#endif
+#ifdef LTC_AES_BITSLICE
+   if (s_aesbs_is_supported()) {
+      return aesbs_ecb_encrypt(pt, ct, skey);
+   }
 #endif
    return rijndael_ecb_encrypt(pt, ct, skey);
 }
@@ -134,11 +235,441 @@ int AES_DEC(const unsigned char *ct, unsigned char *pt, const symmetric_key *ske
    if (s_aesni_is_supported()) {
       return aesni_ecb_decrypt(ct, pt, skey);
    }
+#endif
+#ifdef LTC_AES_BITSLICE
+   if (s_aesbs_is_supported()) {
+      return aesbs_ecb_decrypt(ct, pt, skey);
+   }
 #endif
    return rijndael_ecb_decrypt(ct, pt, skey);
 }
 #endif /* ENCRYPT_ONLY */
 
+#if defined(LTC_AES_NI) || defined(LTC_AES_BITSLICE)
+/**
+  Encrypts multiple blocks of text with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   int err;
+
+#if defined(LTC_AES_VAES)
+   if (vaes512_is_supported()) {
+      return vaes512_accel_ecb_encrypt(pt, ct, blocks, skey);
+   }
+   if (vaes256_is_supported()) {
+      return vaes256_accel_ecb_encrypt(pt, ct, blocks, skey);
+   }
+#endif
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_ecb_encrypt(pt, ct, blocks, skey);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_ecb_encrypt(pt, ct, blocks, skey);
+   }
+#endif
+   while (blocks-- > 0) {
+      if ((err = rijndael_ecb_encrypt(pt, ct, skey)) != CRYPT_OK) {
+         return err;
+      }
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+
+/**
+  CBC encrypt multiple blocks with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   int err, x;
+
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_cbc_encrypt(pt, ct, blocks, IV, skey);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_cbc_encrypt(pt, ct, blocks, IV, skey);
+   }
+#endif
+   while (blocks-- > 0) {
+      for (x = 0; x < 16; x++) {
+         IV[x] ^= pt[x];
+      }
+      if ((err = rijndael_ecb_encrypt(IV, ct, skey)) != CRYPT_OK) {
+         return err;
+      }
+      XMEMCPY(IV, ct, 16);
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+
+/**
+  CTR encrypt multiple blocks with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The current counter
+  @param mode   The counter mode ORed with the width of the counter
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   int err, x, width;
+   unsigned char pad[16];
+
+#if defined(LTC_AES_VAES)
+   if (vaes512_is_supported()) {
+      return vaes512_accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey);
+   }
+   if (vaes256_is_supported()) {
+      return vaes256_accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey);
+   }
+#endif
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey);
+   }
+#endif
+   width = (mode & 255) ? (mode & 255) : 16;
+   while (blocks-- > 0) {
+      /* increment counter */
+      if ((mode & CTR_COUNTER_BIG_ENDIAN) == CTR_COUNTER_LITTLE_ENDIAN) {
+         for (x = 0; x < width; x++) {
+            IV[x] = (IV[x] + (unsigned char)1) & (unsigned char)255;
+            if (IV[x] != (unsigned char)0) {
+               break;
+            }
+         }
+      } else {
+         for (x = 15; x >= 16 - width; x--) {
+            IV[x] = (IV[x] + (unsigned char)1) & (unsigned char)255;
+            if (IV[x] != (unsigned char)0) {
+               break;
+            }
+         }
+      }
+      if ((err = rijndael_ecb_encrypt(IV, pad, skey)) != CRYPT_OK) {
+         return err;
+      }
+      for (x = 0; x < 16; x++) {
+         ct[x] = pt[x] ^ pad[x];
+      }
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+
+#ifndef ENCRYPT_ONLY
+/**
+  Decrypts multiple blocks of text with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey)
+{
+   int err;
+
+#if defined(LTC_AES_VAES)
+   if (vaes512_is_supported()) {
+      return vaes512_accel_ecb_decrypt(ct, pt, blocks, skey);
+   }
+   if (vaes256_is_supported()) {
+      return vaes256_accel_ecb_decrypt(ct, pt, blocks, skey);
+   }
+#endif
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_ecb_decrypt(ct, pt, blocks, skey);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_ecb_decrypt(ct, pt, blocks, skey);
+   }
+#endif
+   while (blocks-- > 0) {
+      if ((err = rijndael_ecb_decrypt(ct, pt, skey)) != CRYPT_OK) {
+         return err;
+      }
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+
+/**
+  CBC decrypt multiple blocks with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   int err, x;
+   unsigned char tmp[16], tmpy;
+
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_cbc_decrypt(ct, pt, blocks, IV, skey);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_cbc_decrypt(ct, pt, blocks, IV, skey);
+   }
+#endif
+   while (blocks-- > 0) {
+      if ((err = rijndael_ecb_decrypt(ct, tmp, skey)) != CRYPT_OK) {
+         return err;
+      }
+      for (x = 0; x < 16; x++) {
+         tmpy  = tmp[x] ^ IV[x];
+         IV[x] = ct[x];
+         pt[x] = tmpy;
+      }
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+static void s_aes_xts_mult_x(unsigned char *I)
+{
+   int x;
+   unsigned char t, tt;
+
+   for (x = t = 0; x < 16; x++) {
+      tt = I[x] >> 7;
+      I[x] = ((I[x] << 1) | t) & 0xFF;
+      t = tt;
+   }
+   if (tt) {
+      I[0] ^= 0x87;
+   }
+}
+
+/**
+  XTS encrypt multiple blocks with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                                   const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   int err, x;
+
+#if defined(LTC_AES_VAES)
+   if (vaes512_is_supported()) {
+      return vaes512_accel_xts_encrypt(pt, ct, blocks, tweak, skey1, skey2);
+   }
+   if (vaes256_is_supported()) {
+      return vaes256_accel_xts_encrypt(pt, ct, blocks, tweak, skey1, skey2);
+   }
+#endif
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_xts_encrypt(pt, ct, blocks, tweak, skey1, skey2);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_xts_encrypt(pt, ct, blocks, tweak, skey1, skey2);
+   }
+#endif
+   if ((err = rijndael_ecb_encrypt(tweak, tweak, skey2)) != CRYPT_OK) {
+      return err;
+   }
+   while (blocks-- > 0) {
+      for (x = 0; x < 16; x++) {
+         ct[x] = pt[x] ^ tweak[x];
+      }
+      if ((err = rijndael_ecb_encrypt(ct, ct, skey1)) != CRYPT_OK) {
+         return err;
+      }
+      for (x = 0; x < 16; x++) {
+         ct[x] ^= tweak[x];
+      }
+      s_aes_xts_mult_x(tweak);
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+
+/**
+  XTS decrypt multiple blocks with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+static int s_aes_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                                   const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   int err, x;
+
+#if defined(LTC_AES_VAES)
+   if (vaes512_is_supported()) {
+      return vaes512_accel_xts_decrypt(ct, pt, blocks, tweak, skey1, skey2);
+   }
+   if (vaes256_is_supported()) {
+      return vaes256_accel_xts_decrypt(ct, pt, blocks, tweak, skey1, skey2);
+   }
+#endif
+#if defined(LTC_AES_NI)
+   if (s_aesni_is_supported()) {
+      return aesni_accel_xts_decrypt(ct, pt, blocks, tweak, skey1, skey2);
+   }
+#endif
+#if defined(LTC_AES_BITSLICE)
+   if (s_aesbs_is_supported()) {
+      return aesbs_accel_xts_decrypt(ct, pt, blocks, tweak, skey1, skey2);
+   }
+#endif
+   if ((err = rijndael_ecb_encrypt(tweak, tweak, skey2)) != CRYPT_OK) {
+      return err;
+   }
+   while (blocks-- > 0) {
+      for (x = 0; x < 16; x++) {
+         pt[x] = ct[x] ^ tweak[x];
+      }
+      if ((err = rijndael_ecb_decrypt(pt, pt, skey1)) != CRYPT_OK) {
+         return err;
+      }
+      for (x = 0; x < 16; x++) {
+         pt[x] ^= tweak[x];
+      }
+      s_aes_xts_mult_x(tweak);
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+#endif /* ENCRYPT_ONLY */
+#endif /* LTC_AES_NI || LTC_AES_BITSLICE */
+
+#if defined(LTC_AES_NI) && defined(LTC_CCM_MODE)
+/**
+  CCM encrypt/decrypt and produce an authentication tag
+  @param key        The secret key to use
+  @param keylen     The length of the secret key (octets)
+  @param uskey      A previously scheduled key [optional can be NULL]
+  @param nonce      The session nonce [use once]
+  @param noncelen   The length of the nonce
+  @param header     The header for the session
+  @param headerlen  The length of the header (octets)
+  @param pt         The plaintext
+  @param ptlen      The length of the plaintext (octets)
+  @param ct         The ciphertext
+  @param tag        The destination tag
+  @param taglen     The max size and resulting size of the authentication tag
+  @param direction  Encrypt or Decrypt direction (0 or 1)
+  @return CRYPT_OK on success, CRYPT_NOP if ccm_memory() has to use the generic implementation
+*/
+static int s_aes_accel_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                                  symmetric_key       *uskey,
+                                  const unsigned char *nonce,  unsigned long noncelen,
+                                  const unsigned char *header, unsigned long headerlen,
+                                        unsigned char *pt,     unsigned long ptlen,
+                                        unsigned char *ct,
+                                        unsigned char *tag,    unsigned long *taglen,
+                                                  int  direction)
+{
+   if (s_aesni_is_supported()) {
+      return aesni_accel_ccm_memory(key, keylen, uskey, nonce, noncelen, header, headerlen, pt, ptlen, ct, tag, taglen, direction);
+   }
+   return CRYPT_NOP;
+}
+#endif
+
+#if defined(LTC_AES_NI) && defined(LTC_GCM_MODE)
+#if defined(LTC_AES_VAES)
+/* the higher powers of H and the wide registers only pay off
+ * for longer packets, shorter ones are faster with AES-NI */
+#define VAES_GCM_MIN_LEN 1024
+#endif
+
+/**
+  Process an entire GCM packet in one call
+  @param key               The secret key
+  @param keylen            The length of the secret key
+  @param IV                The initialization vector
+  @param IVlen             The length of the initialization vector
+  @param adata             The additional authentication data (header)
+  @param adatalen          The length of the adata
+  @param pt                The plaintext
+  @param ptlen             The length of the plaintext (ciphertext length is the same)
+  @param ct                The ciphertext
+  @param tag               [out] The MAC tag
+  @param taglen            [in/out] The MAC tag length
+  @param direction         Encrypt or Decrypt mode (GCM_ENCRYPT or GCM_DECRYPT)
+  @return CRYPT_OK on success, CRYPT_NOP if gcm_memory() has to use the generic implementation
+*/
+static int s_aes_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                                  const unsigned char *IV,     unsigned long IVlen,
+                                  const unsigned char *adata,  unsigned long adatalen,
+                                        unsigned char *pt,     unsigned long ptlen,
+                                        unsigned char *ct,
+                                        unsigned char *tag,    unsigned long *taglen,
+                                                  int direction)
+{
+#if defined(LTC_AES_VAES)
+   int err;
+   if (ptlen >= VAES_GCM_MIN_LEN && vaes512_is_supported()) {
+      /* CRYPT_NOP if the CPU lacks VPCLMULQDQ */
+      err = vaes512_accel_gcm_memory(key, keylen, IV, IVlen, adata, adatalen, pt, ptlen, ct, tag, taglen, direction);
+      if (err != CRYPT_NOP) {
+         return err;
+      }
+   }
+#endif
+   if (s_aesni_is_supported()) {
+      return aesni_accel_gcm_memory(key, keylen, IV, IVlen, adata, adatalen, pt, ptlen, ct, tag, taglen, direction);
+   }
+   return CRYPT_NOP;
+}
+#endif
+
 /**
   Performs a self-test of the AES block cipher
   @return CRYPT_OK if functional, CRYPT_NOP if self-test has been disabled
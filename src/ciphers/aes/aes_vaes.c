@@ -0,0 +1,1286 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file aes_vaes.c
+  Multi-block AES via the VAES instructions on x86_64
+
+  VAES extends AESENC & friends to 256 and 512 bit registers, i.e. a single
+  instruction processes two resp. four blocks.  The key schedule is the one
+  of aesni_setup(), single blocks and short tails are handled by the
+  AES-NI code.  With VPCLMULQDQ the GHASH of GCM is computed on the
+  same register width, four blocks per instruction.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_AES_VAES)
+
+/* Number of registers that are processed in parallel */
+#define VAES_PAR 8
+
+#define VAES512_FEATURES (LTC_CPU_AES | LTC_CPU_SSE41 | LTC_CPU_VAES | LTC_CPU_AVX512F | LTC_CPU_AVX512BW)
+#define VAES256_FEATURES (LTC_CPU_AES | LTC_CPU_SSE41 | LTC_CPU_VAES | LTC_CPU_AVX2)
+
+/**
+  Check whether the CPU supports VAES on 512 bit registers
+  @return 1 if supported, 0 otherwise
+*/
+int vaes512_is_supported(void)
+{
+   return (ltc_cpu_features() & VAES512_FEATURES) == VAES512_FEATURES;
+}
+
+/**
+  Check whether the CPU supports VAES on 256 bit registers
+  @return 1 if supported, 0 otherwise
+*/
+int vaes256_is_supported(void)
+{
+   return (ltc_cpu_features() & VAES256_FEATURES) == VAES256_FEATURES;
+}
+
+/* c.f. s_aesni_xts_mult_x() */
+LTC_ATTRIBUTE((__target__("sse2")))
+static LTC_INLINE __m128i s_vaes_xts_mult_x(__m128i t)
+{
+   __m128i c;
+   c = _mm_srai_epi32(t, 31);
+   c = _mm_shuffle_epi32(c, 0x93);
+   c = _mm_and_si128(c, _mm_set_epi32(1, 1, 1, 0x87));
+   return _mm_xor_si128(_mm_slli_epi32(t, 1), c);
+}
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE __m128i s_vaes_enc1(__m128i b, const unsigned char *skeys, int Nr)
+{
+   int r;
+   b = _mm_xor_si128(b, _mm_loadu_si128((const __m128i*) skeys));
+   for (r = 1; r < Nr; r++) {
+      b = _mm_aesenc_si128(b, _mm_loadu_si128((const __m128i*) (skeys + 16 * r)));
+   }
+   return _mm_aesenclast_si128(b, _mm_loadu_si128((const __m128i*) (skeys + 16 * Nr)));
+}
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE __m128i s_vaes_dec1(__m128i b, const unsigned char *skeys, int Nr)
+{
+   int r;
+   b = _mm_xor_si128(b, _mm_loadu_si128((const __m128i*) skeys));
+   for (r = 1; r < Nr; r++) {
+      b = _mm_aesdec_si128(b, _mm_loadu_si128((const __m128i*) (skeys + 16 * r)));
+   }
+   return _mm_aesdeclast_si128(b, _mm_loadu_si128((const __m128i*) (skeys + 16 * Nr)));
+}
+
+/* The XTS tail, i.e. the last blocks which don't fill a wide register */
+LTC_ATTRIBUTE((__target__("aes")))
+static __m128i s_vaes_xts_tail(const unsigned char *in, unsigned char *out, unsigned long blocks, __m128i T,
+                               const unsigned char *skeys, int Nr, int decrypt)
+{
+   __m128i b;
+   while (blocks-- > 0) {
+      b = _mm_xor_si128(_mm_loadu_si128((const __m128i*) in), T);
+      b = decrypt ? s_vaes_dec1(b, skeys, Nr) : s_vaes_enc1(b, skeys, Nr);
+      _mm_storeu_si128((__m128i*) out, _mm_xor_si128(b, T));
+      T = s_vaes_xts_mult_x(T);
+      in += 16;
+      out += 16;
+   }
+   return T;
+}
+
+/*
+ * 512 bit registers, four blocks per register
+ */
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx512f")))
+static LTC_INLINE void s_vaes512_load_keys(__m512i *rk, const unsigned char *skeys, int Nr)
+{
+   int r;
+   for (r = 0; r <= Nr; r++) {
+      rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*) (skeys + 16 * r)));
+   }
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx512f")))
+static LTC_INLINE void s_vaes512_enc(__m512i *b, int n, const __m512i *rk, int Nr)
+{
+   int i, r;
+   for (i = 0; i < n; i++) {
+      b[i] = _mm512_xor_si512(b[i], rk[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < n; i++) {
+         b[i] = _mm512_aesenc_epi128(b[i], rk[r]);
+      }
+   }
+   for (i = 0; i < n; i++) {
+      b[i] = _mm512_aesenclast_epi128(b[i], rk[Nr]);
+   }
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx512f")))
+static LTC_INLINE void s_vaes512_dec(__m512i *b, int n, const __m512i *rk, int Nr)
+{
+   int i, r;
+   for (i = 0; i < n; i++) {
+      b[i] = _mm512_xor_si512(b[i], rk[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < n; i++) {
+         b[i] = _mm512_aesdec_epi128(b[i], rk[r]);
+      }
+   }
+   for (i = 0; i < n; i++) {
+      b[i] = _mm512_aesdeclast_epi128(b[i], rk[Nr]);
+   }
+}
+
+/* Multiply the XTS tweak in each 128 bit lane by x^4
+ * The four bits shifted out at the top are reduced by a carry-less
+ * multiplication with 0x87, i.e. t ^ t<<1 ^ t<<2 ^ t<<7.
+ */
+LTC_ATTRIBUTE((__target__("avx512f,avx512bw")))
+static LTC_INLINE __m512i s_vaes512_xts_mult_x4(__m512i t)
+{
+   __m512i top, c;
+   top = _mm512_srli_epi64(t, 60);
+   c = _mm512_bslli_epi128(top, 8);
+   top = _mm512_bsrli_epi128(top, 8);
+   top = _mm512_xor_si512(_mm512_xor_si512(top, _mm512_slli_epi64(top, 1)),
+                          _mm512_xor_si512(_mm512_slli_epi64(top, 2), _mm512_slli_epi64(top, 7)));
+   return _mm512_xor_si512(_mm512_xor_si512(_mm512_slli_epi64(t, 4), c), top);
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx512f")))
+static int s_vaes512_ecb(const unsigned char *in, unsigned char *out, unsigned long blocks, symmetric_key *skey, int decrypt)
+{
+   int Nr, i;
+   __m512i rk[15], b[VAES_PAR];
+
+   LTC_ARGCHK(in != NULL);
+   LTC_ARGCHK(out != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   s_vaes512_load_keys(rk, (const unsigned char*) (decrypt ? skey->rijndael.dK : skey->rijndael.eK), Nr);
+
+   while (blocks >= 4 * VAES_PAR) {
+      for (i = 0; i < VAES_PAR; i++) {
+         b[i] = _mm512_loadu_si512((const void*) (in + 64 * i));
+      }
+      if (decrypt) {
+         s_vaes512_dec(b, VAES_PAR, rk, Nr);
+      } else {
+         s_vaes512_enc(b, VAES_PAR, rk, Nr);
+      }
+      for (i = 0; i < VAES_PAR; i++) {
+         _mm512_storeu_si512((void*) (out + 64 * i), b[i]);
+      }
+      in += 64 * VAES_PAR;
+      out += 64 * VAES_PAR;
+      blocks -= 4 * VAES_PAR;
+   }
+   while (blocks >= 4) {
+      b[0] = _mm512_loadu_si512((const void*) in);
+      if (decrypt) {
+         s_vaes512_dec(b, 1, rk, Nr);
+      } else {
+         s_vaes512_enc(b, 1, rk, Nr);
+      }
+      _mm512_storeu_si512((void*) out, b[0]);
+      in += 64;
+      out += 64;
+      blocks -= 4;
+   }
+   if (blocks == 0) {
+      return CRYPT_OK;
+   }
+   if (decrypt) {
+      return aesni_accel_ecb_decrypt(in, out, blocks, skey);
+   }
+   return aesni_accel_ecb_encrypt(in, out, blocks, skey);
+}
+
+/**
+  Encrypts multiple blocks of text with AES, four blocks per instruction
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled by aesni_setup()
+  @return CRYPT_OK if successful
+*/
+int vaes512_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   return s_vaes512_ecb(pt, ct, blocks, skey, 0);
+}
+
+/**
+  Decrypts multiple blocks of text with AES, four blocks per instruction
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled by aesni_setup()
+  @return CRYPT_OK if successful
+*/
+int vaes512_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey)
+{
+   return s_vaes512_ecb(ct, pt, blocks, skey, 1);
+}
+
+/**
+  CTR encrypt multiple blocks with AES, four blocks per instruction
+  As long as the lower 32 bits of the counter don't wrap around, the counter
+  blocks are generated in the wide registers, the rest is left to
+  aesni_accel_ctr_encrypt().
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The current counter, will be updated to the last counter used
+  @param mode   The counter mode (CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN)
+                combined with the width of the counter in octets (0 for the full block)
+  @param skey   The key as scheduled by aesni_setup()
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes,vaes,avx512f,avx512bw")))
+int vaes512_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   int Nr, i, width, big;
+   __m512i rk[15], b[VAES_PAR], c[VAES_PAR], base, inc, bswap;
+   __m128i ctr, bswap128;
+   ulong32 lo;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   width = (mode & 255) ? (mode & 255) : 16;
+   big = (mode & CTR_COUNTER_BIG_ENDIAN) == CTR_COUNTER_BIG_ENDIAN;
+   if (width > 16) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   if (width >= 4 && blocks >= 4 * VAES_PAR) {
+      /* the counter is kept as little-endian 128 bit integer in `ctr` */
+      bswap128 = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+      bswap = _mm512_broadcast_i32x4(bswap128);
+      ctr = _mm_loadu_si128((const __m128i*) IV);
+      if (big) {
+         ctr = _mm_shuffle_epi8(ctr, bswap128);
+      }
+      lo = (ulong32)_mm_cvtsi128_si32(ctr);
+      if (lo <= 0xFFFFFFFFUL - 4 * VAES_PAR) {
+         s_vaes512_load_keys(rk, (const unsigned char*) skey->rijndael.eK, Nr);
+         base = _mm512_add_epi32(_mm512_broadcast_i32x4(ctr), _mm512_set_epi32(0, 0, 0, 4, 0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 1));
+         inc = _mm512_set_epi32(0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4);
+         do {
+            for (i = 0; i < VAES_PAR; i++) {
+               c[i] = base;
+               b[i] = big ? _mm512_shuffle_epi8(base, bswap) : base;
+               base = _mm512_add_epi32(base, inc);
+            }
+            s_vaes512_enc(b, VAES_PAR, rk, Nr);
+            for (i = 0; i < VAES_PAR; i++) {
+               b[i] = _mm512_xor_si512(b[i], _mm512_loadu_si512((const void*) (pt + 64 * i)));
+               _mm512_storeu_si512((void*) (ct + 64 * i), b[i]);
+            }
+            pt += 64 * VAES_PAR;
+            ct += 64 * VAES_PAR;
+            blocks -= 4 * VAES_PAR;
+            lo += 4 * VAES_PAR;
+         } while (blocks >= 4 * VAES_PAR && lo <= 0xFFFFFFFFUL - 4 * VAES_PAR);
+         /* the last counter used is in the top lane */
+         ctr = _mm512_extracti32x4_epi32(c[VAES_PAR - 1], 3);
+         if (big) {
+            ctr = _mm_shuffle_epi8(ctr, bswap128);
+         }
+         _mm_storeu_si128((__m128i*) IV, ctr);
+      }
+   }
+   if (blocks == 0) {
+      return CRYPT_OK;
+   }
+   return aesni_accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey);
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx512f,avx512bw")))
+static int s_vaes512_xts(const unsigned char *in, unsigned char *out, unsigned long blocks, unsigned char *tweak,
+                         const symmetric_key *skey1, const symmetric_key *skey2, int decrypt)
+{
+   int Nr, i;
+   const unsigned char *skeys;
+   __m512i rk[15], b[VAES_PAR], t[VAES_PAR], base;
+   __m128i T, T1, T2, T3;
+
+   LTC_ARGCHK(in != NULL);
+   LTC_ARGCHK(out != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14 || skey2->rijndael.Nr != Nr) return CRYPT_INVALID_ROUNDS;
+
+   T = s_vaes_enc1(_mm_loadu_si128((const __m128i*) tweak), (const unsigned char*) skey2->rijndael.eK, Nr);
+   skeys = (const unsigned char*) (decrypt ? skey1->rijndael.dK : skey1->rijndael.eK);
+
+   if (blocks >= 4) {
+      s_vaes512_load_keys(rk, skeys, Nr);
+      T1 = s_vaes_xts_mult_x(T);
+      T2 = s_vaes_xts_mult_x(T1);
+      T3 = s_vaes_xts_mult_x(T2);
+      base = _mm512_inserti32x4(_mm512_castsi128_si512(T), T1, 1);
+      base = _mm512_inserti32x4(base, T2, 2);
+      base = _mm512_inserti32x4(base, T3, 3);
+
+      while (blocks >= 4 * VAES_PAR) {
+         for (i = 0; i < VAES_PAR; i++) {
+            t[i] = base;
+            b[i] = _mm512_xor_si512(_mm512_loadu_si512((const void*) (in + 64 * i)), base);
+            base = s_vaes512_xts_mult_x4(base);
+         }
+         if (decrypt) {
+            s_vaes512_dec(b, VAES_PAR, rk, Nr);
+         } else {
+            s_vaes512_enc(b, VAES_PAR, rk, Nr);
+         }
+         for (i = 0; i < VAES_PAR; i++) {
+            _mm512_storeu_si512((void*) (out + 64 * i), _mm512_xor_si512(b[i], t[i]));
+         }
+         in += 64 * VAES_PAR;
+         out += 64 * VAES_PAR;
+         blocks -= 4 * VAES_PAR;
+      }
+      while (blocks >= 4) {
+         b[0] = _mm512_xor_si512(_mm512_loadu_si512((const void*) in), base);
+         if (decrypt) {
+            s_vaes512_dec(b, 1, rk, Nr);
+         } else {
+            s_vaes512_enc(b, 1, rk, Nr);
+         }
+         _mm512_storeu_si512((void*) out, _mm512_xor_si512(b[0], base));
+         base = s_vaes512_xts_mult_x4(base);
+         in += 64;
+         out += 64;
+         blocks -= 4;
+      }
+      T = _mm512_castsi512_si128(base);
+   }
+   T = s_vaes_xts_tail(in, out, blocks, T, skeys, Nr, decrypt);
+   _mm_storeu_si128((__m128i*) tweak, T);
+
+   return CRYPT_OK;
+}
+
+/**
+  XTS encrypt multiple blocks with AES, four blocks per instruction
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+int vaes512_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                              const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   return s_vaes512_xts(pt, ct, blocks, tweak, skey1, skey2, 0);
+}
+
+/**
+  XTS decrypt multiple blocks with AES, four blocks per instruction
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+int vaes512_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                              const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   return s_vaes512_xts(ct, pt, blocks, tweak, skey1, skey2, 1);
+}
+
+#if defined(LTC_GCM_MODE)
+
+/* Number of registers per step of the stitched GCM, i.e. 16 blocks */
+#define VAES_GCM_PAR 4
+
+#define VAES512_GCM_FEATURES (VAES512_FEATURES | LTC_CPU_SSSE3 | LTC_CPU_PCLMUL | LTC_CPU_VPCLMUL)
+
+/* c.f. AESNI_GCM_BSWAP, applied to each 128 bit lane */
+#define VAES_GCM_BSWAP _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)
+
+/* c.f. s_aesni_gcm_mul() */
+LTC_ATTRIBUTE((__target__("pclmul,sse2")))
+static LTC_INLINE void s_vaes_gcm_mul(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+   __m128i mid;
+   *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+   *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+   mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+   *lo = _mm_xor_si128(*lo, _mm_slli_si128(mid, 8));
+   *hi = _mm_xor_si128(*hi, _mm_srli_si128(mid, 8));
+}
+
+/* c.f. s_aesni_gcm_reduce() */
+LTC_ATTRIBUTE((__target__("sse2")))
+static LTC_INLINE __m128i s_vaes_gcm_reduce(__m128i lo, __m128i hi)
+{
+   __m128i t7, t8, t9, t2, t4, t5;
+
+   t7 = _mm_srli_epi32(lo, 31);
+   t8 = _mm_srli_epi32(hi, 31);
+   lo = _mm_slli_epi32(lo, 1);
+   hi = _mm_slli_epi32(hi, 1);
+   t9 = _mm_srli_si128(t7, 12);
+   t8 = _mm_slli_si128(t8, 4);
+   t7 = _mm_slli_si128(t7, 4);
+   lo = _mm_or_si128(lo, t7);
+   hi = _mm_or_si128(hi, t8);
+   hi = _mm_or_si128(hi, t9);
+
+   t7 = _mm_slli_epi32(lo, 31);
+   t8 = _mm_slli_epi32(lo, 30);
+   t9 = _mm_slli_epi32(lo, 25);
+   t7 = _mm_xor_si128(t7, t8);
+   t7 = _mm_xor_si128(t7, t9);
+   t8 = _mm_srli_si128(t7, 4);
+   t7 = _mm_slli_si128(t7, 12);
+   lo = _mm_xor_si128(lo, t7);
+
+   t2 = _mm_srli_epi32(lo, 1);
+   t4 = _mm_srli_epi32(lo, 2);
+   t5 = _mm_srli_epi32(lo, 7);
+   t2 = _mm_xor_si128(t2, t4);
+   t2 = _mm_xor_si128(t2, t5);
+   t2 = _mm_xor_si128(t2, t8);
+   lo = _mm_xor_si128(lo, t2);
+   return _mm_xor_si128(hi, lo);
+}
+
+LTC_ATTRIBUTE((__target__("pclmul,sse2")))
+static LTC_INLINE __m128i s_vaes_gcm_gfmul(__m128i a, __m128i b)
+{
+   __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+   s_vaes_gcm_mul(a, b, &lo, &hi);
+   return s_vaes_gcm_reduce(lo, hi);
+}
+
+/* s_vaes_gcm_mul() of the four lanes at once */
+LTC_ATTRIBUTE((__target__("vpclmulqdq,avx512f,avx512bw")))
+static LTC_INLINE void s_vaes512_gcm_mul(__m512i a, __m512i b, __m512i *lo, __m512i *hi)
+{
+   __m512i mid;
+   *lo = _mm512_xor_si512(*lo, _mm512_clmulepi64_epi128(a, b, 0x00));
+   *hi = _mm512_xor_si512(*hi, _mm512_clmulepi64_epi128(a, b, 0x11));
+   mid = _mm512_xor_si512(_mm512_clmulepi64_epi128(a, b, 0x10), _mm512_clmulepi64_epi128(a, b, 0x01));
+   *lo = _mm512_xor_si512(*lo, _mm512_bslli_epi128(mid, 8));
+   *hi = _mm512_xor_si512(*hi, _mm512_bsrli_epi128(mid, 8));
+}
+
+/* Add up the unreduced products of the four lanes, the reduction is linear
+ * so it's only done once for all of them */
+LTC_ATTRIBUTE((__target__("avx512f")))
+static LTC_INLINE __m128i s_vaes512_gcm_reduce(__m512i lo, __m512i hi)
+{
+   __m128i l, h;
+   l = _mm_xor_si128(_mm_xor_si128(_mm512_castsi512_si128(lo), _mm512_extracti32x4_epi32(lo, 1)),
+                     _mm_xor_si128(_mm512_extracti32x4_epi32(lo, 2), _mm512_extracti32x4_epi32(lo, 3)));
+   h = _mm_xor_si128(_mm_xor_si128(_mm512_castsi512_si128(hi), _mm512_extracti32x4_epi32(hi, 1)),
+                     _mm_xor_si128(_mm512_extracti32x4_epi32(hi, 2), _mm512_extracti32x4_epi32(hi, 3)));
+   return s_vaes_gcm_reduce(l, h);
+}
+
+/* Load four byte-reflected blocks, `x` is added to the first one */
+LTC_ATTRIBUTE((__target__("avx512f,avx512bw")))
+static LTC_INLINE __m512i s_vaes512_gcm_load(const unsigned char *in, __m128i x, __m512i bswap)
+{
+   __m512i d = _mm512_shuffle_epi8(_mm512_loadu_si512((const void*) in), bswap);
+   return _mm512_xor_si512(d, _mm512_inserti32x4(_mm512_setzero_si512(), x, 0));
+}
+
+/* GHASH `len` bytes of `in` into `x`, a final partial block is padded with zeros.
+ * hp[j] contains H^(16-4j) ... H^(13-4j) in its lanes, h1 is H. */
+LTC_ATTRIBUTE((__target__("pclmul,vpclmulqdq,avx512f,avx512bw")))
+static __m128i s_vaes512_gcm_ghash(__m128i x, const unsigned char *in, unsigned long len, const __m512i *hp, __m128i h1)
+{
+   __m512i bswap, lo, hi, d;
+   unsigned char buf[16];
+   int j;
+
+   bswap = _mm512_broadcast_i32x4(VAES_GCM_BSWAP);
+   while (len >= 64 * VAES_GCM_PAR) {
+      lo = _mm512_setzero_si512();
+      hi = _mm512_setzero_si512();
+      for (j = 0; j < VAES_GCM_PAR; j++) {
+         d = s_vaes512_gcm_load(in + 64 * j, j == 0 ? x : _mm_setzero_si128(), bswap);
+         s_vaes512_gcm_mul(d, hp[j], &lo, &hi);
+      }
+      x = s_vaes512_gcm_reduce(lo, hi);
+      in += 64 * VAES_GCM_PAR;
+      len -= 64 * VAES_GCM_PAR;
+   }
+   while (len >= 64) {
+      lo = _mm512_setzero_si512();
+      hi = _mm512_setzero_si512();
+      s_vaes512_gcm_mul(s_vaes512_gcm_load(in, x, bswap), hp[VAES_GCM_PAR - 1], &lo, &hi);
+      x = s_vaes512_gcm_reduce(lo, hi);
+      in += 64;
+      len -= 64;
+   }
+   while (len > 0) {
+      zeromem(buf, sizeof(buf));
+      XMEMCPY(buf, in, MIN(len, 16));
+      x = s_vaes_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), VAES_GCM_BSWAP)), h1);
+      in += MIN(len, 16);
+      len -= MIN(len, 16);
+   }
+   return x;
+}
+
+/* Encrypt sixteen counter blocks while the GHASH of the sixteen blocks `d` is computed */
+LTC_ATTRIBUTE((__target__("aes,vaes,vpclmulqdq,avx512f,avx512bw")))
+static LTC_INLINE void s_vaes512_gcm_enc_ghash(__m512i *b, const __m512i *rk, int Nr,
+                                               const __m512i *d, const __m512i *hp, __m512i *lo, __m512i *hi)
+{
+   int i, r;
+   for (i = 0; i < VAES_GCM_PAR; i++) {
+      b[i] = _mm512_xor_si512(b[i], rk[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < VAES_GCM_PAR; i++) {
+         b[i] = _mm512_aesenc_epi128(b[i], rk[r]);
+      }
+      /* one register of four multiplications per round, Nr is at least 10 */
+      if (r <= VAES_GCM_PAR) {
+         s_vaes512_gcm_mul(d[r - 1], hp[r - 1], lo, hi);
+      }
+   }
+   for (i = 0; i < VAES_GCM_PAR; i++) {
+      b[i] = _mm512_aesenclast_epi128(b[i], rk[Nr]);
+   }
+}
+
+/**
+  Process an entire GCM packet in one call, sixteen blocks at a time
+  c.f. aesni_accel_gcm_memory(), the CTR encryption of four registers of
+  counter blocks is interleaved with the GHASH of four registers of
+  ciphertext blocks via VPCLMULQDQ.
+  @param key               The secret key
+  @param keylen            The length of the secret key
+  @param IV                The initialization vector
+  @param IVlen             The length of the initialization vector
+  @param adata             The additional authentication data (header)
+  @param adatalen          The length of the adata
+  @param pt                The plaintext
+  @param ptlen             The length of the plaintext (ciphertext length is the same)
+  @param ct                The ciphertext
+  @param tag               [out] The MAC tag
+  @param taglen            [in/out] The MAC tag length
+  @param direction         Encrypt or Decrypt mode (GCM_ENCRYPT or GCM_DECRYPT)
+  @return CRYPT_OK on success, CRYPT_NOP if the CPU doesn't support VAES and VPCLMULQDQ on 512 bit registers
+*/
+LTC_ATTRIBUTE((__target__("aes,pclmul,ssse3,vaes,vpclmulqdq,avx512f,avx512bw")))
+int vaes512_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                             const unsigned char *IV,     unsigned long IVlen,
+                             const unsigned char *adata,  unsigned long adatalen,
+                                   unsigned char *pt,     unsigned long ptlen,
+                                   unsigned char *ct,
+                                   unsigned char *tag,    unsigned long *taglen,
+                                             int direction)
+{
+   symmetric_key skey;
+   const unsigned char *skeys;
+   __m512i rk[15], hp[VAES_GCM_PAR], b[VAES_GCM_PAR], d[VAES_GCM_PAR], bswap, cb, inc, lo, hi;
+   __m128i h[4 * VAES_GCM_PAR], x, ctr, ek0, ks, c, one;
+   unsigned char buf[16];
+   unsigned long i, n;
+   int err, Nr, j;
+
+   LTC_ARGCHK(key    != NULL);
+   LTC_ARGCHK(IV     != NULL);
+   LTC_ARGCHK(tag    != NULL);
+   LTC_ARGCHK(taglen != NULL);
+   if (adatalen > 0) {
+      LTC_ARGCHK(adata != NULL);
+   }
+   if (ptlen > 0) {
+      LTC_ARGCHK(pt != NULL);
+      LTC_ARGCHK(ct != NULL);
+   }
+
+   if ((ltc_cpu_features() & VAES512_GCM_FEATURES) != VAES512_GCM_FEATURES) {
+      return CRYPT_NOP;
+   }
+
+   if (direction != GCM_ENCRYPT && direction != GCM_DECRYPT) {
+      return CRYPT_INVALID_ARG;
+   }
+   /* IV length must be > 0 */
+   if (IVlen == 0) {
+      return CRYPT_ERROR;
+   }
+   /* 0xFFFFFFFE0 = ((2^39)-256)/8 */
+   if ((ulong64)ptlen >= CONST64(0xFFFFFFFE0)) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (keylen > 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+
+   if ((err = aesni_setup(key, (int)keylen, 0, &skey)) != CRYPT_OK) {
+      return err;
+   }
+   skeys = (const unsigned char*) skey.rijndael.eK;
+   Nr = skey.rijndael.Nr;
+
+   bswap = _mm512_broadcast_i32x4(VAES_GCM_BSWAP);
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   /* H = E(0), the higher powers are only required for four blocks at once */
+   h[0] = _mm_shuffle_epi8(s_vaes_enc1(_mm_setzero_si128(), skeys, Nr), VAES_GCM_BSWAP);
+   if (IVlen >= 64 || adatalen >= 64 || ptlen >= 64) {
+      for (j = 1; j < 4 * VAES_GCM_PAR; j++) {
+         h[j] = s_vaes_gcm_gfmul(h[j - 1], h[0]);
+      }
+      /* the block in lane l of register j is multiplied by H^(16-4j-l) */
+      for (j = 0; j < VAES_GCM_PAR; j++) {
+         hp[j] = _mm512_castsi128_si512(h[4 * (VAES_GCM_PAR - j) - 1]);
+         hp[j] = _mm512_inserti32x4(hp[j], h[4 * (VAES_GCM_PAR - j) - 2], 1);
+         hp[j] = _mm512_inserti32x4(hp[j], h[4 * (VAES_GCM_PAR - j) - 3], 2);
+         hp[j] = _mm512_inserti32x4(hp[j], h[4 * (VAES_GCM_PAR - j) - 4], 3);
+      }
+   }
+
+   /* the counter is kept byte-reflected, i.e. the lower 32 bits are in the lowest lane */
+   if (IVlen == 12) {
+      XMEMCPY(buf, IV, 12);
+      buf[12] = 0;
+      buf[13] = 0;
+      buf[14] = 0;
+      buf[15] = 1;
+      ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), VAES_GCM_BSWAP);
+   } else {
+      x = s_vaes512_gcm_ghash(_mm_setzero_si128(), IV, IVlen, hp, h[0]);
+      zeromem(buf, 8);
+      STORE64H((ulong64)IVlen * 8, buf + 8);
+      ctr = s_vaes_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), VAES_GCM_BSWAP)), h[0]);
+   }
+   ek0 = s_vaes_enc1(_mm_shuffle_epi8(ctr, VAES_GCM_BSWAP), skeys, Nr);
+
+   x = s_vaes512_gcm_ghash(_mm_setzero_si128(), adata, adatalen, hp, h[0]);
+
+   i = 0;
+   if (ptlen >= 64) {
+      s_vaes512_load_keys(rk, skeys, Nr);
+      /* the counters ctr+1 ... ctr+4 in the lanes, the lower 32 bits wrap around like in gcm_add_iv() */
+      cb = _mm512_add_epi32(_mm512_broadcast_i32x4(ctr), _mm512_set_epi32(0, 0, 0, 4, 0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 1));
+      inc = _mm512_set_epi32(0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4);
+
+      if (direction == GCM_ENCRYPT) {
+         if (ptlen >= 64 * VAES_GCM_PAR) {
+            /* the first sixteen blocks are only encrypted */
+            for (j = 0; j < VAES_GCM_PAR; j++) {
+               b[j] = _mm512_shuffle_epi8(cb, bswap);
+               cb = _mm512_add_epi32(cb, inc);
+            }
+            s_vaes512_enc(b, VAES_GCM_PAR, rk, Nr);
+            for (j = 0; j < VAES_GCM_PAR; j++) {
+               _mm512_storeu_si512((void*) (ct + 64 * j), _mm512_xor_si512(b[j], _mm512_loadu_si512((const void*) (pt + 64 * j))));
+               d[j] = s_vaes512_gcm_load(ct + 64 * j, j == 0 ? x : _mm_setzero_si128(), bswap);
+            }
+            i = 64 * VAES_GCM_PAR;
+            /* then the next sixteen blocks are encrypted while the previous ones are hashed */
+            while (ptlen - i >= 64 * VAES_GCM_PAR) {
+               for (j = 0; j < VAES_GCM_PAR; j++) {
+                  b[j] = _mm512_shuffle_epi8(cb, bswap);
+                  cb = _mm512_add_epi32(cb, inc);
+               }
+               lo = _mm512_setzero_si512();
+               hi = _mm512_setzero_si512();
+               s_vaes512_gcm_enc_ghash(b, rk, Nr, d, hp, &lo, &hi);
+               x = s_vaes512_gcm_reduce(lo, hi);
+               for (j = 0; j < VAES_GCM_PAR; j++) {
+                  _mm512_storeu_si512((void*) (ct + i + 64 * j), _mm512_xor_si512(b[j], _mm512_loadu_si512((const void*) (pt + i + 64 * j))));
+                  d[j] = s_vaes512_gcm_load(ct + i + 64 * j, j == 0 ? x : _mm_setzero_si128(), bswap);
+               }
+               i += 64 * VAES_GCM_PAR;
+            }
+            /* and finally the last sixteen blocks are hashed */
+            lo = _mm512_setzero_si512();
+            hi = _mm512_setzero_si512();
+            for (j = 0; j < VAES_GCM_PAR; j++) {
+               s_vaes512_gcm_mul(d[j], hp[j], &lo, &hi);
+            }
+            x = s_vaes512_gcm_reduce(lo, hi);
+         }
+      } else {
+         while (ptlen - i >= 64 * VAES_GCM_PAR) {
+            for (j = 0; j < VAES_GCM_PAR; j++) {
+               b[j] = _mm512_shuffle_epi8(cb, bswap);
+               cb = _mm512_add_epi32(cb, inc);
+               d[j] = s_vaes512_gcm_load(ct + i + 64 * j, j == 0 ? x : _mm_setzero_si128(), bswap);
+            }
+            lo = _mm512_setzero_si512();
+            hi = _mm512_setzero_si512();
+            s_vaes512_gcm_enc_ghash(b, rk, Nr, d, hp, &lo, &hi);
+            x = s_vaes512_gcm_reduce(lo, hi);
+            for (j = 0; j < VAES_GCM_PAR; j++) {
+               _mm512_storeu_si512((void*) (pt + i + 64 * j), _mm512_xor_si512(b[j], _mm512_loadu_si512((const void*) (ct + i + 64 * j))));
+            }
+            i += 64 * VAES_GCM_PAR;
+         }
+      }
+
+      /* the remaining groups of four blocks */
+      while (ptlen - i >= 64) {
+         b[0] = _mm512_shuffle_epi8(cb, bswap);
+         cb = _mm512_add_epi32(cb, inc);
+         s_vaes512_enc(b, 1, rk, Nr);
+         if (direction == GCM_ENCRYPT) {
+            _mm512_storeu_si512((void*) (ct + i), _mm512_xor_si512(b[0], _mm512_loadu_si512((const void*) (pt + i))));
+            d[0] = s_vaes512_gcm_load(ct + i, x, bswap);
+         } else {
+            d[0] = s_vaes512_gcm_load(ct + i, x, bswap);
+            _mm512_storeu_si512((void*) (pt + i), _mm512_xor_si512(b[0], _mm512_loadu_si512((const void*) (ct + i))));
+         }
+         lo = _mm512_setzero_si512();
+         hi = _mm512_setzero_si512();
+         s_vaes512_gcm_mul(d[0], hp[VAES_GCM_PAR - 1], &lo, &hi);
+         x = s_vaes512_gcm_reduce(lo, hi);
+         i += 64;
+      }
+      /* the lowest lane contains the next counter */
+      ctr = _mm_sub_epi32(_mm512_castsi512_si128(cb), one);
+   }
+
+   /* the remaining blocks one by one, the last one may be partial */
+   while (i < ptlen) {
+      n = MIN(ptlen - i, 16);
+      ctr = _mm_add_epi32(ctr, one);
+      ks = s_vaes_enc1(_mm_shuffle_epi8(ctr, VAES_GCM_BSWAP), skeys, Nr);
+      zeromem(buf, sizeof(buf));
+      if (direction == GCM_ENCRYPT) {
+         XMEMCPY(buf, pt + i, n);
+         _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(ks, _mm_loadu_si128((const __m128i*) buf)));
+         XMEMCPY(ct + i, buf, n);
+         /* the padding of the partial block must be zero for GHASH */
+         zeromem(buf + n, sizeof(buf) - n);
+         c = _mm_loadu_si128((const __m128i*) buf);
+      } else {
+         XMEMCPY(buf, ct + i, n);
+         c = _mm_loadu_si128((const __m128i*) buf);
+         _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(ks, c));
+         XMEMCPY(pt + i, buf, n);
+      }
+      x = s_vaes_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(c, VAES_GCM_BSWAP)), h[0]);
+      i += n;
+   }
+
+   /* mix in the lengths and compute the tag */
+   STORE64H((ulong64)adatalen * 8, buf);
+   STORE64H((ulong64)ptlen * 8, buf + 8);
+   x = s_vaes_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), VAES_GCM_BSWAP)), h[0]);
+   _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(ek0, _mm_shuffle_epi8(x, VAES_GCM_BSWAP)));
+
+   if (direction == GCM_ENCRYPT) {
+      for (i = 0; i < 16 && i < *taglen; i++) {
+         tag[i] = buf[i];
+      }
+      *taglen = i;
+   } else if (*taglen != 16 || XMEM_NEQ(buf, tag, 16) != 0) {
+      err = CRYPT_ERROR;
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(&skey, sizeof(skey));
+   zeromem(buf, sizeof(buf));
+#endif
+
+   return err;
+}
+
+#endif /* LTC_GCM_MODE */
+
+/*
+ * 256 bit registers, two blocks per register
+ */
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx2")))
+static LTC_INLINE void s_vaes256_load_keys(__m256i *rk, const unsigned char *skeys, int Nr)
+{
+   int r;
+   for (r = 0; r <= Nr; r++) {
+      rk[r] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) (skeys + 16 * r)));
+   }
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx2")))
+static LTC_INLINE void s_vaes256_enc(__m256i *b, int n, const __m256i *rk, int Nr)
+{
+   int i, r;
+   for (i = 0; i < n; i++) {
+      b[i] = _mm256_xor_si256(b[i], rk[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < n; i++) {
+         b[i] = _mm256_aesenc_epi128(b[i], rk[r]);
+      }
+   }
+   for (i = 0; i < n; i++) {
+      b[i] = _mm256_aesenclast_epi128(b[i], rk[Nr]);
+   }
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx2")))
+static LTC_INLINE void s_vaes256_dec(__m256i *b, int n, const __m256i *rk, int Nr)
+{
+   int i, r;
+   for (i = 0; i < n; i++) {
+      b[i] = _mm256_xor_si256(b[i], rk[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < n; i++) {
+         b[i] = _mm256_aesdec_epi128(b[i], rk[r]);
+      }
+   }
+   for (i = 0; i < n; i++) {
+      b[i] = _mm256_aesdeclast_epi128(b[i], rk[Nr]);
+   }
+}
+
+/* Multiply the XTS tweak in each 128 bit lane by x^2, c.f. s_vaes512_xts_mult_x4() */
+LTC_ATTRIBUTE((__target__("avx2")))
+static LTC_INLINE __m256i s_vaes256_xts_mult_x2(__m256i t)
+{
+   __m256i top, c;
+   top = _mm256_srli_epi64(t, 62);
+   c = _mm256_bslli_epi128(top, 8);
+   top = _mm256_bsrli_epi128(top, 8);
+   top = _mm256_xor_si256(_mm256_xor_si256(top, _mm256_slli_epi64(top, 1)),
+                          _mm256_xor_si256(_mm256_slli_epi64(top, 2), _mm256_slli_epi64(top, 7)));
+   return _mm256_xor_si256(_mm256_xor_si256(_mm256_slli_epi64(t, 2), c), top);
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx2")))
+static int s_vaes256_ecb(const unsigned char *in, unsigned char *out, unsigned long blocks, symmetric_key *skey, int decrypt)
+{
+   int Nr, i;
+   __m256i rk[15], b[VAES_PAR];
+
+   LTC_ARGCHK(in != NULL);
+   LTC_ARGCHK(out != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   s_vaes256_load_keys(rk, (const unsigned char*) (decrypt ? skey->rijndael.dK : skey->rijndael.eK), Nr);
+
+   while (blocks >= 2 * VAES_PAR) {
+      for (i = 0; i < VAES_PAR; i++) {
+         b[i] = _mm256_loadu_si256((const __m256i*) (in + 32 * i));
+      }
+      if (decrypt) {
+         s_vaes256_dec(b, VAES_PAR, rk, Nr);
+      } else {
+         s_vaes256_enc(b, VAES_PAR, rk, Nr);
+      }
+      for (i = 0; i < VAES_PAR; i++) {
+         _mm256_storeu_si256((__m256i*) (out + 32 * i), b[i]);
+      }
+      in += 32 * VAES_PAR;
+      out += 32 * VAES_PAR;
+      blocks -= 2 * VAES_PAR;
+   }
+   if (blocks == 0) {
+      return CRYPT_OK;
+   }
+   if (decrypt) {
+      return aesni_accel_ecb_decrypt(in, out, blocks, skey);
+   }
+   return aesni_accel_ecb_encrypt(in, out, blocks, skey);
+}
+
+/**
+  Encrypts multiple blocks of text with AES, two blocks per instruction
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled by aesni_setup()
+  @return CRYPT_OK if successful
+*/
+int vaes256_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   return s_vaes256_ecb(pt, ct, blocks, skey, 0);
+}
+
+/**
+  Decrypts multiple blocks of text with AES, two blocks per instruction
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled by aesni_setup()
+  @return CRYPT_OK if successful
+*/
+int vaes256_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey)
+{
+   return s_vaes256_ecb(ct, pt, blocks, skey, 1);
+}
+
+/**
+  CTR encrypt multiple blocks with AES, two blocks per instruction
+  c.f. vaes512_accel_ctr_encrypt()
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The current counter, will be updated to the last counter used
+  @param mode   The counter mode (CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN)
+                combined with the width of the counter in octets (0 for the full block)
+  @param skey   The key as scheduled by aesni_setup()
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes,vaes,avx2")))
+int vaes256_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   int Nr, i, width, big;
+   __m256i rk[15], b[VAES_PAR], c[VAES_PAR], base, inc, bswap;
+   __m128i ctr, bswap128;
+   ulong32 lo;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   width = (mode & 255) ? (mode & 255) : 16;
+   big = (mode & CTR_COUNTER_BIG_ENDIAN) == CTR_COUNTER_BIG_ENDIAN;
+   if (width > 16) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   if (width >= 4 && blocks >= 2 * VAES_PAR) {
+      bswap128 = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+      bswap = _mm256_broadcastsi128_si256(bswap128);
+      ctr = _mm_loadu_si128((const __m128i*) IV);
+      if (big) {
+         ctr = _mm_shuffle_epi8(ctr, bswap128);
+      }
+      lo = (ulong32)_mm_cvtsi128_si32(ctr);
+      if (lo <= 0xFFFFFFFFUL - 2 * VAES_PAR) {
+         s_vaes256_load_keys(rk, (const unsigned char*) skey->rijndael.eK, Nr);
+         base = _mm256_add_epi32(_mm256_broadcastsi128_si256(ctr), _mm256_set_epi32(0, 0, 0, 2, 0, 0, 0, 1));
+         inc = _mm256_set_epi32(0, 0, 0, 2, 0, 0, 0, 2);
+         do {
+            for (i = 0; i < VAES_PAR; i++) {
+               c[i] = base;
+               b[i] = big ? _mm256_shuffle_epi8(base, bswap) : base;
+               base = _mm256_add_epi32(base, inc);
+            }
+            s_vaes256_enc(b, VAES_PAR, rk, Nr);
+            for (i = 0; i < VAES_PAR; i++) {
+               b[i] = _mm256_xor_si256(b[i], _mm256_loadu_si256((const __m256i*) (pt + 32 * i)));
+               _mm256_storeu_si256((__m256i*) (ct + 32 * i), b[i]);
+            }
+            pt += 32 * VAES_PAR;
+            ct += 32 * VAES_PAR;
+            blocks -= 2 * VAES_PAR;
+            lo += 2 * VAES_PAR;
+         } while (blocks >= 2 * VAES_PAR && lo <= 0xFFFFFFFFUL - 2 * VAES_PAR);
+         ctr = _mm256_extracti128_si256(c[VAES_PAR - 1], 1);
+         if (big) {
+            ctr = _mm_shuffle_epi8(ctr, bswap128);
+         }
+         _mm_storeu_si128((__m128i*) IV, ctr);
+      }
+   }
+   if (blocks == 0) {
+      return CRYPT_OK;
+   }
+   return aesni_accel_ctr_encrypt(pt, ct, blocks, IV, mode, skey);
+}
+
+LTC_ATTRIBUTE((__target__("aes,vaes,avx2")))
+static int s_vaes256_xts(const unsigned char *in, unsigned char *out, unsigned long blocks, unsigned char *tweak,
+                         const symmetric_key *skey1, const symmetric_key *skey2, int decrypt)
+{
+   int Nr, i;
+   const unsigned char *skeys;
+   __m256i rk[15], b[VAES_PAR], t[VAES_PAR], base;
+   __m128i T;
+
+   LTC_ARGCHK(in != NULL);
+   LTC_ARGCHK(out != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14 || skey2->rijndael.Nr != Nr) return CRYPT_INVALID_ROUNDS;
+
+   T = s_vaes_enc1(_mm_loadu_si128((const __m128i*) tweak), (const unsigned char*) skey2->rijndael.eK, Nr);
+   skeys = (const unsigned char*) (decrypt ? skey1->rijndael.dK : skey1->rijndael.eK);
+
+   if (blocks >= 2 * VAES_PAR) {
+      s_vaes256_load_keys(rk, skeys, Nr);
+      base = _mm256_inserti128_si256(_mm256_castsi128_si256(T), s_vaes_xts_mult_x(T), 1);
+
+      while (blocks >= 2 * VAES_PAR) {
+         for (i = 0; i < VAES_PAR; i++) {
+            t[i] = base;
+            b[i] = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) (in + 32 * i)), base);
+            base = s_vaes256_xts_mult_x2(base);
+         }
+         if (decrypt) {
+            s_vaes256_dec(b, VAES_PAR, rk, Nr);
+         } else {
+            s_vaes256_enc(b, VAES_PAR, rk, Nr);
+         }
+         for (i = 0; i < VAES_PAR; i++) {
+            _mm256_storeu_si256((__m256i*) (out + 32 * i), _mm256_xor_si256(b[i], t[i]));
+         }
+         in += 32 * VAES_PAR;
+         out += 32 * VAES_PAR;
+         blocks -= 2 * VAES_PAR;
+      }
+      T = _mm256_castsi256_si128(base);
+   }
+   T = s_vaes_xts_tail(in, out, blocks, T, skeys, Nr, decrypt);
+   _mm_storeu_si128((__m128i*) tweak, T);
+
+   return CRYPT_OK;
+}
+
+/**
+  XTS encrypt multiple blocks with AES, two blocks per instruction
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+int vaes256_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                              const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   return s_vaes256_xts(pt, ct, blocks, tweak, skey1, skey2, 0);
+}
+
+/**
+  XTS decrypt multiple blocks with AES, two blocks per instruction
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+int vaes256_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                              const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   return s_vaes256_xts(ct, pt, blocks, tweak, skey1, skey2, 1);
+}
+
+/**
+  Performs a self-test of the VAES implementations
+  The multi-block functions of every VAES tier the CPU supports are compared
+  against the AES-NI implementation, including the tails and counter wrap-arounds.
+  @return CRYPT_OK if functional, CRYPT_NOP if self-test has been disabled or VAES isn't supported
+*/
+int vaes_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const struct {
+      int (*ecb_encrypt)(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+      int (*ecb_decrypt)(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey);
+      int (*ctr_encrypt)(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+      int (*xts_encrypt)(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                         const symmetric_key *skey1, const symmetric_key *skey2);
+      int (*xts_decrypt)(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                         const symmetric_key *skey1, const symmetric_key *skey2);
+      int (*is_supported)(void);
+      const char *name;
+   } tiers[] = {
+      { vaes512_accel_ecb_encrypt, vaes512_accel_ecb_decrypt, vaes512_accel_ctr_encrypt,
+        vaes512_accel_xts_encrypt, vaes512_accel_xts_decrypt, vaes512_is_supported, "VAES-512" },
+      { vaes256_accel_ecb_encrypt, vaes256_accel_ecb_decrypt, vaes256_accel_ctr_encrypt,
+        vaes256_accel_xts_encrypt, vaes256_accel_xts_decrypt, vaes256_is_supported, "VAES-256" },
+   };
+   static const unsigned long blocks[] = { 1, 3, 4, 5, 15, 16, 17, 31, 32, 33, 47, 71 };
+   static const struct {
+      int mode;
+      ulong32 lo;
+   } ctr_modes[] = {
+      { CTR_COUNTER_BIG_ENDIAN, 0x01234567UL },
+      { CTR_COUNTER_BIG_ENDIAN, 0xFFFFFFF0UL },
+      { CTR_COUNTER_BIG_ENDIAN | 4, 0xFFFFFFD9UL },
+      { CTR_COUNTER_LITTLE_ENDIAN, 0xFFFFFFE7UL },
+      { CTR_COUNTER_LITTLE_ENDIAN | 4, 0x89ABCDEFUL },
+      { CTR_COUNTER_BIG_ENDIAN | 2, 0x0000FFF5UL },
+   };
+#if defined(LTC_GCM_MODE)
+   static const unsigned long gcm_ptlen[] = { 0, 1, 15, 16, 63, 64, 65, 255, 256, 257, 300, 16 * 71 };
+   static const unsigned long gcm_aadlen[] = { 0, 13, 64, 300 };
+   static const unsigned long gcm_ivlen[] = { 12, 1, 60, 80 };
+   unsigned char tag[2][16];
+   unsigned long taglen[2];
+#endif
+   unsigned char key[32], pt[16 * 71], ct[2][16 * 71], iv[2][16];
+   symmetric_key skey, skey2;
+   int err, i, k, n, m, keylen;
+
+   if (!vaes256_is_supported()) {
+      return CRYPT_NOP;
+   }
+
+   for (i = 0; i < (int)sizeof(key); i++) {
+      key[i] = (unsigned char)(i * 13 + 1);
+   }
+   for (i = 0; i < (int)sizeof(pt); i++) {
+      pt[i] = (unsigned char)(i * 7 + 3);
+   }
+
+   for (k = 0; k < (int)(sizeof(tiers) / sizeof(tiers[0])); k++) {
+      if (!tiers[k].is_supported()) {
+         continue;
+      }
+      for (keylen = 16; keylen <= 32; keylen += 16) {
+         if ((err = aesni_setup(key, keylen, 0, &skey)) != CRYPT_OK) {
+            return err;
+         }
+         if ((err = aesni_setup(key + 32 - keylen, keylen, 0, &skey2)) != CRYPT_OK) {
+            return err;
+         }
+         for (n = 0; n < (int)(sizeof(blocks) / sizeof(blocks[0])); n++) {
+            /* ECB */
+            if ((err = tiers[k].ecb_encrypt(pt, ct[0], blocks[n], &skey)) != CRYPT_OK) {
+               return err;
+            }
+            if ((err = aesni_accel_ecb_encrypt(pt, ct[1], blocks[n], &skey)) != CRYPT_OK) {
+               return err;
+            }
+            if (compare_testvector(ct[0], blocks[n] * 16, ct[1], blocks[n] * 16, tiers[k].name, n)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+            if ((err = tiers[k].ecb_decrypt(ct[0], ct[1], blocks[n], &skey)) != CRYPT_OK) {
+               return err;
+            }
+            if (compare_testvector(ct[1], blocks[n] * 16, pt, blocks[n] * 16, tiers[k].name, n)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+
+            /* CTR */
+            for (m = 0; m < (int)(sizeof(ctr_modes) / sizeof(ctr_modes[0])); m++) {
+               for (i = 0; i < 2; i++) {
+                  XMEMSET(iv[i], 0xA5, 16);
+                  if (ctr_modes[m].mode & CTR_COUNTER_BIG_ENDIAN) {
+                     STORE32H(ctr_modes[m].lo, iv[i] + 12);
+                  } else {
+                     STORE32L(ctr_modes[m].lo, iv[i]);
+                  }
+               }
+               if ((err = tiers[k].ctr_encrypt(pt, ct[0], blocks[n], iv[0], ctr_modes[m].mode, &skey)) != CRYPT_OK) {
+                  return err;
+               }
+               if ((err = aesni_accel_ctr_encrypt(pt, ct[1], blocks[n], iv[1], ctr_modes[m].mode, &skey)) != CRYPT_OK) {
+                  return err;
+               }
+               if (compare_testvector(ct[0], blocks[n] * 16, ct[1], blocks[n] * 16, tiers[k].name, 100 + m) ||
+                   compare_testvector(iv[0], 16, iv[1], 16, tiers[k].name, 200 + m)) {
+                  return CRYPT_FAIL_TESTVECTOR;
+               }
+            }
+
+            /* XTS */
+            for (i = 0; i < 2; i++) {
+               XMEMSET(iv[i], 0, 16);
+               STORE32L(0x12345678UL + (ulong32)n, iv[i]);
+            }
+            if ((err = tiers[k].xts_encrypt(pt, ct[0], blocks[n], iv[0], &skey, &skey2)) != CRYPT_OK) {
+               return err;
+            }
+            if ((err = aesni_accel_xts_encrypt(pt, ct[1], blocks[n], iv[1], &skey, &skey2)) != CRYPT_OK) {
+               return err;
+            }
+            if (compare_testvector(ct[0], blocks[n] * 16, ct[1], blocks[n] * 16, tiers[k].name, 300 + n) ||
+                compare_testvector(iv[0], 16, iv[1], 16, tiers[k].name, 400 + n)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+            XMEMSET(iv[0], 0, 16);
+            STORE32L(0x12345678UL + (ulong32)n, iv[0]);
+            if ((err = tiers[k].xts_decrypt(ct[0], ct[1], blocks[n], iv[0], &skey, &skey2)) != CRYPT_OK) {
+               return err;
+            }
+            if (compare_testvector(ct[1], blocks[n] * 16, pt, blocks[n] * 16, tiers[k].name, 500 + n) ||
+                compare_testvector(iv[0], 16, iv[1], 16, tiers[k].name, 600 + n)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+         }
+      }
+   }
+
+#if defined(LTC_GCM_MODE)
+   for (keylen = 16; keylen <= 32; keylen += 16) {
+      for (n = 0; n < (int)(sizeof(gcm_ptlen) / sizeof(gcm_ptlen[0])); n++) {
+         for (m = 0; m < (int)(sizeof(gcm_aadlen) / sizeof(gcm_aadlen[0])); m++) {
+            i = (n + m) % (int)(sizeof(gcm_ivlen) / sizeof(gcm_ivlen[0]));
+            taglen[0] = taglen[1] = 16;
+            /* the IV and the AAD are taken from the plaintext */
+            err = vaes512_accel_gcm_memory(key, keylen, pt + 500, gcm_ivlen[i], pt + 700, gcm_aadlen[m],
+                                           pt, gcm_ptlen[n], ct[0], tag[0], &taglen[0], GCM_ENCRYPT);
+            if (err == CRYPT_NOP) {
+               /* no VPCLMULQDQ */
+               return CRYPT_OK;
+            }
+            if (err != CRYPT_OK) {
+               return err;
+            }
+            if ((err = aesni_accel_gcm_memory(key, keylen, pt + 500, gcm_ivlen[i], pt + 700, gcm_aadlen[m],
+                                              pt, gcm_ptlen[n], ct[1], tag[1], &taglen[1], GCM_ENCRYPT)) != CRYPT_OK) {
+               return err;
+            }
+            if (compare_testvector(ct[0], gcm_ptlen[n], ct[1], gcm_ptlen[n], "VAES-512 GCM", 10 * n + m) ||
+                compare_testvector(tag[0], taglen[0], tag[1], taglen[1], "VAES-512 GCM tag", 10 * n + m)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+            if ((err = vaes512_accel_gcm_memory(key, keylen, pt + 500, gcm_ivlen[i], pt + 700, gcm_aadlen[m],
+                                                ct[1], gcm_ptlen[n], ct[0], tag[0], &taglen[0], GCM_DECRYPT)) != CRYPT_OK) {
+               return err;
+            }
+            if (compare_testvector(ct[1], gcm_ptlen[n], pt, gcm_ptlen[n], "VAES-512 GCM decrypt", 10 * n + m)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+         }
+      }
+   }
+#endif
+
+   return CRYPT_OK;
+#endif
+}
+
+#endif
@@ -0,0 +1,1356 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file aesbs.c
+  Constant-time implementation of AES via bitslicing with SSSE3
+
+  Eight blocks are processed in parallel in the layout of Kaesper and
+  Schwabe: the state is held in eight 128 bit registers, register i holds
+  bit i of every byte of the eight blocks.  SubBytes is computed by the
+  circuit of Boyar and Peralta, ShiftRows and MixColumns are byte shuffles
+  within the registers, i.e. there are no secret-dependent memory accesses
+  or branches, neither in the cipher nor in the key schedule.
+
+  Single blocks, CBC encryption and up to four blocks are processed by a
+  single-block implementation with nibble lookups via pshufb, which is
+  constant-time as well.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_AES_BITSLICE)
+
+const struct ltc_cipher_descriptor aesbs_desc =
+{
+    "aes",
+    6,
+    16, 32, 16, 10,
+    aesbs_setup, aesbs_ecb_encrypt, aesbs_ecb_decrypt, aesbs_test, aesbs_done, aesbs_keysize,
+    aesbs_accel_ecb_encrypt, aesbs_accel_ecb_decrypt, aesbs_accel_cbc_encrypt, aesbs_accel_cbc_decrypt, aesbs_accel_ctr_encrypt,
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, aesbs_accel_xts_encrypt, aesbs_accel_xts_decrypt
+};
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+/* Number of blocks that are processed in parallel */
+#define AESBS_PAR 8
+
+/* Transpose the 8x8 bit matrices formed by each byte position of the
+ * eight registers, c.f. swapmove.  This is an involution, it converts
+ * eight blocks to the bitsliced representation and back.
+ */
+#define AESBS_SWAPMOVE(x, y, m, s)                                                  \
+   do {                                                                             \
+      a = x;                                                                        \
+      b = y;                                                                        \
+      x = _mm_or_si128(_mm_and_si128(a, m), _mm_slli_epi64(_mm_and_si128(b, m), s)); \
+      y = _mm_or_si128(_mm_srli_epi64(_mm_andnot_si128(m, a), s), _mm_andnot_si128(m, b)); \
+   } while (0)
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_ortho(__m128i *q)
+{
+   __m128i a, b, m;
+
+   m = _mm_set1_epi8(0x55);
+   AESBS_SWAPMOVE(q[0], q[1], m, 1);
+   AESBS_SWAPMOVE(q[2], q[3], m, 1);
+   AESBS_SWAPMOVE(q[4], q[5], m, 1);
+   AESBS_SWAPMOVE(q[6], q[7], m, 1);
+
+   m = _mm_set1_epi8(0x33);
+   AESBS_SWAPMOVE(q[0], q[2], m, 2);
+   AESBS_SWAPMOVE(q[1], q[3], m, 2);
+   AESBS_SWAPMOVE(q[4], q[6], m, 2);
+   AESBS_SWAPMOVE(q[5], q[7], m, 2);
+
+   m = _mm_set1_epi8(0x0f);
+   AESBS_SWAPMOVE(q[0], q[4], m, 4);
+   AESBS_SWAPMOVE(q[1], q[5], m, 4);
+   AESBS_SWAPMOVE(q[2], q[6], m, 4);
+   AESBS_SWAPMOVE(q[3], q[7], m, 4);
+}
+
+#define X(a, b) _mm_xor_si128(a, b)
+#define A(a, b) _mm_and_si128(a, b)
+#define N(a, b) _mm_xor_si128(_mm_xor_si128(a, b), ones)
+
+/* The AES S-box as circuit of 113 gates by Boyar and Peralta,
+ * c.f. "A depth-16 circuit for the AES S-box", https://eprint.iacr.org/2011/332
+ */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_sbox(__m128i *q)
+{
+   __m128i x0, x1, x2, x3, x4, x5, x6, x7;
+   __m128i y1, y2, y3, y4, y5, y6, y7, y8, y9;
+   __m128i y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+   __m128i y20, y21;
+   __m128i z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+   __m128i z10, z11, z12, z13, z14, z15, z16, z17;
+   __m128i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+   __m128i t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+   __m128i t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+   __m128i t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+   __m128i t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+   __m128i t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+   __m128i t60, t61, t62, t63, t64, t65, t66, t67;
+   __m128i ones = _mm_set1_epi8(-1);
+
+   x0 = q[7];
+   x1 = q[6];
+   x2 = q[5];
+   x3 = q[4];
+   x4 = q[3];
+   x5 = q[2];
+   x6 = q[1];
+   x7 = q[0];
+
+   /* top linear transformation */
+   y14 = X(x3, x5);
+   y13 = X(x0, x6);
+   y9 = X(x0, x3);
+   y8 = X(x0, x5);
+   t0 = X(x1, x2);
+   y1 = X(t0, x7);
+   y4 = X(y1, x3);
+   y12 = X(y13, y14);
+   y2 = X(y1, x0);
+   y5 = X(y1, x6);
+   y3 = X(y5, y8);
+   t1 = X(x4, y12);
+   y15 = X(t1, x5);
+   y20 = X(t1, x1);
+   y6 = X(y15, x7);
+   y10 = X(y15, t0);
+   y11 = X(y20, y9);
+   y7 = X(x7, y11);
+   y17 = X(y10, y11);
+   y19 = X(y10, y8);
+   y16 = X(t0, y11);
+   y21 = X(y13, y16);
+   y18 = X(x0, y16);
+
+   /* non-linear section */
+   t2 = A(y12, y15);
+   t3 = A(y3, y6);
+   t4 = X(t3, t2);
+   t5 = A(y4, x7);
+   t6 = X(t5, t2);
+   t7 = A(y13, y16);
+   t8 = A(y5, y1);
+   t9 = X(t8, t7);
+   t10 = A(y2, y7);
+   t11 = X(t10, t7);
+   t12 = A(y9, y11);
+   t13 = A(y14, y17);
+   t14 = X(t13, t12);
+   t15 = A(y8, y10);
+   t16 = X(t15, t12);
+   t17 = X(t4, t14);
+   t18 = X(t6, t16);
+   t19 = X(t9, t14);
+   t20 = X(t11, t16);
+   t21 = X(t17, y20);
+   t22 = X(t18, y19);
+   t23 = X(t19, y21);
+   t24 = X(t20, y18);
+
+   t25 = X(t21, t22);
+   t26 = A(t21, t23);
+   t27 = X(t24, t26);
+   t28 = A(t25, t27);
+   t29 = X(t28, t22);
+   t30 = X(t23, t24);
+   t31 = X(t22, t26);
+   t32 = A(t31, t30);
+   t33 = X(t32, t24);
+   t34 = X(t23, t33);
+   t35 = X(t27, t33);
+   t36 = A(t24, t35);
+   t37 = X(t36, t34);
+   t38 = X(t27, t36);
+   t39 = A(t29, t38);
+   t40 = X(t25, t39);
+
+   t41 = X(t40, t37);
+   t42 = X(t29, t33);
+   t43 = X(t29, t40);
+   t44 = X(t33, t37);
+   t45 = X(t42, t41);
+   z0 = A(t44, y15);
+   z1 = A(t37, y6);
+   z2 = A(t33, x7);
+   z3 = A(t43, y16);
+   z4 = A(t40, y1);
+   z5 = A(t29, y7);
+   z6 = A(t42, y11);
+   z7 = A(t45, y17);
+   z8 = A(t41, y10);
+   z9 = A(t44, y12);
+   z10 = A(t37, y3);
+   z11 = A(t33, y4);
+   z12 = A(t43, y13);
+   z13 = A(t40, y5);
+   z14 = A(t29, y2);
+   z15 = A(t42, y9);
+   z16 = A(t45, y14);
+   z17 = A(t41, y8);
+
+   /* bottom linear transformation */
+   t46 = X(z15, z16);
+   t47 = X(z10, z11);
+   t48 = X(z5, z13);
+   t49 = X(z9, z10);
+   t50 = X(z2, z12);
+   t51 = X(z2, z5);
+   t52 = X(z7, z8);
+   t53 = X(z0, z3);
+   t54 = X(z6, z7);
+   t55 = X(z16, z17);
+   t56 = X(z12, t48);
+   t57 = X(t50, t53);
+   t58 = X(z4, t46);
+   t59 = X(z3, t54);
+   t60 = X(t46, t57);
+   t61 = X(z14, t57);
+   t62 = X(t52, t58);
+   t63 = X(t49, t58);
+   t64 = X(z4, t59);
+   t65 = X(t61, t62);
+   t66 = X(z1, t63);
+   q[7] = X(t59, t63);
+   q[1] = N(t56, t62);
+   q[0] = N(t48, t60);
+   t67 = X(t64, t65);
+   q[4] = X(t53, t66);
+   q[3] = X(t51, t66);
+   q[2] = X(t47, t65);
+   q[6] = N(t64, q[4]);
+   q[5] = N(t55, t67);
+}
+
+/* The inverse affine transformation of the S-box, B(x ^ 0x63) */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_inv_affine(__m128i *q)
+{
+   __m128i q0, q1, q2, q3, q4, q5, q6, q7;
+   __m128i ones = _mm_set1_epi8(-1);
+
+   q0 = X(q[0], ones);
+   q1 = X(q[1], ones);
+   q2 = q[2];
+   q3 = q[3];
+   q4 = q[4];
+   q5 = X(q[5], ones);
+   q6 = X(q[6], ones);
+   q7 = q[7];
+   q[7] = X(X(q1, q4), q6);
+   q[6] = X(X(q0, q3), q5);
+   q[5] = X(X(q7, q2), q4);
+   q[4] = X(X(q6, q1), q3);
+   q[3] = X(X(q5, q0), q2);
+   q[2] = X(X(q4, q7), q1);
+   q[1] = X(X(q3, q6), q0);
+   q[0] = X(X(q2, q5), q7);
+}
+
+/* The inverse S-box is computed via the forward S-box S(x) = A(I(x)) ^ 0x63,
+ * where I is the inversion in GF(2^8) and A an affine transformation:
+ * S^-1(x) = B(S(B(x ^ 0x63)) ^ 0x63) with B being the inverse of A.
+ */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_inv_sbox(__m128i *q)
+{
+   s_aesbs_inv_affine(q);
+   s_aesbs_sbox(q);
+   s_aesbs_inv_affine(q);
+}
+
+#undef X
+#undef A
+#undef N
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_shuffle(__m128i *q, __m128i m)
+{
+   int i;
+   for (i = 0; i < 8; i++) {
+      q[i] = _mm_shuffle_epi8(q[i], m);
+   }
+}
+
+#define AESBS_SHIFT_ROWS     _mm_setr_epi8(0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11)
+#define AESBS_INV_SHIFT_ROWS _mm_setr_epi8(0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3)
+/* rotate the bytes within each column by one resp. two rows */
+#define AESBS_ROT1           _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12)
+#define AESBS_ROT2           _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13)
+
+/* multiplication by x in GF(2^8) */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_xtime(__m128i *r, const __m128i *t)
+{
+   __m128i t7 = t[7];
+   r[7] = t[6];
+   r[6] = t[5];
+   r[5] = t[4];
+   r[4] = _mm_xor_si128(t[3], t7);
+   r[3] = _mm_xor_si128(t[2], t7);
+   r[2] = t[1];
+   r[1] = _mm_xor_si128(t[0], t7);
+   r[0] = t7;
+}
+
+/* out = 2 * a_r ^ 3 * a_r+1 ^ a_r+2 ^ a_r+3 = 2 * t ^ a_r+1 ^ t_r+2 with t = a_r ^ a_r+1 */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_mix_columns(__m128i *q)
+{
+   __m128i r1[8], t[8], x[8], rot1, rot2;
+   int i;
+
+   rot1 = AESBS_ROT1;
+   rot2 = AESBS_ROT2;
+   for (i = 0; i < 8; i++) {
+      r1[i] = _mm_shuffle_epi8(q[i], rot1);
+      t[i] = _mm_xor_si128(q[i], r1[i]);
+   }
+   s_aesbs_xtime(x, t);
+   for (i = 0; i < 8; i++) {
+      q[i] = _mm_xor_si128(_mm_xor_si128(x[i], r1[i]), _mm_shuffle_epi8(t[i], rot2));
+   }
+}
+
+/* InvMixColumns is MixColumns after a multiplication with 4 * x^2 + 5 */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_inv_mix_columns(__m128i *q)
+{
+   __m128i t[8], x[8], rot2;
+   int i;
+
+   rot2 = AESBS_ROT2;
+   for (i = 0; i < 8; i++) {
+      t[i] = _mm_xor_si128(q[i], _mm_shuffle_epi8(q[i], rot2));
+   }
+   s_aesbs_xtime(x, t);
+   s_aesbs_xtime(t, x);
+   for (i = 0; i < 8; i++) {
+      q[i] = _mm_xor_si128(q[i], t[i]);
+   }
+   s_aesbs_mix_columns(q);
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_add_round_key(__m128i *q, const __m128i *sk)
+{
+   int i;
+   for (i = 0; i < 8; i++) {
+      q[i] = _mm_xor_si128(q[i], sk[i]);
+   }
+}
+
+/* Expand the round keys to the bitsliced representation, i.e. bit i of
+ * every key byte is spread to a full byte of register i.  The round keys
+ * are stored as big-endian words like the ones of rijndael_setup(). */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_aesbs_slice_keys(__m128i *sk, const ulong32 *rk, int Nr)
+{
+   unsigned char b[16];
+   __m128i k, m;
+   int r, i;
+   for (r = 0; r <= Nr; r++) {
+      for (i = 0; i < 4; i++) {
+         STORE32H(rk[4 * r + i], b + 4 * i);
+      }
+      k = _mm_loadu_si128((const __m128i*) b);
+      for (i = 0; i < 8; i++) {
+         m = _mm_set1_epi8((char)(1 << i));
+         sk[8 * r + i] = _mm_cmpeq_epi8(_mm_and_si128(k, m), m);
+      }
+   }
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_aesbs_encrypt8(__m128i *q, const __m128i *sk, int Nr)
+{
+   int r;
+   __m128i sr = AESBS_SHIFT_ROWS;
+
+   s_aesbs_add_round_key(q, sk);
+   for (r = 1; r < Nr; r++) {
+      s_aesbs_sbox(q);
+      s_aesbs_shuffle(q, sr);
+      s_aesbs_mix_columns(q);
+      s_aesbs_add_round_key(q, sk + 8 * r);
+   }
+   s_aesbs_sbox(q);
+   s_aesbs_shuffle(q, sr);
+   s_aesbs_add_round_key(q, sk + 8 * Nr);
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_aesbs_decrypt8(__m128i *q, const __m128i *sk, int Nr)
+{
+   int r;
+   __m128i isr = AESBS_INV_SHIFT_ROWS;
+
+   s_aesbs_add_round_key(q, sk + 8 * Nr);
+   for (r = Nr - 1; r > 0; r--) {
+      s_aesbs_shuffle(q, isr);
+      s_aesbs_inv_sbox(q);
+      s_aesbs_add_round_key(q, sk + 8 * r);
+      s_aesbs_inv_mix_columns(q);
+   }
+   s_aesbs_shuffle(q, isr);
+   s_aesbs_inv_sbox(q);
+   s_aesbs_add_round_key(q, sk);
+}
+
+/* Apply the S-box to the word `w` */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static ulong32 s_aesbs_sub_word(ulong32 w)
+{
+   __m128i q[8];
+   int i;
+
+   q[0] = _mm_cvtsi32_si128((int)w);
+   for (i = 1; i < 8; i++) {
+      q[i] = _mm_setzero_si128();
+   }
+   s_aesbs_ortho(q);
+   s_aesbs_sbox(q);
+   s_aesbs_ortho(q);
+   return (ulong32)_mm_cvtsi128_si32(q[0]);
+}
+
+/* InvMixColumns of the column `w`, computed on all four bytes at once */
+static ulong32 s_aesbs_inv_mix_word(ulong32 w)
+{
+   ulong32 x2, x4, x8;
+
+   x2 = ((w  & 0x7f7f7f7fUL) << 1) ^ (((w  >> 7) & 0x01010101UL) * 0x1b);
+   x4 = ((x2 & 0x7f7f7f7fUL) << 1) ^ (((x2 >> 7) & 0x01010101UL) * 0x1b);
+   x8 = ((x4 & 0x7f7f7f7fUL) << 1) ^ (((x4 >> 7) & 0x01010101UL) * 0x1b);
+   /* every byte is 14*b[i] ^ 11*b[i+1] ^ 13*b[i+2] ^ 9*b[i+3] */
+   return (x8 ^ x4 ^ x2) ^ ROLc(x8 ^ x2 ^ w, 8) ^ ROLc(x8 ^ x4 ^ w, 16) ^ ROLc(x8 ^ w, 24);
+}
+
+/* Single blocks, with pshufb as in "Accelerating AES with Vector Permute
+ * Instructions" by Hamburg, but with the inversion via logarithms in GF(16).
+ *
+ * The bytes of the state are held in a tower representation over GF(16):
+ * X = i * w + k * w^16 with w^16 + w = 1, the byte being i << 4 | k.  Its
+ * inverse is (k * w + i * w^16) / N with N = i * k + l * (i + k)^2 in GF(16),
+ * the products and quotients are additions of the logarithms.  Every step
+ * is a lookup with a nibble as index via pshufb, there are no
+ * secret-dependent memory accesses.  The logarithm of 0 is 0xe0, sums with
+ * it keep the top bit set and the following pshufb returns 0.
+ *
+ * The output tables are indexed by the logarithms of the two coordinates of
+ * the inverse and contain the affine map resp. the multiplication of
+ * MixColumns, mapped back into the tower representation.  The constants of
+ * the S-box are folded into the round keys, c.f. s_aesbs_tower_keys().
+ */
+static const unsigned char s_aesbs_tower[24][16] = {
+   { 0xe0, 0x00, 0x01, 0x04, 0x02, 0x08, 0x05, 0x0a, 0x03, 0x0e, 0x09, 0x07, 0x06, 0x0d, 0x0b, 0x0c }, /* log */
+   { 0xe0, 0x00, 0x0e, 0x0b, 0x0d, 0x07, 0x0a, 0x05, 0x0c, 0x01, 0x06, 0x08, 0x09, 0x02, 0x04, 0x03 }, /* -log */
+   { 0x01, 0x02, 0x04, 0x08, 0x03, 0x06, 0x0c, 0x0b, 0x05, 0x0a, 0x07, 0x0e, 0x0f, 0x0d, 0x09, 0x00 }, /* exp */
+   { 0x00, 0x0b, 0x0a, 0x01, 0x0e, 0x05, 0x04, 0x0f, 0x0d, 0x06, 0x07, 0x0c, 0x03, 0x08, 0x09, 0x02 }, /* l * x^2 */
+   /* encryption: to the tower representation, plus the constant 0x63 of the S-box */
+   { 0x3f, 0x2e, 0xa4, 0xb5, 0x4c, 0x5d, 0xd7, 0xc6, 0xe6, 0xf7, 0x7d, 0x6c, 0x95, 0x84, 0x0e, 0x1f },
+   { 0x00, 0x8b, 0xb6, 0x3d, 0x03, 0x88, 0xb5, 0x3e, 0xf1, 0x7a, 0x47, 0xcc, 0xf2, 0x79, 0x44, 0xcf },
+   /* the affine map A of the S-box without its constant, 2 * A(x) and A(x) in the standard representation for the last round */
+   { 0xd2, 0x25, 0x68, 0x37, 0xf7, 0x4d, 0x5f, 0xc0, 0xba, 0x12, 0x9f, 0x7a, 0xa8, 0x8d, 0xe5, 0x00 },
+   { 0x79, 0x72, 0x7c, 0xe2, 0x0b, 0x0e, 0x9e, 0xe9, 0x05, 0x90, 0x77, 0xec, 0x95, 0xe7, 0x9b, 0x00 },
+   { 0x93, 0x99, 0x04, 0xf3, 0x0a, 0x9d, 0xf7, 0xf9, 0x97, 0x6a, 0x0e, 0x6e, 0xfd, 0x64, 0x60, 0x00 },
+   { 0x9f, 0x87, 0xbc, 0xec, 0x18, 0x3b, 0x50, 0xf4, 0x23, 0x6b, 0xa4, 0xd7, 0x48, 0xcf, 0x73, 0x00 },
+   { 0xcf, 0xa5, 0xd1, 0xe4, 0x6a, 0x74, 0x35, 0x8e, 0x1e, 0x41, 0xbb, 0x90, 0x5f, 0xfa, 0x2b, 0x00 },
+   { 0xd0, 0x17, 0x7a, 0xd2, 0xc7, 0x6d, 0xa8, 0x15, 0xaa, 0xc5, 0xbd, 0xbf, 0x6f, 0x78, 0x02, 0x00 },
+   /* decryption: to the tower representation after the inverse of the affine map */
+   { 0x00, 0x41, 0x09, 0x48, 0x7e, 0x3f, 0x77, 0x36, 0x13, 0x52, 0x1a, 0x5b, 0x6d, 0x2c, 0x64, 0x25 },
+   { 0x00, 0x34, 0xcb, 0xff, 0xe1, 0xd5, 0x2a, 0x1e, 0xd4, 0xe0, 0x1f, 0x2b, 0x35, 0x01, 0xfe, 0xca },
+   /* 9 * x, 13 * x, 11 * x, 14 * x in that representation and x in the standard one for the last round */
+   { 0xdd, 0x28, 0x29, 0xc0, 0xf5, 0x01, 0xe9, 0x35, 0xf4, 0xe8, 0xdc, 0xc1, 0x1c, 0x34, 0x1d, 0x00 },
+   { 0x8f, 0xe6, 0x77, 0x49, 0x69, 0x91, 0x3e, 0x20, 0xf8, 0xaf, 0x1e, 0xd8, 0x57, 0xb1, 0xc6, 0x00 },
+   { 0x2f, 0xba, 0x12, 0x9f, 0x95, 0xa8, 0x8d, 0x0a, 0x3d, 0x25, 0x87, 0x37, 0x18, 0xa2, 0xb0, 0x00 },
+   { 0x03, 0x05, 0x7f, 0x98, 0x06, 0x7a, 0xe7, 0x9e, 0x7c, 0x9d, 0x79, 0xe2, 0xe1, 0xe4, 0x9b, 0x00 },
+   { 0x68, 0x78, 0x0b, 0xd4, 0x10, 0x73, 0xdf, 0xc4, 0x63, 0xac, 0x1b, 0xa7, 0xcf, 0xb7, 0xbc, 0x00 },
+   { 0x33, 0x8e, 0x0f, 0x42, 0xbd, 0x81, 0x4d, 0xff, 0x3c, 0xcc, 0xb2, 0xc3, 0xf0, 0x7e, 0x71, 0x00 },
+   { 0xa7, 0xcf, 0xb7, 0xbc, 0x68, 0x78, 0x0b, 0xd4, 0x10, 0x73, 0xdf, 0xc4, 0x63, 0xac, 0x1b, 0x00 },
+   { 0xc3, 0xf0, 0x7e, 0x71, 0x33, 0x8e, 0x0f, 0x42, 0xbd, 0x81, 0x4d, 0xff, 0x3c, 0xcc, 0xb2, 0x00 },
+   { 0x12, 0x0f, 0x59, 0xd7, 0x1d, 0x56, 0x8e, 0xca, 0x4b, 0xd8, 0x44, 0x81, 0x93, 0x9c, 0xc5, 0x00 },
+   { 0x13, 0x53, 0xb9, 0x87, 0x40, 0xea, 0x3e, 0xc7, 0xaa, 0xd4, 0xf9, 0x6d, 0x7e, 0x2d, 0x94, 0x00 }
+};
+
+#define AESBS_TOWER(n)  _mm_loadu_si128((const __m128i*) s_aesbs_tower[n])
+#define AESBS_ROT3      _mm_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14)
+
+/* Look up the low and the high nibbles of `x` in `lo` resp. `hi` */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE __m128i s_aesbs_lookup(__m128i x, __m128i lo, __m128i hi)
+{
+   __m128i m = _mm_set1_epi8(0x0f);
+   return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, m)),
+                        _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), m)));
+}
+
+/* The sum of two logarithms in GF(16) modulo 15, s - 15 wraps around for s < 15 */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE __m128i s_aesbs_log_add(__m128i x, __m128i y)
+{
+   __m128i s = _mm_add_epi8(x, y);
+   return _mm_min_epu8(s, _mm_sub_epi8(s, _mm_set1_epi8(15)));
+}
+
+/* Invert the bytes of `s`, the result are the logarithms of the two coordinates */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_aesbs_tower_inv(__m128i s, __m128i *a, __m128i *b)
+{
+   __m128i m = _mm_set1_epi8(0x0f), i, k, li, lk, n;
+
+   k = _mm_and_si128(s, m);
+   i = _mm_and_si128(_mm_srli_epi16(s, 4), m);
+   li = _mm_shuffle_epi8(AESBS_TOWER(0), i);
+   lk = _mm_shuffle_epi8(AESBS_TOWER(0), k);
+   n = _mm_xor_si128(_mm_shuffle_epi8(AESBS_TOWER(2), s_aesbs_log_add(li, lk)),
+                     _mm_shuffle_epi8(AESBS_TOWER(3), _mm_xor_si128(i, k)));
+   n = _mm_shuffle_epi8(AESBS_TOWER(1), n);
+   *a = s_aesbs_log_add(lk, n);
+   *b = s_aesbs_log_add(li, n);
+}
+
+/* Look up the coordinates `a` and `b` of an inverse in the output tables `n` and `n + 1` */
+#define AESBS_TOWER_OUT(n, a, b) _mm_xor_si128(_mm_shuffle_epi8(AESBS_TOWER(n), a), _mm_shuffle_epi8(AESBS_TOWER(n + 1), b))
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static __m128i s_aesbs_encrypt1(__m128i s, const unsigned char (*vk)[16], int Nr)
+{
+   __m128i sr = AESBS_SHIFT_ROWS, rot1 = AESBS_ROT1, rot2 = AESBS_ROT2, rot3 = AESBS_ROT3, a, b, x, x2;
+   int r;
+
+   s = _mm_xor_si128(s_aesbs_lookup(s, AESBS_TOWER(4), AESBS_TOWER(5)), _mm_loadu_si128((const __m128i*) vk[0]));
+   for (r = 1; r < Nr; r++) {
+      s_aesbs_tower_inv(_mm_shuffle_epi8(s, sr), &a, &b);
+      x = AESBS_TOWER_OUT(6, a, b);
+      x2 = AESBS_TOWER_OUT(8, a, b);
+      /* 2 * x_r ^ 3 * x_r+1 ^ x_r+2 ^ x_r+3, summed as a tree as single blocks are bound by the latency */
+      s = _mm_xor_si128(_mm_shuffle_epi8(x, rot2), _mm_shuffle_epi8(x, rot3));
+      s = _mm_xor_si128(s, _mm_shuffle_epi8(_mm_xor_si128(x, x2), rot1));
+      s = _mm_xor_si128(s, _mm_xor_si128(x2, _mm_loadu_si128((const __m128i*) vk[r])));
+   }
+   s_aesbs_tower_inv(_mm_shuffle_epi8(s, sr), &a, &b);
+   return _mm_xor_si128(AESBS_TOWER_OUT(10, a, b), _mm_loadu_si128((const __m128i*) vk[Nr]));
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static __m128i s_aesbs_decrypt1(__m128i s, const unsigned char (*vk)[16], int Nr)
+{
+   __m128i isr = AESBS_INV_SHIFT_ROWS, rot1 = AESBS_ROT1, rot2 = AESBS_ROT2, rot3 = AESBS_ROT3, a, b, t;
+   int r;
+
+   s = _mm_xor_si128(s_aesbs_lookup(s, AESBS_TOWER(12), AESBS_TOWER(13)), _mm_loadu_si128((const __m128i*) vk[0]));
+   for (r = 1; r < Nr; r++) {
+      s_aesbs_tower_inv(_mm_shuffle_epi8(s, isr), &a, &b);
+      /* 14 * x_r ^ 11 * x_r+1 ^ 13 * x_r+2 ^ 9 * x_r+3 */
+      t = _mm_xor_si128(_mm_shuffle_epi8(AESBS_TOWER_OUT(16, a, b), rot2), _mm_shuffle_epi8(AESBS_TOWER_OUT(14, a, b), rot3));
+      s = _mm_xor_si128(AESBS_TOWER_OUT(20, a, b), _mm_loadu_si128((const __m128i*) vk[r]));
+      s = _mm_xor_si128(s, _mm_xor_si128(t, _mm_shuffle_epi8(AESBS_TOWER_OUT(18, a, b), rot1)));
+   }
+   s_aesbs_tower_inv(_mm_shuffle_epi8(s, isr), &a, &b);
+   return _mm_xor_si128(AESBS_TOWER_OUT(22, a, b), _mm_loadu_si128((const __m128i*) vk[Nr]));
+}
+
+/* Convert the round keys `rk` to the ones of the single-block code, i.e. to
+ * the tower representation via the tables `in` and `in + 1`.  The S-box
+ * constant before the inversion is `c`, the one of the last round `c_last`,
+ * the last round key stays in the standard representation.
+ *
+ * Encryption: the input table contains 0x63, i.e. every round key but the
+ * last one as well, and the last one gets the 0x63 after the last S-box.
+ * Decryption: the inverse of the affine map turns 0x63 into 0x05, which is
+ * 0x62 in the tower representation.
+ */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_aesbs_tower_keys(unsigned char (*vk)[16], const ulong32 *rk, int Nr, int in, int c, int c_last)
+{
+   unsigned char b[16];
+   __m128i k;
+   int r, i;
+   for (r = 0; r <= Nr; r++) {
+      for (i = 0; i < 4; i++) {
+         STORE32H(rk[4 * r + i], b + 4 * i);
+      }
+      k = _mm_loadu_si128((const __m128i*) b);
+      if (r < Nr) {
+         k = _mm_xor_si128(s_aesbs_lookup(k, AESBS_TOWER(in), AESBS_TOWER(in + 1)), _mm_set1_epi8((char)c));
+      } else {
+         k = _mm_xor_si128(k, _mm_set1_epi8((char)c_last));
+      }
+      _mm_storeu_si128((__m128i*) vk[r], k);
+   }
+   zeromem(b, sizeof(b));
+}
+
+/* Up to this many blocks are processed one by one instead of as a padded batch of eight */
+#define AESBS_SINGLE_MAX 4
+
+/* Encrypt the `n` blocks of `q` in place, the bitsliced round keys `sk` are only used for more than AESBS_SINGLE_MAX blocks */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_aesbs_encrypt_n(__m128i *q, unsigned long n, const __m128i *sk, const struct rijndael_key *rk)
+{
+   unsigned long i;
+
+   if (n <= AESBS_SINGLE_MAX) {
+      for (i = 0; i < n; i++) {
+         q[i] = s_aesbs_encrypt1(q[i], rk->vK[0], rk->Nr);
+      }
+      return;
+   }
+   for (i = n; i < AESBS_PAR; i++) {
+      q[i] = _mm_setzero_si128();
+   }
+   s_aesbs_ortho(q);
+   s_aesbs_encrypt8(q, sk, rk->Nr);
+   s_aesbs_ortho(q);
+}
+
+/* Decrypt the `n` blocks of `q` in place, c.f. s_aesbs_encrypt_n() */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_aesbs_decrypt_n(__m128i *q, unsigned long n, const __m128i *sk, const struct rijndael_key *rk)
+{
+   unsigned long i;
+
+   if (n <= AESBS_SINGLE_MAX) {
+      for (i = 0; i < n; i++) {
+         q[i] = s_aesbs_decrypt1(q[i], rk->vK[1], rk->Nr);
+      }
+      return;
+   }
+   for (i = n; i < AESBS_PAR; i++) {
+      q[i] = _mm_setzero_si128();
+   }
+   s_aesbs_ortho(q);
+   s_aesbs_decrypt8(q, sk, rk->Nr);
+   s_aesbs_ortho(q);
+}
+
+ /**
+    Initialize the AES (Rijndael) block cipher
+    The round keys are stored in the format of rijndael_setup(), the
+    bitsliced representation is derived on the fly, the one of the
+    single-block code is stored in addition.
+    @param key The symmetric key you wish to pass
+    @param keylen The key length in bytes
+    @param num_rounds The number of rounds desired (0 for default)
+    @param skey The key in as scheduled by this function.
+    @return CRYPT_OK if successful
+ */
+int aesbs_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey)
+{
+   int i, Nk, Nw;
+   ulong32 *w, t, rcon;
+   unsigned char b[4];
+
+   LTC_ARGCHK(key != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   if (keylen != 16 && keylen != 24 && keylen != 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+
+   if (num_rounds != 0 && num_rounds != (keylen / 4 + 6)) {
+      return CRYPT_INVALID_ROUNDS;
+   }
+
+   skey->rijndael.Nr = keylen / 4 + 6;
+   skey->rijndael.eK = LTC_ALIGN_BUF(skey->rijndael.K, 16);
+   skey->rijndael.dK = skey->rijndael.eK + 60;
+
+   /* the words are expanded in little-endian order, as s_aesbs_sub_word() works on the bytes in order */
+   w = skey->rijndael.eK;
+   Nk = keylen / 4;
+   Nw = 4 * (skey->rijndael.Nr + 1);
+   for (i = 0; i < Nk; i++) {
+      LOAD32L(w[i], key + 4 * i);
+   }
+   rcon = 1;
+   for (i = Nk; i < Nw; i++) {
+      t = w[i - 1];
+      if (i % Nk == 0) {
+         t = s_aesbs_sub_word(RORc(t, 8)) ^ rcon;
+         rcon = (rcon << 1) ^ ((rcon >> 7) * 0x11b);
+      } else if (Nk > 6 && i % Nk == 4) {
+         t = s_aesbs_sub_word(t);
+      }
+      w[i] = w[i - Nk] ^ t;
+   }
+   for (i = 0; i < Nw; i++) {
+      STORE32L(w[i], b);
+      LOAD32H(w[i], b);
+   }
+
+   /* the decryption keys of the equivalent inverse cipher */
+   for (i = 0; i < Nw; i += 4) {
+      for (Nk = 0; Nk < 4; Nk++) {
+         t = w[Nw - 4 - i + Nk];
+         skey->rijndael.dK[i + Nk] = (i == 0 || i == Nw - 4) ? t : s_aesbs_inv_mix_word(t);
+      }
+   }
+
+   s_aesbs_tower_keys(skey->rijndael.vK[0], skey->rijndael.eK, skey->rijndael.Nr, 4, 0, 0x63);
+   s_aesbs_tower_keys(skey->rijndael.vK[1], skey->rijndael.dK, skey->rijndael.Nr, 12, 0x62, 0);
+
+   return CRYPT_OK;
+}
+
+/**
+  Encrypts a block of text with AES
+  @param pt The input plaintext (16 bytes)
+  @param ct The output ciphertext (16 bytes)
+  @param skey The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey)
+{
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   if (skey->rijndael.Nr < 2 || skey->rijndael.Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   _mm_storeu_si128((__m128i*) ct, s_aesbs_encrypt1(_mm_loadu_si128((const __m128i*) pt), skey->rijndael.vK[0], skey->rijndael.Nr));
+   return CRYPT_OK;
+}
+
+/**
+  Decrypts a block of text with AES
+  @param ct The input ciphertext (16 bytes)
+  @param pt The output plaintext (16 bytes)
+  @param skey The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetric_key *skey)
+{
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   if (skey->rijndael.Nr < 2 || skey->rijndael.Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   _mm_storeu_si128((__m128i*) pt, s_aesbs_decrypt1(_mm_loadu_si128((const __m128i*) ct), skey->rijndael.vK[1], skey->rijndael.Nr));
+   return CRYPT_OK;
+}
+
+/**
+  Encrypts multiple blocks of text with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   __m128i sk[8 * 15], q[AESBS_PAR];
+   unsigned long n, i;
+   int Nr;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   /* the bitsliced round keys are only needed for more than AESBS_SINGLE_MAX blocks */
+   if (blocks > AESBS_SINGLE_MAX) {
+      s_aesbs_slice_keys(sk, skey->rijndael.eK, Nr);
+   }
+   while (blocks > 0) {
+      n = blocks < AESBS_PAR ? blocks : AESBS_PAR;
+      for (i = 0; i < n; i++) {
+         q[i] = _mm_loadu_si128((const __m128i*) (pt + 16 * i));
+      }
+      s_aesbs_encrypt_n(q, n, sk, &skey->rijndael);
+      for (i = 0; i < n; i++) {
+         _mm_storeu_si128((__m128i*) (ct + 16 * i), q[i]);
+      }
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+
+   return CRYPT_OK;
+}
+
+/**
+  Decrypts multiple blocks of text with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey)
+{
+   __m128i sk[8 * 15], q[AESBS_PAR];
+   unsigned long n, i;
+   int Nr;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   if (blocks > AESBS_SINGLE_MAX) {
+      s_aesbs_slice_keys(sk, skey->rijndael.eK, Nr);
+   }
+   while (blocks > 0) {
+      n = blocks < AESBS_PAR ? blocks : AESBS_PAR;
+      for (i = 0; i < n; i++) {
+         q[i] = _mm_loadu_si128((const __m128i*) (ct + 16 * i));
+      }
+      s_aesbs_decrypt_n(q, n, sk, &skey->rijndael);
+      for (i = 0; i < n; i++) {
+         _mm_storeu_si128((__m128i*) (pt + 16 * i), q[i]);
+      }
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+
+   return CRYPT_OK;
+}
+
+/**
+  CBC encrypt multiple blocks with AES
+  CBC encryption is serial, every block is encrypted by the single-block code.
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value, will be updated to the last ciphertext block
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   __m128i iv;
+   int Nr;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   iv = _mm_loadu_si128((const __m128i*) IV);
+   while (blocks-- > 0) {
+      iv = s_aesbs_encrypt1(_mm_xor_si128(iv, _mm_loadu_si128((const __m128i*) pt)), skey->rijndael.vK[0], Nr);
+      _mm_storeu_si128((__m128i*) ct, iv);
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i*) IV, iv);
+
+   return CRYPT_OK;
+}
+
+/**
+  CBC decrypt multiple blocks with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value, will be updated to the last ciphertext block
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   __m128i sk[8 * 15], q[AESBS_PAR], c[AESBS_PAR], iv;
+   unsigned long n, i;
+   int Nr;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   if (blocks > AESBS_SINGLE_MAX) {
+      s_aesbs_slice_keys(sk, skey->rijndael.eK, Nr);
+   }
+   iv = _mm_loadu_si128((const __m128i*) IV);
+   while (blocks > 0) {
+      n = blocks < AESBS_PAR ? blocks : AESBS_PAR;
+      /* keep a copy of the ciphertext, `ct` and `pt` may overlap */
+      for (i = 0; i < n; i++) {
+         c[i] = q[i] = _mm_loadu_si128((const __m128i*) (ct + 16 * i));
+      }
+      s_aesbs_decrypt_n(q, n, sk, &skey->rijndael);
+      _mm_storeu_si128((__m128i*) pt, _mm_xor_si128(q[0], iv));
+      for (i = 1; i < n; i++) {
+         _mm_storeu_si128((__m128i*) (pt + 16 * i), _mm_xor_si128(q[i], c[i - 1]));
+      }
+      iv = c[n - 1];
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+   _mm_storeu_si128((__m128i*) IV, iv);
+
+   return CRYPT_OK;
+}
+
+static LTC_INLINE void s_aesbs_ctr_increment(unsigned char *ctr, int width, int mode)
+{
+   int x;
+   if (mode == CTR_COUNTER_LITTLE_ENDIAN) {
+      for (x = 0; x < width; x++) {
+         ctr[x] = (ctr[x] + (unsigned char)1) & (unsigned char)255;
+         if (ctr[x] != (unsigned char)0) {
+            break;
+         }
+      }
+   } else {
+      for (x = 15; x >= 16 - width; x--) {
+         ctr[x] = (ctr[x] + (unsigned char)1) & (unsigned char)255;
+         if (ctr[x] != (unsigned char)0) {
+            break;
+         }
+      }
+   }
+}
+
+/**
+  CTR encrypt multiple blocks with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The current counter, will be updated to the last counter used
+  @param mode   The counter mode (CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN)
+                combined with the width of the counter in octets (0 for the full block)
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   __m128i sk[8 * 15], q[AESBS_PAR];
+   unsigned long n, i;
+   int Nr, width;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14) return CRYPT_INVALID_ROUNDS;
+
+   width = mode & 255;
+   mode &= CTR_COUNTER_BIG_ENDIAN;
+   if (width == 0) {
+      width = 16;
+   }
+   if (width > 16) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   if (blocks > AESBS_SINGLE_MAX) {
+      s_aesbs_slice_keys(sk, skey->rijndael.eK, Nr);
+   }
+   while (blocks > 0) {
+      n = blocks < AESBS_PAR ? blocks : AESBS_PAR;
+      for (i = 0; i < n; i++) {
+         s_aesbs_ctr_increment(IV, width, mode);
+         q[i] = _mm_loadu_si128((const __m128i*) IV);
+      }
+      s_aesbs_encrypt_n(q, n, sk, &skey->rijndael);
+      for (i = 0; i < n; i++) {
+         q[i] = _mm_xor_si128(q[i], _mm_loadu_si128((const __m128i*) (pt + 16 * i)));
+         _mm_storeu_si128((__m128i*) (ct + 16 * i), q[i]);
+      }
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+
+   return CRYPT_OK;
+}
+
+/* Multiply the XTS tweak by x in GF(2^128), c.f. xts_mult_x() */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE __m128i s_aesbs_xts_mult_x(__m128i t)
+{
+   __m128i c;
+   c = _mm_srai_epi32(t, 31);
+   c = _mm_shuffle_epi32(c, 0x93);
+   c = _mm_and_si128(c, _mm_set_epi32(1, 1, 1, 0x87));
+   return _mm_xor_si128(_mm_slli_epi32(t, 1), c);
+}
+
+/**
+  XTS encrypt multiple blocks with AES
+  Ciphertext stealing is left to xts_encrypt().
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                            const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   __m128i sk[8 * 15], q[AESBS_PAR], t[AESBS_PAR], T;
+   unsigned long n, i;
+   int Nr;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14 || skey2->rijndael.Nr != Nr) return CRYPT_INVALID_ROUNDS;
+
+   /* the tweak is encrypted with the tweak key */
+   T = s_aesbs_encrypt1(_mm_loadu_si128((const __m128i*) tweak), skey2->rijndael.vK[0], Nr);
+   if (blocks > AESBS_SINGLE_MAX) {
+      s_aesbs_slice_keys(sk, skey1->rijndael.eK, Nr);
+   }
+
+   while (blocks > 0) {
+      n = blocks < AESBS_PAR ? blocks : AESBS_PAR;
+      for (i = 0; i < n; i++) {
+         t[i] = T;
+         q[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt + 16 * i)), T);
+         T = s_aesbs_xts_mult_x(T);
+      }
+      s_aesbs_encrypt_n(q, n, sk, &skey1->rijndael);
+      for (i = 0; i < n; i++) {
+         _mm_storeu_si128((__m128i*) (ct + 16 * i), _mm_xor_si128(q[i], t[i]));
+      }
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+   _mm_storeu_si128((__m128i*) tweak, T);
+
+   return CRYPT_OK;
+}
+
+/**
+  XTS decrypt multiple blocks with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("ssse3")))
+int aesbs_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                            const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   __m128i sk[8 * 15], q[AESBS_PAR], t[AESBS_PAR], T;
+   unsigned long n, i;
+   int Nr;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 14 || skey2->rijndael.Nr != Nr) return CRYPT_INVALID_ROUNDS;
+
+   /* the tweak is encrypted with the tweak key */
+   T = s_aesbs_encrypt1(_mm_loadu_si128((const __m128i*) tweak), skey2->rijndael.vK[0], Nr);
+   if (blocks > AESBS_SINGLE_MAX) {
+      s_aesbs_slice_keys(sk, skey1->rijndael.eK, Nr);
+   }
+
+   while (blocks > 0) {
+      n = blocks < AESBS_PAR ? blocks : AESBS_PAR;
+      for (i = 0; i < n; i++) {
+         t[i] = T;
+         q[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct + 16 * i)), T);
+         T = s_aesbs_xts_mult_x(T);
+      }
+      s_aesbs_decrypt_n(q, n, sk, &skey1->rijndael);
+      for (i = 0; i < n; i++) {
+         _mm_storeu_si128((__m128i*) (pt + 16 * i), _mm_xor_si128(q[i], t[i]));
+      }
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+   _mm_storeu_si128((__m128i*) tweak, T);
+
+   return CRYPT_OK;
+}
+
+#if defined(LTC_TEST) && defined(LTC_RIJNDAEL)
+/* XTS with the table based implementation, for the comparison in aesbs_test() */
+static void s_aesbs_xts_ref(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                            const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   unsigned char T[16], tmp[16];
+   unsigned long i;
+   int x;
+
+   rijndael_ecb_encrypt(tweak, T, skey2);
+   for (i = 0; i < blocks; i++) {
+      for (x = 0; x < 16; x++) tmp[x] = pt[16 * i + x] ^ T[x];
+      rijndael_ecb_encrypt(tmp, tmp, skey1);
+      for (x = 0; x < 16; x++) ct[16 * i + x] = tmp[x] ^ T[x];
+      /* multiply by x */
+      tmp[0] = T[15] >> 7;
+      for (x = 15; x > 0; x--) T[x] = (unsigned char)((T[x] << 1) | (T[x - 1] >> 7));
+      T[0] = (unsigned char)((T[0] << 1) ^ (tmp[0] * 0x87));
+   }
+   XMEMCPY(tweak, T, 16);
+}
+#endif
+
+/**
+  Performs a self-test of the AES block cipher
+  @return CRYPT_OK if functional, CRYPT_NOP if self-test has been disabled
+*/
+int aesbs_test(void)
+{
+ #ifndef LTC_TEST
+    return CRYPT_NOP;
+ #else
+ int err;
+ static const struct {
+     int keylen;
+     unsigned char key[32], pt[16], ct[16];
+ } tests[] = {
+    { 16,
+      { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f },
+      { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+      { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+        0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a }
+    }, {
+      24,
+      { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17 },
+      { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+      { 0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0,
+        0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91 }
+    }, {
+      32,
+      { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+        0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f },
+      { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+      { 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+        0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 }
+    }
+ };
+
+  symmetric_key key;
+  unsigned char tmp[2][16];
+  unsigned char buf[3][16 * (2 * AESBS_PAR + 3)];
+  int i, y;
+#if defined(LTC_RIJNDAEL)
+  symmetric_key key2, ref, ref2;
+  unsigned char iv[2][16];
+  int x;
+#endif
+
+  for (i = 0; i < (int)(sizeof(tests)/sizeof(tests[0])); i++) {
+    zeromem(&key, sizeof(key));
+    if ((err = aesbs_setup(tests[i].key, tests[i].keylen, 0, &key)) != CRYPT_OK) {
+       return err;
+    }
+
+    aesbs_ecb_encrypt(tests[i].pt, tmp[0], &key);
+    aesbs_ecb_decrypt(tmp[0], tmp[1], &key);
+    if (compare_testvector(tmp[0], 16, tests[i].ct, 16, "AES-BS Encrypt", i) ||
+          compare_testvector(tmp[1], 16, tests[i].pt, 16, "AES-BS Decrypt", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+
+    /* now see if we can encrypt all zero bytes 1000 times, decrypt and come back where we started */
+    for (y = 0; y < 16; y++) tmp[0][y] = 0;
+    for (y = 0; y < 1000; y++) aesbs_ecb_encrypt(tmp[0], tmp[0], &key);
+    for (y = 0; y < 1000; y++) aesbs_ecb_decrypt(tmp[0], tmp[0], &key);
+    for (y = 0; y < 16; y++) if (tmp[0][y] != 0) return CRYPT_FAIL_TESTVECTOR;
+
+    /* the multi-block functions have to give the same result as the single-block ones */
+    for (y = 0; y < (int)sizeof(buf[0]); y++) buf[0][y] = (unsigned char)(y * 7 + i);
+    for (y = 0; y < (int)sizeof(buf[0]); y += 16) aesbs_ecb_encrypt(buf[0] + y, buf[1] + y, &key);
+    if ((err = aesbs_accel_ecb_encrypt(buf[0], buf[2], sizeof(buf[0]) / 16, &key)) != CRYPT_OK) {
+       return err;
+    }
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[1], sizeof(buf[1]), "AES-BS multi-block Encrypt", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+    if ((err = aesbs_accel_ecb_decrypt(buf[2], buf[2], sizeof(buf[2]) / 16, &key)) != CRYPT_OK) {
+       return err;
+    }
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[0], sizeof(buf[0]), "AES-BS multi-block Decrypt", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+
+#if defined(LTC_RIJNDAEL)
+    /* compare the modes against the table based implementation */
+    if ((err = rijndael_setup(tests[i].key, tests[i].keylen, 0, &ref)) != CRYPT_OK) {
+       return err;
+    }
+    for (y = 0; y < (int)sizeof(buf[0]); y += 16) rijndael_ecb_encrypt(buf[0] + y, buf[1] + y, &ref);
+    aesbs_accel_ecb_encrypt(buf[0], buf[2], sizeof(buf[0]) / 16, &key);
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[1], sizeof(buf[1]), "AES-BS ECB vs. tables", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+    /* every number of blocks, i.e. single blocks, padded batches and both mixed */
+    for (y = 1; y <= (int)sizeof(buf[0]) / 16; y++) {
+       aesbs_accel_ecb_encrypt(buf[0], buf[2], y, &key);
+       if (compare_testvector(buf[2], 16 * y, buf[1], 16 * y, "AES-BS ECB blocks vs. tables", y)) {
+           return CRYPT_FAIL_TESTVECTOR;
+       }
+       aesbs_accel_ecb_decrypt(buf[2], buf[2], y, &key);
+       if (compare_testvector(buf[2], 16 * y, buf[0], 16 * y, "AES-BS ECB blocks Decrypt", y)) {
+           return CRYPT_FAIL_TESTVECTOR;
+       }
+    }
+
+    /* the round keys are in the format of rijndael_setup() */
+    rijndael_ecb_encrypt(tests[i].pt, tmp[0], &key);
+    rijndael_ecb_decrypt(tmp[0], tmp[1], &key);
+    if (compare_testvector(tmp[0], 16, tests[i].ct, 16, "AES-BS key with tables Encrypt", i) ||
+          compare_testvector(tmp[1], 16, tests[i].pt, 16, "AES-BS key with tables Decrypt", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+
+    /* CBC */
+    for (y = 0; y < 16; y++) iv[0][y] = iv[1][y] = (unsigned char)(0xf0 + y);
+    for (y = 0; y < (int)sizeof(buf[0]); y += 16) {
+       for (x = 0; x < 16; x++) iv[0][x] ^= buf[0][y + x];
+       rijndael_ecb_encrypt(iv[0], iv[0], &ref);
+       XMEMCPY(buf[1] + y, iv[0], 16);
+    }
+    aesbs_accel_cbc_encrypt(buf[0], buf[2], sizeof(buf[0]) / 16, iv[1], &key);
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[1], sizeof(buf[1]), "AES-BS CBC Encrypt", i) ||
+          compare_testvector(iv[1], 16, iv[0], 16, "AES-BS CBC Encrypt IV", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+    for (y = 0; y < 16; y++) iv[1][y] = (unsigned char)(0xf0 + y);
+    aesbs_accel_cbc_decrypt(buf[2], buf[2], sizeof(buf[2]) / 16, iv[1], &key);
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[0], sizeof(buf[0]), "AES-BS CBC Decrypt", i) ||
+          compare_testvector(iv[1], 16, iv[0], 16, "AES-BS CBC Decrypt IV", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+
+    /* CTR, big endian with a carry over the lower 32 bits */
+    for (y = 0; y < 16; y++) iv[0][y] = iv[1][y] = (unsigned char)(y < 12 ? y : 0xff);
+    iv[0][15] = iv[1][15] = 0xf8;
+    for (y = 0; y < (int)sizeof(buf[0]); y += 16) {
+       for (x = 15; x >= 0; x--) {
+          iv[0][x]++;
+          if (iv[0][x] != 0) break;
+       }
+       rijndael_ecb_encrypt(iv[0], tmp[0], &ref);
+       for (x = 0; x < 16; x++) buf[1][y + x] = buf[0][y + x] ^ tmp[0][x];
+    }
+    aesbs_accel_ctr_encrypt(buf[0], buf[2], sizeof(buf[0]) / 16, iv[1], CTR_COUNTER_BIG_ENDIAN, &key);
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[1], sizeof(buf[1]), "AES-BS CTR", i) ||
+          compare_testvector(iv[1], 16, iv[0], 16, "AES-BS CTR IV", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+
+    /* XTS, the tweak key is derived from the data key */
+    for (y = 0; y < tests[i].keylen; y++) buf[1][y] = tests[i].key[y] ^ 0x5a;
+    if ((err = aesbs_setup(buf[1], tests[i].keylen, 0, &key2)) != CRYPT_OK) {
+       return err;
+    }
+    if ((err = rijndael_setup(buf[1], tests[i].keylen, 0, &ref2)) != CRYPT_OK) {
+       return err;
+    }
+    for (y = 0; y < 16; y++) iv[0][y] = iv[1][y] = (unsigned char)(y * 3 + i);
+    s_aesbs_xts_ref(buf[0], buf[1], sizeof(buf[0]) / 16, iv[0], &ref, &ref2);
+    aesbs_accel_xts_encrypt(buf[0], buf[2], sizeof(buf[0]) / 16, iv[1], &key, &key2);
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[1], sizeof(buf[1]), "AES-BS XTS Encrypt", i) ||
+          compare_testvector(iv[1], 16, iv[0], 16, "AES-BS XTS Encrypt tweak", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+    for (y = 0; y < 16; y++) iv[1][y] = (unsigned char)(y * 3 + i);
+    aesbs_accel_xts_decrypt(buf[2], buf[2], sizeof(buf[2]) / 16, iv[1], &key, &key2);
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[0], sizeof(buf[0]), "AES-BS XTS Decrypt", i) ||
+          compare_testvector(iv[1], 16, iv[0], 16, "AES-BS XTS Decrypt tweak", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+#endif
+  }
+  return CRYPT_OK;
+ #endif
+}
+
+
+/** Terminate the context
+   @param skey    The scheduled key
+*/
+void aesbs_done(symmetric_key *skey)
+{
+  LTC_UNUSED_PARAM(skey);
+}
+
+
+/**
+  Gets suitable key size
+  @param keysize [in/out] The length of the recommended key (in bytes).  This function will store the suitable size back in this variable.
+  @return CRYPT_OK if the input key size is acceptable.
+*/
+int aesbs_keysize(int *keysize)
+{
+   LTC_ARGCHK(keysize != NULL);
+
+   if (*keysize < 16) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+   if (*keysize < 24) {
+      *keysize = 16;
+      return CRYPT_OK;
+   }
+   if (*keysize < 32) {
+      *keysize = 24;
+      return CRYPT_OK;
+   }
+   *keysize = 32;
+   return CRYPT_OK;
+}
+
+#endif
@@ -11,16 +11,30 @@
 
 #if defined(LTC_AES_NI)
 
+#if defined(LTC_CCM_MODE)
+#define AESNI_ACCEL_CCM_MEMORY aesni_accel_ccm_memory
+#else
+#define AESNI_ACCEL_CCM_MEMORY NULL
+#endif
+
+#if defined(LTC_GCM_MODE)
+#define AESNI_ACCEL_GCM_MEMORY aesni_accel_gcm_memory
+#else
+#define AESNI_ACCEL_GCM_MEMORY NULL
+#endif
+
 const struct ltc_cipher_descriptor aesni_desc =
 {
     "aes",
     6,
     16, 32, 16, 10,
     aesni_setup, aesni_ecb_encrypt, aesni_ecb_decrypt, aesni_test, aesni_done, aesni_keysize,
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    aesni_accel_ecb_encrypt, aesni_accel_ecb_decrypt, aesni_accel_cbc_encrypt, aesni_accel_cbc_decrypt, aesni_accel_ctr_encrypt,
+    NULL, NULL, AESNI_ACCEL_CCM_MEMORY, AESNI_ACCEL_GCM_MEMORY, NULL, NULL, NULL, aesni_accel_xts_encrypt, aesni_accel_xts_decrypt
 };
 
 #include <emmintrin.h>
+#include <tmmintrin.h>
 #include <smmintrin.h>
 #include <wmmintrin.h>
 
@@ -266,6 +280,1079 @@ int aesni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetri
 }
 #endif
 
+/* Number of blocks that are processed in parallel by the multi-block functions.
+ * AESENC/AESDEC have a latency of 4-7 cycles but a throughput of 1-2 per cycle,
+ * so interleaving 8 independent blocks keeps the AES unit busy.
+ */
+#define AESNI_PAR 8
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE void s_aesni_enc8(__m128i *b, const __m128i *skeys, int Nr)
+{
+   int i, r;
+   for (i = 0; i < AESNI_PAR; i++) {
+      b[i] = _mm_xor_si128(b[i], skeys[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         b[i] = _mm_aesenc_si128(b[i], skeys[r]);
+      }
+   }
+   for (i = 0; i < AESNI_PAR; i++) {
+      b[i] = _mm_aesenclast_si128(b[i], skeys[Nr]);
+   }
+}
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE void s_aesni_dec8(__m128i *b, const __m128i *skeys, int Nr)
+{
+   int i, r;
+   for (i = 0; i < AESNI_PAR; i++) {
+      b[i] = _mm_xor_si128(b[i], skeys[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         b[i] = _mm_aesdec_si128(b[i], skeys[r]);
+      }
+   }
+   for (i = 0; i < AESNI_PAR; i++) {
+      b[i] = _mm_aesdeclast_si128(b[i], skeys[Nr]);
+   }
+}
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE __m128i s_aesni_enc1(__m128i b, const __m128i *skeys, int Nr)
+{
+   int r;
+   b = _mm_xor_si128(b, skeys[0]);
+   for (r = 1; r < Nr; r++) {
+      b = _mm_aesenc_si128(b, skeys[r]);
+   }
+   return _mm_aesenclast_si128(b, skeys[Nr]);
+}
+
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE __m128i s_aesni_dec1(__m128i b, const __m128i *skeys, int Nr)
+{
+   int r;
+   b = _mm_xor_si128(b, skeys[0]);
+   for (r = 1; r < Nr; r++) {
+      b = _mm_aesdec_si128(b, skeys[r]);
+   }
+   return _mm_aesdeclast_si128(b, skeys[Nr]);
+}
+
+/**
+  Encrypts multiple blocks of text with AES
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   int Nr, i;
+   const __m128i *skeys;
+   __m128i b[AESNI_PAR];
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (__m128i*) skey->rijndael.eK;
+
+   while (blocks >= AESNI_PAR) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         b[i] = _mm_loadu_si128((const __m128i*) (pt + 16 * i));
+      }
+      s_aesni_enc8(b, skeys, Nr);
+      for (i = 0; i < AESNI_PAR; i++) {
+         _mm_storeu_si128((__m128i*) (ct + 16 * i), b[i]);
+      }
+      pt += 16 * AESNI_PAR;
+      ct += 16 * AESNI_PAR;
+      blocks -= AESNI_PAR;
+   }
+   while (blocks-- > 0) {
+      b[0] = s_aesni_enc1(_mm_loadu_si128((const __m128i*) pt), skeys, Nr);
+      _mm_storeu_si128((__m128i*) ct, b[0]);
+      pt += 16;
+      ct += 16;
+   }
+
+   return CRYPT_OK;
+}
+
+/**
+  Decrypts multiple blocks of text with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey)
+{
+   int Nr, i;
+   const __m128i *skeys;
+   __m128i b[AESNI_PAR];
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (__m128i*) skey->rijndael.dK;
+
+   while (blocks >= AESNI_PAR) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         b[i] = _mm_loadu_si128((const __m128i*) (ct + 16 * i));
+      }
+      s_aesni_dec8(b, skeys, Nr);
+      for (i = 0; i < AESNI_PAR; i++) {
+         _mm_storeu_si128((__m128i*) (pt + 16 * i), b[i]);
+      }
+      pt += 16 * AESNI_PAR;
+      ct += 16 * AESNI_PAR;
+      blocks -= AESNI_PAR;
+   }
+   while (blocks-- > 0) {
+      b[0] = s_aesni_dec1(_mm_loadu_si128((const __m128i*) ct), skeys, Nr);
+      _mm_storeu_si128((__m128i*) pt, b[0]);
+      pt += 16;
+      ct += 16;
+   }
+
+   return CRYPT_OK;
+}
+
+/**
+  CBC encrypt multiple blocks with AES
+  CBC encryption is inherently serial, but the chaining value and the round
+  keys are kept in registers for the whole run.
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value, will be updated to the last ciphertext block
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   int Nr;
+   const __m128i *skeys;
+   __m128i iv;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (__m128i*) skey->rijndael.eK;
+   iv = _mm_loadu_si128((const __m128i*) IV);
+
+   while (blocks-- > 0) {
+      iv = _mm_xor_si128(iv, _mm_loadu_si128((const __m128i*) pt));
+      iv = s_aesni_enc1(iv, skeys, Nr);
+      _mm_storeu_si128((__m128i*) ct, iv);
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i*) IV, iv);
+
+   return CRYPT_OK;
+}
+
+/**
+  CBC decrypt multiple blocks with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The chaining value, will be updated to the last ciphertext block
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_accel_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   int Nr, i;
+   const __m128i *skeys;
+   __m128i b[AESNI_PAR], c[AESNI_PAR], iv;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   skeys = (__m128i*) skey->rijndael.dK;
+   iv = _mm_loadu_si128((const __m128i*) IV);
+
+   while (blocks >= AESNI_PAR) {
+      /* keep a copy of the ciphertext, `ct` and `pt` may overlap */
+      for (i = 0; i < AESNI_PAR; i++) {
+         c[i] = b[i] = _mm_loadu_si128((const __m128i*) (ct + 16 * i));
+      }
+      s_aesni_dec8(b, skeys, Nr);
+      _mm_storeu_si128((__m128i*) pt, _mm_xor_si128(b[0], iv));
+      for (i = 1; i < AESNI_PAR; i++) {
+         _mm_storeu_si128((__m128i*) (pt + 16 * i), _mm_xor_si128(b[i], c[i - 1]));
+      }
+      iv = c[AESNI_PAR - 1];
+      pt += 16 * AESNI_PAR;
+      ct += 16 * AESNI_PAR;
+      blocks -= AESNI_PAR;
+   }
+   while (blocks-- > 0) {
+      c[0] = _mm_loadu_si128((const __m128i*) ct);
+      b[0] = s_aesni_dec1(c[0], skeys, Nr);
+      _mm_storeu_si128((__m128i*) pt, _mm_xor_si128(b[0], iv));
+      iv = c[0];
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i*) IV, iv);
+
+   return CRYPT_OK;
+}
+
+static LTC_INLINE void s_aesni_ctr_increment(unsigned char *ctr, int width, int mode)
+{
+   int x;
+   if (mode == CTR_COUNTER_LITTLE_ENDIAN) {
+      for (x = 0; x < width; x++) {
+         ctr[x] = (ctr[x] + (unsigned char)1) & (unsigned char)255;
+         if (ctr[x] != (unsigned char)0) {
+            break;
+         }
+      }
+   } else {
+      for (x = 15; x >= 16 - width; x--) {
+         ctr[x] = (ctr[x] + (unsigned char)1) & (unsigned char)255;
+         if (ctr[x] != (unsigned char)0) {
+            break;
+         }
+      }
+   }
+}
+
+/**
+  CTR encrypt multiple blocks with AES
+  The counter blocks are generated in SIMD registers, eight at a time, as long
+  as the lower 32 bits of the counter don't wrap around.  Otherwise (and for
+  counters narrower than 32 bits) the counter is incremented byte-wise.
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param IV     [in/out] The current counter, will be updated to the last counter used
+  @param mode   The counter mode (CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN)
+                combined with the width of the counter in octets (0 for the full block)
+  @param skey   The key as scheduled
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes,ssse3")))
+int aesni_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   int Nr, i, width;
+   const __m128i *skeys;
+   __m128i b[AESNI_PAR], ctr, bswap, one;
+   ulong32 lo;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(IV != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   Nr = skey->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16) return CRYPT_INVALID_ROUNDS;
+
+   width = mode & 255;
+   mode &= CTR_COUNTER_BIG_ENDIAN;
+   if (width == 0) {
+      width = 16;
+   }
+   if (width > 16) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   skeys = (__m128i*) skey->rijndael.eK;
+   /* the counter is kept as little-endian 128 bit integer in `ctr` */
+   bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   while (blocks > 0) {
+      ctr = _mm_loadu_si128((const __m128i*) IV);
+      if (mode == CTR_COUNTER_BIG_ENDIAN) {
+         ctr = _mm_shuffle_epi8(ctr, bswap);
+      }
+      lo = (ulong32)_mm_cvtsi128_si32(ctr);
+      if (blocks >= AESNI_PAR && width >= 4 && lo <= 0xFFFFFFFFUL - AESNI_PAR) {
+         do {
+            for (i = 0; i < AESNI_PAR; i++) {
+               ctr = _mm_add_epi32(ctr, one);
+               b[i] = mode == CTR_COUNTER_BIG_ENDIAN ? _mm_shuffle_epi8(ctr, bswap) : ctr;
+            }
+            s_aesni_enc8(b, skeys, Nr);
+            for (i = 0; i < AESNI_PAR; i++) {
+               b[i] = _mm_xor_si128(b[i], _mm_loadu_si128((const __m128i*) (pt + 16 * i)));
+               _mm_storeu_si128((__m128i*) (ct + 16 * i), b[i]);
+            }
+            pt += 16 * AESNI_PAR;
+            ct += 16 * AESNI_PAR;
+            blocks -= AESNI_PAR;
+            lo += AESNI_PAR;
+         } while (blocks >= AESNI_PAR && lo <= 0xFFFFFFFFUL - AESNI_PAR);
+         if (mode == CTR_COUNTER_BIG_ENDIAN) {
+            ctr = _mm_shuffle_epi8(ctr, bswap);
+         }
+         _mm_storeu_si128((__m128i*) IV, ctr);
+      } else {
+         s_aesni_ctr_increment(IV, width, mode);
+         b[0] = s_aesni_enc1(_mm_loadu_si128((const __m128i*) IV), skeys, Nr);
+         b[0] = _mm_xor_si128(b[0], _mm_loadu_si128((const __m128i*) pt));
+         _mm_storeu_si128((__m128i*) ct, b[0]);
+         pt += 16;
+         ct += 16;
+         blocks--;
+      }
+   }
+
+   return CRYPT_OK;
+}
+
+/* Multiply the XTS tweak by x in GF(2^128), c.f. xts_mult_x()
+ * Each 32-bit lane is shifted left by one, the carries are rotated into the
+ * next lane and the carry out of the top lane is reduced with 0x87.
+ */
+LTC_ATTRIBUTE((__target__("sse2")))
+static LTC_INLINE __m128i s_aesni_xts_mult_x(__m128i t)
+{
+   __m128i c;
+   c = _mm_srai_epi32(t, 31);
+   c = _mm_shuffle_epi32(c, 0x93);
+   c = _mm_and_si128(c, _mm_set_epi32(1, 1, 1, 0x87));
+   return _mm_xor_si128(_mm_slli_epi32(t, 1), c);
+}
+
+/**
+  XTS encrypt multiple blocks with AES
+  The tweaks for eight blocks are computed in SIMD registers and the blocks
+  are encrypted interleaved.  Ciphertext stealing is left to xts_encrypt().
+  @param pt     The input plaintext (blocks * 16 bytes)
+  @param ct     [out] The output ciphertext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak,
+                            const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   int Nr, i;
+   const __m128i *skeys;
+   __m128i b[AESNI_PAR], t[AESNI_PAR], T;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16 || skey2->rijndael.Nr != Nr) return CRYPT_INVALID_ROUNDS;
+
+   T = s_aesni_enc1(_mm_loadu_si128((const __m128i*) tweak), (const __m128i*) skey2->rijndael.eK, Nr);
+   skeys = (const __m128i*) skey1->rijndael.eK;
+
+   while (blocks >= AESNI_PAR) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         t[i] = T;
+         b[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pt + 16 * i)), T);
+         T = s_aesni_xts_mult_x(T);
+      }
+      s_aesni_enc8(b, skeys, Nr);
+      for (i = 0; i < AESNI_PAR; i++) {
+         _mm_storeu_si128((__m128i*) (ct + 16 * i), _mm_xor_si128(b[i], t[i]));
+      }
+      pt += 16 * AESNI_PAR;
+      ct += 16 * AESNI_PAR;
+      blocks -= AESNI_PAR;
+   }
+   while (blocks-- > 0) {
+      b[0] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) pt), T);
+      b[0] = s_aesni_enc1(b[0], skeys, Nr);
+      _mm_storeu_si128((__m128i*) ct, _mm_xor_si128(b[0], T));
+      T = s_aesni_xts_mult_x(T);
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i*) tweak, T);
+
+   return CRYPT_OK;
+}
+
+/**
+  XTS decrypt multiple blocks with AES
+  @param ct     The input ciphertext (blocks * 16 bytes)
+  @param pt     [out] The output plaintext (blocks * 16 bytes)
+  @param blocks The number of blocks to process
+  @param tweak  [in/out] The tweak, unencrypted on input, the encrypted next tweak on output
+  @param skey1  The key as scheduled for the data
+  @param skey2  The key as scheduled for the tweak
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes")))
+int aesni_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak,
+                            const symmetric_key *skey1, const symmetric_key *skey2)
+{
+   int Nr, i;
+   const __m128i *skeys;
+   __m128i b[AESNI_PAR], t[AESNI_PAR], T;
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(tweak != NULL);
+   LTC_ARGCHK(skey1 != NULL);
+   LTC_ARGCHK(skey2 != NULL);
+
+   Nr = skey1->rijndael.Nr;
+
+   if (Nr < 2 || Nr > 16 || skey2->rijndael.Nr != Nr) return CRYPT_INVALID_ROUNDS;
+
+   T = s_aesni_enc1(_mm_loadu_si128((const __m128i*) tweak), (const __m128i*) skey2->rijndael.eK, Nr);
+   skeys = (const __m128i*) skey1->rijndael.dK;
+
+   while (blocks >= AESNI_PAR) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         t[i] = T;
+         b[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct + 16 * i)), T);
+         T = s_aesni_xts_mult_x(T);
+      }
+      s_aesni_dec8(b, skeys, Nr);
+      for (i = 0; i < AESNI_PAR; i++) {
+         _mm_storeu_si128((__m128i*) (pt + 16 * i), _mm_xor_si128(b[i], t[i]));
+      }
+      pt += 16 * AESNI_PAR;
+      ct += 16 * AESNI_PAR;
+      blocks -= AESNI_PAR;
+   }
+   while (blocks-- > 0) {
+      b[0] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) ct), T);
+      b[0] = s_aesni_dec1(b[0], skeys, Nr);
+      _mm_storeu_si128((__m128i*) pt, _mm_xor_si128(b[0], T));
+      T = s_aesni_xts_mult_x(T);
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i*) tweak, T);
+
+   return CRYPT_OK;
+}
+
+#if defined(LTC_CCM_MODE)
+
+/* Encrypt two independent blocks in the same round loop */
+LTC_ATTRIBUTE((__target__("aes")))
+static LTC_INLINE void s_aesni_enc2(__m128i *a, __m128i *b, const __m128i *skeys, int Nr)
+{
+   int r;
+   *a = _mm_xor_si128(*a, skeys[0]);
+   *b = _mm_xor_si128(*b, skeys[0]);
+   for (r = 1; r < Nr; r++) {
+      *a = _mm_aesenc_si128(*a, skeys[r]);
+      *b = _mm_aesenc_si128(*b, skeys[r]);
+   }
+   *a = _mm_aesenclast_si128(*a, skeys[Nr]);
+   *b = _mm_aesenclast_si128(*b, skeys[Nr]);
+}
+
+/**
+  CCM encrypt/decrypt and produce an authentication tag
+
+    *1 'pt', 'ct' and 'tag' can both be 'in' or 'out', depending on 'direction'
+
+  The CBC-MAC is a serial chain of block encryptions, so the key stream
+  block for the next CTR block is computed in the same round loop as the
+  CBC-MAC of the current block, where it is hidden by the latency of the
+  chain.
+  @param key        The secret key to use
+  @param keylen     The length of the secret key (octets)
+  @param uskey      A previously scheduled key [optional can be NULL]
+  @param nonce      The session nonce [use once]
+  @param noncelen   The length of the nonce
+  @param header     The header for the session
+  @param headerlen  The length of the header (octets)
+  @param pt         [*1] The plaintext
+  @param ptlen      The length of the plaintext (octets)
+  @param ct         [*1] The ciphertext
+  @param tag        [*1] The destination tag
+  @param taglen     The max size and resulting size of the authentication tag
+  @param direction  Encrypt or Decrypt direction (0 or 1)
+  @return CRYPT_OK if successful
+*/
+LTC_ATTRIBUTE((__target__("aes,ssse3")))
+int aesni_accel_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                           symmetric_key       *uskey,
+                           const unsigned char *nonce,  unsigned long noncelen,
+                           const unsigned char *header, unsigned long headerlen,
+                                 unsigned char *pt,     unsigned long ptlen,
+                                 unsigned char *ct,
+                                 unsigned char *tag,    unsigned long *taglen,
+                                           int  direction)
+{
+   symmetric_key skey;
+   const symmetric_key *sk;
+   const __m128i *skeys;
+   __m128i bswap, one, mac, ctr, ks, s0, d;
+   unsigned char buf[16], *pt_work = NULL, *out;
+   unsigned long L, x, y, i, n;
+   ulong64 len;
+   int err = CRYPT_OK, Nr;
+
+   if (uskey == NULL) {
+      LTC_ARGCHK(key != NULL);
+   }
+   LTC_ARGCHK(nonce  != NULL);
+   if (headerlen > 0) {
+      LTC_ARGCHK(header != NULL);
+   }
+   LTC_ARGCHK(pt     != NULL);
+   LTC_ARGCHK(ct     != NULL);
+   LTC_ARGCHK(tag    != NULL);
+   LTC_ARGCHK(taglen != NULL);
+
+   if (direction != CCM_ENCRYPT && direction != CCM_DECRYPT) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (*taglen < 4 || *taglen > 16 || (*taglen % 2) == 1 || headerlen > 0x7fffffffu) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* let's get the L value */
+   len = ptlen;
+   L   = 0;
+   while (len) {
+      ++L;
+      len >>= 8;
+   }
+   if (L <= 1) {
+      L = 2;
+   }
+   noncelen = (noncelen > 13) ? 13 : noncelen;
+   if ((15 - noncelen) > L) {
+      L = 15 - noncelen;
+   }
+   if (L > 8) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   if (uskey == NULL) {
+      if ((err = aesni_setup(key, (int)keylen, 0, &skey)) != CRYPT_OK) {
+         return err;
+      }
+      sk = &skey;
+   } else {
+      sk = uskey;
+   }
+   skeys = (const __m128i*) sk->rijndael.eK;
+   Nr = sk->rijndael.Nr;
+
+   bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   /* A_0 == flags | Nonce N | 0, the counter is kept byte-reversed in `ctr` */
+   zeromem(buf, sizeof(buf));
+   buf[0] = (unsigned char)(L - 1);
+   XMEMCPY(buf + 1, nonce, 15 - L);
+   ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), bswap);
+
+   /* B_0 == flags | Nonce N | l(m) */
+   buf[0] = (unsigned char)(((headerlen > 0) ? (1<<6) : 0) | (((*taglen - 2)>>1)<<3) | (L-1));
+   len = ptlen;
+   for (x = 15; x > 15 - L; x--) {
+      buf[x] = (unsigned char)(len & 255);
+      len >>= 8;
+   }
+
+   /* the MAC of B_0 and S_0 = E(A_0) which encrypts the tag */
+   mac = _mm_loadu_si128((const __m128i*) buf);
+   s0 = _mm_shuffle_epi8(ctr, bswap);
+   s_aesni_enc2(&mac, &s0, skeys, Nr);
+
+   /* handle header */
+   if (headerlen > 0) {
+      zeromem(buf, sizeof(buf));
+      x = 0;
+      if (headerlen < ((1UL<<16) - (1UL<<8))) {
+         buf[x++] = (headerlen>>8) & 255;
+         buf[x++] = headerlen & 255;
+      } else {
+         buf[x++] = 0xFF;
+         buf[x++] = 0xFE;
+         buf[x++] = (headerlen>>24) & 255;
+         buf[x++] = (headerlen>>16) & 255;
+         buf[x++] = (headerlen>>8) & 255;
+         buf[x++] = headerlen & 255;
+      }
+      n = MIN(16 - x, headerlen);
+      XMEMCPY(buf + x, header, n);
+      mac = s_aesni_enc1(_mm_xor_si128(mac, _mm_loadu_si128((const __m128i*) buf)), skeys, Nr);
+      for (y = n; y + 16 <= headerlen; y += 16) {
+         mac = s_aesni_enc1(_mm_xor_si128(mac, _mm_loadu_si128((const __m128i*) (header + y))), skeys, Nr);
+      }
+      if (y < headerlen) {
+         zeromem(buf, sizeof(buf));
+         XMEMCPY(buf, header + y, headerlen - y);
+         mac = s_aesni_enc1(_mm_xor_si128(mac, _mm_loadu_si128((const __m128i*) buf)), skeys, Nr);
+      }
+   }
+
+   /* decrypt to a temporary buffer, the plaintext is only released if the tag is valid */
+   out = pt;
+   if (direction == CCM_DECRYPT && ptlen > 0) {
+      pt_work = XMALLOC(ptlen);
+      if (pt_work == NULL) {
+         err = CRYPT_MEM;
+         goto LBL_ERR;
+      }
+      out = pt_work;
+   }
+
+   if (ptlen > 0) {
+      ctr = _mm_add_epi64(ctr, one);
+      ks = s_aesni_enc1(_mm_shuffle_epi8(ctr, bswap), skeys, Nr);
+   } else {
+      ks = _mm_setzero_si128();
+   }
+   for (i = 0; i + 16 <= ptlen; i += 16) {
+      if (direction == CCM_ENCRYPT) {
+         d = _mm_loadu_si128((const __m128i*) (pt + i));
+         _mm_storeu_si128((__m128i*) (ct + i), _mm_xor_si128(d, ks));
+      } else {
+         d = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (ct + i)), ks);
+         _mm_storeu_si128((__m128i*) (out + i), d);
+      }
+      mac = _mm_xor_si128(mac, d);
+      if (i + 16 < ptlen) {
+         /* the next key stream block along with the MAC of this block */
+         ctr = _mm_add_epi64(ctr, one);
+         ks = _mm_shuffle_epi8(ctr, bswap);
+         s_aesni_enc2(&mac, &ks, skeys, Nr);
+      } else {
+         mac = s_aesni_enc1(mac, skeys, Nr);
+      }
+   }
+   if (i < ptlen) {
+      n = ptlen - i;
+      zeromem(buf, sizeof(buf));
+      if (direction == CCM_ENCRYPT) {
+         XMEMCPY(buf, pt + i, n);
+         d = _mm_loadu_si128((const __m128i*) buf);
+         _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(d, ks));
+         XMEMCPY(ct + i, buf, n);
+      } else {
+         XMEMCPY(buf, ct + i, n);
+         _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(_mm_loadu_si128((const __m128i*) buf), ks));
+         /* the padding of the partial block must be zero for the MAC */
+         zeromem(buf + n, sizeof(buf) - n);
+         XMEMCPY(out + i, buf, n);
+         d = _mm_loadu_si128((const __m128i*) buf);
+      }
+      mac = s_aesni_enc1(_mm_xor_si128(mac, d), skeys, Nr);
+   }
+
+   _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(mac, s0));
+   if (direction == CCM_ENCRYPT) {
+      for (x = 0; x < 16 && x < *taglen; x++) {
+         tag[x] = buf[x];
+      }
+      *taglen = x;
+   } else {
+      /* check the tag in constant time, see ccm_memory() */
+      err = XMEM_NEQ(buf, tag, *taglen);
+
+      /* Zero the plaintext if the tag was invalid (in constant time) */
+      if (ptlen > 0) {
+         copy_or_zeromem(out, pt, ptlen, err);
+      }
+   }
+
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   if (uskey == NULL) {
+      zeromem(&skey, sizeof(skey));
+   }
+   zeromem(buf, sizeof(buf));
+   if (pt_work != NULL) {
+      zeromem(pt_work, ptlen);
+   }
+#endif
+   if (pt_work != NULL) {
+      XFREE(pt_work);
+   }
+
+   return err;
+}
+
+#endif /* LTC_CCM_MODE */
+
+#if defined(LTC_GCM_MODE)
+
+#define AESNI_GCM_BSWAP _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)
+
+/* Accumulate the unreduced carry-less product a * b of two byte-reflected
+ * blocks in `lo` and `hi`, c.f. gcm_pclmul.c
+ */
+LTC_ATTRIBUTE((__target__("pclmul,sse2")))
+static LTC_INLINE void s_aesni_gcm_mul(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+   __m128i mid;
+   *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+   *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+   mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+   *lo = _mm_xor_si128(*lo, _mm_slli_si128(mid, 8));
+   *hi = _mm_xor_si128(*hi, _mm_srli_si128(mid, 8));
+}
+
+/* Shift the 256 bit value hi:lo left by one bit and reduce it modulo the GCM polynomial */
+LTC_ATTRIBUTE((__target__("sse2")))
+static LTC_INLINE __m128i s_aesni_gcm_reduce(__m128i lo, __m128i hi)
+{
+   __m128i t7, t8, t9, t2, t4, t5;
+
+   t7 = _mm_srli_epi32(lo, 31);
+   t8 = _mm_srli_epi32(hi, 31);
+   lo = _mm_slli_epi32(lo, 1);
+   hi = _mm_slli_epi32(hi, 1);
+   t9 = _mm_srli_si128(t7, 12);
+   t8 = _mm_slli_si128(t8, 4);
+   t7 = _mm_slli_si128(t7, 4);
+   lo = _mm_or_si128(lo, t7);
+   hi = _mm_or_si128(hi, t8);
+   hi = _mm_or_si128(hi, t9);
+
+   t7 = _mm_slli_epi32(lo, 31);
+   t8 = _mm_slli_epi32(lo, 30);
+   t9 = _mm_slli_epi32(lo, 25);
+   t7 = _mm_xor_si128(t7, t8);
+   t7 = _mm_xor_si128(t7, t9);
+   t8 = _mm_srli_si128(t7, 4);
+   t7 = _mm_slli_si128(t7, 12);
+   lo = _mm_xor_si128(lo, t7);
+
+   t2 = _mm_srli_epi32(lo, 1);
+   t4 = _mm_srli_epi32(lo, 2);
+   t5 = _mm_srli_epi32(lo, 7);
+   t2 = _mm_xor_si128(t2, t4);
+   t2 = _mm_xor_si128(t2, t5);
+   t2 = _mm_xor_si128(t2, t8);
+   lo = _mm_xor_si128(lo, t2);
+   return _mm_xor_si128(hi, lo);
+}
+
+LTC_ATTRIBUTE((__target__("pclmul,sse2")))
+static LTC_INLINE __m128i s_aesni_gcm_gfmul(__m128i a, __m128i b)
+{
+   __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+   s_aesni_gcm_mul(a, b, &lo, &hi);
+   return s_aesni_gcm_reduce(lo, hi);
+}
+
+/* GHASH `len` bytes of `in` into `x`, a final partial block is padded with zeros */
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+static __m128i s_aesni_gcm_ghash(__m128i x, const unsigned char *in, unsigned long len, const __m128i *h)
+{
+   __m128i bswap, lo, hi, d;
+   unsigned char buf[16];
+   int i;
+
+   bswap = AESNI_GCM_BSWAP;
+   while (len >= 16 * AESNI_PAR) {
+      lo = _mm_setzero_si128();
+      hi = _mm_setzero_si128();
+      for (i = 0; i < AESNI_PAR; i++) {
+         d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (in + 16 * i)), bswap);
+         if (i == 0) {
+            d = _mm_xor_si128(d, x);
+         }
+         s_aesni_gcm_mul(d, h[AESNI_PAR - 1 - i], &lo, &hi);
+      }
+      x = s_aesni_gcm_reduce(lo, hi);
+      in += 16 * AESNI_PAR;
+      len -= 16 * AESNI_PAR;
+   }
+   while (len > 0) {
+      if (len >= 16) {
+         d = _mm_loadu_si128((const __m128i*) in);
+      } else {
+         zeromem(buf, sizeof(buf));
+         XMEMCPY(buf, in, len);
+         d = _mm_loadu_si128((const __m128i*) buf);
+      }
+      x = s_aesni_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(d, bswap)), h[0]);
+      in += MIN(len, 16);
+      len -= MIN(len, 16);
+   }
+   return x;
+}
+
+/* Encrypt eight counter blocks while the GHASH of the eight blocks `d` is computed */
+LTC_ATTRIBUTE((__target__("aes,pclmul,sse2")))
+static LTC_INLINE void s_aesni_gcm_enc8_ghash8(__m128i *b, const __m128i *skeys, int Nr,
+                                               const __m128i *d, const __m128i *h, __m128i *lo, __m128i *hi)
+{
+   int i, r;
+   for (i = 0; i < AESNI_PAR; i++) {
+      b[i] = _mm_xor_si128(b[i], skeys[0]);
+   }
+   for (r = 1; r < Nr; r++) {
+      for (i = 0; i < AESNI_PAR; i++) {
+         b[i] = _mm_aesenc_si128(b[i], skeys[r]);
+      }
+      /* one multiplication per round, Nr is at least 10 */
+      if (r <= AESNI_PAR) {
+         s_aesni_gcm_mul(d[r - 1], h[AESNI_PAR - r], lo, hi);
+      }
+   }
+   for (i = 0; i < AESNI_PAR; i++) {
+      b[i] = _mm_aesenclast_si128(b[i], skeys[Nr]);
+   }
+}
+
+/**
+  Process an entire GCM packet in one call
+  The CTR encryption of eight blocks is interleaved with the GHASH of the
+  previous eight ciphertext blocks (resp. of the current eight blocks when
+  decrypting), so the data is only passed once.
+  @param key               The secret key
+  @param keylen            The length of the secret key
+  @param IV                The initialization vector
+  @param IVlen             The length of the initialization vector
+  @param adata             The additional authentication data (header)
+  @param adatalen          The length of the adata
+  @param pt                The plaintext
+  @param ptlen             The length of the plaintext (ciphertext length is the same)
+  @param ct                The ciphertext
+  @param tag               [out] The MAC tag
+  @param taglen            [in/out] The MAC tag length
+  @param direction         Encrypt or Decrypt mode (GCM_ENCRYPT or GCM_DECRYPT)
+  @return CRYPT_OK on success, CRYPT_NOP if the CPU doesn't support PCLMULQDQ
+*/
+LTC_ATTRIBUTE((__target__("aes,pclmul,ssse3")))
+int aesni_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                           const unsigned char *IV,     unsigned long IVlen,
+                           const unsigned char *adata,  unsigned long adatalen,
+                                 unsigned char *pt,     unsigned long ptlen,
+                                 unsigned char *ct,
+                                 unsigned char *tag,    unsigned long *taglen,
+                                           int direction)
+{
+   symmetric_key skey;
+   const __m128i *skeys;
+   __m128i bswap, one, h[AESNI_PAR], b[AESNI_PAR], d[AESNI_PAR], x, ctr, ek0, ks, lo, hi;
+   unsigned char buf[16];
+   unsigned long i, n;
+   int err, Nr, j;
+
+   LTC_ARGCHK(key    != NULL);
+   LTC_ARGCHK(IV     != NULL);
+   LTC_ARGCHK(tag    != NULL);
+   LTC_ARGCHK(taglen != NULL);
+   if (adatalen > 0) {
+      LTC_ARGCHK(adata != NULL);
+   }
+   if (ptlen > 0) {
+      LTC_ARGCHK(pt != NULL);
+      LTC_ARGCHK(ct != NULL);
+   }
+
+   if ((ltc_cpu_features() & LTC_CPU_PCLMUL) == 0) {
+      /* gcm_memory() falls back to the generic implementation */
+      return CRYPT_NOP;
+   }
+
+   if (direction != GCM_ENCRYPT && direction != GCM_DECRYPT) {
+      return CRYPT_INVALID_ARG;
+   }
+   /* IV length must be > 0 */
+   if (IVlen == 0) {
+      return CRYPT_ERROR;
+   }
+   /* 0xFFFFFFFE0 = ((2^39)-256)/8 */
+   if ((ulong64)ptlen >= CONST64(0xFFFFFFFE0)) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (keylen > 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+
+   if ((err = aesni_setup(key, (int)keylen, 0, &skey)) != CRYPT_OK) {
+      return err;
+   }
+   skeys = (const __m128i*) skey.rijndael.eK;
+   Nr = skey.rijndael.Nr;
+
+   bswap = AESNI_GCM_BSWAP;
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   /* H = E(0), the higher powers are only required for eight blocks at once */
+   h[0] = _mm_shuffle_epi8(s_aesni_enc1(_mm_setzero_si128(), skeys, Nr), bswap);
+   if (IVlen >= 16 * AESNI_PAR || adatalen >= 16 * AESNI_PAR || ptlen >= 16 * AESNI_PAR) {
+      for (j = 1; j < AESNI_PAR; j++) {
+         h[j] = s_aesni_gcm_gfmul(h[j - 1], h[0]);
+      }
+   }
+
+   /* the counter is kept byte-reflected, i.e. the lower 32 bits are in the lowest lane */
+   if (IVlen == 12) {
+      XMEMCPY(buf, IV, 12);
+      buf[12] = 0;
+      buf[13] = 0;
+      buf[14] = 0;
+      buf[15] = 1;
+      ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), bswap);
+   } else {
+      x = s_aesni_gcm_ghash(_mm_setzero_si128(), IV, IVlen, h);
+      zeromem(buf, 8);
+      STORE64H((ulong64)IVlen * 8, buf + 8);
+      ctr = s_aesni_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), bswap)), h[0]);
+   }
+   ek0 = s_aesni_enc1(_mm_shuffle_epi8(ctr, bswap), skeys, Nr);
+
+   x = s_aesni_gcm_ghash(_mm_setzero_si128(), adata, adatalen, h);
+
+   i = 0;
+   if (direction == GCM_ENCRYPT) {
+      if (ptlen >= 16 * AESNI_PAR) {
+         /* the first eight blocks are only encrypted */
+         for (j = 0; j < AESNI_PAR; j++) {
+            ctr = _mm_add_epi32(ctr, one);
+            b[j] = _mm_shuffle_epi8(ctr, bswap);
+         }
+         s_aesni_enc8(b, skeys, Nr);
+         for (j = 0; j < AESNI_PAR; j++) {
+            d[j] = _mm_xor_si128(b[j], _mm_loadu_si128((const __m128i*) (pt + 16 * j)));
+            _mm_storeu_si128((__m128i*) (ct + 16 * j), d[j]);
+            d[j] = _mm_shuffle_epi8(d[j], bswap);
+         }
+         d[0] = _mm_xor_si128(d[0], x);
+         i = 16 * AESNI_PAR;
+         /* then the next eight blocks are encrypted while the previous ones are hashed */
+         while (ptlen - i >= 16 * AESNI_PAR) {
+            for (j = 0; j < AESNI_PAR; j++) {
+               ctr = _mm_add_epi32(ctr, one);
+               b[j] = _mm_shuffle_epi8(ctr, bswap);
+            }
+            lo = _mm_setzero_si128();
+            hi = _mm_setzero_si128();
+            s_aesni_gcm_enc8_ghash8(b, skeys, Nr, d, h, &lo, &hi);
+            x = s_aesni_gcm_reduce(lo, hi);
+            for (j = 0; j < AESNI_PAR; j++) {
+               d[j] = _mm_xor_si128(b[j], _mm_loadu_si128((const __m128i*) (pt + i + 16 * j)));
+               _mm_storeu_si128((__m128i*) (ct + i + 16 * j), d[j]);
+               d[j] = _mm_shuffle_epi8(d[j], bswap);
+            }
+            d[0] = _mm_xor_si128(d[0], x);
+            i += 16 * AESNI_PAR;
+         }
+         /* and finally the last eight blocks are hashed */
+         lo = _mm_setzero_si128();
+         hi = _mm_setzero_si128();
+         for (j = 0; j < AESNI_PAR; j++) {
+            s_aesni_gcm_mul(d[j], h[AESNI_PAR - 1 - j], &lo, &hi);
+         }
+         x = s_aesni_gcm_reduce(lo, hi);
+      }
+   } else {
+      while (ptlen - i >= 16 * AESNI_PAR) {
+         for (j = 0; j < AESNI_PAR; j++) {
+            ctr = _mm_add_epi32(ctr, one);
+            b[j] = _mm_shuffle_epi8(ctr, bswap);
+            d[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (ct + i + 16 * j)), bswap);
+         }
+         d[0] = _mm_xor_si128(d[0], x);
+         lo = _mm_setzero_si128();
+         hi = _mm_setzero_si128();
+         s_aesni_gcm_enc8_ghash8(b, skeys, Nr, d, h, &lo, &hi);
+         x = s_aesni_gcm_reduce(lo, hi);
+         for (j = 0; j < AESNI_PAR; j++) {
+            b[j] = _mm_xor_si128(b[j], _mm_loadu_si128((const __m128i*) (ct + i + 16 * j)));
+            _mm_storeu_si128((__m128i*) (pt + i + 16 * j), b[j]);
+         }
+         i += 16 * AESNI_PAR;
+      }
+   }
+
+   /* the remaining blocks one by one, the last one may be partial */
+   while (i < ptlen) {
+      n = MIN(ptlen - i, 16);
+      ctr = _mm_add_epi32(ctr, one);
+      ks = s_aesni_enc1(_mm_shuffle_epi8(ctr, bswap), skeys, Nr);
+      zeromem(buf, sizeof(buf));
+      if (direction == GCM_ENCRYPT) {
+         XMEMCPY(buf, pt + i, n);
+         _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(ks, _mm_loadu_si128((const __m128i*) buf)));
+         XMEMCPY(ct + i, buf, n);
+         /* the padding of the partial block must be zero for GHASH */
+         zeromem(buf + n, sizeof(buf) - n);
+         d[0] = _mm_loadu_si128((const __m128i*) buf);
+      } else {
+         XMEMCPY(buf, ct + i, n);
+         d[0] = _mm_loadu_si128((const __m128i*) buf);
+         _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(ks, d[0]));
+         XMEMCPY(pt + i, buf, n);
+      }
+      x = s_aesni_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(d[0], bswap)), h[0]);
+      i += n;
+   }
+
+   /* mix in the lengths and compute the tag */
+   STORE64H((ulong64)adatalen * 8, buf);
+   STORE64H((ulong64)ptlen * 8, buf + 8);
+   x = s_aesni_gcm_gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) buf), bswap)), h[0]);
+   _mm_storeu_si128((__m128i*) buf, _mm_xor_si128(ek0, _mm_shuffle_epi8(x, bswap)));
+
+   if (direction == GCM_ENCRYPT) {
+      for (i = 0; i < 16 && i < *taglen; i++) {
+         tag[i] = buf[i];
+      }
+      *taglen = i;
+   } else if (*taglen != 16 || XMEM_NEQ(buf, tag, 16) != 0) {
+      err = CRYPT_ERROR;
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(&skey, sizeof(skey));
+   zeromem(buf, sizeof(buf));
+#endif
+
+   return err;
+}
+
+#endif /* LTC_GCM_MODE */
+
 /**
   Performs a self-test of the AES block cipher
   @return CRYPT_OK if functional, CRYPT_NOP if self-test has been disabled
@@ -311,6 +1398,7 @@ int aesni_test(void)
 
   symmetric_key key;
   unsigned char tmp[2][16];
+  unsigned char buf[3][16 * (2 * AESNI_PAR + 3)];
   int i, y;
 
   for (i = 0; i < (int)(sizeof(tests)/sizeof(tests[0])); i++) {
@@ -331,6 +1419,22 @@ int aesni_test(void)
     for (y = 0; y < 1000; y++) aesni_ecb_encrypt(tmp[0], tmp[0], &key);
     for (y = 0; y < 1000; y++) aesni_ecb_decrypt(tmp[0], tmp[0], &key);
     for (y = 0; y < 16; y++) if (tmp[0][y] != 0) return CRYPT_FAIL_TESTVECTOR;
+
+    /* the multi-block functions have to give the same result as the single-block ones */
+    for (y = 0; y < (int)sizeof(buf[0]); y++) buf[0][y] = (unsigned char)(y * 7 + i);
+    for (y = 0; y < (int)sizeof(buf[0]); y += 16) aesni_ecb_encrypt(buf[0] + y, buf[1] + y, &key);
+    if ((err = aesni_accel_ecb_encrypt(buf[0], buf[2], sizeof(buf[0]) / 16, &key)) != CRYPT_OK) {
+       return err;
+    }
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[1], sizeof(buf[1]), "AES-NI multi-block Encrypt", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
+    if ((err = aesni_accel_ecb_decrypt(buf[2], buf[2], sizeof(buf[2]) / 16, &key)) != CRYPT_OK) {
+       return err;
+    }
+    if (compare_testvector(buf[2], sizeof(buf[2]), buf[0], sizeof(buf[0]), "AES-NI multi-block Decrypt", i)) {
+        return CRYPT_FAIL_TESTVECTOR;
+    }
   }
   return CRYPT_OK;
  #endif
@@ -81,7 +81,7 @@ int ccm_memory(int cipher,
 
    /* is there an accelerator? */
    if (cipher_descriptor[cipher].accel_ccm_memory != NULL) {
-       return cipher_descriptor[cipher].accel_ccm_memory(
+       err = cipher_descriptor[cipher].accel_ccm_memory(
            key,    keylen,
            uskey,
            nonce,  noncelen,
@@ -90,6 +90,10 @@ int ccm_memory(int cipher,
            ct,
            tag,    taglen,
            direction);
+       /* CRYPT_NOP means the accelerator can't be used, e.g. due to missing CPU support */
+       if (err != CRYPT_NOP) {
+          return err;
+       }
    }
 
    /* let's get the L value */
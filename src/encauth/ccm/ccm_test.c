@@ -240,6 +240,66 @@ int ccm_test(void)
       }
    }
 
+   /* ccm_memory() may use an accelerator, it has to give the same result as the state based API */
+   {
+      static const unsigned long ptlens[] = { 0, 1, 15, 16, 17, 31, 32, 33, 127, 128, 1000 };
+      static const unsigned long hdrlens[] = { 0, 1, 14, 15, 16, 30, 333, 65280 };
+      static const unsigned long noncelens[] = { 7, 13 };
+      unsigned char *hdr, pt[1000], ct[2][1000];
+      unsigned long i, j, k, n;
+
+      hdr = XMALLOC(65280);
+      if (hdr == NULL) {
+         return CRYPT_MEM;
+      }
+      for (x = 0; x < 65280; x++) hdr[x] = (unsigned char)(x * 7 + 1);
+      for (x = 0; x < sizeof(pt); x++) pt[x] = (unsigned char)(x * 13 + 7);
+      err = CRYPT_OK;
+      for (i = 0; err == CRYPT_OK && i < sizeof(ptlens)/sizeof(ptlens[0]); i++) {
+      for (j = 0; err == CRYPT_OK && j < sizeof(hdrlens)/sizeof(hdrlens[0]); j++) {
+      for (k = 0; err == CRYPT_OK && k < sizeof(noncelens)/sizeof(noncelens[0]); k++) {
+         y = i * 100 + j * 10 + k;
+         n = 4 + 12 * k;
+         if ((err = ccm_init(&ccm, idx, tests[0].key, 16, ptlens[i], n, hdrlens[j])) != CRYPT_OK)  break;
+         if ((err = ccm_add_nonce(&ccm, hdr + 100, noncelens[k])) != CRYPT_OK)                  break;
+         if ((err = ccm_add_aad(&ccm, hdr, hdrlens[j])) != CRYPT_OK)                            break;
+         if ((err = ccm_process(&ccm, pt, ptlens[i], ct[1], CCM_ENCRYPT)) != CRYPT_OK)          break;
+         if ((err = ccm_done(&ccm, tag2, &n)) != CRYPT_OK)                                      break;
+
+         taglen = n;
+         if ((err = ccm_memory(idx, tests[0].key, 16, NULL, hdr + 100, noncelens[k], hdr, hdrlens[j],
+                               pt, ptlens[i], ct[0], tag, &taglen, CCM_ENCRYPT)) != CRYPT_OK) {
+            break;
+         }
+         if (compare_testvector(ct[0], ptlens[i], ct[1], ptlens[i], "CCM memory CT", y) ||
+             compare_testvector(tag, taglen, tag2, n, "CCM memory Tag", y)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            break;
+         }
+
+         if ((err = ccm_memory(idx, tests[0].key, 16, NULL, hdr + 100, noncelens[k], hdr, hdrlens[j],
+                               ct[1], ptlens[i], ct[0], tag, &taglen, CCM_DECRYPT)) != CRYPT_OK) {
+            break;
+         }
+         if (compare_testvector(ct[1], ptlens[i], pt, ptlens[i], "CCM memory PT", y)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            break;
+         }
+         tag[y % taglen] ^= 1;
+         if (ccm_memory(idx, tests[0].key, 16, NULL, hdr + 100, noncelens[k], hdr, hdrlens[j],
+                        ct[1], ptlens[i], ct[0], tag, &taglen, CCM_DECRYPT) != CRYPT_ERROR ||
+             compare_testvector(ct[1], MIN(ptlens[i], sizeof(zero)), zero, MIN(ptlens[i], sizeof(zero)), "CCM memory wrong tag", y)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+      }
+      }
+      XFREE(hdr);
+      if (err != CRYPT_OK) {
+         return err;
+      }
+   }
+
    /* wycheproof failing test - https://github.com/libtom/libtomcrypt/pull/452 */
    {
       unsigned char key[] = { 0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f };
@@ -16,7 +16,7 @@
 int chacha20poly1305_decrypt(chacha20poly1305_state *st, const unsigned char *in, unsigned long inlen, unsigned char *out)
 {
    unsigned char padzero[16] = { 0 };
-   unsigned long padlen;
+   unsigned long padlen, i, n;
    int err;
 
    LTC_ARGCHK(st != NULL);
@@ -28,9 +28,12 @@ int chacha20poly1305_decrypt(chacha20poly1305_state *st, const unsigned char *in
       }
       st->aadflg = 0; /* no more AAD */
    }
-   if (st->aadflg) st->aadflg = 0; /* no more AAD */
-   if ((err = poly1305_process(&st->poly, in, inlen)) != CRYPT_OK)         return err;
-   if ((err = chacha_crypt(&st->chacha, in, inlen, out)) != CRYPT_OK)      return err;
+   /* interleave both passes in chunks, so the data is still in the L1 cache when it's read again */
+   for (i = 0; i < inlen; i += n) {
+      n = MIN(inlen - i, CHACHA20POLY1305_CHUNK);
+      if ((err = poly1305_process(&st->poly, in + i, n)) != CRYPT_OK) return err;
+      if ((err = chacha_crypt(&st->chacha, in + i, n, out + i)) != CRYPT_OK) return err;
+   }
    st->ctlen += (ulong64)inlen;
    return CRYPT_OK;
 }
@@ -32,6 +32,7 @@ int chacha20poly1305_done(chacha20poly1305_state *st, unsigned char *tag, unsign
    }
    if ((err = poly1305_done(&st->poly, tag, taglen)) != CRYPT_OK)          return err;
    if ((err = chacha_done(&st->chacha)) != CRYPT_OK)                       return err;
+   zeromem(st->key, sizeof(st->key));
    return CRYPT_OK;
 }
 
@@ -16,12 +16,11 @@
 int chacha20poly1305_encrypt(chacha20poly1305_state *st, const unsigned char *in, unsigned long inlen, unsigned char *out)
 {
    unsigned char padzero[16] = { 0 };
-   unsigned long padlen;
+   unsigned long padlen, i, n;
    int err;
 
    LTC_ARGCHK(st != NULL);
 
-   if ((err = chacha_crypt(&st->chacha, in, inlen, out)) != CRYPT_OK)         return err;
    if (st->aadflg) {
       padlen = 16 - (unsigned long)(st->aadlen % 16);
       if (padlen < 16) {
@@ -29,7 +28,12 @@ int chacha20poly1305_encrypt(chacha20poly1305_state *st, const unsigned char *in
       }
       st->aadflg = 0; /* no more AAD */
    }
-   if ((err = poly1305_process(&st->poly, out, inlen)) != CRYPT_OK)           return err;
+   /* interleave both passes in chunks, so the ciphertext is still in the L1 cache when it's read again */
+   for (i = 0; i < inlen; i += n) {
+      n = MIN(inlen - i, CHACHA20POLY1305_CHUNK);
+      if ((err = chacha_crypt(&st->chacha, in + i, n, out + i)) != CRYPT_OK) return err;
+      if ((err = poly1305_process(&st->poly, out + i, n)) != CRYPT_OK) return err;
+   }
    st->ctlen += (ulong64)inlen;
    return CRYPT_OK;
 }
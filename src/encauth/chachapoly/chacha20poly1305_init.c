@@ -14,8 +14,13 @@
 */
 int chacha20poly1305_init(chacha20poly1305_state *st, const unsigned char *key, unsigned long keylen)
 {
+   int err;
+
    XMEMSET(st, 0, sizeof(*st));
-   return chacha_setup(&st->chacha, key, keylen, 20);
+   if ((err = chacha_setup(&st->chacha, key, keylen, 20)) != CRYPT_OK) return err;
+   XMEMCPY(st->key, key, keylen);
+   st->keylen = keylen;
+   return CRYPT_OK;
 }
 
 #endif
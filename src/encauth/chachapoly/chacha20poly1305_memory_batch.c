@@ -0,0 +1,214 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_CHACHA20POLY1305_MODE
+
+static int s_chacha20poly1305_batch_check(const ltc_aead_packet *p, int direction)
+{
+   if (p->nonce == NULL || p->in == NULL || p->out == NULL || p->tag == NULL) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (p->aadlen > 0 && p->aad == NULL) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (p->noncelen != 12 && p->noncelen != 8 && p->noncelen != 24) {
+      return CRYPT_INVALID_ARG;
+   }
+   /* poly1305_done() needs room for the full tag */
+   if (direction == CHACHA20POLY1305_ENCRYPT && p->taglen < 16) {
+      return CRYPT_INVALID_ARG;
+   }
+   return CRYPT_OK;
+}
+
+#ifdef LTC_CHACHA_SIMD
+/* en-/decrypt a packet with its keystream, which starts with block 0, and create resp. verify the tag */
+static int s_chacha20poly1305_batch_finish(ltc_aead_packet *p, const unsigned char *ks, int direction)
+{
+   poly1305_state poly;
+   unsigned char padzero[16] = { 0 };
+   unsigned char buf[16];
+   unsigned long x, buflen;
+   int err;
+
+   /* the poly1305 key is the first half of block 0 */
+   if ((err = poly1305_init(&poly, ks, 32)) != CRYPT_OK)                          goto LBL_ERR;
+   if (p->aadlen > 0) {
+      if ((err = poly1305_process(&poly, p->aad, p->aadlen)) != CRYPT_OK)         goto LBL_ERR;
+      if (p->aadlen % 16) {
+         if ((err = poly1305_process(&poly, padzero, 16 - p->aadlen % 16)) != CRYPT_OK) goto LBL_ERR;
+      }
+   }
+   if (direction == CHACHA20POLY1305_DECRYPT) {
+      if ((err = poly1305_process(&poly, p->in, p->inlen)) != CRYPT_OK)           goto LBL_ERR;
+   }
+   for (x = 0; x < p->inlen; x++) {
+       p->out[x] = p->in[x] ^ ks[64 + x];
+   }
+   if (direction == CHACHA20POLY1305_ENCRYPT) {
+      if ((err = poly1305_process(&poly, p->out, p->inlen)) != CRYPT_OK)          goto LBL_ERR;
+   }
+   if (p->inlen % 16) {
+      if ((err = poly1305_process(&poly, padzero, 16 - p->inlen % 16)) != CRYPT_OK) goto LBL_ERR;
+   }
+   STORE64L((ulong64)p->aadlen, buf);
+   STORE64L((ulong64)p->inlen, buf + 8);
+   if ((err = poly1305_process(&poly, buf, 16)) != CRYPT_OK)                      goto LBL_ERR;
+
+   if (direction == CHACHA20POLY1305_ENCRYPT) {
+      err = poly1305_done(&poly, p->tag, &p->taglen);
+   } else {
+      buflen = sizeof(buf);
+      if ((err = poly1305_done(&poly, buf, &buflen)) != CRYPT_OK)                 goto LBL_ERR;
+      if (buflen != p->taglen || XMEM_NEQ(buf, p->tag, buflen) != 0) {
+         err = CRYPT_ERROR;
+      }
+   }
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(&poly, sizeof(poly));
+   zeromem(buf, sizeof(buf));
+#endif
+   return err;
+}
+#endif
+
+/**
+  Process many independent ChaCha20-Poly1305 packets with the same key in one call.
+
+  With LTC_CHACHA_SIMD the keystream blocks of as many packets as fit into a
+  buffer of CHACHA20POLY1305_BATCH_BLOCKS blocks are computed together, i.e.
+  the SIMD lanes work on different packets, then every packet is en- resp.
+  decrypted and authenticated on its own.  Larger packets, 24 byte IVs (XChaCha20-Poly1305)
+  and CHACHA20POLY1305_OPENSSH_COMPAT are processed with chacha20poly1305_memory().
+
+  Every packet gets its own result in `err`, a decrypted packet whose tag
+  doesn't match gets CRYPT_ERROR (its plaintext must not be used).
+  @param key               The secret key
+  @param keylen            The length of the secret key
+  @param pkt               The packets
+  @param npkt              The number of packets
+  @param direction         Encrypt or Decrypt mode (CHACHA20POLY1305_ENCRYPT or CHACHA20POLY1305_DECRYPT)
+  @return CRYPT_OK if all packets were processed successfully, otherwise the error of the first packet which failed
+ */
+int chacha20poly1305_memory_batch(const unsigned char *key, unsigned long keylen,
+                                  ltc_aead_packet *pkt,     unsigned long npkt,
+                                  int direction)
+{
+   ltc_aead_packet *p;
+   unsigned long i;
+   int err = CRYPT_OK, dir;
+#ifdef LTC_CHACHA_SIMD
+   chacha_state   st;
+   int            simd = 0;
+   unsigned char *ks = NULL;
+   ulong32       *words = NULL;
+   unsigned long  j, n, first, need;
+#endif
+
+   LTC_ARGCHK(key != NULL);
+   LTC_ARGCHK(pkt != NULL);
+
+   dir = direction & ~(CHACHA20POLY1305_OPENSSH_COMPAT);
+   if (dir != CHACHA20POLY1305_ENCRYPT && dir != CHACHA20POLY1305_DECRYPT) {
+      return CRYPT_INVALID_ARG;
+   }
+
+#ifdef LTC_CHACHA_SIMD
+   if (dir == direction && chacha_simd_is_supported()) {
+      if ((err = chacha_setup(&st, key, keylen, 20)) != CRYPT_OK) {
+         return err;
+      }
+      simd  = 1;
+      ks    = XMALLOC(CHACHA20POLY1305_BATCH_BLOCKS * 64);
+      words = XMALLOC(CHACHA20POLY1305_BATCH_BLOCKS * 4 * sizeof(ulong32));
+      if (ks == NULL || words == NULL) {
+         err = CRYPT_MEM;
+         goto LBL_ERR;
+      }
+   }
+#endif
+
+   for (i = 0; i < npkt; ) {
+#ifdef LTC_CHACHA_SIMD
+      if (simd) {
+         /* collect the blocks of as many packets as fit into the buffer, the
+          * state words 12..15 are the block counter and the IV of the packet */
+         first = i;
+         for (n = 0; i < npkt; i++) {
+            p = &pkt[i];
+            need = p->noncelen == 24 ? CHACHA20POLY1305_BATCH_BLOCKS + 1 : 1 + (p->inlen + 63) / 64;
+            if (need > CHACHA20POLY1305_BATCH_BLOCKS - n) {
+               break;
+            }
+            if ((p->err = s_chacha20poly1305_batch_check(p, dir)) != CRYPT_OK) {
+               continue;
+            }
+            for (j = 0; j < need; j++) {
+               words[4 * (n + j)] = (ulong32)j;
+               if (p->noncelen == 12) {
+                  LOAD32L(words[4 * (n + j) + 1], p->nonce);
+               } else {
+                  words[4 * (n + j) + 1] = 0;
+               }
+               LOAD32L(words[4 * (n + j) + 2], p->nonce + p->noncelen - 8);
+               LOAD32L(words[4 * (n + j) + 3], p->nonce + p->noncelen - 4);
+            }
+            n += need;
+         }
+
+         if (n > 0) {
+            /* the SIMD kernels work on multiples of 4 blocks, the padding isn't used */
+            for (; n % 4; n++) {
+               XMEMSET(words + 4 * n, 0, 4 * sizeof(ulong32));
+            }
+            chacha_simd_keystream_lanes(st.input, st.rounds, words, ks, n);
+            for (n = 0; first < i; first++) {
+               p = &pkt[first];
+               if (p->err == CRYPT_OK) {
+                  p->err = s_chacha20poly1305_batch_finish(p, ks + 64 * n, dir);
+                  n += 1 + (p->inlen + 63) / 64;
+               }
+            }
+            continue;
+         }
+      }
+#endif
+      if (i < npkt) {
+         p = &pkt[i++];
+         if ((p->err = s_chacha20poly1305_batch_check(p, dir)) != CRYPT_OK) {
+            continue;
+         }
+         p->err = chacha20poly1305_memory(key, keylen, p->nonce, p->noncelen, p->aad, p->aadlen,
+                                          p->in, p->inlen, p->out, p->tag, &p->taglen, direction);
+      }
+   }
+
+   for (i = 0; i < npkt; i++) {
+      if (pkt[i].err != CRYPT_OK) {
+         err = pkt[i].err;
+         break;
+      }
+   }
+
+#ifdef LTC_CHACHA_SIMD
+LBL_ERR:
+   if (simd) {
+      chacha_done(&st);
+   }
+   if (ks != NULL) {
+#ifdef LTC_CLEAN_STACK
+      zeromem(ks, CHACHA20POLY1305_BATCH_BLOCKS * 64);
+#endif
+      XFREE(ks);
+   }
+   if (words != NULL) {
+      XFREE(words);
+   }
+#endif
+   return err;
+}
+
+#endif
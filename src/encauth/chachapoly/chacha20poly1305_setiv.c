@@ -9,7 +9,7 @@
   Set IV + counter data to the ChaCha20Poly1305 state and reset the context
   @param st     The ChaCha20Poly1305 state
   @param iv     The IV data to add
-  @param ivlen  The length of the IV (must be 12 or 8)
+  @param ivlen  The length of the IV (must be 12 or 8, or 24 for XChaCha20-Poly1305 with a 32 byte key)
   @return CRYPT_OK on success
  */
 int chacha20poly1305_setiv(chacha20poly1305_state *st, const unsigned char *iv, unsigned long ivlen)
@@ -20,32 +20,50 @@ int chacha20poly1305_setiv(chacha20poly1305_state *st, const unsigned char *iv,
 
    LTC_ARGCHK(st != NULL);
    LTC_ARGCHK(iv != NULL);
-   LTC_ARGCHK(ivlen == 12 || ivlen == 8);
+   LTC_ARGCHK(ivlen == 12 || ivlen == 8 || ivlen == 24);
 
-   /* set IV for chacha20 */
-   if (ivlen == 12) {
-      /* IV 96bit */
-      if ((err = chacha_ivctr32(&st->chacha, iv, ivlen, 1)) != CRYPT_OK) return err;
+   if (ivlen == 24) {
+#ifdef LTC_XCHACHA20
+      /* XChaCha20: HChaCha20 subkey, the poly1305 key is the keystream of block 0 */
+      if (st->keylen != 32) return CRYPT_INVALID_KEYSIZE;
+      if ((err = xchacha20_setup(&st->chacha, st->key, st->keylen, iv, ivlen, 20)) != CRYPT_OK) return err;
+      if ((err = chacha_keystream(&st->chacha, polykey, 32)) != CRYPT_OK) return err;
+      /* continue with block 1 */
+      st->chacha.input[12] = 1;
+      st->chacha.ksleft = 0;
+#else
+      return CRYPT_INVALID_ARG;
+#endif
    }
    else {
-      /* IV 64bit */
-      if ((err = chacha_ivctr64(&st->chacha, iv, ivlen, 1)) != CRYPT_OK) return err;
-   }
+      /* (re)load the key, a previous 24 byte IV replaced it with the XChaCha20 subkey */
+      if ((err = chacha_setup(&st->chacha, st->key, st->keylen, 20)) != CRYPT_OK) return err;
 
-   /* copy chacha20 key to temporary state */
-   for(i = 0; i < 12; i++) tmp_st.input[i] = st->chacha.input[i];
-   tmp_st.rounds = 20;
-   /* set IV */
-   if (ivlen == 12) {
-      /* IV 32bit */
-      if ((err = chacha_ivctr32(&tmp_st, iv, ivlen, 0)) != CRYPT_OK) return err;
-   }
-   else {
-      /* IV 64bit */
-      if ((err = chacha_ivctr64(&tmp_st, iv, ivlen, 0)) != CRYPT_OK) return err;
+      /* set IV for chacha20 */
+      if (ivlen == 12) {
+         /* IV 96bit */
+         if ((err = chacha_ivctr32(&st->chacha, iv, ivlen, 1)) != CRYPT_OK) return err;
+      }
+      else {
+         /* IV 64bit */
+         if ((err = chacha_ivctr64(&st->chacha, iv, ivlen, 1)) != CRYPT_OK) return err;
+      }
+
+      /* copy chacha20 key to temporary state */
+      for(i = 0; i < 12; i++) tmp_st.input[i] = st->chacha.input[i];
+      tmp_st.rounds = 20;
+      /* set IV */
+      if (ivlen == 12) {
+         /* IV 32bit */
+         if ((err = chacha_ivctr32(&tmp_st, iv, ivlen, 0)) != CRYPT_OK) return err;
+      }
+      else {
+         /* IV 64bit */
+         if ((err = chacha_ivctr64(&tmp_st, iv, ivlen, 0)) != CRYPT_OK) return err;
+      }
+      /* (re)generate new poly1305 key */
+      if ((err = chacha_keystream(&tmp_st, polykey, 32)) != CRYPT_OK) return err;
    }
-   /* (re)generate new poly1305 key */
-   if ((err = chacha_keystream(&tmp_st, polykey, 32)) != CRYPT_OK) return err;
    /* (re)initialise poly1305 */
    if ((err = poly1305_init(&st->poly, polykey, 32)) != CRYPT_OK) return err;
    st->ctlen  = 0;
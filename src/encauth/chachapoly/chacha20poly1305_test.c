@@ -117,6 +117,168 @@ int chacha20poly1305_test(void)
    if (compare_testvector(pt, mlen, m, mlen, "DEC-PT4", 1) != 0) return CRYPT_FAIL_TESTVECTOR;
    if (compare_testvector(dmac, len, emac, len, "DEC-TAG4", 2) != 0) return CRYPT_FAIL_TESTVECTOR;
 
+#ifdef LTC_XCHACHA20
+   /* XChaCha20-Poly1305 - https://datatracker.ietf.org/doc/html/draft-irtf-cfrg-xchacha-03#appendix-A.3.1 */
+   {
+      unsigned char i24[]  = { 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f,
+                               0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57 };
+      unsigned char xenc[] = { 0xBD, 0x6D, 0x17, 0x9D, 0x3E, 0x83, 0xD4, 0x3B, 0x95, 0x76, 0x57, 0x94, 0x93, 0xC0, 0xE9, 0x39,
+                               0x57, 0x2A, 0x17, 0x00, 0x25, 0x2B, 0xFA, 0xCC, 0xBE, 0xD2, 0x90, 0x2C, 0x21, 0x39, 0x6C, 0xBB,
+                               0x73, 0x1C, 0x7F, 0x1B, 0x0B, 0x4A, 0xA6, 0x44, 0x0B, 0xF3, 0xA8, 0x2F, 0x4E, 0xDA, 0x7E, 0x39,
+                               0xAE, 0x64, 0xC6, 0x70, 0x8C, 0x54, 0xC2, 0x16, 0xCB, 0x96, 0xB7, 0x2E, 0x12, 0x13, 0xB4, 0x52,
+                               0x2F, 0x8C, 0x9B, 0xA4, 0x0D, 0xB5, 0xD9, 0x45, 0xB1, 0x1B, 0x69, 0xB9, 0x82, 0xC1, 0xBB, 0x9E,
+                               0x3F, 0x3F, 0xAC, 0x2B, 0xC3, 0x69, 0x48, 0x8F, 0x76, 0xB2, 0x38, 0x35, 0x65, 0xD3, 0xFF, 0xF9,
+                               0x21, 0xF9, 0x66, 0x4C, 0x97, 0x63, 0x7D, 0xA9, 0x76, 0x88, 0x12, 0xF6, 0x15, 0xC6, 0x8B, 0x13,
+                               0xB5, 0x2E };
+      unsigned char xtag[] = { 0xC0, 0x87, 0x59, 0x24, 0xC1, 0xC7, 0x98, 0x79, 0x47, 0xDE, 0xAF, 0xD8, 0x78, 0x0A, 0xCF, 0x49 };
+
+      if ((err = chacha20poly1305_init(&st1, k, sizeof(k))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_setiv(&st1, i24, sizeof(i24))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_add_aad(&st1, aad, sizeof(aad))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_encrypt(&st1, (unsigned char *)m,      33,        ct)) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_encrypt(&st1, (unsigned char *)m + 33, mlen - 33, ct + 33)) != CRYPT_OK) return err;
+      len = sizeof(emac);
+      if ((err = chacha20poly1305_done(&st1, emac, &len)) != CRYPT_OK) return err;
+      if (compare_testvector(ct, mlen, xenc, sizeof(xenc), "ENC-CT6", 1) != 0) return CRYPT_FAIL_TESTVECTOR;
+      if (compare_testvector(emac, len, xtag, sizeof(xtag), "ENC-TAG6", 2) != 0) return CRYPT_FAIL_TESTVECTOR;
+
+      len = sizeof(xtag);
+      if ((err = chacha20poly1305_memory(k, sizeof(k), i24, sizeof(i24), aad, sizeof(aad),
+                                         xenc, sizeof(xenc), pt, xtag, &len, CHACHA20POLY1305_DECRYPT)) != CRYPT_OK) return err;
+      if (compare_testvector(pt, mlen, m, mlen, "DEC-PT6", 3) != 0) return CRYPT_FAIL_TESTVECTOR;
+
+      /* a 12 byte IV after a 24 byte IV has to use the original key again */
+      if ((err = chacha20poly1305_init(&st1, k, sizeof(k))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_setiv(&st1, i24, sizeof(i24))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_setiv(&st1, i12, sizeof(i12))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_add_aad(&st1, aad, sizeof(aad))) != CRYPT_OK) return err;
+      if ((err = chacha20poly1305_encrypt(&st1, (unsigned char *)m, mlen, ct)) != CRYPT_OK) return err;
+      len = sizeof(emac);
+      if ((err = chacha20poly1305_done(&st1, emac, &len)) != CRYPT_OK) return err;
+      if (compare_testvector(ct, mlen, enc, sizeof(enc), "ENC-CT7", 1) != 0) return CRYPT_FAIL_TESTVECTOR;
+      if (compare_testvector(emac, len, tag, sizeof(tag), "ENC-TAG7", 2) != 0) return CRYPT_FAIL_TESTVECTOR;
+
+      /* XChaCha20 needs a 256 bit key */
+      if ((err = chacha20poly1305_init(&st1, k, 16)) != CRYPT_OK) return err;
+      if (chacha20poly1305_setiv(&st1, i24, sizeof(i24)) != CRYPT_INVALID_KEYSIZE) return CRYPT_FAIL_TESTVECTOR;
+      if ((err = chacha20poly1305_setiv(&st1, i12, sizeof(i12))) != CRYPT_OK) return err;
+      len = sizeof(emac);
+      if ((err = chacha20poly1305_done(&st1, emac, &len)) != CRYPT_OK) return err;
+   }
+#endif
+
+   /* long message, in place and over several chunks, in one go and piece by piece */
+   {
+      unsigned char long_tag[] = { 0xcb, 0x55, 0xbf, 0x32, 0xa0, 0x62, 0x6f, 0xe4, 0x9f, 0x59, 0x0d, 0xaa, 0x10, 0x44, 0xab, 0xa8 };
+      unsigned long buflen = 10000, x, n;
+      unsigned char *buf;
+
+      if ((buf = XMALLOC(buflen)) == NULL) return CRYPT_MEM;
+      for (x = 0; x < buflen; x++) {
+         buf[x] = (unsigned char)(x * 7 + 3);
+      }
+
+      len = sizeof(emac);
+      if ((err = chacha20poly1305_memory(k, sizeof(k), i12, sizeof(i12), aad, sizeof(aad), buf,
+                                         buflen, buf, emac, &len, CHACHA20POLY1305_ENCRYPT)) != CRYPT_OK) goto LBL_LONG;
+      if (compare_testvector(emac, len, long_tag, sizeof(long_tag), "ENC-TAG5", 1) != 0) err = CRYPT_FAIL_TESTVECTOR;
+
+      if (err == CRYPT_OK && (err = chacha20poly1305_init(&st2, k, sizeof(k))) == CRYPT_OK &&
+                             (err = chacha20poly1305_setiv(&st2, i12, sizeof(i12))) == CRYPT_OK) {
+         err = chacha20poly1305_add_aad(&st2, aad, sizeof(aad));
+      }
+      for (x = 0, n = 1; err == CRYPT_OK && x < buflen; x += n, n = n * 3 + 1000) {
+         n = MIN(n, buflen - x);
+         err = chacha20poly1305_decrypt(&st2, buf + x, n, buf + x);
+      }
+      if (err != CRYPT_OK) goto LBL_LONG;
+      len = sizeof(dmac);
+      if ((err = chacha20poly1305_done(&st2, dmac, &len)) != CRYPT_OK) goto LBL_LONG;
+      if (compare_testvector(dmac, len, long_tag, sizeof(long_tag), "DEC-TAG5", 2) != 0) err = CRYPT_FAIL_TESTVECTOR;
+      for (x = 0; x < buflen; x++) {
+         if (buf[x] != (unsigned char)(x * 7 + 3)) err = CRYPT_FAIL_TESTVECTOR;
+      }
+LBL_LONG:
+      XFREE(buf);
+      if (err != CRYPT_OK) return err;
+   }
+
+   /* chacha20poly1305_memory_batch() has to give the same results as chacha20poly1305_memory() for every packet */
+   {
+      static const unsigned long ptlens[] = { 0, 1, 15, 16, 63, 64, 100, 1500, 5000, 17 };
+      static const unsigned long ivlens[] = { 12, 12, 8, 12, 12, 12, 24, 12, 12, 12 };
+      ltc_aead_packet pkt[11];
+      unsigned char *buf, *bct, *dec, btag[11][16];
+      unsigned long i, off;
+      int xerr;
+
+      if ((buf = XMALLOC(3 * 7000)) == NULL) return CRYPT_MEM;
+      bct = buf + 7000;
+      dec = buf + 14000;
+      for (i = 0; i < 7000; i++) buf[i] = (unsigned char)(i * 11 + 5);
+      XMEMSET(pkt, 0, sizeof(pkt));
+      for (i = off = 0; i < 10; off += ptlens[i++]) {
+         pkt[i].nonce    = buf + 100 + i;
+         pkt[i].noncelen = ivlens[i];
+         pkt[i].aad      = buf + 200;
+         pkt[i].aadlen   = i * 13;
+         pkt[i].in       = buf + off;
+         pkt[i].inlen    = ptlens[i];
+         pkt[i].out      = bct + off;
+         pkt[i].tag      = btag[i];
+         pkt[i].taglen   = 16;
+      }
+      /* one packet in place and one with a missing nonce */
+      XMEMCPY(bct + 95, buf + 95, ptlens[5]);
+      pkt[5].in = bct + 95;
+      pkt[10] = pkt[0];
+      pkt[10].nonce = NULL;
+
+      err = chacha20poly1305_memory_batch(k, sizeof(k), pkt, 11, CHACHA20POLY1305_ENCRYPT);
+      if (err != CRYPT_INVALID_ARG || pkt[10].err != CRYPT_INVALID_ARG) {
+         err = CRYPT_FAIL_TESTVECTOR;
+         goto LBL_BATCH;
+      }
+      for (i = off = 0; i < 10; off += ptlens[i++]) {
+         len = sizeof(emac);
+         err = chacha20poly1305_memory(k, sizeof(k), pkt[i].nonce, pkt[i].noncelen, pkt[i].aad, pkt[i].aadlen,
+                                       buf + off, ptlens[i], dec + off, emac, &len, CHACHA20POLY1305_ENCRYPT);
+         /* without XChaCha20 the 24 byte IV fails in both */
+         if (err != pkt[i].err) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_BATCH;
+         }
+         if (err == CRYPT_OK &&
+             (compare_testvector(bct + off, ptlens[i], dec + off, ptlens[i], "BATCH-CT", i) != 0 ||
+              compare_testvector(btag[i], pkt[i].taglen, emac, len, "BATCH-TAG", i) != 0)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_BATCH;
+         }
+         pkt[i].in  = bct + off;
+         pkt[i].out = i == 5 ? bct + off : dec + off;
+      }
+
+      /* a corrupted tag only fails its own packet */
+      xerr = pkt[6].err;
+      btag[7][3] ^= 1;
+      err = chacha20poly1305_memory_batch(k, sizeof(k), pkt, 10, CHACHA20POLY1305_DECRYPT);
+      if (err != (xerr != CRYPT_OK ? xerr : CRYPT_ERROR)) {
+         err = CRYPT_FAIL_TESTVECTOR;
+         goto LBL_BATCH;
+      }
+      for (i = off = 0; i < 10; off += ptlens[i++]) {
+         if (pkt[i].err != (i == 7 ? CRYPT_ERROR : i == 6 ? xerr : CRYPT_OK) ||
+             (pkt[i].err == CRYPT_OK && compare_testvector(pkt[i].out, ptlens[i], buf + off, ptlens[i], "BATCH-PT", i) != 0)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_BATCH;
+         }
+      }
+      err = CRYPT_OK;
+LBL_BATCH:
+      XFREE(buf);
+      if (err != CRYPT_OK) return err;
+   }
+
    /* wycheproof failing test - https://github.com/libtom/libtomcrypt/pull/451 */
    {
       unsigned char key[] = { 0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,0x88,0x99,0xaa,0xbb,0xcc,0xdd,0xee,0xff,
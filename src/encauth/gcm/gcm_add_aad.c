@@ -19,6 +19,7 @@
 int gcm_add_aad(gcm_state *gcm,
                const unsigned char *adata,  unsigned long adatalen)
 {
+   const gcm_state *key;
    unsigned long x;
    int           err;
 #ifdef LTC_FAST
@@ -34,7 +35,8 @@ int gcm_add_aad(gcm_state *gcm,
       return CRYPT_INVALID_ARG;
    }
 
-   if ((err = cipher_is_valid(gcm->cipher)) != CRYPT_OK) {
+   key = gcm_key_state(gcm);
+   if ((err = cipher_is_valid(key->cipher)) != CRYPT_OK) {
       return err;
    }
 
@@ -82,6 +84,16 @@ int gcm_add_aad(gcm_state *gcm,
    }
 
    x = 0;
+#ifdef LTC_GCM_PCLMUL
+   if (key->pclmul && gcm->buflen == 0 && adatalen > 15) {
+      x = adatalen & ~15;
+      gcm_pclmul_ghash(gcm, adata, x / 16);
+      gcm->totlen += x * CONST64(8);
+      adata    += x;
+      adatalen -= x;
+      x = 0;
+   }
+#endif
 #ifdef LTC_FAST
    if (gcm->buflen == 0 && adatalen > 15) {
       for (x = 0; x < (adatalen & ~15); x += 16) {
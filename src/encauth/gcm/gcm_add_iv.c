@@ -19,6 +19,7 @@
 int gcm_add_iv(gcm_state *gcm,
                const unsigned char *IV,     unsigned long IVlen)
 {
+   const gcm_state *key;
    unsigned long x, y;
    int           err;
 
@@ -36,7 +37,8 @@ int gcm_add_iv(gcm_state *gcm,
       return CRYPT_INVALID_ARG;
    }
 
-   if ((err = cipher_is_valid(gcm->cipher)) != CRYPT_OK) {
+   key = gcm_key_state(gcm);
+   if ((err = cipher_is_valid(key->cipher)) != CRYPT_OK) {
       return err;
    }
 
@@ -11,6 +11,8 @@
 
 /**
   Terminate a GCM stream
+  A state which uses shared key tables always drops its reference to them, it
+  has to be initialized again with gcm_init_htable() before it can be reused.
   @param gcm     The GCM state
   @param tag     [out] The destination for the MAC tag
   @param taglen  [in/out]  The length of the MAC tag
@@ -19,6 +21,7 @@
 int gcm_done(gcm_state *gcm,
                      unsigned char *tag,    unsigned long *taglen)
 {
+   const gcm_state *key;
    unsigned long x;
    int err;
 
@@ -30,22 +33,24 @@ int gcm_done(gcm_state *gcm,
       return CRYPT_INVALID_ARG;
    }
 
-   if ((err = cipher_is_valid(gcm->cipher)) != CRYPT_OK) {
-      return err;
+   key = gcm_key_state(gcm);
+   if ((err = cipher_is_valid(key->cipher)) != CRYPT_OK) {
+      goto LBL_ERR;
    }
 
    if (gcm->mode == LTC_GCM_MODE_IV) {
       /* let's process the IV */
-      if ((err = gcm_add_aad(gcm, NULL, 0)) != CRYPT_OK) return err;
+      if ((err = gcm_add_aad(gcm, NULL, 0)) != CRYPT_OK) goto LBL_ERR;
    }
 
    if (gcm->mode == LTC_GCM_MODE_AAD) {
       /* let's process the AAD */
-      if ((err = gcm_process(gcm, NULL, 0, NULL, 0)) != CRYPT_OK) return err;
+      if ((err = gcm_process(gcm, NULL, 0, NULL, 0)) != CRYPT_OK) goto LBL_ERR;
    }
 
    if (gcm->mode != LTC_GCM_MODE_TEXT) {
-      return CRYPT_INVALID_ARG;
+      err = CRYPT_INVALID_ARG;
+      goto LBL_ERR;
    }
 
    /* handle remaining ciphertext */
@@ -63,17 +68,27 @@ int gcm_done(gcm_state *gcm,
    gcm_mult_h(gcm, gcm->X);
 
    /* encrypt original counter */
-   if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y_0, gcm->buf, &gcm->K)) != CRYPT_OK) {
-      return err;
+   if ((err = cipher_descriptor[key->cipher].ecb_encrypt(gcm->Y_0, gcm->buf, &key->K)) != CRYPT_OK) {
+      goto LBL_ERR;
    }
    for (x = 0; x < 16 && x < *taglen; x++) {
        tag[x] = gcm->buf[x] ^ gcm->X[x];
    }
    *taglen = x;
 
-   cipher_descriptor[gcm->cipher].done(&gcm->K);
+   if (gcm->ht == NULL) {
+      cipher_descriptor[gcm->cipher].done(&gcm->K);
+   }
 
-   return CRYPT_OK;
+LBL_ERR:
+   /* a state with shared key tables always drops its reference */
+   if (gcm->ht != NULL) {
+      gcm_htable_free(gcm->ht);
+      gcm->ht = NULL;
+      /* from now on the state fails the `buflen` check of every function */
+      gcm->buflen = -1;
+   }
+   return err;
 }
 
 #endif
@@ -0,0 +1,117 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file gcm_htable.c
+   GCM implementation, key tables shared by many states
+*/
+#include "tomcrypt_private.h"
+
+#ifdef LTC_GCM_MODE
+
+/**
+  Create a set of GCM key tables which can be shared by many GCM states
+  @param ht      [out] The new key tables, with a reference count of one
+  @param cipher  The index of the cipher to use
+  @param key     The secret key
+  @param keylen  The length of the secret key
+  @return CRYPT_OK on success
+ */
+int gcm_htable_new(gcm_htable **ht, int cipher,
+                   const unsigned char *key, int keylen)
+{
+   gcm_htable *t;
+   int         err;
+
+   LTC_ARGCHK(ht  != NULL);
+   LTC_ARGCHK(key != NULL);
+
+   t = XMALLOC(sizeof(*t));
+   if (t == NULL) {
+      return CRYPT_MEM;
+   }
+
+   if ((err = gcm_init(&t->gcm, cipher, key, keylen)) != CRYPT_OK) {
+      zeromem(t, sizeof(*t));
+      XFREE(t);
+      return err;
+   }
+   t->refs = 1;
+   LTC_MUTEX_INIT(&t->lock)
+
+   *ht = t;
+   return CRYPT_OK;
+}
+
+/**
+  Take another reference to a set of GCM key tables
+  @param ht    The key tables
+  @return CRYPT_OK on success
+ */
+int gcm_htable_ref(gcm_htable *ht)
+{
+   int err = CRYPT_OK;
+
+   LTC_ARGCHK(ht != NULL);
+
+   LTC_MUTEX_LOCK(&ht->lock);
+   if (ht->refs == 0xFFFFFFFFuL) {
+      err = CRYPT_ERROR;
+   } else {
+      ht->refs++;
+   }
+   LTC_MUTEX_UNLOCK(&ht->lock);
+
+   return err;
+}
+
+/**
+  Drop a reference to a set of GCM key tables, the last one frees them
+  @param ht    The key tables
+ */
+void gcm_htable_free(gcm_htable *ht)
+{
+   ulong32 refs;
+
+   if (ht == NULL) {
+      return;
+   }
+
+   LTC_MUTEX_LOCK(&ht->lock);
+   refs = --ht->refs;
+   LTC_MUTEX_UNLOCK(&ht->lock);
+
+   if (refs == 0) {
+      cipher_descriptor[ht->gcm.cipher].done(&ht->gcm.K);
+      LTC_MUTEX_DESTROY(&ht->lock);
+      zeromem(ht, sizeof(*ht));
+      XFREE(ht);
+   }
+}
+
+/**
+  Initialize a GCM state which uses shared key tables
+  The state takes a reference to the tables, which is dropped again by
+  gcm_done().  It reads the key and the tables from `ht` and doesn't
+  touch its own, so it can be allocated with GCM_SHARED_STATE_SIZE bytes.
+  @param gcm   The GCM state to initialize
+  @param ht    The key tables
+  @return CRYPT_OK on success
+ */
+int gcm_init_htable(gcm_state *gcm, gcm_htable *ht)
+{
+   int err;
+
+   LTC_ARGCHK(gcm != NULL);
+   LTC_ARGCHK(ht  != NULL);
+
+   if ((err = gcm_htable_ref(ht)) != CRYPT_OK) {
+      return err;
+   }
+   gcm->ht     = ht;
+   gcm->buflen = 0;
+
+   return gcm_reset(gcm);
+}
+
+#endif
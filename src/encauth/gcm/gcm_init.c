@@ -25,6 +25,10 @@ int gcm_init(gcm_state *gcm, int cipher,
 #ifdef LTC_GCM_TABLES
    int           x, y, z, t;
 #endif
+#ifdef LTC_GCM_TABLES_4BIT
+   int           x, y;
+   ulong64       V[2], R;
+#endif
 
    LTC_ARGCHK(gcm != NULL);
    LTC_ARGCHK(key != NULL);
@@ -63,6 +67,16 @@ int gcm_init(gcm_state *gcm, int cipher,
    gcm->buflen   = 0;
    gcm->totlen   = 0;
    gcm->pttotlen = 0;
+   gcm->ht       = NULL;
+
+#ifdef LTC_GCM_PCLMUL
+   gcm->pclmul   = gcm_pclmul_is_supported();
+   if (gcm->pclmul) {
+      gcm_pclmul_init(gcm);
+      /* the tables aren't required with the carry-less multiplication */
+      return CRYPT_OK;
+   }
+#endif
 
 #ifdef LTC_GCM_TABLES
    /* setup tables */
@@ -89,6 +103,28 @@ int gcm_init(gcm_state *gcm, int cipher,
 
 #endif
 
+#ifdef LTC_GCM_TABLES_4BIT
+   /* M[8] = H, M[4] = H*x, M[2] = H*x^2 and M[1] = H*x^3 */
+   LOAD64H(V[0], gcm->H);
+   LOAD64H(V[1], gcm->H + 8);
+   gcm->M[0][0] = gcm->M[0][1] = 0;
+   for (x = 8; x > 0; x >>= 1) {
+      gcm->M[x][0] = V[0];
+      gcm->M[x][1] = V[1];
+      R    = CONST64(0xE100000000000000) & (0 - (V[1] & 1));
+      V[1] = (V[0] << 63) | (V[1] >> 1);
+      V[0] = (V[0] >> 1) ^ R;
+   }
+
+   /* the other entries are sums of those */
+   for (x = 2; x < 16; x <<= 1) {
+      for (y = 1; y < x; y++) {
+         gcm->M[x + y][0] = gcm->M[x][0] ^ gcm->M[y][0];
+         gcm->M[x + y][1] = gcm->M[x][1] ^ gcm->M[y][1];
+      }
+   }
+#endif
+
    return CRYPT_OK;
 }
 
@@ -0,0 +1,323 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file gcm_memory_batch.c
+   GCM implementation, process many packets with the same key
+*/
+#include "tomcrypt_private.h"
+
+#ifdef LTC_GCM_MODE
+
+/* X = (X ^ in) * H over the complete blocks and the zero padded rest of in */
+static void s_gcm_batch_ghash(gcm_state *gcm, const unsigned char *in, unsigned long inlen)
+{
+   unsigned long x, y, n;
+
+#ifdef LTC_GCM_PCLMUL
+   if (gcm->pclmul && inlen > 15) {
+      n = inlen & ~15uL;
+      gcm_pclmul_ghash(gcm, in, n / 16);
+      in    += n;
+      inlen -= n;
+   }
+#endif
+   for (x = 0; x < inlen; x += n) {
+      n = MIN(inlen - x, 16);
+      for (y = 0; y < n; y++) {
+         gcm->X[y] ^= in[x + y];
+      }
+      gcm_mult_h(gcm, gcm->X);
+   }
+}
+
+static int s_gcm_batch_check(const ltc_aead_packet *p)
+{
+   if (p->nonce == NULL || p->noncelen == 0 || p->tag == NULL) {
+      return CRYPT_INVALID_ARG;
+   }
+   if ((p->aadlen > 0 && p->aad == NULL) || (p->inlen > 0 && (p->in == NULL || p->out == NULL))) {
+      return CRYPT_INVALID_ARG;
+   }
+   /* 0xFFFFFFFE0 = ((2^39)-256)/8 */
+   if ((ulong64)p->inlen >= CONST64(0xFFFFFFFE0)) {
+      return CRYPT_INVALID_ARG;
+   }
+   return CRYPT_OK;
+}
+
+/* process a packet with the one-pass implementation of the cipher, which only reads from the input */
+static int s_gcm_batch_accel(int cipher, const unsigned char *key, unsigned long keylen,
+                             ltc_aead_packet *p, int direction)
+{
+   if (direction == GCM_ENCRYPT) {
+      return cipher_descriptor[cipher].accel_gcm_memory(key, keylen, p->nonce, p->noncelen, p->aad, p->aadlen,
+                                                        (unsigned char *)p->in, p->inlen, p->out,
+                                                        p->tag, &p->taglen, direction);
+   }
+   return cipher_descriptor[cipher].accel_gcm_memory(key, keylen, p->nonce, p->noncelen, p->aad, p->aadlen,
+                                                     p->out, p->inlen, (unsigned char *)p->in,
+                                                     p->tag, &p->taglen, direction);
+}
+
+/* process a packet which doesn't fit into the buffer with the already initialized state */
+static int s_gcm_batch_stream(gcm_state *gcm, ltc_aead_packet *p, int direction)
+{
+   unsigned char T[16];
+   unsigned long Tlen = sizeof(T);
+   int err;
+
+   if ((err = gcm_reset(gcm)) != CRYPT_OK)                                            goto LBL_ERR;
+   if ((err = gcm_add_iv(gcm, p->nonce, p->noncelen)) != CRYPT_OK)                    goto LBL_ERR;
+   if ((err = gcm_add_aad(gcm, p->aad, p->aadlen)) != CRYPT_OK)                       goto LBL_ERR;
+   if (direction == GCM_ENCRYPT) {
+      if ((err = gcm_process(gcm, (unsigned char *)p->in, p->inlen, p->out, direction)) != CRYPT_OK) goto LBL_ERR;
+      err = gcm_done(gcm, p->tag, &p->taglen);
+   } else {
+      if ((err = gcm_process(gcm, p->out, p->inlen, (unsigned char *)p->in, direction)) != CRYPT_OK)  goto LBL_ERR;
+      if ((err = gcm_done(gcm, T, &Tlen)) != CRYPT_OK)                                goto LBL_ERR;
+      if (p->taglen != 16 || XMEM_NEQ(T, p->tag, 16) != 0) {
+         err = CRYPT_ERROR;
+      }
+   }
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(T, sizeof(T));
+#endif
+   return err;
+}
+
+/* compute the initial counter J0 of a packet */
+static void s_gcm_batch_j0(gcm_state *gcm, const ltc_aead_packet *p, unsigned char *J0)
+{
+   unsigned char buf[16];
+   int x;
+
+   if (p->noncelen == 12) {
+      XMEMCPY(J0, p->nonce, 12);
+      J0[12] = 0;
+      J0[13] = 0;
+      J0[14] = 0;
+      J0[15] = 1;
+   } else {
+      /* J0 = GHASH(IV || pad || 0^64 || len(IV)) */
+      zeromem(gcm->X, 16);
+      s_gcm_batch_ghash(gcm, p->nonce, p->noncelen);
+      zeromem(buf, 8);
+      STORE64H((ulong64)p->noncelen * CONST64(8), buf + 8);
+      for (x = 0; x < 16; x++) {
+          gcm->X[x] ^= buf[x];
+      }
+      gcm_mult_h(gcm, gcm->X);
+      XMEMCPY(J0, gcm->X, 16);
+   }
+}
+
+/* en-/decrypt a packet with its keystream, which starts with E(J0), and create resp. verify the tag */
+static int s_gcm_batch_finish(gcm_state *gcm, ltc_aead_packet *p, const unsigned char *ks, int direction)
+{
+   unsigned char T[16];
+   unsigned long x;
+   int err = CRYPT_OK;
+
+   zeromem(gcm->X, 16);
+   s_gcm_batch_ghash(gcm, p->aad, p->aadlen);
+   if (direction == GCM_DECRYPT) {
+      s_gcm_batch_ghash(gcm, p->in, p->inlen);
+   }
+   x = 0;
+#ifdef LTC_FAST
+   for (; x + sizeof(LTC_FAST_TYPE) <= p->inlen; x += sizeof(LTC_FAST_TYPE)) {
+       *(LTC_FAST_TYPE_PTR_CAST(&p->out[x])) = *(LTC_FAST_TYPE_PTR_CAST(&p->in[x])) ^ *(LTC_FAST_TYPE_PTR_CAST(&ks[16 + x]));
+   }
+#endif
+   for (; x < p->inlen; x++) {
+       p->out[x] = p->in[x] ^ ks[16 + x];
+   }
+   if (direction == GCM_ENCRYPT) {
+      s_gcm_batch_ghash(gcm, p->out, p->inlen);
+   }
+
+   /* length */
+   STORE64H((ulong64)p->aadlen * CONST64(8), T);
+   STORE64H((ulong64)p->inlen * CONST64(8), T + 8);
+   for (x = 0; x < 16; x++) {
+       gcm->X[x] ^= T[x];
+   }
+   gcm_mult_h(gcm, gcm->X);
+
+   for (x = 0; x < 16; x++) {
+       T[x] = ks[x] ^ gcm->X[x];
+   }
+   if (direction == GCM_ENCRYPT) {
+      for (x = 0; x < 16 && x < p->taglen; x++) {
+          p->tag[x] = T[x];
+      }
+      p->taglen = x;
+   } else if (p->taglen != 16 || XMEM_NEQ(T, p->tag, 16) != 0) {
+      err = CRYPT_ERROR;
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(T, sizeof(T));
+#endif
+   return err;
+}
+
+/**
+  Process many independent GCM packets with the same key in one call.
+
+  Packets of at least GCM_BATCH_STITCH_MIN bytes are given to the one-pass
+  implementation of the cipher (accel_gcm_memory) if it has one.  For the
+  smaller packets the counter blocks of as many packets as fit into a buffer
+  of GCM_BATCH_BLOCKS blocks are encrypted together, so the multi-block ECB
+  accelerator of the cipher can work on several packets at once, then every
+  packet is en- resp. decrypted and authenticated on its own.  Packets which
+  don't fit into the buffer are processed with the same key setup one by one.
+
+  Every packet gets its own result in `err`, a decrypted packet whose tag
+  doesn't match gets CRYPT_ERROR (its plaintext must not be used).
+  @param cipher            Index of cipher to use
+  @param key               The secret key
+  @param keylen            The length of the secret key
+  @param pkt               The packets
+  @param npkt              The number of packets
+  @param direction         Encrypt or Decrypt mode (GCM_ENCRYPT or GCM_DECRYPT)
+  @return CRYPT_OK if all packets were processed successfully, otherwise the error of the first packet which failed
+ */
+int gcm_memory_batch(int cipher,
+                     const unsigned char *key, unsigned long keylen,
+                     ltc_aead_packet *pkt,     unsigned long npkt,
+                     int direction)
+{
+   void          *orig;
+   gcm_state     *gcm;
+   unsigned char *ks;
+   unsigned long  i, j, n, first, need;
+   ltc_aead_packet *p;
+   int            y, err, stitch;
+
+   LTC_ARGCHK(key != NULL);
+   LTC_ARGCHK(pkt != NULL);
+
+   if (direction != GCM_ENCRYPT && direction != GCM_DECRYPT) {
+      return CRYPT_INVALID_ARG;
+   }
+   if ((err = cipher_is_valid(cipher)) != CRYPT_OK) {
+      return err;
+   }
+
+#ifndef LTC_GCM_TABLES_SSE2
+   orig = gcm = XMALLOC(sizeof(*gcm));
+#else
+   orig = gcm = XMALLOC(sizeof(*gcm) + 16);
+#endif
+   ks = XMALLOC(GCM_BATCH_BLOCKS * 16);
+   if (gcm == NULL || ks == NULL) {
+      if (orig != NULL) {
+         XFREE(orig);
+      }
+      if (ks != NULL) {
+         XFREE(ks);
+      }
+      return CRYPT_MEM;
+   }
+#ifdef LTC_GCM_TABLES_SSE2
+   gcm = LTC_ALIGN_BUF(gcm, 16);
+#endif
+
+   if ((err = gcm_init(gcm, cipher, key, keylen)) != CRYPT_OK) {
+      goto LTC_ERR_FREE;
+   }
+
+   /* packets which are large enough for the one-pass implementation of the
+    * cipher are handed to it, only the small ones share the ECB calls */
+   stitch = cipher_descriptor[cipher].accel_gcm_memory != NULL;
+
+   for (i = 0; i < npkt; ) {
+      /* collect the counter blocks of as many packets as fit into the buffer */
+      first = i;
+      for (n = 0; i < npkt; i++) {
+         p = &pkt[i];
+         need = 1 + (p->inlen + 15) / 16;
+         if (need > GCM_BATCH_BLOCKS - n || (stitch && p->inlen >= GCM_BATCH_STITCH_MIN)) {
+            break;
+         }
+         if ((p->err = s_gcm_batch_check(p)) != CRYPT_OK) {
+            continue;
+         }
+         s_gcm_batch_j0(gcm, p, ks + 16 * n);
+         for (j = n + 1; j < n + need; j++) {
+            XMEMCPY(ks + 16 * j, ks + 16 * (j - 1), 16);
+            for (y = 15; y >= 12; y--) {
+                if (++ks[16 * j + y] & 255) { break; }
+            }
+         }
+         n += need;
+      }
+
+      if (n > 0) {
+         if (cipher_descriptor[cipher].accel_ecb_encrypt != NULL) {
+            err = cipher_descriptor[cipher].accel_ecb_encrypt(ks, ks, n, &gcm->K);
+         } else {
+            for (j = 0; j < n && err == CRYPT_OK; j++) {
+               err = cipher_descriptor[cipher].ecb_encrypt(ks + 16 * j, ks + 16 * j, &gcm->K);
+            }
+         }
+         if (err != CRYPT_OK) {
+            for (; first < i; first++) {
+               if (pkt[first].err == CRYPT_OK) {
+                  pkt[first].err = err;
+               }
+            }
+            goto LTC_ERR;
+         }
+         for (n = 0; first < i; first++) {
+            p = &pkt[first];
+            if (p->err == CRYPT_OK) {
+               p->err = s_gcm_batch_finish(gcm, p, ks + 16 * n, direction);
+               n += 1 + (p->inlen + 15) / 16;
+            }
+         }
+      } else if (i < npkt) {
+         /* a large packet */
+         p = &pkt[i++];
+         if ((p->err = s_gcm_batch_check(p)) != CRYPT_OK) {
+            continue;
+         }
+         if (stitch) {
+            p->err = s_gcm_batch_accel(cipher, key, keylen, p, direction);
+            if (p->err != CRYPT_NOP) {
+               continue;
+            }
+            /* CRYPT_NOP means the accelerator can't be used, e.g. due to missing CPU support */
+            stitch = 0;
+            if (1 + (p->inlen + 15) / 16 <= GCM_BATCH_BLOCKS) {
+               i--;
+               continue;
+            }
+         }
+         p->err = s_gcm_batch_stream(gcm, p, direction);
+      }
+   }
+
+   for (i = 0; i < npkt; i++) {
+      if (pkt[i].err != CRYPT_OK) {
+         err = pkt[i].err;
+         break;
+      }
+   }
+
+LTC_ERR:
+   cipher_descriptor[cipher].done(&gcm->K);
+   gcm_reset(gcm);
+LTC_ERR_FREE:
+#ifdef LTC_CLEAN_STACK
+   zeromem(ks, GCM_BATCH_BLOCKS * 16);
+#endif
+   XFREE(ks);
+   XFREE(orig);
+   return err;
+}
+
+#endif
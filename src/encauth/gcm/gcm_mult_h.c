@@ -8,6 +8,17 @@
 #include "tomcrypt_private.h"
 
 #if defined(LTC_GCM_MODE)
+
+#ifdef LTC_GCM_TABLES_4BIT
+/* reduction of the 4 bits which are shifted out of the product */
+static const ulong64 gcm_rem_4bit[16] = {
+   CONST64(0x0000000000000000), CONST64(0x1C20000000000000), CONST64(0x3840000000000000), CONST64(0x2460000000000000),
+   CONST64(0x7080000000000000), CONST64(0x6CA0000000000000), CONST64(0x48C0000000000000), CONST64(0x54E0000000000000),
+   CONST64(0xE100000000000000), CONST64(0xFD20000000000000), CONST64(0xD940000000000000), CONST64(0xC560000000000000),
+   CONST64(0x9180000000000000), CONST64(0x8DA0000000000000), CONST64(0xA9C0000000000000), CONST64(0xB5E0000000000000)
+};
+#endif
+
 /**
   GCM multiply by H
   @param gcm   The GCM state which holds the H value
@@ -16,31 +27,61 @@
 void gcm_mult_h(const gcm_state *gcm, unsigned char *I)
 {
    unsigned char T[16];
-#ifdef LTC_GCM_TABLES
+   /* the key tables are either in the state itself or shared */
+   const gcm_state *tab = gcm_key_state(gcm);
+#if defined(LTC_GCM_TABLES) || defined(LTC_GCM_TABLES_4BIT)
    int x;
+#endif
+#ifdef LTC_GCM_TABLES_4BIT
+   ulong64 Z[2], r;
+#endif
+#if defined(LTC_GCM_TABLES_4BIT) || (defined(LTC_GCM_TABLES) && !defined(LTC_GCM_TABLES_SSE2))
+   int y;
+#endif
+#ifdef LTC_GCM_PCLMUL
+   if (tab->pclmul) {
+      gcm_pclmul_mult_h(gcm, I);
+      return;
+   }
+#endif
+#ifdef LTC_GCM_TABLES
 #ifdef LTC_GCM_TABLES_SSE2
-   __asm__("movdqa (%0),%%xmm0"::"r"(&gcm->PC[0][I[0]][0]));
+   __asm__("movdqa (%0),%%xmm0"::"r"(&tab->PC[0][I[0]][0]));
    for (x = 1; x < 16; x++) {
-      __asm__("pxor (%0),%%xmm0"::"r"(&gcm->PC[x][I[x]][0]));
+      __asm__("pxor (%0),%%xmm0"::"r"(&tab->PC[x][I[x]][0]));
    }
-   __asm__("movdqa %%xmm0,(%0)"::"r"(&T));
+   __asm__("movdqa %%xmm0,(%0)"::"r"(&T):"memory");
 #else
-   int y;
-   XMEMCPY(T, &gcm->PC[0][I[0]][0], 16);
+   XMEMCPY(T, &tab->PC[0][I[0]][0], 16);
    for (x = 1; x < 16; x++) {
 #ifdef LTC_FAST
        for (y = 0; y < 16; y += sizeof(LTC_FAST_TYPE)) {
-           *(LTC_FAST_TYPE_PTR_CAST(T + y)) ^= *(LTC_FAST_TYPE_PTR_CAST(&gcm->PC[x][I[x]][y]));
+           *(LTC_FAST_TYPE_PTR_CAST(T + y)) ^= *(LTC_FAST_TYPE_PTR_CAST(&tab->PC[x][I[x]][y]));
        }
 #else
        for (y = 0; y < 16; y++) {
-           T[y] ^= gcm->PC[x][I[x]][y];
+           T[y] ^= tab->PC[x][I[x]][y];
        }
 #endif /* LTC_FAST */
    }
 #endif /* LTC_GCM_TABLES_SSE2 */
+#elif defined(LTC_GCM_TABLES_4BIT)
+   /* Horner's rule over the nibbles, starting with the last one */
+   Z[0] = Z[1] = 0;
+   for (x = 15; x >= 0; x--) {
+      for (y = 0; y < 8; y += 4) {
+         /* Z = Z * x^4 + M[nibble] */
+         r    = Z[1] & 15;
+         Z[1] = (Z[0] << 60) | (Z[1] >> 4);
+         Z[0] = (Z[0] >> 4) ^ gcm_rem_4bit[r];
+         Z[0] ^= tab->M[(I[x] >> y) & 15][0];
+         Z[1] ^= tab->M[(I[x] >> y) & 15][1];
+      }
+   }
+   STORE64H(Z[0], T);
+   STORE64H(Z[1], T + 8);
 #else
-   gcm_gf_mult(gcm->H, I, T);
+   gcm_gf_mult(tab->H, I, T);
 #endif
    XMEMCPY(I, T, 16);
 }
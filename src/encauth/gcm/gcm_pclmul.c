@@ -0,0 +1,200 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file gcm_pclmul.c
+   GCM implementation, GHASH with the carry-less multiplication (PCLMULQDQ)
+
+   The multiplication follows the Intel white paper "Intel Carry-Less
+   Multiplication Instruction and its Usage for Computing the GCM Mode" by
+   Shay Gueron and Michael E. Kounavis.  The blocks are byte-reflected, the
+   256 bit product is shifted left by one bit and reduced modulo
+   x^128 + x^7 + x^2 + x + 1.  Since the shift and the reduction are linear,
+   eight products X_i * H^(8-i) are summed up before they're reduced once.
+*/
+#include "tomcrypt_private.h"
+
+#if defined(LTC_GCM_MODE) && defined(LTC_GCM_PCLMUL)
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+/**
+  Check whether the CPU supports the carry-less multiplication
+  @return 1 if supported, 0 otherwise
+*/
+int gcm_pclmul_is_supported(void)
+{
+   return (ltc_cpu_features() & (LTC_CPU_SSSE3 | LTC_CPU_PCLMUL)) == (LTC_CPU_SSSE3 | LTC_CPU_PCLMUL);
+}
+
+#define GCM_PCLMUL_BSWAP _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)
+
+/* Accumulate the unreduced product a * b in `lo` and `hi` */
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+static LTC_INLINE void s_gcm_pclmul_mul(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+   __m128i mid;
+   *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+   *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+   mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+   *lo = _mm_xor_si128(*lo, _mm_slli_si128(mid, 8));
+   *hi = _mm_xor_si128(*hi, _mm_srli_si128(mid, 8));
+}
+
+/* Shift the 256 bit value hi:lo left by one bit and reduce it */
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+static LTC_INLINE __m128i s_gcm_pclmul_reduce(__m128i lo, __m128i hi)
+{
+   __m128i t7, t8, t9, t2, t4, t5;
+
+   t7 = _mm_srli_epi32(lo, 31);
+   t8 = _mm_srli_epi32(hi, 31);
+   lo = _mm_slli_epi32(lo, 1);
+   hi = _mm_slli_epi32(hi, 1);
+   t9 = _mm_srli_si128(t7, 12);
+   t8 = _mm_slli_si128(t8, 4);
+   t7 = _mm_slli_si128(t7, 4);
+   lo = _mm_or_si128(lo, t7);
+   hi = _mm_or_si128(hi, t8);
+   hi = _mm_or_si128(hi, t9);
+
+   t7 = _mm_slli_epi32(lo, 31);
+   t8 = _mm_slli_epi32(lo, 30);
+   t9 = _mm_slli_epi32(lo, 25);
+   t7 = _mm_xor_si128(t7, t8);
+   t7 = _mm_xor_si128(t7, t9);
+   t8 = _mm_srli_si128(t7, 4);
+   t7 = _mm_slli_si128(t7, 12);
+   lo = _mm_xor_si128(lo, t7);
+
+   t2 = _mm_srli_epi32(lo, 1);
+   t4 = _mm_srli_epi32(lo, 2);
+   t5 = _mm_srli_epi32(lo, 7);
+   t2 = _mm_xor_si128(t2, t4);
+   t2 = _mm_xor_si128(t2, t5);
+   t2 = _mm_xor_si128(t2, t8);
+   lo = _mm_xor_si128(lo, t2);
+   return _mm_xor_si128(hi, lo);
+}
+
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+static LTC_INLINE __m128i s_gcm_pclmul_gfmul(__m128i a, __m128i b)
+{
+   __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+   s_gcm_pclmul_mul(a, b, &lo, &hi);
+   return s_gcm_pclmul_reduce(lo, hi);
+}
+
+/**
+  Precompute the byte-reflected powers H^1..H^8
+  @param H     The H value
+  @param PH    [out] The powers of H
+*/
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+void gcm_pclmul_powers(const unsigned char *H, unsigned char (*PH)[16])
+{
+   __m128i h, hp;
+   int x;
+
+   h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) H), GCM_PCLMUL_BSWAP);
+   hp = h;
+   _mm_storeu_si128((__m128i*) PH[0], h);
+   for (x = 1; x < 8; x++) {
+      hp = s_gcm_pclmul_gfmul(hp, h);
+      _mm_storeu_si128((__m128i*) PH[x], hp);
+   }
+}
+
+/**
+  Precompute the powers H^1..H^8 of the GCM state
+  @param gcm   The GCM state which holds the H value
+*/
+void gcm_pclmul_init(gcm_state *gcm)
+{
+   gcm_pclmul_powers(gcm->H, gcm->PH);
+}
+
+/**
+  GCM multiply by H
+  @param gcm   The GCM state which holds the H value
+  @param I     The value to multiply H by
+*/
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+void gcm_pclmul_mult_h(const gcm_state *gcm, unsigned char *I)
+{
+   __m128i bswap, x;
+
+   bswap = GCM_PCLMUL_BSWAP;
+   x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) I), bswap);
+   x = s_gcm_pclmul_gfmul(x, _mm_loadu_si128((const __m128i*) gcm_key_state(gcm)->PH[0]));
+   _mm_storeu_si128((__m128i*) I, _mm_shuffle_epi8(x, bswap));
+}
+
+/* X = (X + D_0) * H^8 + D_1 * H^7 + ... + D_7 * H, `dmask` reflects the data blocks */
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+static void s_gcm_pclmul_ghash(const unsigned char (*PH)[16], unsigned char *X,
+                               const unsigned char *in, unsigned long blocks, __m128i dmask)
+{
+   __m128i bswap, x, h[8], lo, hi, d;
+   int i;
+
+   bswap = GCM_PCLMUL_BSWAP;
+   for (i = 0; i < 8; i++) {
+      h[i] = _mm_loadu_si128((const __m128i*) PH[i]);
+   }
+   x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) X), bswap);
+
+   while (blocks >= 8) {
+      lo = _mm_setzero_si128();
+      hi = _mm_setzero_si128();
+      for (i = 0; i < 8; i++) {
+         d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (in + 16 * i)), dmask);
+         if (i == 0) {
+            d = _mm_xor_si128(d, x);
+         }
+         s_gcm_pclmul_mul(d, h[7 - i], &lo, &hi);
+      }
+      x = s_gcm_pclmul_reduce(lo, hi);
+      in += 128;
+      blocks -= 8;
+   }
+   while (blocks-- > 0) {
+      d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) in), dmask);
+      x = s_gcm_pclmul_gfmul(_mm_xor_si128(x, d), h[0]);
+      in += 16;
+   }
+
+   _mm_storeu_si128((__m128i*) X, _mm_shuffle_epi8(x, bswap));
+}
+
+/**
+  Add complete blocks to the GHASH accumulator X of the GCM state
+  @param gcm     The GCM state
+  @param in      The data to hash
+  @param blocks  The number of 16 byte blocks to hash
+*/
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+void gcm_pclmul_ghash(gcm_state *gcm, const unsigned char *in, unsigned long blocks)
+{
+   s_gcm_pclmul_ghash((const unsigned char (*)[16]) gcm_key_state(gcm)->PH, gcm->X, in, blocks, GCM_PCLMUL_BSWAP);
+}
+
+/**
+  Add complete blocks to a POLYVAL accumulator
+
+  POLYVAL is GHASH with H * x and the blocks byte-reversed (RFC 8452 Appendix A),
+  so the blocks are simply not reflected.
+  @param PH      The powers H^1..H^8 as computed by gcm_pclmul_powers()
+  @param X       The accumulator (in the GHASH byte order)
+  @param in      The data to hash
+  @param blocks  The number of 16 byte blocks to hash
+*/
+LTC_ATTRIBUTE((__target__("pclmul,ssse3")))
+void gcm_pclmul_polyval(const unsigned char (*PH)[16], unsigned char *X, const unsigned char *in, unsigned long blocks)
+{
+   s_gcm_pclmul_ghash(PH, X, in, blocks, _mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+#endif
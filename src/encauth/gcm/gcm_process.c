@@ -23,9 +23,13 @@ int gcm_process(gcm_state *gcm,
                      unsigned char *ct,
                      int direction)
 {
+   const gcm_state *key;
    unsigned long x;
    int           y, err;
    unsigned char b;
+#ifdef LTC_GCM_PCLMUL
+   unsigned long n, z;
+#endif
 
    LTC_ARGCHK(gcm != NULL);
    if (ptlen > 0) {
@@ -37,7 +41,8 @@ int gcm_process(gcm_state *gcm,
       return CRYPT_INVALID_ARG;
    }
 
-   if ((err = cipher_is_valid(gcm->cipher)) != CRYPT_OK) {
+   key = gcm_key_state(gcm);
+   if ((err = cipher_is_valid(key->cipher)) != CRYPT_OK) {
       return err;
    }
 
@@ -64,7 +69,7 @@ int gcm_process(gcm_state *gcm,
           if (++gcm->Y[y] & 255) { break; }
       }
       /* encrypt the counter */
-      if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y, gcm->buf, &gcm->K)) != CRYPT_OK) {
+      if ((err = cipher_descriptor[key->cipher].ecb_encrypt(gcm->Y, gcm->buf, &key->K)) != CRYPT_OK) {
          return err;
       }
 
@@ -77,6 +82,44 @@ int gcm_process(gcm_state *gcm,
    }
 
    x = 0;
+#ifdef LTC_GCM_PCLMUL
+   if (key->pclmul && gcm->buflen == 0 && ptlen > 15) {
+      /* process up to eight blocks at once, so GHASH can reduce only once per eight blocks */
+      for (x = 0; x < (ptlen & ~15); x += n) {
+         n = MIN((ptlen & ~15) - x, 128);
+         if (direction == GCM_DECRYPT) {
+            gcm_pclmul_ghash(gcm, ct + x, n / 16);
+         }
+         for (z = x; z < x + n; z += 16) {
+            /* ctr encrypt */
+            if (direction == GCM_ENCRYPT) {
+               for (y = 0; y < 16; y++) {
+                   ct[z + y] = pt[z + y] ^ gcm->buf[y];
+               }
+            } else {
+               for (y = 0; y < 16; y++) {
+                   pt[z + y] = ct[z + y] ^ gcm->buf[y];
+               }
+            }
+            /* increment counter */
+            for (y = 15; y >= 12; y--) {
+                if (++gcm->Y[y] & 255) { break; }
+            }
+            if ((err = cipher_descriptor[key->cipher].ecb_encrypt(gcm->Y, gcm->buf, &key->K)) != CRYPT_OK) {
+               return err;
+            }
+         }
+         if (direction == GCM_ENCRYPT) {
+            gcm_pclmul_ghash(gcm, ct + x, n / 16);
+         }
+         gcm->pttotlen += n * CONST64(8);
+      }
+      pt    += x;
+      ct    += x;
+      ptlen -= x;
+      x = 0;
+   }
+#endif
 #ifdef LTC_FAST
    if (gcm->buflen == 0) {
       if (direction == GCM_ENCRYPT) {
@@ -93,7 +136,7 @@ int gcm_process(gcm_state *gcm,
              for (y = 15; y >= 12; y--) {
                  if (++gcm->Y[y] & 255) { break; }
              }
-             if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y, gcm->buf, &gcm->K)) != CRYPT_OK) {
+             if ((err = cipher_descriptor[key->cipher].ecb_encrypt(gcm->Y, gcm->buf, &key->K)) != CRYPT_OK) {
                 return err;
              }
          }
@@ -111,7 +154,7 @@ int gcm_process(gcm_state *gcm,
              for (y = 15; y >= 12; y--) {
                  if (++gcm->Y[y] & 255) { break; }
              }
-             if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y, gcm->buf, &gcm->K)) != CRYPT_OK) {
+             if ((err = cipher_descriptor[key->cipher].ecb_encrypt(gcm->Y, gcm->buf, &key->K)) != CRYPT_OK) {
                 return err;
              }
          }
@@ -129,7 +172,7 @@ int gcm_process(gcm_state *gcm,
           for (y = 15; y >= 12; y--) {
               if (++gcm->Y[y] & 255) { break; }
           }
-          if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y, gcm->buf, &gcm->K)) != CRYPT_OK) {
+          if ((err = cipher_descriptor[key->cipher].ecb_encrypt(gcm->Y, gcm->buf, &key->K)) != CRYPT_OK) {
              return err;
           }
           gcm->buflen = 0;
@@ -18,6 +18,11 @@ int gcm_reset(gcm_state *gcm)
 {
    LTC_ARGCHK(gcm != NULL);
 
+   /* the shared key tables have already been released by gcm_done() */
+   if (gcm->buflen < 0) {
+      return CRYPT_INVALID_ARG;
+   }
+
    zeromem(gcm->buf, sizeof(gcm->buf));
    zeromem(gcm->X,   sizeof(gcm->X));
    gcm->mode     = LTC_GCM_MODE_IV;
@@ -371,6 +371,210 @@ int gcm_test(void)
        }
    }
 
+   /* the bulk paths have to give the same result as processing the data in pieces of 15 bytes */
+   {
+      unsigned char pt[1000], ct[2][1000], tag[2][16];
+      unsigned long n;
+
+      for (x = 0; x < sizeof(pt); x++) pt[x] = (unsigned char)(x * 13 + 7);
+      for (y = 0; y < 2; y++) {
+         if ((err = gcm_init(&gcm, idx, tests[2].K, tests[2].keylen)) != CRYPT_OK) return err;
+         if ((err = gcm_add_iv(&gcm, tests[2].IV, tests[2].IVlen)) != CRYPT_OK)    return err;
+         for (x = 0; x < 333; x += n) {
+            n = y == 0 ? 333 : MIN(333 - x, 15);
+            if ((err = gcm_add_aad(&gcm, pt + x, n)) != CRYPT_OK)                  return err;
+         }
+         for (x = 0; x < sizeof(pt); x += n) {
+            n = y == 0 ? sizeof(pt) : MIN(sizeof(pt) - x, 15);
+            if ((err = gcm_process(&gcm, pt + x, n, ct[y] + x, GCM_ENCRYPT)) != CRYPT_OK) return err;
+         }
+         n = sizeof(tag[y]);
+         if ((err = gcm_done(&gcm, tag[y], &n)) != CRYPT_OK)                        return err;
+      }
+      if (compare_testvector(ct[0], sizeof(ct[0]), ct[1], sizeof(ct[1]), "GCM bulk CT", 0) ||
+          compare_testvector(tag[0], sizeof(tag[0]), tag[1], sizeof(tag[1]), "GCM bulk Tag", 0)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+
+      /* decrypt in place */
+      if ((err = gcm_init(&gcm, idx, tests[2].K, tests[2].keylen)) != CRYPT_OK)     return err;
+      if ((err = gcm_add_iv(&gcm, tests[2].IV, tests[2].IVlen)) != CRYPT_OK)        return err;
+      if ((err = gcm_add_aad(&gcm, pt, 333)) != CRYPT_OK)                           return err;
+      if ((err = gcm_process(&gcm, ct[0], sizeof(ct[0]), ct[0], GCM_DECRYPT)) != CRYPT_OK) return err;
+      n = sizeof(tag[1]);
+      if ((err = gcm_done(&gcm, tag[1], &n)) != CRYPT_OK)                           return err;
+      if (compare_testvector(ct[0], sizeof(ct[0]), pt, sizeof(pt), "GCM bulk PT", 0) ||
+          compare_testvector(tag[1], sizeof(tag[1]), tag[0], sizeof(tag[0]), "GCM bulk Decrypt Tag", 0)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
+   /* gcm_memory() may use an accelerator, it has to give the same result as the state based API */
+   {
+      static const unsigned long ptlens[] = { 0, 1, 15, 16, 17, 127, 128, 129, 255, 256, 257, 1000 };
+      static const unsigned long alens[] = { 0, 13, 130, 333 };
+      static const unsigned long ivlens[] = { 12, 7, 60 };
+      unsigned char pt[1000], ct[2][1000], tag[2][16];
+      unsigned long n, i, j, k;
+
+      for (x = 0; x < sizeof(pt); x++) pt[x] = (unsigned char)(x * 17 + 3);
+      for (i = 0; i < sizeof(ptlens)/sizeof(ptlens[0]); i++) {
+      for (j = 0; j < sizeof(alens)/sizeof(alens[0]); j++) {
+      for (k = 0; k < sizeof(ivlens)/sizeof(ivlens[0]); k++) {
+         y = i * 100 + j * 10 + k;
+         if ((err = gcm_init(&gcm, idx, tests[3].K, tests[3].keylen)) != CRYPT_OK)      return err;
+         if ((err = gcm_add_iv(&gcm, pt + 500, ivlens[k])) != CRYPT_OK)                return err;
+         if ((err = gcm_add_aad(&gcm, pt + 600, alens[j])) != CRYPT_OK)                return err;
+         if ((err = gcm_process(&gcm, pt, ptlens[i], ct[1], GCM_ENCRYPT)) != CRYPT_OK) return err;
+         n = sizeof(tag[1]);
+         if ((err = gcm_done(&gcm, tag[1], &n)) != CRYPT_OK)                            return err;
+
+         n = sizeof(tag[0]);
+         if ((err = gcm_memory(idx, tests[3].K, tests[3].keylen, pt + 500, ivlens[k], pt + 600, alens[j],
+                               pt, ptlens[i], ct[0], tag[0], &n, GCM_ENCRYPT)) != CRYPT_OK) {
+            return err;
+         }
+         if (compare_testvector(ct[0], ptlens[i], ct[1], ptlens[i], "GCM memory CT", y) ||
+             compare_testvector(tag[0], n, tag[1], sizeof(tag[1]), "GCM memory Tag", y)) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+
+         if ((err = gcm_memory(idx, tests[3].K, tests[3].keylen, pt + 500, ivlens[k], pt + 600, alens[j],
+                               ct[1], ptlens[i], ct[0], tag[0], &n, GCM_DECRYPT)) != CRYPT_OK) {
+            return err;
+         }
+         if (compare_testvector(ct[1], ptlens[i], pt, ptlens[i], "GCM memory PT", y)) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+         tag[0][y % 16] ^= 1;
+         if (gcm_memory(idx, tests[3].K, tests[3].keylen, pt + 500, ivlens[k], pt + 600, alens[j],
+                        ct[1], ptlens[i], ct[0], tag[0], &n, GCM_DECRYPT) != CRYPT_ERROR) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+      }
+      }
+   }
+
+   /* states which share the key tables have to give the same results as after gcm_init(),
+    * they only need the head of a gcm_state and keep the tables alive on their own */
+   if (GCM_SHARED_STATE_SIZE + sizeof(symmetric_key) > sizeof(gcm_state)) {
+      return CRYPT_FAIL_TESTVECTOR;
+   }
+   for (x = 0; x < sizeof(tests)/sizeof(tests[0]); x++) {
+      gcm_htable *ht;
+      gcm_state  *st[2];
+
+      st[0] = XMALLOC(GCM_SHARED_STATE_SIZE);
+      st[1] = XMALLOC(GCM_SHARED_STATE_SIZE);
+      if (st[0] == NULL || st[1] == NULL) {
+         err = CRYPT_MEM;
+         goto LBL_SHARED;
+      }
+      if ((err = gcm_htable_new(&ht, idx, tests[x].K, tests[x].keylen)) != CRYPT_OK) goto LBL_SHARED;
+      for (y = 0; err == CRYPT_OK && y < 2; y++) {
+         err = gcm_init_htable(st[y], ht);
+      }
+      /* the states hold the only references from now on */
+      gcm_htable_free(ht);
+      /* interleave the two states */
+      for (y = 0; err == CRYPT_OK && y < 2; y++) {
+         if ((err = gcm_add_iv(st[y], tests[x].IV, tests[x].IVlen)) == CRYPT_OK) {
+            err = gcm_add_aad(st[y], tests[x].A, tests[x].alen);
+         }
+      }
+      for (y = 0; err == CRYPT_OK && y < 2; y++) {
+         err = gcm_process(st[y], (unsigned char*)tests[x].P, tests[x].ptlen, out[y], GCM_ENCRYPT);
+      }
+      for (y = 0; err == CRYPT_OK && y < 2; y++) {
+         unsigned long taglen = sizeof(T[y]);
+         if ((err = gcm_done(st[y], T[y], &taglen)) != CRYPT_OK) break;
+         if (compare_testvector(out[y], tests[x].ptlen, tests[x].C, tests[x].ptlen, "GCM shared CT", x) ||
+             compare_testvector(T[y], taglen, tests[x].T, 16, "GCM shared Tag", x)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+      /* the tables are gone with the last gcm_done(), the states have to be initialized again */
+      if (err == CRYPT_OK && gcm_reset(st[0]) != CRYPT_INVALID_ARG) {
+         err = CRYPT_FAIL_TESTVECTOR;
+      }
+LBL_SHARED:
+      XFREE(st[0]);
+      XFREE(st[1]);
+      if (err != CRYPT_OK) return err;
+   }
+
+   /* gcm_memory_batch() has to give the same results as gcm_memory() for every packet */
+   {
+      static const unsigned long ptlens[] = { 0, 1, 15, 16, 64, 100, 1500, 3000, 17, 2032 };
+      static const unsigned long ivlens[] = { 12, 12, 12, 7, 12, 60, 12, 12, 12, 12 };
+      ltc_aead_packet pkt[11];
+      unsigned char *pt, *ct, *dec, tag[11][16], T2[16];
+      unsigned long n, i, off;
+
+      if ((pt = XMALLOC(4 * 7000)) == NULL) return CRYPT_MEM;
+      ct  = pt + 7000;
+      dec = pt + 14000;
+      for (x = 0; x < 7000; x++) pt[x] = (unsigned char)(x * 11 + 5);
+      XMEMSET(pkt, 0, sizeof(pkt));
+      for (i = off = 0; i < 10; off += ptlens[i++]) {
+         pkt[i].nonce    = pt + 100 + i;
+         pkt[i].noncelen = ivlens[i];
+         pkt[i].aad      = pt + 200;
+         pkt[i].aadlen   = i * 13;
+         pkt[i].in       = pt + off;
+         pkt[i].inlen    = ptlens[i];
+         pkt[i].out      = ct + off;
+         pkt[i].tag      = tag[i];
+         pkt[i].taglen   = i == 2 ? 12 : 16;
+      }
+      /* one packet in place and one with a missing nonce */
+      XMEMCPY(ct + 32, pt + 32, ptlens[4]);
+      pkt[4].in = ct + 32;
+      pkt[10] = pkt[0];
+      pkt[10].nonce = NULL;
+
+      err = gcm_memory_batch(idx, tests[3].K, tests[3].keylen, pkt, 11, GCM_ENCRYPT);
+      if (err != CRYPT_INVALID_ARG || pkt[10].err != CRYPT_INVALID_ARG) {
+         err = CRYPT_FAIL_TESTVECTOR;
+         goto LBL_BATCH;
+      }
+      for (i = off = 0; i < 10; off += ptlens[i++]) {
+         n = sizeof(T2);
+         if ((err = pkt[i].err) != CRYPT_OK ||
+             (err = gcm_memory(idx, tests[3].K, tests[3].keylen, pkt[i].nonce, pkt[i].noncelen, pkt[i].aad, pkt[i].aadlen,
+                               pt + off, ptlens[i], dec + off, T2, &n, GCM_ENCRYPT)) != CRYPT_OK) {
+            goto LBL_BATCH;
+         }
+         if (compare_testvector(ct + off, ptlens[i], dec + off, ptlens[i], "GCM batch CT", i) ||
+             compare_testvector(tag[i], pkt[i].taglen, T2, i == 2 ? 12 : 16, "GCM batch Tag", i)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_BATCH;
+         }
+         pkt[i].in  = ct + off;
+         pkt[i].out = i == 4 ? ct + off : dec + off;
+      }
+
+      /* a corrupted tag only fails its own packet, like gcm_memory() decryption needs the full tag */
+      tag[6][5] ^= 1;
+      err = gcm_memory_batch(idx, tests[3].K, tests[3].keylen, pkt, 10, GCM_DECRYPT);
+      if (err != CRYPT_ERROR) {
+         err = CRYPT_FAIL_TESTVECTOR;
+         goto LBL_BATCH;
+      }
+      for (i = off = 0; i < 10; off += ptlens[i++]) {
+         if (pkt[i].err != ((i == 2 || i == 6) ? CRYPT_ERROR : CRYPT_OK) ||
+             (i != 6 && compare_testvector(pkt[i].out, ptlens[i], pt + off, ptlens[i], "GCM batch PT", i))) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_BATCH;
+         }
+      }
+      err = CRYPT_OK;
+LBL_BATCH:
+      XFREE(pt);
+      if (err != CRYPT_OK) return err;
+   }
+
    /* wycheproof failing test - https://github.com/libtom/libtomcrypt/pull/451 */
    {
       unsigned char key[] = { 0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f };
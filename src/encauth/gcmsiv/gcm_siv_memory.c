@@ -0,0 +1,237 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file gcm_siv_memory.c
+   AES-GCM-SIV (RFC 8452), process a packet in one call
+*/
+#include "tomcrypt_private.h"
+
+#ifdef LTC_GCM_SIV_MODE
+
+typedef struct {
+   unsigned char H[16],              /* H * x, in the GHASH byte order */
+                 X[16];              /* accumulator, in the GHASH byte order */
+#ifdef LTC_GCM_PCLMUL
+   unsigned char PH[8][16];          /* powers of H for the carry-less multiplication */
+   int           pclmul;
+#endif
+} gcm_siv_polyval;
+
+/*
+   POLYVAL is computed with the GHASH multiplication as described in RFC 8452
+   Appendix A: POLYVAL(H, X_1, ..., X_n) =
+   ByteReverse(GHASH(mulX_GHASH(ByteReverse(H)), ByteReverse(X_1), ..., ByteReverse(X_n)))
+*/
+static void s_gcm_siv_polyval_init(gcm_siv_polyval *pv, const unsigned char *key)
+{
+   unsigned char c;
+   int x;
+
+   for (x = 0; x < 16; x++) {
+      pv->H[x] = key[15 - x];
+   }
+   c = pv->H[15] & 1;
+   for (x = 15; x > 0; x--) {
+      pv->H[x] = (unsigned char)((pv->H[x] >> 1) | (pv->H[x - 1] << 7));
+   }
+   pv->H[0] = (unsigned char)((pv->H[0] >> 1) ^ (c * 0xE1));
+   zeromem(pv->X, sizeof(pv->X));
+
+#ifdef LTC_GCM_PCLMUL
+   pv->pclmul = gcm_pclmul_is_supported();
+   if (pv->pclmul) {
+      gcm_pclmul_powers(pv->H, pv->PH);
+   }
+#endif
+}
+
+/* hash `len` bytes, the last block is padded with zeros */
+static void s_gcm_siv_polyval_process(gcm_siv_polyval *pv, const unsigned char *in, unsigned long len)
+{
+   unsigned char B[16], T[16];
+   unsigned long n;
+   int x;
+
+#ifdef LTC_GCM_PCLMUL
+   if (pv->pclmul && len >= 16) {
+      gcm_pclmul_polyval((const unsigned char (*)[16]) pv->PH, pv->X, in, len / 16);
+      in  += len & ~15uL;
+      len &= 15;
+   }
+#endif
+   while (len > 0) {
+      n = MIN(len, 16);
+      zeromem(B, sizeof(B));
+      XMEMCPY(B, in, n);
+#ifdef LTC_GCM_PCLMUL
+      if (pv->pclmul) {
+         gcm_pclmul_polyval((const unsigned char (*)[16]) pv->PH, pv->X, B, 1);
+      } else
+#endif
+      {
+         for (x = 0; x < 16; x++) {
+            pv->X[x] ^= B[15 - x];
+         }
+         gcm_gf_mult(pv->H, pv->X, T);
+         XMEMCPY(pv->X, T, 16);
+      }
+      in  += n;
+      len -= n;
+   }
+}
+
+/**
+  Process an entire AES-GCM-SIV packet in one call.
+  @param cipher            Index of cipher to use, it has to have a 16 byte block
+  @param key               The key-generating key
+  @param keylen            The length of the key (16 or 32 octets)
+  @param nonce             The nonce
+  @param noncelen          The length of the nonce (12 octets)
+  @param adata             The additional authentication data (header)
+  @param adatalen          The length of the adata
+  @param in                The plaintext (or ciphertext when decrypting)
+  @param inlen             The length of the input
+  @param out               [out] The ciphertext (or plaintext when decrypting)
+  @param tag               [in/out] The MAC tag
+  @param taglen            [in/out] The MAC tag length, always 16 octets
+  @param direction         Encrypt or Decrypt mode (GCM_SIV_ENCRYPT or GCM_SIV_DECRYPT)
+  @return CRYPT_OK on success, CRYPT_ERROR if the tag doesn't match when decrypting
+ */
+int gcm_siv_memory(      int           cipher,
+                   const unsigned char *key,    unsigned long keylen,
+                   const unsigned char *nonce,  unsigned long noncelen,
+                   const unsigned char *adata,  unsigned long adatalen,
+                   const unsigned char *in,     unsigned long inlen,
+                         unsigned char *out,
+                         unsigned char *tag,    unsigned long *taglen,
+                                   int direction)
+{
+   unsigned char   blk[16], S[16], T[16], mk[48];
+   gcm_siv_polyval pv;
+   symmetric_CTR  *ctr;
+   unsigned long   x;
+   int             err;
+
+   LTC_ARGCHK(key    != NULL);
+   LTC_ARGCHK(nonce  != NULL);
+   LTC_ARGCHK(tag    != NULL);
+   LTC_ARGCHK(taglen != NULL);
+   if (adatalen > 0) {
+      LTC_ARGCHK(adata != NULL);
+   }
+   if (inlen > 0) {
+      LTC_ARGCHK(in  != NULL);
+      LTC_ARGCHK(out != NULL);
+   }
+
+   if ((err = cipher_is_valid(cipher)) != CRYPT_OK) {
+      return err;
+   }
+   if (cipher_descriptor[cipher].block_length != 16) {
+      return CRYPT_INVALID_CIPHER;
+   }
+   if (keylen != 16 && keylen != 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+   if (noncelen != 12) {
+      return CRYPT_INVALID_ARG;
+   }
+   /* P_MAX and A_MAX are 2^36 octets */
+   if ((ulong64)inlen > CONST64(0x1000000000) || (ulong64)adatalen > CONST64(0x1000000000)) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (direction == GCM_SIV_ENCRYPT) {
+      if (*taglen < 16) {
+         *taglen = 16;
+         return CRYPT_BUFFER_OVERFLOW;
+      }
+   } else if (direction == GCM_SIV_DECRYPT) {
+      if (*taglen != 16) {
+         return CRYPT_INVALID_ARG;
+      }
+   } else {
+      return CRYPT_INVALID_ARG;
+   }
+
+   ctr = XMALLOC(sizeof(*ctr));
+   if (ctr == NULL) {
+      return CRYPT_MEM;
+   }
+
+   /* derive the message authentication and encryption keys from the first
+    * halves of E(K, LE32(i) || nonce), the key schedule of K is only needed here */
+   if ((err = cipher_descriptor[cipher].setup(key, keylen, 0, &ctr->key)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   XMEMCPY(blk + 4, nonce, 12);
+   for (x = 0; x < 2 + keylen / 8; x++) {
+      STORE32L(x, blk);
+      if ((err = cipher_descriptor[cipher].ecb_encrypt(blk, T, &ctr->key)) != CRYPT_OK) {
+         cipher_descriptor[cipher].done(&ctr->key);
+         goto LBL_ERR;
+      }
+      XMEMCPY(mk + 8 * x, T, 8);
+   }
+   cipher_descriptor[cipher].done(&ctr->key);
+
+   /* the counter is the little-endian first word of the block, it's set later */
+   zeromem(blk, sizeof(blk));
+   if ((err = ctr_start(cipher, blk, mk + 16, keylen, 0, CTR_COUNTER_LITTLE_ENDIAN | 4, ctr)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+
+   if (direction == GCM_SIV_DECRYPT) {
+      XMEMCPY(blk, tag, 16);
+      blk[15] |= 0x80;
+      if ((err = ctr_setiv(blk, 16, ctr)) != CRYPT_OK)          { goto LBL_CTR; }
+      if ((err = ctr_decrypt(in, out, inlen, ctr)) != CRYPT_OK) { goto LBL_CTR; }
+   }
+
+   /* S = POLYVAL(auth key, AAD || PT || LE64(8 * |AAD|) || LE64(8 * |PT|)) */
+   s_gcm_siv_polyval_init(&pv, mk);
+   s_gcm_siv_polyval_process(&pv, adata, adatalen);
+   s_gcm_siv_polyval_process(&pv, direction == GCM_SIV_ENCRYPT ? in : out, inlen);
+   STORE64L((ulong64)adatalen * 8, blk);
+   STORE64L((ulong64)inlen * 8, blk + 8);
+   s_gcm_siv_polyval_process(&pv, blk, 16);
+   for (x = 0; x < 16; x++) {
+      S[x] = pv.X[15 - x];
+   }
+
+   for (x = 0; x < 12; x++) {
+      S[x] ^= nonce[x];
+   }
+   S[15] &= 0x7F;
+   if ((err = cipher_descriptor[cipher].ecb_encrypt(S, T, &ctr->key)) != CRYPT_OK) {
+      goto LBL_CTR;
+   }
+
+   if (direction == GCM_SIV_ENCRYPT) {
+      XMEMCPY(tag, T, 16);
+      *taglen = 16;
+      XMEMCPY(blk, T, 16);
+      blk[15] |= 0x80;
+      if ((err = ctr_setiv(blk, 16, ctr)) != CRYPT_OK)          { goto LBL_CTR; }
+      if ((err = ctr_encrypt(in, out, inlen, ctr)) != CRYPT_OK) { goto LBL_CTR; }
+   } else if (XMEM_NEQ(T, tag, 16) != 0) {
+      /* don't release unauthenticated plaintext */
+      zeromem(out, inlen);
+      err = CRYPT_ERROR;
+   }
+
+LBL_CTR:
+   ctr_done(ctr);
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(mk, sizeof(mk));
+   zeromem(&pv, sizeof(pv));
+   zeromem(S, sizeof(S));
+   zeromem(T, sizeof(T));
+   zeromem(ctr, sizeof(*ctr));
+#endif
+   XFREE(ctr);
+   return err;
+}
+
+#endif
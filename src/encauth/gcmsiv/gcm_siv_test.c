@@ -0,0 +1,175 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file gcm_siv_test.c
+   AES-GCM-SIV (RFC 8452), test vectors
+*/
+#include "tomcrypt_private.h"
+
+#ifdef LTC_GCM_SIV_MODE
+
+/**
+  Test the AES-GCM-SIV code
+  @return CRYPT_OK on success
+ */
+int gcm_siv_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* RFC 8452 Appendix C */
+   static const struct {
+      unsigned char K[32];
+      unsigned long keylen;
+      unsigned char N[12];
+      unsigned char A[20];
+      unsigned long alen;
+      unsigned char P[48];
+      unsigned long ptlen;
+      unsigned char C[48];
+      unsigned char T[16];
+   } tests[] = {
+   {
+      { 0x01 }, 16,
+      { 0x03 },
+      { 0 }, 0,
+      { 0 }, 0,
+      { 0 },
+      { 0xdc, 0x20, 0xe2, 0xd8, 0x3f, 0x25, 0x70, 0x5b, 0xb4, 0x9e, 0x43, 0x9e, 0xca, 0x56, 0xde, 0x25 }
+   },
+   {
+      { 0x01 }, 16,
+      { 0x03 },
+      { 0 }, 0,
+      { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, 8,
+      { 0xb5, 0xd8, 0x39, 0x33, 0x0a, 0xc7, 0xb7, 0x86 },
+      { 0x57, 0x87, 0x82, 0xff, 0xf6, 0x01, 0x3b, 0x81, 0x5b, 0x28, 0x7c, 0x22, 0x49, 0x3a, 0x36, 0x4c }
+   },
+   {
+      { 0x01 }, 16,
+      { 0x03 },
+      { 0x01 }, 1,
+      { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, 8,
+      { 0x1e, 0x6d, 0xab, 0xa3, 0x56, 0x69, 0xf4, 0x27 },
+      { 0x3b, 0x0a, 0x1a, 0x25, 0x60, 0x96, 0x9c, 0xdf, 0x79, 0x0d, 0x99, 0x75, 0x9a, 0xbd, 0x15, 0x08 }
+   },
+   {
+      { 0x01 }, 32,
+      { 0x03 },
+      { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x00, 0x00 }, 20,
+      { 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, 48,
+      { 0x64, 0x00, 0x31, 0xce, 0x44, 0x51, 0x7a, 0x1c, 0x3a, 0x37, 0x4a, 0x6e, 0xf7, 0xb6, 0x37, 0x44,
+        0x52, 0xbb, 0xbd, 0x85, 0xa9, 0xcd, 0x4a, 0x6f, 0x4b, 0x32, 0xa5, 0x13, 0xf2, 0xeb, 0x9c, 0x67,
+        0xf4, 0x0c, 0xdc, 0x83, 0x44, 0x5b, 0xf0, 0x80, 0x0b, 0x97, 0xbb, 0xa8, 0x4f, 0x28, 0xee, 0x30 },
+      { 0x30, 0x35, 0xb2, 0x0b, 0xe4, 0xe2, 0x7d, 0x1f, 0xd8, 0xf9, 0x3b, 0x79, 0xb2, 0xab, 0xe7, 0xe8 }
+   },
+   /* counter wrap */
+   {
+      { 0 }, 32,
+      { 0 },
+      { 0 }, 0,
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x4d, 0xb9, 0x23, 0xdc, 0x79, 0x3e, 0xe6, 0x49, 0x7c, 0x76, 0xdc, 0xc0, 0x3a, 0x98, 0xe1, 0x08 }, 32,
+      { 0xf3, 0xf8, 0x0f, 0x2c, 0xf0, 0xcb, 0x2d, 0xd9, 0xc5, 0x98, 0x4f, 0xcd, 0xa9, 0x08, 0x45, 0x6c,
+        0xc5, 0x37, 0x70, 0x3b, 0x5b, 0xa7, 0x03, 0x24, 0xa6, 0x79, 0x3a, 0x7b, 0xf2, 0x18, 0xd3, 0xea },
+      { 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+   },
+   {
+      { 0 }, 32,
+      { 0 },
+      { 0 }, 0,
+      { 0xeb, 0x36, 0x40, 0x27, 0x7c, 0x7f, 0xfd, 0x13, 0x03, 0xc7, 0xa5, 0x42, 0xd0, 0x2d, 0x3e, 0x4c,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, 24,
+      { 0x18, 0xce, 0x4f, 0x0b, 0x8c, 0xb4, 0xd0, 0xca, 0xc6, 0x5f, 0xea, 0x8f, 0x79, 0x25, 0x7b, 0x20,
+        0x88, 0x8e, 0x53, 0xe7, 0x22, 0x99, 0xe5, 0x6d },
+      { 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+   },
+   };
+   /* long messages, the last block of the ciphertext and the tag */
+   static const unsigned char long_ct[2][16] = {
+      { 0xf2, 0xda, 0xda, 0xf8, 0xde, 0xe3, 0x04, 0xb2, 0xe7, 0xb8, 0x3b, 0x58, 0x68, 0x67, 0x7f, 0x02 },
+      { 0xcc, 0x03, 0x0d, 0x8f, 0xf5, 0x81, 0x3f, 0xb7, 0x13, 0xa1, 0x70, 0x55, 0xd9, 0xc0, 0x49, 0xc5 }
+   };
+   static const unsigned char long_tag[2][16] = {
+      { 0x96, 0x56, 0x26, 0x7f, 0xd9, 0x1e, 0x69, 0x4a, 0x9e, 0x2c, 0xa3, 0x51, 0x4a, 0x89, 0xf2, 0x6a },
+      { 0x41, 0x9f, 0xec, 0x61, 0x20, 0xd3, 0xd0, 0xef, 0x3f, 0xcc, 0xb1, 0x65, 0xd9, 0xf3, 0xbf, 0xdb }
+   };
+   unsigned char out[1000], pt[1000], key[32], nonce[12], aad[333], tag[16];
+   unsigned long x, y, taglen;
+   int idx, err;
+
+   idx = find_cipher("aes");
+   if (idx == -1) {
+      idx = find_cipher("rijndael");
+      if (idx == -1) {
+         return CRYPT_NOP;
+      }
+   }
+
+   for (x = 0; x < sizeof(tests)/sizeof(tests[0]); x++) {
+      taglen = sizeof(tag);
+      if ((err = gcm_siv_memory(idx, tests[x].K, tests[x].keylen, tests[x].N, 12, tests[x].A, tests[x].alen,
+                                tests[x].P, tests[x].ptlen, out, tag, &taglen, GCM_SIV_ENCRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(out, tests[x].ptlen, tests[x].C, tests[x].ptlen, "GCM-SIV CT", x) ||
+          compare_testvector(tag, taglen, tests[x].T, 16, "GCM-SIV Tag", x)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+      if ((err = gcm_siv_memory(idx, tests[x].K, tests[x].keylen, tests[x].N, 12, tests[x].A, tests[x].alen,
+                                out, tests[x].ptlen, out, tag, &taglen, GCM_SIV_DECRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(out, tests[x].ptlen, tests[x].P, tests[x].ptlen, "GCM-SIV PT", x)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
+   for (x = 0; x < sizeof(key); x++)   key[x] = (unsigned char)x;
+   for (x = 0; x < sizeof(nonce); x++) nonce[x] = (unsigned char)(100 + x);
+   for (x = 0; x < sizeof(aad); x++)   aad[x] = (unsigned char)(x * 7 + 1);
+   for (x = 0; x < sizeof(pt); x++)    pt[x] = (unsigned char)(x * 13 + 7);
+   for (x = 0; x < 2; x++) {
+      taglen = sizeof(tag);
+      if ((err = gcm_siv_memory(idx, key, 16 + 16 * x, nonce, sizeof(nonce), aad, sizeof(aad),
+                                pt, sizeof(pt), out, tag, &taglen, GCM_SIV_ENCRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(out + sizeof(out) - 16, 16, long_ct[x], 16, "GCM-SIV long CT", x) ||
+          compare_testvector(tag, taglen, long_tag[x], 16, "GCM-SIV long Tag", x)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+      if ((err = gcm_siv_memory(idx, key, 16 + 16 * x, nonce, sizeof(nonce), aad, sizeof(aad),
+                                out, sizeof(out), out, tag, &taglen, GCM_SIV_DECRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(out, sizeof(out), pt, sizeof(pt), "GCM-SIV long PT", x)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+
+      /* a modified tag has to be rejected and the plaintext wiped */
+      if ((err = gcm_siv_memory(idx, key, 16 + 16 * x, nonce, sizeof(nonce), aad, sizeof(aad),
+                                pt, sizeof(pt), out, tag, &taglen, GCM_SIV_ENCRYPT)) != CRYPT_OK) {
+         return err;
+      }
+      tag[x] ^= 0x10;
+      if (gcm_siv_memory(idx, key, 16 + 16 * x, nonce, sizeof(nonce), aad, sizeof(aad),
+                         out, sizeof(out), out, tag, &taglen, GCM_SIV_DECRYPT) != CRYPT_ERROR) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+      for (y = 0; y < sizeof(out); y++) {
+         if (out[y] != 0) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+   }
+
+   return CRYPT_OK;
+#endif
+}
+
+#endif
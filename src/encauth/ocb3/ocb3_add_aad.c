@@ -79,7 +79,14 @@ int ocb3_add_aad(ocb3_state *ocb, const unsigned char *aad, unsigned long aadlen
    full_blocks_len = full_blocks * ocb->block_len;
    last_block_len = datalen - full_blocks_len;
 
-   for (x=0; x<full_blocks; x++) {
+   x = 0;
+   if (ocb->block_len == 16 && cipher_descriptor[ocb->cipher].accel_ecb_encrypt != NULL && full_blocks >= OCB3_PAR) {
+     x = full_blocks - full_blocks % OCB3_PAR;
+     if ((err = ocb3_int_process_blocks(ocb, ocb->aOffset_current, &ocb->ablock_index, data, NULL, ocb->aSum_current, x, OCB3_INT_AAD)) != CRYPT_OK) {
+       return err;
+     }
+   }
+   for (; x<full_blocks; x++) {
      if ((err = s_ocb3_int_aad_add_block(ocb, data+x*ocb->block_len)) != CRYPT_OK) {
        return err;
      }
@@ -40,7 +40,17 @@ int ocb3_decrypt(ocb3_state *ocb, const unsigned char *ct, unsigned long ctlen,
    }
 
    full_blocks = ctlen/ocb->block_len;
-   for(i=0; i<full_blocks; i++) {
+   i = 0;
+
+   /* process runs of OCB3_PAR blocks with the multi-block ECB of the cipher */
+   if (ocb->block_len == 16 && cipher_descriptor[ocb->cipher].accel_ecb_decrypt != NULL && full_blocks >= OCB3_PAR) {
+     i = full_blocks - full_blocks % OCB3_PAR;
+     if ((err = ocb3_int_process_blocks(ocb, ocb->Offset_current, &ocb->block_index, ct, pt, ocb->checksum, i, OCB3_INT_DECRYPT)) != CRYPT_OK) {
+        goto LBL_ERR;
+     }
+   }
+
+   for(; i<full_blocks; i++) {
      pt_b = (unsigned char *)pt+i*ocb->block_len;
      ct_b = (unsigned char *)ct+i*ocb->block_len;
 
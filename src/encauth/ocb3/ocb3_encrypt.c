@@ -40,13 +40,26 @@ int ocb3_encrypt(ocb3_state *ocb, const unsigned char *pt, unsigned long ptlen,
    }
 
    full_blocks = ptlen/ocb->block_len;
-   for(i=0; i<full_blocks; i++) {
+   i = 0;
+
+   /* process runs of OCB3_PAR blocks with the multi-block ECB of the cipher */
+   if (ocb->block_len == 16 && cipher_descriptor[ocb->cipher].accel_ecb_encrypt != NULL && full_blocks >= OCB3_PAR) {
+     i = full_blocks - full_blocks % OCB3_PAR;
+     if ((err = ocb3_int_process_blocks(ocb, ocb->Offset_current, &ocb->block_index, pt, ct, ocb->checksum, i, OCB3_INT_ENCRYPT)) != CRYPT_OK) {
+        goto LBL_ERR;
+     }
+   }
+
+   for(; i<full_blocks; i++) {
      pt_b = (unsigned char *)pt+i*ocb->block_len;
      ct_b = (unsigned char *)ct+i*ocb->block_len;
 
      /* ocb->Offset_current[] = ocb->Offset_current[] ^ Offset_{ntz(block_index)} */
      ocb3_int_xor_blocks(ocb->Offset_current, ocb->Offset_current, ocb->L_[ocb3_int_ntz(ocb->block_index)], ocb->block_len);
 
+     /* ocb->checksum[] = ocb->checksum[] XOR pt[] (before ct[] is written, pt and ct may overlap) */
+     ocb3_int_xor_blocks(ocb->checksum, ocb->checksum, pt_b, ocb->block_len);
+
      /* tmp[] = pt[] XOR ocb->Offset_current[] */
      ocb3_int_xor_blocks(tmp, pt_b, ocb->Offset_current, ocb->block_len);
 
@@ -58,9 +71,6 @@ int ocb3_encrypt(ocb3_state *ocb, const unsigned char *pt, unsigned long ptlen,
      /* ct[] = tmp[] XOR ocb->Offset_current[] */
      ocb3_int_xor_blocks(ct_b, tmp, ocb->Offset_current, ocb->block_len);
 
-     /* ocb->checksum[] = ocb->checksum[] XOR pt[] */
-     ocb3_int_xor_blocks(ocb->checksum, ocb->checksum, pt_b, ocb->block_len);
-
      ocb->block_index++;
    }
 
@@ -9,51 +9,6 @@
 
 #ifdef LTC_OCB3_MODE
 
-static void s_ocb3_int_calc_offset_zero(ocb3_state *ocb, const unsigned char *nonce, unsigned long noncelen, unsigned long taglen)
-{
-   int x, y, bottom;
-   int idx, shift;
-   unsigned char iNonce[MAXBLOCKSIZE];
-   unsigned char iKtop[MAXBLOCKSIZE];
-   unsigned char iStretch[MAXBLOCKSIZE+8];
-
-   /* Nonce = zeros(127-bitlen(N)) || 1 || N          */
-   zeromem(iNonce, sizeof(iNonce));
-   for (x = ocb->block_len-1, y=0; y<(int)noncelen; x--, y++) {
-     iNonce[x] = nonce[noncelen-y-1];
-   }
-   iNonce[x] = 0x01;
-   iNonce[0] |= ((taglen*8) % 128) << 1;
-
-   /* bottom = str2num(Nonce[123..128])               */
-   bottom = iNonce[ocb->block_len-1] & 0x3F;
-
-   /* Ktop = ENCIPHER(K, Nonce[1..122] || zeros(6))   */
-   iNonce[ocb->block_len-1] = iNonce[ocb->block_len-1] & 0xC0;
-   if ((cipher_descriptor[ocb->cipher].ecb_encrypt(iNonce, iKtop, &ocb->key)) != CRYPT_OK) {
-      zeromem(ocb->Offset_current, ocb->block_len);
-      return;
-   }
-
-   /* Stretch = Ktop || (Ktop[1..64] xor Ktop[9..72]) */
-   for (x = 0; x < ocb->block_len; x++) {
-     iStretch[x] = iKtop[x];
-   }
-   for (y = 0; y < 8; y++) {
-     iStretch[x+y] = iKtop[y] ^ iKtop[y+1];
-   }
-
-   /* Offset_0 = Stretch[1+bottom..128+bottom]        */
-   idx = bottom / 8;
-   shift = (bottom % 8);
-   for (x = 0; x < ocb->block_len; x++) {
-      ocb->Offset_current[x] = iStretch[idx+x] << shift;
-      if (shift > 0) {
-        ocb->Offset_current[x] |= iStretch[idx+x+1] >> (8-shift);
-      }
-   }
-}
-
 static const struct {
     int           len;
     unsigned char poly_mul[MAXBLOCKSIZE];
@@ -165,22 +120,8 @@ int ocb3_init(ocb3_state *ocb, int cipher,
       }
    }
 
-   /* initialize ocb->Offset_current = Offset_0 */
-   s_ocb3_int_calc_offset_zero(ocb, nonce, noncelen, taglen);
-
-   /* initialize checksum to all zeros */
-   zeromem(ocb->checksum, ocb->block_len);
-
-   /* set block index */
-   ocb->block_index = 1;
-
-   /* initialize AAD related stuff */
-   ocb->ablock_index = 1;
-   ocb->adata_buffer_bytes = 0;
-   zeromem(ocb->aOffset_current, ocb->block_len);
-   zeromem(ocb->aSum_current, ocb->block_len);
-
-   return CRYPT_OK;
+   /* Offset_0, checksum etc. of the first message */
+   return ocb3_reset(ocb, nonce, noncelen, taglen);
 }
 
 #endif
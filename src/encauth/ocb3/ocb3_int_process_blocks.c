@@ -0,0 +1,117 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file ocb3_int_process_blocks.c
+   OCB implementation, INTERNAL ONLY helper, multi-block processing
+*/
+#include "tomcrypt_private.h"
+
+#ifdef LTC_OCB3_MODE
+
+/* ntz(i) for i mod 8 = 1..7, every eighth index needs ocb3_int_ntz() */
+static const unsigned char s_ocb3_ntz8[8] = { 0, 0, 1, 0, 2, 0, 1, 0 };
+
+/* out = a XOR b for one 16 byte block */
+static LTC_INLINE void s_ocb3_xor16(unsigned char *out, const unsigned char *a, const unsigned char *b)
+{
+   int x;
+#ifdef LTC_FAST
+   for (x = 0; x < 16; x += sizeof(LTC_FAST_TYPE)) {
+      *(LTC_FAST_TYPE_PTR_CAST(out + x)) = *(LTC_FAST_TYPE_PTR_CAST(a + x)) ^ *(LTC_FAST_TYPE_PTR_CAST(b + x));
+   }
+#else
+   for (x = 0; x < 16; x++) {
+      out[x] = a[x] ^ b[x];
+   }
+#endif
+}
+
+/**
+   Process full blocks OCB3_PAR at a time with the multi-block ECB of the cipher (internal function)
+
+   The offsets of a run are computed upfront from the L table, so the cipher
+   gets OCB3_PAR independent blocks per call and can pipeline them.
+   Only ciphers with a block length of 16 bytes are supported.
+   OCB3_INT_ENCRYPT:  out_i = ENCIPHER(K, in_i xor Offset_i) xor Offset_i,  sum ^= in_i
+   OCB3_INT_DECRYPT:  out_i = DECIPHER(K, in_i xor Offset_i) xor Offset_i,  sum ^= out_i
+   OCB3_INT_AAD:      sum ^= ENCIPHER(K, in_i xor Offset_i), `out` is not used
+   @param ocb     The OCB state
+   @param offset  [in/out] The offset of the last processed block
+   @param index   [in/out] The index of the next block
+   @param in      The input blocks
+   @param out     [out] The output blocks (may be equal to `in`)
+   @param sum     [in/out] The checksum resp. the AAD sum
+   @param blocks  The number of blocks, a multiple of OCB3_PAR
+   @param mode    OCB3_INT_ENCRYPT, OCB3_INT_DECRYPT or OCB3_INT_AAD
+   @return CRYPT_OK if successful
+*/
+int ocb3_int_process_blocks(ocb3_state *ocb, unsigned char *offset, unsigned long *index,
+                            const unsigned char *in, unsigned char *out, unsigned char *sum,
+                            unsigned long blocks, int mode)
+{
+   unsigned char buf[OCB3_PAR * 16], offsets[OCB3_PAR * 16], o[16], s[16];
+   unsigned long i, idx;
+   int err = CRYPT_OK, j, n;
+
+   if (ocb->block_len != 16) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* local copies, so the compiler doesn't have to assume they alias the data */
+   idx = *index;
+   XMEMCPY(o, offset, 16);
+   XMEMCPY(s, sum, 16);
+
+   for (i = 0; i < blocks; i += OCB3_PAR) {
+      /* offsets[j] = Offset_{idx+j}, buf[j] = in[j] XOR offsets[j] */
+      for (j = 0; j < OCB3_PAR; j++) {
+         n = (idx & 7) ? s_ocb3_ntz8[idx & 7] : ocb3_int_ntz(idx);
+         s_ocb3_xor16(o, o, ocb->L_[n]);
+         XMEMCPY(offsets + 16*j, o, 16);
+         s_ocb3_xor16(buf + 16*j, in + 16*j, o);
+         if (mode == OCB3_INT_ENCRYPT) {
+            s_ocb3_xor16(s, s, in + 16*j);
+         }
+         idx++;
+      }
+
+      if (mode == OCB3_INT_DECRYPT) {
+         err = cipher_descriptor[ocb->cipher].accel_ecb_decrypt(buf, buf, OCB3_PAR, &ocb->key);
+      } else {
+         err = cipher_descriptor[ocb->cipher].accel_ecb_encrypt(buf, buf, OCB3_PAR, &ocb->key);
+      }
+      if (err != CRYPT_OK) {
+         goto LBL_ERR;
+      }
+
+      for (j = 0; j < OCB3_PAR; j++) {
+         if (mode == OCB3_INT_AAD) {
+            s_ocb3_xor16(s, s, buf + 16*j);
+         } else {
+            s_ocb3_xor16(out + 16*j, buf + 16*j, offsets + 16*j);
+            if (mode == OCB3_INT_DECRYPT) {
+               s_ocb3_xor16(s, s, out + 16*j);
+            }
+         }
+      }
+
+      in += 16 * OCB3_PAR;
+      if (mode != OCB3_INT_AAD) {
+         out += 16 * OCB3_PAR;
+      }
+   }
+
+   *index = idx;
+   XMEMCPY(offset, o, 16);
+   XMEMCPY(sum, s, 16);
+
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(buf, sizeof(buf));
+   zeromem(offsets, sizeof(offsets));
+#endif
+   return err;
+}
+
+#endif
@@ -19,12 +19,19 @@
 void ocb3_int_xor_blocks(unsigned char *out, const unsigned char *block_a, const unsigned char *block_b, unsigned long block_len)
 {
    int x;
+#ifdef LTC_FAST
+   for (x = 0; x + (int)sizeof(LTC_FAST_TYPE) <= (int)block_len; x += sizeof(LTC_FAST_TYPE)) {
+     *(LTC_FAST_TYPE_PTR_CAST(out + x)) = *(LTC_FAST_TYPE_PTR_CAST(block_a + x)) ^ *(LTC_FAST_TYPE_PTR_CAST(block_b + x));
+   }
+   for (; x < (int)block_len; x++) out[x] = block_a[x] ^ block_b[x];
+#else
    if (out == block_a) {
      for (x = 0; x < (int)block_len; x++) out[x] ^= block_b[x];
    }
    else {
      for (x = 0; x < (int)block_len; x++) out[x] = block_a[x] ^ block_b[x];
    }
+#endif
 }
 
 #endif
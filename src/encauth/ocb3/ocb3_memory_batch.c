@@ -0,0 +1,121 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file ocb3_memory_batch.c
+   OCB implementation, process many packets with the same key
+*/
+#include "tomcrypt_private.h"
+
+#ifdef LTC_OCB3_MODE
+
+static int s_ocb3_batch_one(ocb3_state *ocb, ltc_aead_packet *p, int direction)
+{
+   unsigned char buf[MAXBLOCKSIZE];
+   unsigned long taglen, buflen;
+   int err;
+
+   if (p->nonce == NULL || p->tag == NULL) {
+      return CRYPT_INVALID_ARG;
+   }
+   if ((p->aadlen > 0 && p->aad == NULL) || (p->inlen > 0 && (p->in == NULL || p->out == NULL))) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   taglen = direction == LTC_ENCRYPT ? p->taglen : MIN(p->taglen, MAXBLOCKSIZE);
+   if ((err = ocb3_reset(ocb, p->nonce, p->noncelen, taglen)) != CRYPT_OK) {
+      return err;
+   }
+   if (p->aadlen > 0) {
+      if ((err = ocb3_add_aad(ocb, p->aad, p->aadlen)) != CRYPT_OK) {
+         return err;
+      }
+   }
+
+   if (direction == LTC_ENCRYPT) {
+      if ((err = ocb3_encrypt_last(ocb, p->in, p->inlen, p->out)) != CRYPT_OK) {
+         return err;
+      }
+      return ocb3_done(ocb, p->tag, &p->taglen);
+   }
+
+   if ((err = ocb3_decrypt_last(ocb, p->in, p->inlen, p->out)) != CRYPT_OK) {
+      return err;
+   }
+   buflen = taglen;
+   if ((err = ocb3_done(ocb, buf, &buflen)) != CRYPT_OK) {
+      return err;
+   }
+   if (buflen < taglen || XMEM_NEQ(buf, p->tag, taglen) != 0) {
+      err = CRYPT_ERROR;
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(buf, sizeof(buf));
+#endif
+   return err;
+}
+
+/**
+   Process many independent OCB packets with the same key in one call.
+
+   The key schedule and the L values are computed once, every packet
+   only sets up its nonce with ocb3_reset().
+
+   Every packet gets its own result in `err`, a decrypted packet whose tag
+   doesn't match gets CRYPT_ERROR (its plaintext must not be used).
+   @param cipher     The index of the cipher desired
+   @param key        The secret key
+   @param keylen     The length of the secret key (octets)
+   @param pkt        The packets
+   @param npkt       The number of packets
+   @param direction  Encrypt or Decrypt mode (LTC_ENCRYPT or LTC_DECRYPT)
+   @return CRYPT_OK if all packets were processed successfully, otherwise the error of the first packet which failed
+*/
+int ocb3_memory_batch(int cipher,
+                      const unsigned char *key, unsigned long keylen,
+                      ltc_aead_packet *pkt,     unsigned long npkt,
+                      int direction)
+{
+   ocb3_state    *ocb;
+   unsigned long  i;
+   int            err;
+
+   LTC_ARGCHK(key != NULL);
+   LTC_ARGCHK(pkt != NULL);
+
+   if (direction != LTC_ENCRYPT && direction != LTC_DECRYPT) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* the keyed state and a working copy, as ocb3_done() may wipe the state */
+   ocb = XMALLOC(2 * sizeof(ocb3_state));
+   if (ocb == NULL) {
+      return CRYPT_MEM;
+   }
+
+   /* the empty nonce of the keyed state is never used */
+   if ((err = ocb3_init(&ocb[0], cipher, key, keylen, key, 0, 16)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+
+   for (i = 0; i < npkt; i++) {
+      XMEMCPY(&ocb[1], &ocb[0], sizeof(ocb3_state));
+      pkt[i].err = s_ocb3_batch_one(&ocb[1], &pkt[i], direction);
+   }
+
+   for (i = 0; i < npkt; i++) {
+      if (pkt[i].err != CRYPT_OK) {
+         err = pkt[i].err;
+         break;
+      }
+   }
+
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(ocb, 2 * sizeof(ocb3_state));
+#endif
+   XFREE(ocb);
+   return err;
+}
+
+#endif
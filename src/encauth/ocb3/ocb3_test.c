@@ -292,6 +292,197 @@ int ocb3_test(void)
     if (compare_testvector(outct, sizeof(C), P, sizeof(P), "OCB3 PT", x))          return CRYPT_FAIL_TESTVECTOR;
     if (compare_testvector(outtag, len, T, sizeof(T), "OCB3 Tag.dec", x))          return CRYPT_FAIL_TESTVECTOR;
 
+    /* RFC 7253 - 'Appendix A.  Sample Results' iterative test with a tag length of 128 bits,
+     * the last call hashes ~22KB of AAD so the multi-block path gets exercised
+     */
+    x = 101;
+    {
+       const unsigned char Tit[] = { 0x67,0xE9,0x44,0xD2,0x32,0x56,0xC5,0xE0,
+                                     0xB6,0xC6,0x1F,0xA2,0x2F,0xDF,0x1E,0xA2 };
+       unsigned char Kit[16] = { 0 }, Nit[12] = { 0 }, S[128] = { 0 }, *Cit;
+       unsigned long i, clen, Clen;
+
+       Kit[15] = 128;
+       Clen = 3 * 128 * 16 + 2 * (127 * 128 / 2);
+       if ((Cit = XMALLOC(Clen)) == NULL) {
+          return CRYPT_MEM;
+       }
+       for (i = 0, clen = 0; i < 128; i++) {
+          STORE32H(3 * i + 1, Nit + 8);
+          len = 16;
+          if ((err = ocb3_encrypt_authenticate_memory(idx, Kit, 16, Nit, 12, S, i, S, i, Cit + clen, Cit + clen + i, &len)) != CRYPT_OK) break;
+          clen += i + 16;
+          STORE32H(3 * i + 2, Nit + 8);
+          len = 16;
+          if ((err = ocb3_encrypt_authenticate_memory(idx, Kit, 16, Nit, 12, NULL, 0, S, i, Cit + clen, Cit + clen + i, &len)) != CRYPT_OK) break;
+          clen += i + 16;
+          STORE32H(3 * i + 3, Nit + 8);
+          len = 16;
+          if ((err = ocb3_encrypt_authenticate_memory(idx, Kit, 16, Nit, 12, S, i, NULL, 0, NULL, Cit + clen, &len)) != CRYPT_OK) break;
+          clen += 16;
+       }
+       if (err == CRYPT_OK) {
+          STORE32H(385, Nit + 8);
+          len = 16;
+          err = ocb3_encrypt_authenticate_memory(idx, Kit, 16, Nit, 12, Cit, clen, NULL, 0, NULL, outtag, &len);
+       }
+       XFREE(Cit);
+       if (err != CRYPT_OK) return err;
+       if (compare_testvector(outtag, len, Tit, sizeof(Tit), "OCB3 Tag.iter", x))     return CRYPT_FAIL_TESTVECTOR;
+    }
+
+    /* the multi-block path must give the same result as feeding the data in pieces */
+    x = 102;
+    {
+       unsigned char buf[1000], bct[1000], bct2[1000], btag[16];
+       unsigned long i, ptlen;
+
+       for (i = 0; i < sizeof(buf); i++) {
+          buf[i] = (unsigned char)(i * 7 + 3);
+       }
+       for (ptlen = 0; ptlen <= sizeof(buf); ptlen += 109) {
+          len = 16;
+          if ((err = ocb3_encrypt_authenticate_memory(idx, key, sizeof(key), nonce, sizeof(nonce),
+                                                      buf, ptlen + 5, buf, ptlen, bct, btag, &len)) != CRYPT_OK) return err;
+
+          /* 7 byte AAD pieces and at most 3 blocks per call never reach OCB3_PAR blocks */
+          if ((err = ocb3_init(&ocb, idx, key, sizeof(key), nonce, sizeof(nonce), 16)) != CRYPT_OK) return err;
+          for (i = 0; i < ptlen + 5; i += 7) {
+             if ((err = ocb3_add_aad(&ocb, buf + i, MIN(7, ptlen + 5 - i))) != CRYPT_OK) return err;
+          }
+          for (i = 0; i + 48 <= ptlen; i += 48) {
+             if ((err = ocb3_encrypt(&ocb, buf + i, 48, bct2 + i)) != CRYPT_OK) return err;
+          }
+          if ((err = ocb3_encrypt_last(&ocb, buf + i, ptlen - i, bct2 + i)) != CRYPT_OK) return err;
+          len = 16;
+          if ((err = ocb3_done(&ocb, outtag, &len)) != CRYPT_OK) return err;
+          if (compare_testvector(bct2, ptlen, bct, ptlen, "OCB3 CT.bulk", x) ||
+              compare_testvector(outtag, len, btag, 16, "OCB3 Tag.bulk", x)) {
+             return CRYPT_FAIL_TESTVECTOR;
+          }
+
+          /* decrypt in place after one odd block so the bulk path starts at an unaligned index */
+          if ((err = ocb3_init(&ocb, idx, key, sizeof(key), nonce, sizeof(nonce), 16)) != CRYPT_OK) return err;
+          if ((err = ocb3_add_aad(&ocb, buf, ptlen + 5)) != CRYPT_OK) return err;
+          i = ptlen >= 16 ? 16 : 0;
+          if ((err = ocb3_decrypt(&ocb, bct2, i, bct2)) != CRYPT_OK) return err;
+          if ((err = ocb3_decrypt(&ocb, bct2 + i, (ptlen - i) & ~15uL, bct2 + i)) != CRYPT_OK) return err;
+          i += (ptlen - i) & ~15uL;
+          if ((err = ocb3_decrypt_last(&ocb, bct2 + i, ptlen - i, bct2 + i)) != CRYPT_OK) return err;
+          len = 16;
+          if ((err = ocb3_done(&ocb, outtag, &len)) != CRYPT_OK) return err;
+          if (compare_testvector(bct2, ptlen, buf, ptlen, "OCB3 PT.bulk", x) ||
+              compare_testvector(outtag, len, btag, 16, "OCB3 Tag.bulk.dec", x)) {
+             return CRYPT_FAIL_TESTVECTOR;
+          }
+       }
+    }
+
+    /* encryption in place, the checksum has to be updated before the plaintext is overwritten */
+    x = 103;
+    {
+       static const unsigned long ptlens[] = { 1, 15, 16, 33, 128, 137, 288, 300 };
+       unsigned char buf[300], bct[300], btag[16];
+       unsigned long i, n;
+
+       for (n = 0; n < sizeof(ptlens)/sizeof(ptlens[0]); n++) {
+          for (i = 0; i < ptlens[n]; i++) {
+             buf[i] = (unsigned char)(i * 5 + 1);
+          }
+          len = 16;
+          if ((err = ocb3_encrypt_authenticate_memory(idx, key, sizeof(key), nonce, sizeof(nonce),
+                                                      NULL, 0, buf, ptlens[n], bct, btag, &len)) != CRYPT_OK) return err;
+          len = 16;
+          if ((err = ocb3_encrypt_authenticate_memory(idx, key, sizeof(key), nonce, sizeof(nonce),
+                                                      NULL, 0, buf, ptlens[n], buf, outtag, &len)) != CRYPT_OK) return err;
+          if (compare_testvector(buf, ptlens[n], bct, ptlens[n], "OCB3 CT.inplace", x) ||
+              compare_testvector(outtag, len, btag, 16, "OCB3 Tag.inplace", x)) {
+             return CRYPT_FAIL_TESTVECTOR;
+          }
+       }
+    }
+
+    /* ocb3_memory_batch() must give the same result as the single packet functions */
+    x = 103;
+    {
+       static const unsigned long ptlens[] = { 0, 1, 15, 16, 64, 100, 1500, 17 };
+       static const unsigned long noncelens[] = { 12, 12, 15, 12, 1, 12, 12, 0 };
+       ltc_aead_packet pkt[9];
+       unsigned char *buf, *bct, *dec, btag[9][16];
+       unsigned long i, off;
+       int stat;
+
+       if ((buf = XMALLOC(3 * 2000)) == NULL) return CRYPT_MEM;
+       bct = buf + 2000;
+       dec = buf + 4000;
+       for (i = 0; i < 2000; i++) buf[i] = (unsigned char)(i * 11 + 5);
+       XMEMSET(pkt, 0, sizeof(pkt));
+       for (i = off = 0; i < 8; off += ptlens[i++]) {
+          pkt[i].nonce    = buf + 100 + i;
+          pkt[i].noncelen = noncelens[i];
+          pkt[i].aad      = buf + 200;
+          pkt[i].aadlen   = i * 13;
+          pkt[i].in       = buf + off;
+          pkt[i].inlen    = ptlens[i];
+          pkt[i].out      = bct + off;
+          pkt[i].tag      = btag[i];
+          pkt[i].taglen   = i == 2 ? 8 : 16;
+       }
+       /* one packet in place and one with a nonce which is too long */
+       XMEMCPY(bct + 32, buf + 32, ptlens[4]);
+       pkt[4].in = bct + 32;
+       pkt[8] = pkt[0];
+       pkt[8].noncelen = 16;
+
+       err = ocb3_memory_batch(idx, key, sizeof(key), pkt, 9, LTC_ENCRYPT);
+       if (err != CRYPT_INVALID_ARG || pkt[8].err != CRYPT_INVALID_ARG) {
+          err = CRYPT_FAIL_TESTVECTOR;
+          goto LBL_BATCH;
+       }
+       for (i = off = 0; i < 8; off += ptlens[i++]) {
+          len = pkt[i].taglen;
+          if ((err = pkt[i].err) != CRYPT_OK ||
+              (err = ocb3_encrypt_authenticate_memory(idx, key, sizeof(key), pkt[i].nonce, pkt[i].noncelen, pkt[i].aad, pkt[i].aadlen,
+                                                      buf + off, ptlens[i], dec + off, outtag, &len)) != CRYPT_OK) {
+             goto LBL_BATCH;
+          }
+          if (compare_testvector(bct + off, ptlens[i], dec + off, ptlens[i], "OCB3 CT.batch", i) ||
+              compare_testvector(btag[i], pkt[i].taglen, outtag, len, "OCB3 Tag.batch", i)) {
+             err = CRYPT_FAIL_TESTVECTOR;
+             goto LBL_BATCH;
+          }
+          if ((err = ocb3_decrypt_verify_memory(idx, key, sizeof(key), pkt[i].nonce, pkt[i].noncelen, pkt[i].aad, pkt[i].aadlen,
+                                                bct + off, ptlens[i], dec + off, btag[i], pkt[i].taglen, &stat)) != CRYPT_OK) {
+             goto LBL_BATCH;
+          }
+          if (stat != 1) {
+             err = CRYPT_FAIL_TESTVECTOR;
+             goto LBL_BATCH;
+          }
+          pkt[i].in  = bct + off;
+          pkt[i].out = i == 4 ? bct + off : dec + off;
+       }
+
+       /* a corrupted tag only fails its own packet */
+       btag[6][0] ^= 1;
+       err = ocb3_memory_batch(idx, key, sizeof(key), pkt, 8, LTC_DECRYPT);
+       if (err != CRYPT_ERROR) {
+          err = CRYPT_FAIL_TESTVECTOR;
+          goto LBL_BATCH;
+       }
+       for (i = off = 0; i < 8; off += ptlens[i++]) {
+          if (pkt[i].err != (i == 6 ? CRYPT_ERROR : CRYPT_OK) ||
+              (i != 6 && compare_testvector(pkt[i].out, ptlens[i], buf + off, ptlens[i], "OCB3 PT.batch", i))) {
+             err = CRYPT_FAIL_TESTVECTOR;
+             goto LBL_BATCH;
+          }
+       }
+       err = CRYPT_OK;
+LBL_BATCH:
+       XFREE(buf);
+       if (err != CRYPT_OK) return err;
+    }
+
     return CRYPT_OK;
 #endif /* LTC_TEST */
 }
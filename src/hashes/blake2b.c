@@ -176,19 +176,27 @@ static void s_blake2b_init0(hash_state *md)
    }
 }
 
-/* init xors IV with input parameter block */
-static int s_blake2b_init_param(hash_state *md, const unsigned char *P)
+/**
+   Set up a chaining value as IV XOR parameter block
+   @param h   [out] The chaining value
+   @param P   The parameter block of 64 bytes
+*/
+void blake2b_init_h(ulong64 *h, const unsigned char *P)
 {
    unsigned long i;
 
-   s_blake2b_init0(md);
-
-   /* IV XOR ParamBlock */
    for (i = 0; i < 8; ++i) {
       ulong64 tmp;
       LOAD64L(tmp, P + i * 8);
-      md->blake2b.h[i] ^= tmp;
+      h[i] = blake2b_IV[i] ^ tmp;
    }
+}
+
+/* init xors IV with input parameter block */
+static int s_blake2b_init_param(hash_state *md, const unsigned char *P)
+{
+   s_blake2b_init0(md);
+   blake2b_init_h(md->blake2b.h, P);
 
    md->blake2b.outlen = P[O_DIGEST_LENGTH];
    return CRYPT_OK;
@@ -299,9 +307,9 @@ int blake2b_512_init(hash_state *md) { return blake2b_init(md, 64, NULL, 0); }
    } while (0)
 
 #ifdef LTC_CLEAN_STACK
-static int ss_blake2b_compress(hash_state *md, const unsigned char *buf)
+static void ss_blake2b_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
 #else
-static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
+static void s_blake2b_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
 #endif
 {
    ulong64 m[16];
@@ -313,17 +321,17 @@ static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
    }
 
    for (i = 0; i < 8; ++i) {
-      v[i] = md->blake2b.h[i];
+      v[i] = h[i];
    }
 
    v[8] = blake2b_IV[0];
    v[9] = blake2b_IV[1];
    v[10] = blake2b_IV[2];
    v[11] = blake2b_IV[3];
-   v[12] = blake2b_IV[4] ^ md->blake2b.t[0];
-   v[13] = blake2b_IV[5] ^ md->blake2b.t[1];
-   v[14] = blake2b_IV[6] ^ md->blake2b.f[0];
-   v[15] = blake2b_IV[7] ^ md->blake2b.f[1];
+   v[12] = blake2b_IV[4] ^ t[0];
+   v[13] = blake2b_IV[5] ^ t[1];
+   v[14] = blake2b_IV[6] ^ f[0];
+   v[15] = blake2b_IV[7] ^ f[1];
 
    ROUND(0);
    ROUND(1);
@@ -339,24 +347,39 @@ static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
    ROUND(11);
 
    for (i = 0; i < 8; ++i) {
-      md->blake2b.h[i] = md->blake2b.h[i] ^ v[i] ^ v[i + 8];
+      h[i] = h[i] ^ v[i] ^ v[i + 8];
    }
-   return CRYPT_OK;
 }
 
 #undef G
 #undef ROUND
 
 #ifdef LTC_CLEAN_STACK
-static int s_blake2b_compress(hash_state *md, const unsigned char *buf)
+static void s_blake2b_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
 {
-   int err;
-   err = ss_blake2b_compress(md, buf);
+   ss_blake2b_compress(h, buf, t, f);
    burn_stack(sizeof(ulong64) * 32 + sizeof(unsigned long));
-   return err;
 }
 #endif
 
+/**
+   Compress one block, used for the leaves and the root of BLAKE2bp as well
+   @param h     The chaining value
+   @param buf   The block of 128 bytes
+   @param t     The counter of bytes processed including this block
+   @param f     The finalization flags
+*/
+void blake2b_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
+{
+#ifdef LTC_BLAKE2_SIMD
+   if (blake2b_avx2_is_supported()) {
+      blake2b_avx2_compress(h, buf, t, f);
+      return;
+   }
+#endif
+   s_blake2b_compress(h, buf, t, f);
+}
+
 /**
    Process a block of memory through the hash
    @param md     The hash state
@@ -380,12 +403,12 @@ int blake2b_process(hash_state *md, const unsigned char *in, unsigned long inlen
          md->blake2b.curlen = 0;
          XMEMCPY(md->blake2b.buf + (left % sizeof(md->blake2b.buf)), in, fill); /* Fill buffer */
          s_blake2b_increment_counter(md, BLAKE2B_BLOCKBYTES);
-         s_blake2b_compress(md, md->blake2b.buf); /* Compress */
+         blake2b_compress(md->blake2b.h, md->blake2b.buf, md->blake2b.t, md->blake2b.f); /* Compress */
          in += fill;
          inlen -= fill;
          while (inlen > BLAKE2B_BLOCKBYTES) {
             s_blake2b_increment_counter(md, BLAKE2B_BLOCKBYTES);
-            s_blake2b_compress(md, in);
+            blake2b_compress(md->blake2b.h, in, md->blake2b.t, md->blake2b.f);
             in += BLAKE2B_BLOCKBYTES;
             inlen -= BLAKE2B_BLOCKBYTES;
          }
@@ -419,7 +442,7 @@ int blake2b_done(hash_state *md, unsigned char *out)
    s_blake2b_increment_counter(md, md->blake2b.curlen);
    s_blake2b_set_lastblock(md);
    XMEMSET(md->blake2b.buf + md->blake2b.curlen, 0, BLAKE2B_BLOCKBYTES - md->blake2b.curlen); /* Padding */
-   s_blake2b_compress(md, md->blake2b.buf);
+   blake2b_compress(md->blake2b.h, md->blake2b.buf, md->blake2b.t, md->blake2b.f);
 
    for (i = 0; i < 8; ++i) { /* Output full hash to temp buffer */
       STORE64L(md->blake2b.h[i], buffer + i * 8);
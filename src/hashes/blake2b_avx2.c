@@ -0,0 +1,202 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file blake2b_avx2.c
+  BLAKE2b compression with AVX2
+
+  blake2b_avx2_compress() keeps a row of the 4x4 state in each register and
+  runs the four G functions of a column resp. diagonal step at once.
+  blake2b_avx2_compress4() compresses one block of each of the four leaves
+  of BLAKE2bp, every register holds the same state word of the four leaves.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_BLAKE2B) && defined(LTC_BLAKE2_SIMD)
+
+static const ulong64 s_blake2b_avx2_IV[8] =
+{
+  CONST64(0x6a09e667f3bcc908), CONST64(0xbb67ae8584caa73b),
+  CONST64(0x3c6ef372fe94f82b), CONST64(0xa54ff53a5f1d36f1),
+  CONST64(0x510e527fade682d1), CONST64(0x9b05688c2b3e6c1f),
+  CONST64(0x1f83d9abfb41bd6b), CONST64(0x5be0cd19137e2179)
+};
+
+static const unsigned char s_blake2b_avx2_sigma[12][16] =
+{
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 } ,
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 } ,
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 } ,
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 } ,
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 } ,
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 } ,
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 } ,
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 } ,
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13 , 0 } ,
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+/**
+  Check whether the CPU supports AVX2
+  @return 1 if supported, 0 otherwise
+*/
+int blake2b_avx2_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX2) == LTC_CPU_AVX2;
+}
+
+/* rotations by 32, 24 and 16 are byte shuffles, by 63 it's a shift and an add */
+#define BLAKE2B_AVX2_ROR32(x) _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))
+#define BLAKE2B_AVX2_ROR24(x) _mm256_shuffle_epi8(x, r24)
+#define BLAKE2B_AVX2_ROR16(x) _mm256_shuffle_epi8(x, r16)
+#define BLAKE2B_AVX2_ROR63(x) _mm256_xor_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x))
+
+#define BLAKE2B_AVX2_G(a, b, c, d, x, y)                                                                               \
+   do {                                                                                                                \
+      a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);                                                                 \
+      d = BLAKE2B_AVX2_ROR32(_mm256_xor_si256(d, a));                                                                  \
+      c = _mm256_add_epi64(c, d);                                                                                      \
+      b = BLAKE2B_AVX2_ROR24(_mm256_xor_si256(b, c));                                                                  \
+      a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);                                                                 \
+      d = BLAKE2B_AVX2_ROR16(_mm256_xor_si256(d, a));                                                                  \
+      c = _mm256_add_epi64(c, d);                                                                                      \
+      b = BLAKE2B_AVX2_ROR63(_mm256_xor_si256(b, c));                                                                  \
+   } while (0)
+
+#define BLAKE2B_AVX2_M(i0, i1, i2, i3) \
+   _mm256_set_epi64x((long long)m[s[i3]], (long long)m[s[i2]], (long long)m[s[i1]], (long long)m[s[i0]])
+
+/**
+  Compress one block
+  @param h     The chaining value
+  @param buf   The block of 128 bytes
+  @param t     The counter of bytes processed including this block
+  @param f     The finalization flags
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+void blake2b_avx2_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f)
+{
+   const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+   __m256i a, b, c, d, h0, h1;
+   ulong64 m[16];
+   const unsigned char *s;
+   int i;
+
+   for (i = 0; i < 16; ++i) {
+      LOAD64L(m[i], buf + i * 8);
+   }
+
+   a = h0 = _mm256_loadu_si256((const __m256i *)h);
+   b = h1 = _mm256_loadu_si256((const __m256i *)(h + 4));
+   c = _mm256_loadu_si256((const __m256i *)s_blake2b_avx2_IV);
+   d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(s_blake2b_avx2_IV + 4)),
+                        _mm256_set_epi64x((long long)f[1], (long long)f[0], (long long)t[1], (long long)t[0]));
+
+   for (i = 0; i < 12; ++i) {
+      s = s_blake2b_avx2_sigma[i];
+      BLAKE2B_AVX2_G(a, b, c, d, BLAKE2B_AVX2_M(0, 2, 4, 6), BLAKE2B_AVX2_M(1, 3, 5, 7));
+      /* diagonalize */
+      b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+      c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+      BLAKE2B_AVX2_G(a, b, c, d, BLAKE2B_AVX2_M(8, 10, 12, 14), BLAKE2B_AVX2_M(9, 11, 13, 15));
+      b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+      c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+   }
+
+   _mm256_storeu_si256((__m256i *)h, _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));
+   _mm256_storeu_si256((__m256i *)(h + 4), _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));
+}
+
+#undef BLAKE2B_AVX2_M
+
+/* 4x4 transpose of 64-bit words, rows and columns are the leaves resp. words */
+#define BLAKE2B_AVX2_TRANSPOSE(r0, r1, r2, r3)                                                                         \
+   do {                                                                                                                \
+      __m256i t0_ = _mm256_unpacklo_epi64(r0, r1);                                                                     \
+      __m256i t1_ = _mm256_unpackhi_epi64(r0, r1);                                                                     \
+      __m256i t2_ = _mm256_unpacklo_epi64(r2, r3);                                                                     \
+      __m256i t3_ = _mm256_unpackhi_epi64(r2, r3);                                                                     \
+      r0 = _mm256_permute2x128_si256(t0_, t2_, 0x20);                                                                  \
+      r1 = _mm256_permute2x128_si256(t1_, t3_, 0x20);                                                                  \
+      r2 = _mm256_permute2x128_si256(t0_, t2_, 0x31);                                                                  \
+      r3 = _mm256_permute2x128_si256(t1_, t3_, 0x31);                                                                  \
+   } while (0)
+
+/**
+  Compress one block of each of the four leaves of BLAKE2bp, none of them the last one
+  @param h     The chaining values of the leaves, 4 times 8 words
+  @param in    The 4 blocks of 128 bytes, one for each leaf
+  @param t     The counter of bytes processed by each leaf including this block
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+void blake2b_avx2_compress4(ulong64 *h, const unsigned char *in, ulong64 t)
+{
+   const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+   __m256i m[16], v[16], hv[8];
+   const unsigned char *s;
+   int i, j;
+
+   for (j = 0; j < 16; j += 4) {
+      m[j    ] = _mm256_loadu_si256((const __m256i *)(in + 0 * 128 + j * 8));
+      m[j + 1] = _mm256_loadu_si256((const __m256i *)(in + 1 * 128 + j * 8));
+      m[j + 2] = _mm256_loadu_si256((const __m256i *)(in + 2 * 128 + j * 8));
+      m[j + 3] = _mm256_loadu_si256((const __m256i *)(in + 3 * 128 + j * 8));
+      BLAKE2B_AVX2_TRANSPOSE(m[j], m[j + 1], m[j + 2], m[j + 3]);
+   }
+   for (j = 0; j < 8; j += 4) {
+      hv[j    ] = _mm256_loadu_si256((const __m256i *)(h + 0 * 8 + j));
+      hv[j + 1] = _mm256_loadu_si256((const __m256i *)(h + 1 * 8 + j));
+      hv[j + 2] = _mm256_loadu_si256((const __m256i *)(h + 2 * 8 + j));
+      hv[j + 3] = _mm256_loadu_si256((const __m256i *)(h + 3 * 8 + j));
+      BLAKE2B_AVX2_TRANSPOSE(hv[j], hv[j + 1], hv[j + 2], hv[j + 3]);
+   }
+
+   for (j = 0; j < 8; ++j) {
+      v[j] = hv[j];
+      v[j + 8] = _mm256_set1_epi64x((long long)s_blake2b_avx2_IV[j]);
+   }
+   v[12] = _mm256_xor_si256(v[12], _mm256_set1_epi64x((long long)t));
+
+   for (i = 0; i < 12; ++i) {
+      s = s_blake2b_avx2_sigma[i];
+      BLAKE2B_AVX2_G(v[0], v[4], v[ 8], v[12], m[s[ 0]], m[s[ 1]]);
+      BLAKE2B_AVX2_G(v[1], v[5], v[ 9], v[13], m[s[ 2]], m[s[ 3]]);
+      BLAKE2B_AVX2_G(v[2], v[6], v[10], v[14], m[s[ 4]], m[s[ 5]]);
+      BLAKE2B_AVX2_G(v[3], v[7], v[11], v[15], m[s[ 6]], m[s[ 7]]);
+      BLAKE2B_AVX2_G(v[0], v[5], v[10], v[15], m[s[ 8]], m[s[ 9]]);
+      BLAKE2B_AVX2_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+      BLAKE2B_AVX2_G(v[2], v[7], v[ 8], v[13], m[s[12]], m[s[13]]);
+      BLAKE2B_AVX2_G(v[3], v[4], v[ 9], v[14], m[s[14]], m[s[15]]);
+   }
+
+   for (j = 0; j < 8; ++j) {
+      hv[j] = _mm256_xor_si256(hv[j], _mm256_xor_si256(v[j], v[j + 8]));
+   }
+   for (j = 0; j < 8; j += 4) {
+      BLAKE2B_AVX2_TRANSPOSE(hv[j], hv[j + 1], hv[j + 2], hv[j + 3]);
+      _mm256_storeu_si256((__m256i *)(h + 0 * 8 + j), hv[j    ]);
+      _mm256_storeu_si256((__m256i *)(h + 1 * 8 + j), hv[j + 1]);
+      _mm256_storeu_si256((__m256i *)(h + 2 * 8 + j), hv[j + 2]);
+      _mm256_storeu_si256((__m256i *)(h + 3 * 8 + j), hv[j + 3]);
+   }
+}
+
+#undef BLAKE2B_AVX2_TRANSPOSE
+#undef BLAKE2B_AVX2_G
+#undef BLAKE2B_AVX2_ROR63
+#undef BLAKE2B_AVX2_ROR16
+#undef BLAKE2B_AVX2_ROR24
+#undef BLAKE2B_AVX2_ROR32
+
+#endif
@@ -0,0 +1,328 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file blake2bp.c
+   BLAKE2bp, the 4-way parallel mode of BLAKE2b [RFC 7693 / blake2.net]
+
+   The input is distributed round-robin in blocks of 128 bytes over 4 leaves
+   of a tree of depth 2, the root hashes the 4 leaf digests.  Every leaf
+   keeps its last block buffered until it is known whether more input for
+   this leaf follows, just like a single BLAKE2b does.  With LTC_BLAKE2_SIMD
+   the 4 leaves are compressed at once with AVX2.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2BP
+
+enum blake2bp_constant {
+   BLAKE2BP_LEAVES = 4,
+   BLAKE2B_BLOCKBYTES = 128,
+   BLAKE2B_OUTBYTES = 64,
+   BLAKE2B_KEYBYTES = 64,
+   BLAKE2B_PARAM_SIZE = 64
+};
+
+/* param offsets */
+enum {
+   O_DIGEST_LENGTH = 0,
+   O_KEY_LENGTH = 1,
+   O_FANOUT = 2,
+   O_DEPTH = 3,
+   O_NODE_OFFSET = 8,
+   O_NODE_DEPTH = 16,
+   O_INNER_LENGTH = 17
+};
+
+const struct ltc_hash_descriptor blake2bp_512_desc =
+{
+    "blake2bp-512",
+    34,
+    64,
+    128,
+
+    /* OID ... does not exist */
+   { 0 },
+   0,
+
+    &blake2bp_512_init,
+    &blake2bp_process,
+    &blake2bp_done,
+    &blake2bp_512_test,
+    NULL
+};
+
+/* the parameter block of a leaf (node_depth 0) or of the root (node_depth 1) */
+static void s_blake2bp_param(unsigned char *P, unsigned long outlen, unsigned long keylen,
+                             unsigned long node_offset, unsigned char node_depth)
+{
+   XMEMSET(P, 0, BLAKE2B_PARAM_SIZE);
+   P[O_DIGEST_LENGTH] = (unsigned char)outlen;
+   P[O_KEY_LENGTH] = (unsigned char)keylen;
+   P[O_FANOUT] = BLAKE2BP_LEAVES;
+   P[O_DEPTH] = 2;
+   STORE64L((ulong64)node_offset, P + O_NODE_OFFSET);
+   P[O_NODE_DEPTH] = node_depth;
+   P[O_INNER_LENGTH] = BLAKE2B_OUTBYTES;
+}
+
+/**
+   Initialize the hash/MAC state
+
+      Use this function to init for arbitrary sizes.
+
+      Give a key and keylen to init for MAC mode.
+
+   @param md      The hash state you wish to initialize
+   @param outlen  The desired output-length
+   @param key     The key of the MAC
+   @param keylen  The length of the key
+   @return CRYPT_OK if successful
+*/
+int blake2bp_init(hash_state *md, unsigned long outlen, const unsigned char *key, unsigned long keylen)
+{
+   unsigned char P[BLAKE2B_PARAM_SIZE];
+   unsigned long i;
+
+   LTC_ARGCHK(md != NULL);
+
+   if ((!outlen) || (outlen > BLAKE2B_OUTBYTES)) {
+      return CRYPT_INVALID_ARG;
+   }
+   if ((key && !keylen) || (keylen && !key) || (keylen > BLAKE2B_KEYBYTES)) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   XMEMSET(&md->blake2bp, 0, sizeof(md->blake2bp));
+   for (i = 0; i < BLAKE2BP_LEAVES; ++i) {
+      s_blake2bp_param(P, outlen, keylen, i, 0);
+      blake2b_init_h(md->blake2bp.h[i], P);
+   }
+   md->blake2bp.outlen = outlen;
+   md->blake2bp.keylen = keylen;
+
+   /* every leaf starts with the key block, which is its last one until more input arrives */
+   if (key) {
+      for (i = 0; i < BLAKE2BP_LEAVES; ++i) {
+         XMEMCPY(md->blake2bp.buf[i], key, keylen);
+         md->blake2bp.buflen[i] = BLAKE2B_BLOCKBYTES;
+      }
+   }
+
+   return CRYPT_OK;
+}
+
+/**
+   Initialize the hash state
+   @param md   The hash state you wish to initialize
+   @return CRYPT_OK if successful
+*/
+int blake2bp_512_init(hash_state *md) { return blake2bp_init(md, 64, NULL, 0); }
+
+/* compress the buffered block of leaf i, more input for this leaf follows */
+static void s_blake2bp_compress_leaf(hash_state *md, unsigned long i)
+{
+   ulong64 t[2], f[2] = { 0, 0 };
+
+   md->blake2bp.t[i] += BLAKE2B_BLOCKBYTES;
+   t[0] = md->blake2bp.t[i];
+   t[1] = 0;
+   blake2b_compress(md->blake2bp.h[i], md->blake2bp.buf[i], t, f);
+   md->blake2bp.buflen[i] = 0;
+}
+
+/**
+   Process a block of memory through the hash
+   @param md     The hash state
+   @param in     The data to hash
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int blake2bp_process(hash_state *md, const unsigned char *in, unsigned long inlen)
+{
+   unsigned long i, n;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(in != NULL);
+
+   if (md->blake2bp.cur >= BLAKE2BP_LEAVES) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   while (inlen > 0) {
+      i = md->blake2bp.cur;
+      if (md->blake2bp.buflen[i] == BLAKE2B_BLOCKBYTES) {
+#ifdef LTC_BLAKE2_SIMD
+         /* all leaves hold a full block and every one of them gets another one */
+         if (i == 0 && inlen > (BLAKE2BP_LEAVES - 1) * BLAKE2B_BLOCKBYTES && blake2b_avx2_is_supported()) {
+            for (n = 0; n < BLAKE2BP_LEAVES; ++n) {
+               md->blake2bp.t[n] += BLAKE2B_BLOCKBYTES;
+               md->blake2bp.buflen[n] = 0;
+            }
+            blake2b_avx2_compress4(md->blake2bp.h[0], md->blake2bp.buf[0], md->blake2bp.t[0]);
+            while (inlen > (2 * BLAKE2BP_LEAVES - 1) * BLAKE2B_BLOCKBYTES) {
+               for (n = 0; n < BLAKE2BP_LEAVES; ++n) {
+                  md->blake2bp.t[n] += BLAKE2B_BLOCKBYTES;
+               }
+               blake2b_avx2_compress4(md->blake2bp.h[0], in, md->blake2bp.t[0]);
+               in += BLAKE2BP_LEAVES * BLAKE2B_BLOCKBYTES;
+               inlen -= BLAKE2BP_LEAVES * BLAKE2B_BLOCKBYTES;
+            }
+            continue;
+         }
+#endif
+         s_blake2bp_compress_leaf(md, i);
+      }
+      n = MIN(BLAKE2B_BLOCKBYTES - md->blake2bp.buflen[i], inlen);
+      XMEMCPY(md->blake2bp.buf[i] + md->blake2bp.buflen[i], in, n);
+      md->blake2bp.buflen[i] += n;
+      in += n;
+      inlen -= n;
+      if (md->blake2bp.buflen[i] == BLAKE2B_BLOCKBYTES) {
+         md->blake2bp.cur = (i + 1) % BLAKE2BP_LEAVES;
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Terminate the hash to get the digest
+   @param md  The hash state
+   @param out [out] The destination of the hash (size depending on the length used on init)
+   @return CRYPT_OK if successful
+*/
+int blake2bp_done(hash_state *md, unsigned char *out)
+{
+   unsigned char P[BLAKE2B_PARAM_SIZE];
+   unsigned char leaves[BLAKE2BP_LEAVES * BLAKE2B_OUTBYTES];
+   ulong64 h[8], t[2], f[2];
+   unsigned long i, j;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(out != NULL);
+
+   if (md->blake2bp.cur >= BLAKE2BP_LEAVES) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* the buffered block of every leaf is its last one, the last leaf is the last node */
+   for (i = 0; i < BLAKE2BP_LEAVES; ++i) {
+      XMEMSET(md->blake2bp.buf[i] + md->blake2bp.buflen[i], 0, BLAKE2B_BLOCKBYTES - md->blake2bp.buflen[i]);
+      t[0] = md->blake2bp.t[i] + md->blake2bp.buflen[i];
+      t[1] = 0;
+      f[0] = CONST64(0xffffffffffffffff);
+      f[1] = (i == BLAKE2BP_LEAVES - 1) ? CONST64(0xffffffffffffffff) : 0;
+      blake2b_compress(md->blake2bp.h[i], md->blake2bp.buf[i], t, f);
+      for (j = 0; j < 8; ++j) {
+         STORE64L(md->blake2bp.h[i][j], leaves + i * BLAKE2B_OUTBYTES + j * 8);
+      }
+   }
+
+   /* the root hashes the leaf digests, which are exactly 2 blocks */
+   s_blake2bp_param(P, md->blake2bp.outlen, md->blake2bp.keylen, 0, 1);
+   blake2b_init_h(h, P);
+   t[0] = BLAKE2B_BLOCKBYTES;
+   t[1] = 0;
+   f[0] = f[1] = 0;
+   blake2b_compress(h, leaves, t, f);
+   t[0] += BLAKE2B_BLOCKBYTES;
+   f[0] = f[1] = CONST64(0xffffffffffffffff);
+   blake2b_compress(h, leaves + BLAKE2B_BLOCKBYTES, t, f);
+
+   for (j = 0; j < 8; ++j) { /* Output full hash to temp buffer */
+      STORE64L(h[j], leaves + j * 8);
+   }
+   XMEMCPY(out, leaves, md->blake2bp.outlen);
+   zeromem(md, sizeof(hash_state));
+#ifdef LTC_CLEAN_STACK
+   zeromem(leaves, sizeof(leaves));
+   zeromem(h, sizeof(h));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+  Self-test the hash
+  @return CRYPT_OK if successful, CRYPT_NOP if self-tests have been disabled
+*/
+int blake2bp_512_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const struct {
+      const char *msg;
+      unsigned char hash[64];
+  } tests[] = {
+    { "",
+      { 0xb5, 0xef, 0x81, 0x1a, 0x80, 0x38, 0xf7, 0x0b,
+        0x62, 0x8f, 0xa8, 0xb2, 0x94, 0xda, 0xae, 0x74,
+        0x92, 0xb1, 0xeb, 0xe3, 0x43, 0xa8, 0x0e, 0xaa,
+        0xbb, 0xf1, 0xf6, 0xae, 0x66, 0x4d, 0xd6, 0x7b,
+        0x9d, 0x90, 0xb0, 0x12, 0x07, 0x91, 0xea, 0xb8,
+        0x1d, 0xc9, 0x69, 0x85, 0xf2, 0x88, 0x49, 0xf6,
+        0xa3, 0x05, 0x18, 0x6a, 0x85, 0x50, 0x1b, 0x40,
+        0x51, 0x14, 0xbf, 0xa6, 0x78, 0xdf, 0x93, 0x80 } },
+    { "abc",
+      { 0xb9, 0x1a, 0x6b, 0x66, 0xae, 0x87, 0x52, 0x6c,
+        0x40, 0x0b, 0x0a, 0x8b, 0x53, 0x77, 0x4d, 0xc6,
+        0x52, 0x84, 0xad, 0x8f, 0x65, 0x75, 0xf8, 0x14,
+        0x8f, 0xf9, 0x3d, 0xff, 0x94, 0x3a, 0x6e, 0xcd,
+        0x83, 0x62, 0x13, 0x0f, 0x22, 0xd6, 0xda, 0xe6,
+        0x33, 0xaa, 0x0f, 0x91, 0xdf, 0x4a, 0xc8, 0x9a,
+        0xaf, 0xf3, 0x1d, 0x0f, 0x1b, 0x92, 0x3c, 0x89,
+        0x8e, 0x82, 0x02, 0x5d, 0xed, 0xbd, 0xad, 0x6e } },
+    { NULL, { 0 } }
+  };
+   /* 2000 bytes 00 01 .. ff 00 01 .., many leaf blocks */
+   static const unsigned char long_hash[64] = {
+      0x00, 0xf7, 0x22, 0x5f, 0xfd, 0x39, 0x73, 0x8b,
+      0x39, 0xc6, 0x4b, 0x1f, 0x9b, 0xc4, 0xea, 0x3a,
+      0x8b, 0x68, 0xd3, 0x49, 0x87, 0x02, 0x63, 0x64,
+      0x53, 0x2d, 0xae, 0x32, 0xea, 0x07, 0x42, 0x1e,
+      0x03, 0x56, 0x6e, 0xb9, 0x36, 0xff, 0x4f, 0x7e,
+      0x63, 0xb7, 0xc7, 0x83, 0xc2, 0x0e, 0xdb, 0x64,
+      0x2c, 0x82, 0xa8, 0xa3, 0x55, 0x49, 0x89, 0xdd,
+      0x63, 0x57, 0x25, 0x6e, 0x61, 0xa0, 0xb1, 0x93
+   };
+   static const unsigned long chunks[] = { 2000, 1000, 513, 129, 7, 1 };
+
+   int i;
+   unsigned long j, n;
+   unsigned char tmp[64], *buf;
+   hash_state md;
+
+   for (i = 0; tests[i].msg != NULL; i++) {
+      blake2bp_512_init(&md);
+      blake2bp_process(&md, (unsigned char *)tests[i].msg, (unsigned long)XSTRLEN(tests[i].msg));
+      blake2bp_done(&md, tmp);
+      if (compare_testvector(tmp, sizeof(tmp), tests[i].hash, sizeof(tests[i].hash), "BLAKE2BP_512", i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
+   if ((buf = XMALLOC(2000)) == NULL) {
+      return CRYPT_MEM;
+   }
+   for (j = 0; j < 2000; j++) {
+      buf[j] = (unsigned char)j;
+   }
+   for (i = 0; i < (int)(sizeof(chunks) / sizeof(chunks[0])); i++) {
+      blake2bp_512_init(&md);
+      for (j = 0; j < 2000; j += n) {
+         n = MIN(chunks[i], 2000 - j);
+         blake2bp_process(&md, buf + j, n);
+      }
+      blake2bp_done(&md, tmp);
+      if (compare_testvector(tmp, sizeof(tmp), long_hash, sizeof(long_hash), "BLAKE2BP_512 long", i)) {
+         XFREE(buf);
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   XFREE(buf);
+   return CRYPT_OK;
+#endif
+}
+
+#endif
@@ -170,19 +170,27 @@ static int s_blake2s_init0(hash_state *md)
    return CRYPT_OK;
 }
 
-/* init2 xors IV with input parameter block */
-static int s_blake2s_init_param(hash_state *md, const unsigned char *P)
+/**
+   Set up a chaining value as IV XOR parameter block
+   @param h   [out] The chaining value
+   @param P   The parameter block of 32 bytes
+*/
+void blake2s_init_h(ulong32 *h, const unsigned char *P)
 {
    unsigned long i;
 
-   s_blake2s_init0(md);
-
-   /* IV XOR ParamBlock */
    for (i = 0; i < 8; ++i) {
       ulong32 tmp;
       LOAD32L(tmp, P + i * 4);
-      md->blake2s.h[i] ^= tmp;
+      h[i] = blake2s_IV[i] ^ tmp;
    }
+}
+
+/* init2 xors IV with input parameter block */
+static int s_blake2s_init_param(hash_state *md, const unsigned char *P)
+{
+   s_blake2s_init0(md);
+   blake2s_init_h(md->blake2s.h, P);
 
    md->blake2s.outlen = P[O_DIGEST_LENGTH];
    return CRYPT_OK;
@@ -291,9 +299,9 @@ int blake2s_256_init(hash_state *md) { return blake2s_init(md, 32, NULL, 0); }
    } while (0)
 
 #ifdef LTC_CLEAN_STACK
-static int ss_blake2s_compress(hash_state *md, const unsigned char *buf)
+static void ss_blake2s_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
 #else
-static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
+static void s_blake2s_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
 #endif
 {
    unsigned long i;
@@ -305,17 +313,17 @@ static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
    }
 
    for (i = 0; i < 8; ++i) {
-      v[i] = md->blake2s.h[i];
+      v[i] = h[i];
    }
 
    v[8] = blake2s_IV[0];
    v[9] = blake2s_IV[1];
    v[10] = blake2s_IV[2];
    v[11] = blake2s_IV[3];
-   v[12] = md->blake2s.t[0] ^ blake2s_IV[4];
-   v[13] = md->blake2s.t[1] ^ blake2s_IV[5];
-   v[14] = md->blake2s.f[0] ^ blake2s_IV[6];
-   v[15] = md->blake2s.f[1] ^ blake2s_IV[7];
+   v[12] = t[0] ^ blake2s_IV[4];
+   v[13] = t[1] ^ blake2s_IV[5];
+   v[14] = f[0] ^ blake2s_IV[6];
+   v[15] = f[1] ^ blake2s_IV[7];
 
    ROUND(0);
    ROUND(1);
@@ -329,23 +337,38 @@ static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
    ROUND(9);
 
    for (i = 0; i < 8; ++i) {
-      md->blake2s.h[i] = md->blake2s.h[i] ^ v[i] ^ v[i + 8];
+      h[i] = h[i] ^ v[i] ^ v[i + 8];
    }
-   return CRYPT_OK;
 }
 #undef G
 #undef ROUND
 
 #ifdef LTC_CLEAN_STACK
-static int s_blake2s_compress(hash_state *md, const unsigned char *buf)
+static void s_blake2s_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
 {
-   int err;
-   err = ss_blake2s_compress(md, buf);
+   ss_blake2s_compress(h, buf, t, f);
    burn_stack(sizeof(ulong32) * (32) + sizeof(unsigned long));
-   return err;
 }
 #endif
 
+/**
+   Compress one block, used for the leaves and the root of BLAKE2sp as well
+   @param h     The chaining value
+   @param buf   The block of 64 bytes
+   @param t     The counter of bytes processed including this block
+   @param f     The finalization flags
+*/
+void blake2s_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
+{
+#ifdef LTC_BLAKE2_SIMD
+   if (blake2s_sse41_is_supported()) {
+      blake2s_sse41_compress(h, buf, t, f);
+      return;
+   }
+#endif
+   s_blake2s_compress(h, buf, t, f);
+}
+
 /**
    Process a block of memory through the hash
    @param md     The hash state
@@ -369,12 +392,12 @@ int blake2s_process(hash_state *md, const unsigned char *in, unsigned long inlen
          md->blake2s.curlen = 0;
          XMEMCPY(md->blake2s.buf + (left % sizeof(md->blake2s.buf)), in, fill); /* Fill buffer */
          s_blake2s_increment_counter(md, BLAKE2S_BLOCKBYTES);
-         s_blake2s_compress(md, md->blake2s.buf); /* Compress */
+         blake2s_compress(md->blake2s.h, md->blake2s.buf, md->blake2s.t, md->blake2s.f); /* Compress */
          in += fill;
          inlen -= fill;
          while (inlen > BLAKE2S_BLOCKBYTES) {
             s_blake2s_increment_counter(md, BLAKE2S_BLOCKBYTES);
-            s_blake2s_compress(md, in);
+            blake2s_compress(md->blake2s.h, in, md->blake2s.t, md->blake2s.f);
             in += BLAKE2S_BLOCKBYTES;
             inlen -= BLAKE2S_BLOCKBYTES;
          }
@@ -407,7 +430,7 @@ int blake2s_done(hash_state *md, unsigned char *out)
    s_blake2s_increment_counter(md, md->blake2s.curlen);
    s_blake2s_set_lastblock(md);
    XMEMSET(md->blake2s.buf + md->blake2s.curlen, 0, BLAKE2S_BLOCKBYTES - md->blake2s.curlen); /* Padding */
-   s_blake2s_compress(md, md->blake2s.buf);
+   blake2s_compress(md->blake2s.h, md->blake2s.buf, md->blake2s.t, md->blake2s.f);
 
    for (i = 0; i < 8; ++i) { /* Output full hash to temp buffer */
       STORE32L(md->blake2s.h[i], buffer + i * 4);
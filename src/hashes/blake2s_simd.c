@@ -0,0 +1,223 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file blake2s_simd.c
+  BLAKE2s compression with SSE4.1 and AVX2
+
+  blake2s_sse41_compress() keeps a row of the 4x4 state in each register and
+  runs the four G functions of a column resp. diagonal step at once.
+  blake2s_avx2_compress8() compresses one block of each of the eight leaves
+  of BLAKE2sp, every register holds the same state word of the eight leaves.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_BLAKE2S) && defined(LTC_BLAKE2_SIMD)
+
+static const ulong32 s_blake2s_simd_IV[8] = {
+   0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+   0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL
+};
+
+static const unsigned char s_blake2s_simd_sigma[10][16] = {
+   { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+   { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+   { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+   { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+   { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+   { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+   { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+   { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+   { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+   { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+};
+
+/**
+  Check whether the CPU supports SSE4.1
+  @return 1 if supported, 0 otherwise
+*/
+int blake2s_sse41_is_supported(void)
+{
+   return (ltc_cpu_features() & (LTC_CPU_SSSE3 | LTC_CPU_SSE41)) == (LTC_CPU_SSSE3 | LTC_CPU_SSE41);
+}
+
+/**
+  Check whether the CPU supports AVX2
+  @return 1 if supported, 0 otherwise
+*/
+int blake2s_avx2_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX2) == LTC_CPU_AVX2;
+}
+
+/* rotations by 16 and 8 are byte shuffles, by 12 and 7 shifts */
+#define BLAKE2S_SSE41_ROR(x, n) _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+
+#define BLAKE2S_SSE41_G(a, b, c, d, x, y)                                                                              \
+   do {                                                                                                                \
+      a = _mm_add_epi32(_mm_add_epi32(a, b), x);                                                                       \
+      d = _mm_shuffle_epi8(_mm_xor_si128(d, a), r16);                                                                  \
+      c = _mm_add_epi32(c, d);                                                                                         \
+      b = BLAKE2S_SSE41_ROR(_mm_xor_si128(b, c), 12);                                                                  \
+      a = _mm_add_epi32(_mm_add_epi32(a, b), y);                                                                       \
+      d = _mm_shuffle_epi8(_mm_xor_si128(d, a), r8);                                                                   \
+      c = _mm_add_epi32(c, d);                                                                                         \
+      b = BLAKE2S_SSE41_ROR(_mm_xor_si128(b, c), 7);                                                                   \
+   } while (0)
+
+#define BLAKE2S_SSE41_M(i0, i1, i2, i3) \
+   _mm_set_epi32((int)m[s[i3]], (int)m[s[i2]], (int)m[s[i1]], (int)m[s[i0]])
+
+/**
+  Compress one block
+  @param h     The chaining value
+  @param buf   The block of 64 bytes
+  @param t     The counter of bytes processed including this block
+  @param f     The finalization flags
+*/
+LTC_ATTRIBUTE((__target__("ssse3,sse4.1")))
+void blake2s_sse41_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f)
+{
+   const __m128i r16 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+   const __m128i r8 = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+   __m128i a, b, c, d, h0, h1;
+   ulong32 m[16];
+   const unsigned char *s;
+   int i;
+
+   for (i = 0; i < 16; ++i) {
+      LOAD32L(m[i], buf + i * 4);
+   }
+
+   a = h0 = _mm_loadu_si128((const __m128i *)h);
+   b = h1 = _mm_loadu_si128((const __m128i *)(h + 4));
+   c = _mm_loadu_si128((const __m128i *)s_blake2s_simd_IV);
+   d = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(s_blake2s_simd_IV + 4)),
+                     _mm_set_epi32((int)f[1], (int)f[0], (int)t[1], (int)t[0]));
+
+   for (i = 0; i < 10; ++i) {
+      s = s_blake2s_simd_sigma[i];
+      BLAKE2S_SSE41_G(a, b, c, d, BLAKE2S_SSE41_M(0, 2, 4, 6), BLAKE2S_SSE41_M(1, 3, 5, 7));
+      /* diagonalize */
+      b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+      c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm_shuffle_epi32(d, _MM_SHUFFLE(2, 1, 0, 3));
+      BLAKE2S_SSE41_G(a, b, c, d, BLAKE2S_SSE41_M(8, 10, 12, 14), BLAKE2S_SSE41_M(9, 11, 13, 15));
+      b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3));
+      c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+      d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0, 3, 2, 1));
+   }
+
+   _mm_storeu_si128((__m128i *)h, _mm_xor_si128(h0, _mm_xor_si128(a, c)));
+   _mm_storeu_si128((__m128i *)(h + 4), _mm_xor_si128(h1, _mm_xor_si128(b, d)));
+}
+
+#undef BLAKE2S_SSE41_M
+#undef BLAKE2S_SSE41_G
+#undef BLAKE2S_SSE41_ROR
+
+#define BLAKE2S_AVX2_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+#define BLAKE2S_AVX2_G(a, b, c, d, x, y)                                                                               \
+   do {                                                                                                                \
+      a = _mm256_add_epi32(_mm256_add_epi32(a, b), x);                                                                 \
+      d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), r16);                                                            \
+      c = _mm256_add_epi32(c, d);                                                                                      \
+      b = BLAKE2S_AVX2_ROR(_mm256_xor_si256(b, c), 12);                                                                \
+      a = _mm256_add_epi32(_mm256_add_epi32(a, b), y);                                                                 \
+      d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), r8);                                                             \
+      c = _mm256_add_epi32(c, d);                                                                                      \
+      b = BLAKE2S_AVX2_ROR(_mm256_xor_si256(b, c), 7);                                                                 \
+   } while (0)
+
+/* 8x8 transpose of 32-bit words, rows and columns are the leaves resp. words */
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_blake2s_avx2_transpose(__m256i *r)
+{
+   __m256i t0, t1, t2, t3, t4, t5, t6, t7, u0, u1, u2, u3, u4, u5, u6, u7;
+
+   t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+   t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+   t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+   t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+   t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+   t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+   t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+   t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+   u0 = _mm256_unpacklo_epi64(t0, t2);
+   u1 = _mm256_unpackhi_epi64(t0, t2);
+   u2 = _mm256_unpacklo_epi64(t1, t3);
+   u3 = _mm256_unpackhi_epi64(t1, t3);
+   u4 = _mm256_unpacklo_epi64(t4, t6);
+   u5 = _mm256_unpackhi_epi64(t4, t6);
+   u6 = _mm256_unpacklo_epi64(t5, t7);
+   u7 = _mm256_unpackhi_epi64(t5, t7);
+   r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+   r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+   r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+   r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+   r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+   r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+   r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+   r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/**
+  Compress one block of each of the eight leaves of BLAKE2sp, none of them the last one
+  @param h     The chaining values of the leaves, 8 times 8 words
+  @param in    The 8 blocks of 64 bytes, one for each leaf
+  @param t     The counter of bytes processed by each leaf including this block
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+void blake2s_avx2_compress8(ulong32 *h, const unsigned char *in, ulong64 t)
+{
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+   const __m256i r8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+                                       1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+   __m256i m[16], v[16], hv[8];
+   const unsigned char *s;
+   int i, j;
+
+   for (j = 0; j < 8; ++j) {
+      m[j] = _mm256_loadu_si256((const __m256i *)(in + j * 64));
+      m[j + 8] = _mm256_loadu_si256((const __m256i *)(in + j * 64 + 32));
+      hv[j] = _mm256_loadu_si256((const __m256i *)(h + j * 8));
+   }
+   s_blake2s_avx2_transpose(m);
+   s_blake2s_avx2_transpose(m + 8);
+   s_blake2s_avx2_transpose(hv);
+
+   for (j = 0; j < 8; ++j) {
+      v[j] = hv[j];
+      v[j + 8] = _mm256_set1_epi32((int)s_blake2s_simd_IV[j]);
+   }
+   v[12] = _mm256_xor_si256(v[12], _mm256_set1_epi32((int)(ulong32)t));
+   v[13] = _mm256_xor_si256(v[13], _mm256_set1_epi32((int)(ulong32)(t >> 32)));
+
+   for (i = 0; i < 10; ++i) {
+      s = s_blake2s_simd_sigma[i];
+      BLAKE2S_AVX2_G(v[0], v[4], v[ 8], v[12], m[s[ 0]], m[s[ 1]]);
+      BLAKE2S_AVX2_G(v[1], v[5], v[ 9], v[13], m[s[ 2]], m[s[ 3]]);
+      BLAKE2S_AVX2_G(v[2], v[6], v[10], v[14], m[s[ 4]], m[s[ 5]]);
+      BLAKE2S_AVX2_G(v[3], v[7], v[11], v[15], m[s[ 6]], m[s[ 7]]);
+      BLAKE2S_AVX2_G(v[0], v[5], v[10], v[15], m[s[ 8]], m[s[ 9]]);
+      BLAKE2S_AVX2_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+      BLAKE2S_AVX2_G(v[2], v[7], v[ 8], v[13], m[s[12]], m[s[13]]);
+      BLAKE2S_AVX2_G(v[3], v[4], v[ 9], v[14], m[s[14]], m[s[15]]);
+   }
+
+   for (j = 0; j < 8; ++j) {
+      hv[j] = _mm256_xor_si256(hv[j], _mm256_xor_si256(v[j], v[j + 8]));
+   }
+   s_blake2s_avx2_transpose(hv);
+   for (j = 0; j < 8; ++j) {
+      _mm256_storeu_si256((__m256i *)(h + j * 8), hv[j]);
+   }
+}
+
+#undef BLAKE2S_AVX2_G
+#undef BLAKE2S_AVX2_ROR
+
+#endif
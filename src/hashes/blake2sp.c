@@ -0,0 +1,320 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file blake2sp.c
+   BLAKE2sp, the 8-way parallel mode of BLAKE2s [RFC 7693 / blake2.net]
+
+   The input is distributed round-robin in blocks of 64 bytes over 8 leaves
+   of a tree of depth 2, the root hashes the 8 leaf digests.  Every leaf
+   keeps its last block buffered until it is known whether more input for
+   this leaf follows, just like a single BLAKE2s does.  With LTC_BLAKE2_SIMD
+   the 8 leaves are compressed at once with AVX2.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2SP
+
+enum blake2sp_constant {
+   BLAKE2SP_LEAVES = 8,
+   BLAKE2S_BLOCKBYTES = 64,
+   BLAKE2S_OUTBYTES = 32,
+   BLAKE2S_KEYBYTES = 32,
+   BLAKE2S_PARAM_SIZE = 32
+};
+
+/* param offsets */
+enum {
+   O_DIGEST_LENGTH = 0,
+   O_KEY_LENGTH = 1,
+   O_FANOUT = 2,
+   O_DEPTH = 3,
+   O_NODE_OFFSET = 8,
+   O_NODE_DEPTH = 14,
+   O_INNER_LENGTH = 15
+};
+
+const struct ltc_hash_descriptor blake2sp_256_desc =
+{
+    "blake2sp-256",
+    35,
+    32,
+    64,
+
+    /* OID ... does not exist */
+   { 0 },
+   0,
+
+    &blake2sp_256_init,
+    &blake2sp_process,
+    &blake2sp_done,
+    &blake2sp_256_test,
+    NULL
+};
+
+/* the parameter block of a leaf (node_depth 0) or of the root (node_depth 1) */
+static void s_blake2sp_param(unsigned char *P, unsigned long outlen, unsigned long keylen,
+                             unsigned long node_offset, unsigned char node_depth)
+{
+   XMEMSET(P, 0, BLAKE2S_PARAM_SIZE);
+   P[O_DIGEST_LENGTH] = (unsigned char)outlen;
+   P[O_KEY_LENGTH] = (unsigned char)keylen;
+   P[O_FANOUT] = BLAKE2SP_LEAVES;
+   P[O_DEPTH] = 2;
+   STORE32L((ulong32)node_offset, P + O_NODE_OFFSET);
+   P[O_NODE_DEPTH] = node_depth;
+   P[O_INNER_LENGTH] = BLAKE2S_OUTBYTES;
+}
+
+/**
+   Initialize the hash/MAC state
+
+      Use this function to init for arbitrary sizes.
+
+      Give a key and keylen to init for MAC mode.
+
+   @param md      The hash state you wish to initialize
+   @param outlen  The desired output-length
+   @param key     The key of the MAC
+   @param keylen  The length of the key
+   @return CRYPT_OK if successful
+*/
+int blake2sp_init(hash_state *md, unsigned long outlen, const unsigned char *key, unsigned long keylen)
+{
+   unsigned char P[BLAKE2S_PARAM_SIZE];
+   unsigned long i;
+
+   LTC_ARGCHK(md != NULL);
+
+   if ((!outlen) || (outlen > BLAKE2S_OUTBYTES)) {
+      return CRYPT_INVALID_ARG;
+   }
+   if ((key && !keylen) || (keylen && !key) || (keylen > BLAKE2S_KEYBYTES)) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   XMEMSET(&md->blake2sp, 0, sizeof(md->blake2sp));
+   for (i = 0; i < BLAKE2SP_LEAVES; ++i) {
+      s_blake2sp_param(P, outlen, keylen, i, 0);
+      blake2s_init_h(md->blake2sp.h[i], P);
+   }
+   md->blake2sp.outlen = outlen;
+   md->blake2sp.keylen = keylen;
+
+   /* every leaf starts with the key block, which is its last one until more input arrives */
+   if (key) {
+      for (i = 0; i < BLAKE2SP_LEAVES; ++i) {
+         XMEMCPY(md->blake2sp.buf[i], key, keylen);
+         md->blake2sp.buflen[i] = BLAKE2S_BLOCKBYTES;
+      }
+   }
+
+   return CRYPT_OK;
+}
+
+/**
+   Initialize the hash state
+   @param md   The hash state you wish to initialize
+   @return CRYPT_OK if successful
+*/
+int blake2sp_256_init(hash_state *md) { return blake2sp_init(md, 32, NULL, 0); }
+
+/* compress the buffered block of leaf i, more input for this leaf follows */
+static void s_blake2sp_compress_leaf(hash_state *md, unsigned long i)
+{
+   ulong32 t[2], f[2] = { 0, 0 };
+
+   md->blake2sp.t[i] += BLAKE2S_BLOCKBYTES;
+   t[0] = (ulong32)md->blake2sp.t[i];
+   t[1] = (ulong32)(md->blake2sp.t[i] >> 32);
+   blake2s_compress(md->blake2sp.h[i], md->blake2sp.buf[i], t, f);
+   md->blake2sp.buflen[i] = 0;
+}
+
+/**
+   Process a block of memory through the hash
+   @param md     The hash state
+   @param in     The data to hash
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int blake2sp_process(hash_state *md, const unsigned char *in, unsigned long inlen)
+{
+   unsigned long i, n;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(in != NULL);
+
+   if (md->blake2sp.cur >= BLAKE2SP_LEAVES) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   while (inlen > 0) {
+      i = md->blake2sp.cur;
+      if (md->blake2sp.buflen[i] == BLAKE2S_BLOCKBYTES) {
+#ifdef LTC_BLAKE2_SIMD
+         /* all leaves hold a full block and every one of them gets another one */
+         if (i == 0 && inlen > (BLAKE2SP_LEAVES - 1) * BLAKE2S_BLOCKBYTES && blake2s_avx2_is_supported()) {
+            for (n = 0; n < BLAKE2SP_LEAVES; ++n) {
+               md->blake2sp.t[n] += BLAKE2S_BLOCKBYTES;
+               md->blake2sp.buflen[n] = 0;
+            }
+            blake2s_avx2_compress8(md->blake2sp.h[0], md->blake2sp.buf[0], md->blake2sp.t[0]);
+            while (inlen > (2 * BLAKE2SP_LEAVES - 1) * BLAKE2S_BLOCKBYTES) {
+               for (n = 0; n < BLAKE2SP_LEAVES; ++n) {
+                  md->blake2sp.t[n] += BLAKE2S_BLOCKBYTES;
+               }
+               blake2s_avx2_compress8(md->blake2sp.h[0], in, md->blake2sp.t[0]);
+               in += BLAKE2SP_LEAVES * BLAKE2S_BLOCKBYTES;
+               inlen -= BLAKE2SP_LEAVES * BLAKE2S_BLOCKBYTES;
+            }
+            continue;
+         }
+#endif
+         s_blake2sp_compress_leaf(md, i);
+      }
+      n = MIN(BLAKE2S_BLOCKBYTES - md->blake2sp.buflen[i], inlen);
+      XMEMCPY(md->blake2sp.buf[i] + md->blake2sp.buflen[i], in, n);
+      md->blake2sp.buflen[i] += n;
+      in += n;
+      inlen -= n;
+      if (md->blake2sp.buflen[i] == BLAKE2S_BLOCKBYTES) {
+         md->blake2sp.cur = (i + 1) % BLAKE2SP_LEAVES;
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Terminate the hash to get the digest
+   @param md  The hash state
+   @param out [out] The destination of the hash (size depending on the length used on init)
+   @return CRYPT_OK if successful
+*/
+int blake2sp_done(hash_state *md, unsigned char *out)
+{
+   unsigned char P[BLAKE2S_PARAM_SIZE];
+   unsigned char leaves[BLAKE2SP_LEAVES * BLAKE2S_OUTBYTES];
+   ulong32 h[8], t[2], f[2];
+   ulong64 len;
+   unsigned long i, j;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(out != NULL);
+
+   if (md->blake2sp.cur >= BLAKE2SP_LEAVES) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   /* the buffered block of every leaf is its last one, the last leaf is the last node */
+   for (i = 0; i < BLAKE2SP_LEAVES; ++i) {
+      XMEMSET(md->blake2sp.buf[i] + md->blake2sp.buflen[i], 0, BLAKE2S_BLOCKBYTES - md->blake2sp.buflen[i]);
+      len = md->blake2sp.t[i] + md->blake2sp.buflen[i];
+      t[0] = (ulong32)len;
+      t[1] = (ulong32)(len >> 32);
+      f[0] = 0xffffffffUL;
+      f[1] = (i == BLAKE2SP_LEAVES - 1) ? 0xffffffffUL : 0;
+      blake2s_compress(md->blake2sp.h[i], md->blake2sp.buf[i], t, f);
+      for (j = 0; j < 8; ++j) {
+         STORE32L(md->blake2sp.h[i][j], leaves + i * BLAKE2S_OUTBYTES + j * 4);
+      }
+   }
+
+   /* the root hashes the leaf digests, which are exactly 4 blocks */
+   s_blake2sp_param(P, md->blake2sp.outlen, md->blake2sp.keylen, 0, 1);
+   blake2s_init_h(h, P);
+   t[1] = 0;
+   f[0] = f[1] = 0;
+   for (i = 0; i < sizeof(leaves); i += BLAKE2S_BLOCKBYTES) {
+      t[0] = (ulong32)(i + BLAKE2S_BLOCKBYTES);
+      if (i + BLAKE2S_BLOCKBYTES == sizeof(leaves)) {
+         f[0] = f[1] = 0xffffffffUL;
+      }
+      blake2s_compress(h, leaves + i, t, f);
+   }
+
+   for (j = 0; j < 8; ++j) { /* Output full hash to temp buffer */
+      STORE32L(h[j], leaves + j * 4);
+   }
+   XMEMCPY(out, leaves, md->blake2sp.outlen);
+   zeromem(md, sizeof(hash_state));
+#ifdef LTC_CLEAN_STACK
+   zeromem(leaves, sizeof(leaves));
+   zeromem(h, sizeof(h));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+  Self-test the hash
+  @return CRYPT_OK if successful, CRYPT_NOP if self-tests have been disabled
+*/
+int blake2sp_256_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const struct {
+      const char *msg;
+      unsigned char hash[32];
+  } tests[] = {
+    { "",
+      { 0xdd, 0x0e, 0x89, 0x17, 0x76, 0x93, 0x3f, 0x43,
+        0xc7, 0xd0, 0x32, 0xb0, 0x8a, 0x91, 0x7e, 0x25,
+        0x74, 0x1f, 0x8a, 0xa9, 0xa1, 0x2c, 0x12, 0xe1,
+        0xca, 0xc8, 0x80, 0x15, 0x00, 0xf2, 0xca, 0x4f } },
+    { "abc",
+      { 0x70, 0xf7, 0x5b, 0x58, 0xf1, 0xfe, 0xca, 0xb8,
+        0x21, 0xdb, 0x43, 0xc8, 0x8a, 0xd8, 0x4e, 0xdd,
+        0xe5, 0xa5, 0x26, 0x00, 0x61, 0x6c, 0xd2, 0x25,
+        0x17, 0xb7, 0xbb, 0x14, 0xd4, 0x40, 0xa7, 0xd5 } },
+    { NULL, { 0 } }
+  };
+   /* 2000 bytes 00 01 .. ff 00 01 .., many leaf blocks */
+   static const unsigned char long_hash[32] = {
+      0x10, 0x00, 0xa2, 0xf4, 0xa8, 0xc3, 0x04, 0xef,
+      0x08, 0x0f, 0xdb, 0x87, 0x70, 0xf9, 0xd6, 0xbb,
+      0xe2, 0xdd, 0x05, 0x87, 0xa1, 0x12, 0x4c, 0x39,
+      0x19, 0xaf, 0xd8, 0x5e, 0x2b, 0xf3, 0x12, 0x41
+   };
+   static const unsigned long chunks[] = { 2000, 1000, 513, 129, 7, 1 };
+
+   int i;
+   unsigned long j, n;
+   unsigned char tmp[32], *buf;
+   hash_state md;
+
+   for (i = 0; tests[i].msg != NULL; i++) {
+      blake2sp_256_init(&md);
+      blake2sp_process(&md, (unsigned char *)tests[i].msg, (unsigned long)XSTRLEN(tests[i].msg));
+      blake2sp_done(&md, tmp);
+      if (compare_testvector(tmp, sizeof(tmp), tests[i].hash, sizeof(tests[i].hash), "BLAKE2SP_256", i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
+   if ((buf = XMALLOC(2000)) == NULL) {
+      return CRYPT_MEM;
+   }
+   for (j = 0; j < 2000; j++) {
+      buf[j] = (unsigned char)j;
+   }
+   for (i = 0; i < (int)(sizeof(chunks) / sizeof(chunks[0])); i++) {
+      blake2sp_256_init(&md);
+      for (j = 0; j < 2000; j += n) {
+         n = MIN(chunks[i], 2000 - j);
+         blake2sp_process(&md, buf + j, n);
+      }
+      blake2sp_done(&md, tmp);
+      if (compare_testvector(tmp, sizeof(tmp), long_hash, sizeof(long_hash), "BLAKE2SP_256 long", i)) {
+         XFREE(buf);
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   XFREE(buf);
+   return CRYPT_OK;
+#endif
+}
+
+#endif
@@ -0,0 +1,1012 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+   @file blake3.c
+   BLAKE3 [https://github.com/BLAKE3-team/BLAKE3-specs]
+
+   The input is cut into chunks of 1024 bytes which are the leaves of a
+   binary tree.  The current chunk is hashed block by block, the chaining
+   values of complete subtrees on its left are kept on a stack and merged
+   lazily, since the last of them might turn out to be the root.  When a
+   single call hands over whole subtrees, their chunks resp. parent nodes
+   are compressed many at a time: 8 with AVX2 resp. 16 with AVX-512 if
+   LTC_BLAKE3_SIMD is defined, and large subtrees are split over up to
+   LTC_BLAKE3_MT_THREADS threads if LTC_BLAKE3_MT is defined.
+
+   This follows the structure of the BLAKE3 reference implementation.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE3
+
+enum blake3_constant {
+   BLAKE3_BLOCK_LEN = 64,
+   BLAKE3_CHUNK_LEN = 1024,
+   BLAKE3_OUT_LEN = 32,
+   BLAKE3_KEY_LEN = 32,
+   BLAKE3_MAX_SIMD_DEGREE = 16
+};
+
+/* domain separation flags */
+enum {
+   CHUNK_START = 1,
+   CHUNK_END = 2,
+   PARENT = 4,
+   ROOT = 8,
+   KEYED_HASH = 16,
+   DERIVE_KEY_CONTEXT = 32,
+   DERIVE_KEY_MATERIAL = 64
+};
+
+#ifdef LTC_BLAKE3_MT
+/* a subtree is only split over two threads if its left half has at least this size */
+#define BLAKE3_MT_MIN_LEN  (512uL * 1024uL)
+#define BLAKE3_THREADS     LTC_BLAKE3_MT_THREADS
+#else
+#define BLAKE3_THREADS     1
+#endif
+
+const struct ltc_hash_descriptor blake3_desc =
+{
+    "blake3",
+    36,
+    32,
+    64,
+
+    /* OID ... does not exist */
+   { 0 },
+   0,
+
+    &blake3_init,
+    &blake3_process,
+    &blake3_done,
+    &blake3_test,
+    NULL
+};
+
+static const ulong32 blake3_IV[8] = {
+    0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+    0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL
+};
+
+/* the message words of each round, i.e. the permutation applied 0..6 times */
+static const unsigned char blake3_schedule[7][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+    { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+    { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+    { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+    { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+    { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+};
+
+/* a node whose chaining value resp. output is not computed yet */
+struct s_blake3_output {
+   ulong32 cv[8];
+   unsigned char block[BLAKE3_BLOCK_LEN];
+   unsigned long block_len;
+   ulong64 counter;
+   unsigned long flags;
+};
+
+#define G(r, i, a, b, c, d)                                                                                            \
+   do {                                                                                                                \
+      a = a + b + m[blake3_schedule[r][2 * i + 0]];                                                                    \
+      d = RORc(d ^ a, 16);                                                                                             \
+      c = c + d;                                                                                                       \
+      b = RORc(b ^ c, 12);                                                                                             \
+      a = a + b + m[blake3_schedule[r][2 * i + 1]];                                                                    \
+      d = RORc(d ^ a, 8);                                                                                              \
+      c = c + d;                                                                                                       \
+      b = RORc(b ^ c, 7);                                                                                              \
+   } while (0)
+
+#define ROUND(r)                                                                                                       \
+   do {                                                                                                                \
+      G(r, 0, v[0], v[4], v[8], v[12]);                                                                                \
+      G(r, 1, v[1], v[5], v[9], v[13]);                                                                                \
+      G(r, 2, v[2], v[6], v[10], v[14]);                                                                               \
+      G(r, 3, v[3], v[7], v[11], v[15]);                                                                               \
+      G(r, 4, v[0], v[5], v[10], v[15]);                                                                               \
+      G(r, 5, v[1], v[6], v[11], v[12]);                                                                               \
+      G(r, 6, v[2], v[7], v[8], v[13]);                                                                                \
+      G(r, 7, v[3], v[4], v[9], v[14]);                                                                                \
+   } while (0)
+
+static void s_blake3_compress(const ulong32 *cv, const unsigned char *block, unsigned long block_len,
+                              ulong64 counter, unsigned long flags, ulong32 *v)
+{
+   ulong32 m[16];
+   unsigned long i;
+
+   for (i = 0; i < 16; ++i) {
+      LOAD32L(m[i], block + i * 4);
+   }
+   for (i = 0; i < 8; ++i) {
+      v[i] = cv[i];
+   }
+   v[8] = blake3_IV[0];
+   v[9] = blake3_IV[1];
+   v[10] = blake3_IV[2];
+   v[11] = blake3_IV[3];
+   v[12] = (ulong32)counter;
+   v[13] = (ulong32)(counter >> 32);
+   v[14] = (ulong32)block_len;
+   v[15] = (ulong32)flags;
+
+   ROUND(0);
+   ROUND(1);
+   ROUND(2);
+   ROUND(3);
+   ROUND(4);
+   ROUND(5);
+   ROUND(6);
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(m, sizeof(m));
+#endif
+}
+
+#undef G
+#undef ROUND
+
+static void s_blake3_compress_in_place(ulong32 *cv, const unsigned char *block, unsigned long block_len,
+                                       ulong64 counter, unsigned long flags)
+{
+   ulong32 v[16];
+   unsigned long i;
+
+   s_blake3_compress(cv, block, block_len, counter, flags, v);
+   for (i = 0; i < 8; ++i) {
+      cv[i] = v[i] ^ v[i + 8];
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(v, sizeof(v));
+#endif
+}
+
+/* the 64 bytes of output block number counter of a root node */
+static void s_blake3_compress_xof(const ulong32 *cv, const unsigned char *block, unsigned long block_len,
+                                  ulong64 counter, unsigned long flags, unsigned char *out)
+{
+   ulong32 v[16];
+   unsigned long i;
+
+   s_blake3_compress(cv, block, block_len, counter, flags, v);
+   for (i = 0; i < 8; ++i) {
+      STORE32L(v[i] ^ v[i + 8], out + i * 4);
+      STORE32L(v[i + 8] ^ cv[i], out + 32 + i * 4);
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(v, sizeof(v));
+#endif
+}
+
+static void s_blake3_hash_one(const unsigned char *in, unsigned long blocks, const ulong32 *key, ulong64 counter,
+                              unsigned long flags, unsigned long flags_start, unsigned long flags_end,
+                              unsigned char *out)
+{
+   ulong32 cv[8];
+   unsigned long i, f;
+
+   for (i = 0; i < 8; ++i) {
+      cv[i] = key[i];
+   }
+   for (f = flags | flags_start; blocks > 0; --blocks, in += BLAKE3_BLOCK_LEN, f = flags) {
+      if (blocks == 1) {
+         f |= flags_end;
+      }
+      s_blake3_compress_in_place(cv, in, BLAKE3_BLOCK_LEN, counter, f);
+   }
+   for (i = 0; i < 8; ++i) {
+      STORE32L(cv[i], out + i * 4);
+   }
+}
+
+/* hash num inputs of the same number of blocks, i.e. whole chunks or parent nodes */
+static void s_blake3_hash_many(const unsigned char * const *in, unsigned long num, unsigned long blocks,
+                               const ulong32 *key, ulong64 counter, int inc, unsigned long flags,
+                               unsigned long flags_start, unsigned long flags_end, unsigned char *out)
+{
+#ifdef LTC_BLAKE3_SIMD
+   if (num >= 16 && blake3_avx512_is_supported()) {
+      for (; num >= 16; num -= 16, in += 16, out += 16 * BLAKE3_OUT_LEN) {
+         blake3_avx512_hash16(in, blocks, key, counter, inc, flags, flags_start, flags_end, out);
+         if (inc) counter += 16;
+      }
+   }
+   if (num >= 8 && blake3_avx2_is_supported()) {
+      for (; num >= 8; num -= 8, in += 8, out += 8 * BLAKE3_OUT_LEN) {
+         blake3_avx2_hash8(in, blocks, key, counter, inc, flags, flags_start, flags_end, out);
+         if (inc) counter += 8;
+      }
+   }
+#endif
+   for (; num > 0; --num, ++in, out += BLAKE3_OUT_LEN) {
+      s_blake3_hash_one(*in, blocks, key, counter, flags, flags_start, flags_end, out);
+      if (inc) counter += 1;
+   }
+}
+
+/* how many inputs s_blake3_hash_many() processes at once */
+static unsigned long s_blake3_simd_degree(void)
+{
+#ifdef LTC_BLAKE3_SIMD
+   if (blake3_avx512_is_supported()) return 16;
+   if (blake3_avx2_is_supported()) return 8;
+#endif
+   return 1;
+}
+
+static ulong64 s_blake3_round_down_pow2(ulong64 x)
+{
+   ulong64 p = 1;
+   while (p <= x / 2) {
+      p <<= 1;
+   }
+   return p;
+}
+
+static unsigned long s_blake3_popcount(ulong64 x)
+{
+   unsigned long n = 0;
+   while (x != 0) {
+      x &= x - 1;
+      ++n;
+   }
+   return n;
+}
+
+static unsigned long s_blake3_compress_chunks(const unsigned char *in, unsigned long inlen, const ulong32 *key,
+                                              ulong64 counter, unsigned long flags, unsigned char *out)
+{
+   const unsigned char *chunks[BLAKE3_MAX_SIMD_DEGREE];
+   unsigned long n;
+
+   for (n = 0; n * BLAKE3_CHUNK_LEN < inlen; ++n) {
+      chunks[n] = in + n * BLAKE3_CHUNK_LEN;
+   }
+   s_blake3_hash_many(chunks, n, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, key, counter, 1,
+                      flags, CHUNK_START, CHUNK_END, out);
+   return n;
+}
+
+/* combine pairs of chaining values, an odd one is passed through */
+static unsigned long s_blake3_compress_parents(const unsigned char *cvs, unsigned long num, const ulong32 *key,
+                                               unsigned long flags, unsigned char *out)
+{
+   const unsigned char *parents[BLAKE3_MAX_SIMD_DEGREE];
+   unsigned long n;
+
+   for (n = 0; num - 2 * n >= 2; ++n) {
+      parents[n] = cvs + 2 * n * BLAKE3_OUT_LEN;
+   }
+   s_blake3_hash_many(parents, n, 1, key, 0, 0, flags | PARENT, 0, 0, out);
+   if (num & 1) {
+      XMEMCPY(out + n * BLAKE3_OUT_LEN, cvs + 2 * n * BLAKE3_OUT_LEN, BLAKE3_OUT_LEN);
+      return n + 1;
+   }
+   return n;
+}
+
+/*
+   Hash a subtree of whole chunks down to at most MAX(degree, 2) chaining
+   values, the caller reduces them further.  The left part is the largest
+   power of two of chunks which leaves at least one byte for the right part.
+*/
+static unsigned long s_blake3_subtree(const unsigned char *in, unsigned long inlen, const ulong32 *key,
+                                      ulong64 counter, unsigned long flags, unsigned long degree,
+                                      unsigned long threads, unsigned char *out);
+
+#ifdef LTC_BLAKE3_MT
+struct s_blake3_job {
+   const unsigned char *in;
+   unsigned long inlen;
+   const ulong32 *key;
+   ulong64 counter;
+   unsigned long flags, degree, threads, n;
+   unsigned char *out;
+};
+
+static void* s_blake3_thread(void *arg)
+{
+   struct s_blake3_job *job = arg;
+   job->n = s_blake3_subtree(job->in, job->inlen, job->key, job->counter, job->flags,
+                             job->degree, job->threads, job->out);
+   return NULL;
+}
+#endif
+
+static unsigned long s_blake3_subtree(const unsigned char *in, unsigned long inlen, const ulong32 *key,
+                                      ulong64 counter, unsigned long flags, unsigned long degree,
+                                      unsigned long threads, unsigned char *out)
+{
+   unsigned char cvs[2 * BLAKE3_MAX_SIMD_DEGREE * BLAKE3_OUT_LEN];
+   unsigned long left_len, left_n, right_n, right_threads, width;
+#ifdef LTC_BLAKE3_MT
+   struct s_blake3_job job;
+   pthread_t thread;
+   int spawned = 0;
+#endif
+
+   if (inlen <= degree * BLAKE3_CHUNK_LEN) {
+      return s_blake3_compress_chunks(in, inlen, key, counter, flags, out);
+   }
+
+   left_len = (unsigned long)s_blake3_round_down_pow2((inlen - 1) / BLAKE3_CHUNK_LEN) * BLAKE3_CHUNK_LEN;
+   /* without SIMD the left part still yields two chaining values */
+   width = (degree == 1 && left_len > BLAKE3_CHUNK_LEN) ? 2 : degree;
+   right_threads = threads;
+
+#ifdef LTC_BLAKE3_MT
+   if (threads > 1 && left_len >= BLAKE3_MT_MIN_LEN) {
+      job.in = in;
+      job.inlen = left_len;
+      job.key = key;
+      job.counter = counter;
+      job.flags = flags;
+      job.degree = degree;
+      job.threads = threads / 2;
+      job.out = cvs;
+      if (pthread_create(&thread, NULL, s_blake3_thread, &job) == 0) {
+         spawned = 1;
+         right_threads = threads - threads / 2;
+      }
+   }
+#endif
+
+   right_n = s_blake3_subtree(in + left_len, inlen - left_len, key, counter + left_len / BLAKE3_CHUNK_LEN,
+                              flags, degree, right_threads, cvs + width * BLAKE3_OUT_LEN);
+#ifdef LTC_BLAKE3_MT
+   if (spawned) {
+      pthread_join(thread, NULL);
+      left_n = job.n;
+   } else
+#endif
+   {
+      left_n = s_blake3_subtree(in, left_len, key, counter, flags, degree, threads, cvs);
+   }
+
+   if (left_n == 1) {
+      /* only one chunk on each side, the caller combines them */
+      XMEMCPY(out, cvs, 2 * BLAKE3_OUT_LEN);
+      return 2;
+   }
+   return s_blake3_compress_parents(cvs, left_n + right_n, key, flags, out);
+}
+
+/* hash a subtree of at least two chunks down to the chaining values of its two children */
+static void s_blake3_subtree_children(const unsigned char *in, unsigned long inlen, const ulong32 *key,
+                                      ulong64 counter, unsigned long flags, unsigned char *out)
+{
+   unsigned char cvs[BLAKE3_MAX_SIMD_DEGREE * BLAKE3_OUT_LEN], tmp[BLAKE3_MAX_SIMD_DEGREE / 2 * BLAKE3_OUT_LEN];
+   unsigned long n;
+
+   n = s_blake3_subtree(in, inlen, key, counter, flags, s_blake3_simd_degree(), BLAKE3_THREADS, cvs);
+   while (n > 2) {
+      n = s_blake3_compress_parents(cvs, n, key, flags, tmp);
+      XMEMCPY(cvs, tmp, n * BLAKE3_OUT_LEN);
+   }
+   XMEMCPY(out, cvs, 2 * BLAKE3_OUT_LEN);
+}
+
+static unsigned long s_blake3_chunk_len(const struct blake3_state *s)
+{
+   return s->blocks * BLAKE3_BLOCK_LEN + s->buflen;
+}
+
+static unsigned long s_blake3_start_flag(const struct blake3_state *s)
+{
+   return s->blocks == 0 ? CHUNK_START : 0;
+}
+
+static void s_blake3_chunk_reset(struct blake3_state *s, ulong64 counter)
+{
+   XMEMCPY(s->cv, s->key, sizeof(s->cv));
+   XMEMSET(s->buf, 0, sizeof(s->buf));
+   s->chunk_counter = counter;
+   s->buflen = 0;
+   s->blocks = 0;
+}
+
+/* the last block of a chunk is kept in buf, it is compressed once it is known which flags it needs */
+static void s_blake3_chunk_update(struct blake3_state *s, const unsigned char *in, unsigned long inlen)
+{
+   unsigned long n;
+
+   if (s->buflen > 0) {
+      n = MIN(BLAKE3_BLOCK_LEN - s->buflen, inlen);
+      XMEMCPY(s->buf + s->buflen, in, n);
+      s->buflen += n;
+      in += n;
+      inlen -= n;
+      if (inlen == 0) {
+         return;
+      }
+      s_blake3_compress_in_place(s->cv, s->buf, BLAKE3_BLOCK_LEN, s->chunk_counter, s->flags | s_blake3_start_flag(s));
+      s->blocks++;
+      s->buflen = 0;
+      XMEMSET(s->buf, 0, sizeof(s->buf));
+   }
+   while (inlen > BLAKE3_BLOCK_LEN) {
+      s_blake3_compress_in_place(s->cv, in, BLAKE3_BLOCK_LEN, s->chunk_counter, s->flags | s_blake3_start_flag(s));
+      s->blocks++;
+      in += BLAKE3_BLOCK_LEN;
+      inlen -= BLAKE3_BLOCK_LEN;
+   }
+   XMEMCPY(s->buf, in, inlen);
+   s->buflen = inlen;
+}
+
+static void s_blake3_chunk_output(const struct blake3_state *s, struct s_blake3_output *o)
+{
+   XMEMCPY(o->cv, s->cv, sizeof(o->cv));
+   XMEMCPY(o->block, s->buf, sizeof(o->block));
+   o->block_len = s->buflen;
+   o->counter = s->chunk_counter;
+   o->flags = s->flags | s_blake3_start_flag(s) | CHUNK_END;
+}
+
+static void s_blake3_parent_output(const struct blake3_state *s, const unsigned char *block, struct s_blake3_output *o)
+{
+   XMEMCPY(o->cv, s->key, sizeof(o->cv));
+   XMEMCPY(o->block, block, sizeof(o->block));
+   o->block_len = BLAKE3_BLOCK_LEN;
+   o->counter = 0;
+   o->flags = s->flags | PARENT;
+}
+
+static void s_blake3_output_cv(const struct s_blake3_output *o, unsigned char *cv)
+{
+   ulong32 h[8];
+   unsigned long i;
+
+   XMEMCPY(h, o->cv, sizeof(h));
+   s_blake3_compress_in_place(h, o->block, o->block_len, o->counter, o->flags);
+   for (i = 0; i < 8; ++i) {
+      STORE32L(h[i], cv + i * 4);
+   }
+}
+
+/* merge the stack down to one entry per 1 bit in the number of chunks so far */
+static void s_blake3_merge_cv_stack(struct blake3_state *s, ulong64 chunks)
+{
+   struct s_blake3_output o;
+   unsigned char *node;
+
+   while (s->cv_stack_len > s_blake3_popcount(chunks)) {
+      node = s->cv_stack + (s->cv_stack_len - 2) * BLAKE3_OUT_LEN;
+      s_blake3_parent_output(s, node, &o);
+      s_blake3_output_cv(&o, node);
+      s->cv_stack_len--;
+   }
+}
+
+static void s_blake3_push_cv(struct blake3_state *s, const unsigned char *cv, ulong64 counter)
+{
+   s_blake3_merge_cv_stack(s, counter);
+   XMEMCPY(s->cv_stack + s->cv_stack_len * BLAKE3_OUT_LEN, cv, BLAKE3_OUT_LEN);
+   s->cv_stack_len++;
+}
+
+static void s_blake3_init(struct blake3_state *s, const ulong32 *key, unsigned long flags)
+{
+   XMEMSET(s, 0, sizeof(*s));
+   XMEMCPY(s->key, key, sizeof(s->key));
+   XMEMCPY(s->cv, key, sizeof(s->cv));
+   s->flags = flags;
+}
+
+/**
+   Initialize the hash state
+   @param md   The hash state you wish to initialize
+   @return CRYPT_OK if successful
+*/
+int blake3_init(hash_state *md)
+{
+   LTC_ARGCHK(md != NULL);
+
+   s_blake3_init(&md->blake3, blake3_IV, 0);
+   return CRYPT_OK;
+}
+
+/**
+   Initialize the hash state for the keyed hash mode
+   @param md      The hash state you wish to initialize
+   @param key     The key
+   @param keylen  The length of the key, must be 32
+   @return CRYPT_OK if successful
+*/
+int blake3_init_keyed(hash_state *md, const unsigned char *key, unsigned long keylen)
+{
+   ulong32 k[8];
+   unsigned long i;
+
+   LTC_ARGCHK(md  != NULL);
+   LTC_ARGCHK(key != NULL);
+
+   if (keylen != BLAKE3_KEY_LEN) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+   for (i = 0; i < 8; ++i) {
+      LOAD32L(k[i], key + i * 4);
+   }
+   s_blake3_init(&md->blake3, k, KEYED_HASH);
+#ifdef LTC_CLEAN_STACK
+   zeromem(k, sizeof(k));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+   Initialize the hash state for the key derivation mode
+
+      The key material is passed with blake3_process(), the derived key
+      of any length is read with blake3_xof_done().
+
+   @param md          The hash state you wish to initialize
+   @param context     The context string
+   @param contextlen  The length of the context string (octets)
+   @return CRYPT_OK if successful
+*/
+int blake3_init_derive_key(hash_state *md, const unsigned char *context, unsigned long contextlen)
+{
+   unsigned char buf[BLAKE3_KEY_LEN];
+   ulong32 k[8];
+   unsigned long i;
+   int err;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(context != NULL || contextlen == 0);
+
+   s_blake3_init(&md->blake3, blake3_IV, DERIVE_KEY_CONTEXT);
+   if ((err = blake3_process(md, context, contextlen)) != CRYPT_OK) {
+      return err;
+   }
+   if ((err = blake3_xof_done(md, buf, sizeof(buf))) != CRYPT_OK) {
+      return err;
+   }
+   for (i = 0; i < 8; ++i) {
+      LOAD32L(k[i], buf + i * 4);
+   }
+   s_blake3_init(&md->blake3, k, DERIVE_KEY_MATERIAL);
+#ifdef LTC_CLEAN_STACK
+   zeromem(buf, sizeof(buf));
+   zeromem(k, sizeof(k));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+   Process a block of memory through the hash
+   @param md     The hash state
+   @param in     The data to hash
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int blake3_process(hash_state *md, const unsigned char *in, unsigned long inlen)
+{
+   struct blake3_state *s;
+   struct s_blake3_output o;
+   unsigned char cv[2 * BLAKE3_OUT_LEN];
+   const unsigned char *p;
+   unsigned long n, sub;
+
+   LTC_ARGCHK(md != NULL);
+   LTC_ARGCHK(in != NULL || inlen == 0);
+
+   s = &md->blake3;
+   if (s->xof_flag) {
+      return CRYPT_ERROR;
+   }
+   if (inlen == 0) {
+      return CRYPT_OK;
+   }
+
+   /* complete the current chunk, it is pushed once more input follows */
+   if (s_blake3_chunk_len(s) > 0) {
+      n = MIN(BLAKE3_CHUNK_LEN - s_blake3_chunk_len(s), inlen);
+      s_blake3_chunk_update(s, in, n);
+      in += n;
+      inlen -= n;
+      if (inlen == 0) {
+         return CRYPT_OK;
+      }
+      s_blake3_chunk_output(s, &o);
+      s_blake3_output_cv(&o, cv);
+      s_blake3_push_cv(s, cv, s->chunk_counter);
+      s_blake3_chunk_reset(s, s->chunk_counter + 1);
+   }
+
+   /* hash the largest complete subtrees which fit, the last byte always stays in the chunk */
+   while (inlen > BLAKE3_CHUNK_LEN) {
+      sub = (unsigned long)s_blake3_round_down_pow2(inlen);
+      while ((((ulong64)sub - 1) & (s->chunk_counter * BLAKE3_CHUNK_LEN)) != 0) {
+         sub /= 2;
+      }
+      if (sub == BLAKE3_CHUNK_LEN) {
+         p = in;
+         s_blake3_hash_many(&p, 1, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, s->key, s->chunk_counter, 1,
+                            s->flags, CHUNK_START, CHUNK_END, cv);
+         s_blake3_push_cv(s, cv, s->chunk_counter);
+      } else {
+         s_blake3_subtree_children(in, sub, s->key, s->chunk_counter, s->flags, cv);
+         s_blake3_push_cv(s, cv, s->chunk_counter);
+         s_blake3_push_cv(s, cv + BLAKE3_OUT_LEN, s->chunk_counter + sub / BLAKE3_CHUNK_LEN / 2);
+      }
+      s->chunk_counter += sub / BLAKE3_CHUNK_LEN;
+      in += sub;
+      inlen -= sub;
+   }
+
+   if (inlen > 0) {
+      s_blake3_chunk_update(s, in, inlen);
+      s_blake3_merge_cv_stack(s, s->chunk_counter);
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(&o, sizeof(o));
+   zeromem(cv, sizeof(cv));
+#endif
+   return CRYPT_OK;
+}
+
+/* the root node: the current chunk, merged with the stack from right to left */
+static void s_blake3_root(const struct blake3_state *s, struct s_blake3_output *o)
+{
+   unsigned char block[BLAKE3_BLOCK_LEN];
+   unsigned long n;
+
+   if (s_blake3_chunk_len(s) > 0 || s->cv_stack_len == 0) {
+      n = s->cv_stack_len;
+      s_blake3_chunk_output(s, o);
+   } else {
+      n = s->cv_stack_len - 2;
+      s_blake3_parent_output(s, s->cv_stack + n * BLAKE3_OUT_LEN, o);
+   }
+   while (n > 0) {
+      --n;
+      XMEMCPY(block, s->cv_stack + n * BLAKE3_OUT_LEN, BLAKE3_OUT_LEN);
+      s_blake3_output_cv(o, block + BLAKE3_OUT_LEN);
+      s_blake3_parent_output(s, block, o);
+   }
+}
+
+/**
+   Terminate the hash and read the output of arbitrary length
+
+      This function can be called many times to continue the output,
+      the hash state can not be processed any further afterwards.
+
+   @param md      The hash state
+   @param out     [out] The destination of the output
+   @param outlen  The length of the output (octets)
+   @return CRYPT_OK if successful
+*/
+int blake3_xof_done(hash_state *md, unsigned char *out, unsigned long outlen)
+{
+   struct blake3_state *s;
+   struct s_blake3_output o;
+   unsigned long n;
+
+   LTC_ARGCHK(md  != NULL);
+   LTC_ARGCHK(out != NULL || outlen == 0);
+
+   s = &md->blake3;
+   if (!s->xof_flag) {
+      /* from now on cv, buf and buflen hold the root node, chunk_counter the next output block */
+      s_blake3_root(s, &o);
+      XMEMCPY(s->cv, o.cv, sizeof(s->cv));
+      XMEMCPY(s->buf, o.block, sizeof(s->buf));
+      s->buflen = o.block_len;
+      s->flags = o.flags | ROOT;
+      s->chunk_counter = 0;
+      s->xof_pos = BLAKE3_BLOCK_LEN;
+      s->xof_flag = 1;
+#ifdef LTC_CLEAN_STACK
+      zeromem(&o, sizeof(o));
+#endif
+   }
+
+   while (outlen > 0) {
+      if (s->xof_pos == BLAKE3_BLOCK_LEN) {
+         s_blake3_compress_xof(s->cv, s->buf, s->buflen, s->chunk_counter++, s->flags, s->xof);
+         s->xof_pos = 0;
+      }
+      n = MIN(BLAKE3_BLOCK_LEN - s->xof_pos, outlen);
+      XMEMCPY(out, s->xof + s->xof_pos, n);
+      s->xof_pos += n;
+      out += n;
+      outlen -= n;
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Terminate the hash to get the digest
+   @param md  The hash state
+   @param out [out] The destination of the hash (32 bytes)
+   @return CRYPT_OK if successful
+*/
+int blake3_done(hash_state *md, unsigned char *out)
+{
+   int err;
+
+   LTC_ARGCHK(md  != NULL);
+   LTC_ARGCHK(out != NULL);
+
+   err = blake3_xof_done(md, out, BLAKE3_OUT_LEN);
+#ifdef LTC_CLEAN_STACK
+   zeromem(md, sizeof(hash_state));
+#endif
+   return err;
+}
+
+/**
+  Self-test the hash
+  @return CRYPT_OK if successful, CRYPT_NOP if self-tests have been disabled
+*/
+int blake3_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const unsigned long lens[10] = { 0, 1, 1023, 1024, 1025, 2049, 8193, 16385, 31744, 102400 };
+   static const unsigned long pieces[5] = { 1, 63, 1000, 4097, 65536 };
+   static const unsigned char key[32] = { 'w', 'h', 'a', 't', 's', ' ', 't', 'h', 'e', ' ', 'E', 'l', 'v', 'i', 's', 'h',
+                                          ' ', 'w', 'o', 'r', 'd', ' ', 'f', 'o', 'r', ' ', 'f', 'r', 'i', 'e', 'n', 'd' };
+   static const char context[] = "BLAKE3 2019-12-27 16:29:52 test vectors context";
+   static const unsigned char hash[10][32] = {
+      { /* 0 */
+        0xaf, 0x13, 0x49, 0xb9, 0xf5, 0xf9, 0xa1, 0xa6,
+        0xa0, 0x40, 0x4d, 0xea, 0x36, 0xdc, 0xc9, 0x49,
+        0x9b, 0xcb, 0x25, 0xc9, 0xad, 0xc1, 0x12, 0xb7,
+        0xcc, 0x9a, 0x93, 0xca, 0xe4, 0x1f, 0x32, 0x62 },
+      { /* 1 */
+        0x2d, 0x3a, 0xde, 0xdf, 0xf1, 0x1b, 0x61, 0xf1,
+        0x4c, 0x88, 0x6e, 0x35, 0xaf, 0xa0, 0x36, 0x73,
+        0x6d, 0xcd, 0x87, 0xa7, 0x4d, 0x27, 0xb5, 0xc1,
+        0x51, 0x02, 0x25, 0xd0, 0xf5, 0x92, 0xe2, 0x13 },
+      { /* 1023 */
+        0x10, 0x10, 0x89, 0x70, 0xee, 0xda, 0x3e, 0xb9,
+        0x32, 0xba, 0xac, 0x14, 0x28, 0xc7, 0xa2, 0x16,
+        0x3b, 0x0e, 0x92, 0x4c, 0x9a, 0x9e, 0x25, 0xb3,
+        0x5b, 0xba, 0x72, 0xb2, 0x8f, 0x70, 0xbd, 0x11 },
+      { /* 1024 */
+        0x42, 0x21, 0x47, 0x39, 0xf0, 0x95, 0xa4, 0x06,
+        0xf3, 0xfc, 0x83, 0xde, 0xb8, 0x89, 0x74, 0x4a,
+        0xc0, 0x0d, 0xf8, 0x31, 0xc1, 0x0d, 0xaa, 0x55,
+        0x18, 0x9b, 0x5d, 0x12, 0x1c, 0x85, 0x5a, 0xf7 },
+      { /* 1025 */
+        0xd0, 0x02, 0x78, 0xae, 0x47, 0xeb, 0x27, 0xb3,
+        0x4f, 0xae, 0xcf, 0x67, 0xb4, 0xfe, 0x26, 0x3f,
+        0x82, 0xd5, 0x41, 0x29, 0x16, 0xc1, 0xff, 0xd9,
+        0x7c, 0x8c, 0xb7, 0xfb, 0x81, 0x4b, 0x84, 0x44 },
+      { /* 2049 */
+        0x5f, 0x4d, 0x72, 0xf4, 0x0d, 0x7a, 0x5f, 0x82,
+        0xb1, 0x5c, 0xa2, 0xb2, 0xe4, 0x4b, 0x1d, 0xe3,
+        0xc2, 0xef, 0x86, 0xc4, 0x26, 0xc9, 0x5c, 0x1a,
+        0xf0, 0xb6, 0x87, 0x95, 0x22, 0x56, 0x30, 0x30 },
+      { /* 8193 */
+        0xba, 0xb6, 0xc0, 0x9c, 0xb8, 0xce, 0x8c, 0xf4,
+        0x59, 0x26, 0x13, 0x98, 0xd2, 0xe7, 0xae, 0xf3,
+        0x57, 0x00, 0xbf, 0x48, 0x81, 0x16, 0xce, 0xb9,
+        0x4a, 0x36, 0xd0, 0xf5, 0xf1, 0xb7, 0xbc, 0x3b },
+      { /* 16385 */
+        0x1d, 0xab, 0xe2, 0x16, 0xbe, 0x25, 0x78, 0x83,
+        0x02, 0x63, 0xb0, 0x49, 0xde, 0x16, 0x39, 0xf3,
+        0x9f, 0x05, 0xa4, 0xda, 0x61, 0x6b, 0x9b, 0x78,
+        0xc7, 0xa5, 0xe4, 0xe4, 0x16, 0x62, 0xfd, 0x1f },
+      { /* 31744 */
+        0x62, 0xb6, 0x96, 0x0e, 0x1a, 0x44, 0xbc, 0xc1,
+        0xeb, 0x1a, 0x61, 0x1a, 0x8d, 0x62, 0x35, 0xb6,
+        0xb4, 0xb7, 0x8f, 0x32, 0xe7, 0xab, 0xc4, 0xfb,
+        0x4c, 0x6c, 0xdc, 0xce, 0x94, 0x89, 0x5c, 0x47 },
+      { /* 102400 */
+        0xbc, 0x3e, 0x3d, 0x41, 0xa1, 0x14, 0x6b, 0x06,
+        0x9a, 0xbf, 0xfa, 0xd3, 0xc0, 0xd4, 0x48, 0x60,
+        0xcf, 0x66, 0x43, 0x90, 0xaf, 0xce, 0x4d, 0x96,
+        0x61, 0xf7, 0x90, 0x2e, 0x79, 0x43, 0xe0, 0x85 }
+   };
+
+   static const unsigned char keyed[10][32] = {
+      { /* 0 */
+        0x92, 0xb2, 0xb7, 0x56, 0x04, 0xed, 0x3c, 0x76,
+        0x1f, 0x9d, 0x6f, 0x62, 0x39, 0x2c, 0x8a, 0x92,
+        0x27, 0xad, 0x0e, 0xa3, 0xf0, 0x95, 0x73, 0xe7,
+        0x83, 0xf1, 0x49, 0x8a, 0x4e, 0xd6, 0x0d, 0x26 },
+      { /* 1 */
+        0x6d, 0x78, 0x78, 0xdf, 0xff, 0x2f, 0x48, 0x56,
+        0x35, 0xd3, 0x90, 0x13, 0x27, 0x8a, 0xe1, 0x4f,
+        0x14, 0x54, 0xb8, 0xc0, 0xa3, 0xa2, 0xd3, 0x4b,
+        0xc1, 0xab, 0x38, 0x22, 0x8a, 0x80, 0xc9, 0x5b },
+      { /* 1023 */
+        0xc9, 0x51, 0xec, 0xdf, 0x03, 0x28, 0x8d, 0x0f,
+        0xcc, 0x96, 0xee, 0x34, 0x13, 0x56, 0x3d, 0x8a,
+        0x6d, 0x35, 0x89, 0x54, 0x7f, 0x2c, 0x2f, 0xb3,
+        0x6d, 0x97, 0x86, 0x47, 0x0f, 0x1b, 0x9d, 0x6e },
+      { /* 1024 */
+        0x75, 0xc4, 0x6f, 0x6f, 0x3d, 0x9e, 0xb4, 0xf5,
+        0x5e, 0xca, 0xae, 0xe4, 0x80, 0xdb, 0x73, 0x2e,
+        0x6c, 0x21, 0x05, 0x54, 0x6f, 0x1e, 0x67, 0x50,
+        0x03, 0x68, 0x7c, 0x31, 0x71, 0x9c, 0x7b, 0xa4 },
+      { /* 1025 */
+        0x35, 0x7d, 0xc5, 0x5d, 0xe0, 0xc7, 0xe3, 0x82,
+        0xc9, 0x00, 0xfd, 0x6e, 0x32, 0x0a, 0xcc, 0x04,
+        0x14, 0x6b, 0xe0, 0x1d, 0xb6, 0xa8, 0xce, 0x72,
+        0x10, 0xb7, 0x18, 0x9b, 0xd6, 0x64, 0xea, 0x69 },
+      { /* 2049 */
+        0x9f, 0x29, 0x70, 0x09, 0x02, 0xf7, 0xc8, 0x6e,
+        0x51, 0x4d, 0xdc, 0x4d, 0xf1, 0xe3, 0x04, 0x9f,
+        0x25, 0x8b, 0x24, 0x72, 0xb6, 0xdd, 0x52, 0x67,
+        0xf6, 0x1b, 0xf1, 0x39, 0x83, 0xb7, 0x8d, 0xd5 },
+      { /* 8193 */
+        0x95, 0x4a, 0x2a, 0x75, 0x42, 0x0c, 0x8d, 0x65,
+        0x47, 0xe3, 0xba, 0x5b, 0x98, 0xd9, 0x63, 0xe6,
+        0xfa, 0x64, 0x91, 0xad, 0xdc, 0x8c, 0x02, 0x31,
+        0x89, 0xcc, 0x51, 0x98, 0x21, 0xb4, 0xa1, 0xf5 },
+      { /* 16385 */
+        0x9f, 0x1e, 0x87, 0x50, 0xb4, 0x85, 0x57, 0x6a,
+        0xa8, 0xaf, 0x42, 0xe4, 0x03, 0xbf, 0xb3, 0x40,
+        0x66, 0x5b, 0x45, 0xa9, 0x52, 0x79, 0x9d, 0x01,
+        0x55, 0x75, 0x6c, 0x99, 0x4d, 0xb7, 0xdf, 0xd2 },
+      { /* 31744 */
+        0xef, 0xa5, 0x3b, 0x38, 0x9a, 0xb6, 0x7c, 0x59,
+        0x3d, 0xba, 0x62, 0x4d, 0x89, 0x8d, 0x0f, 0x73,
+        0x53, 0xab, 0x99, 0xe4, 0xac, 0x9d, 0x42, 0x30,
+        0x2e, 0xe6, 0x4c, 0xbf, 0x99, 0x39, 0xa4, 0x19 },
+      { /* 102400 */
+        0x1c, 0x35, 0xd1, 0xa5, 0x81, 0x10, 0x83, 0xfd,
+        0x71, 0x19, 0xf5, 0xd5, 0xd1, 0xba, 0x02, 0x7b,
+        0x4d, 0x01, 0xc0, 0xc6, 0xc4, 0x9f, 0xb6, 0xff,
+        0x2c, 0xf7, 0x53, 0x93, 0xea, 0x5d, 0xb4, 0xa7 }
+   };
+
+   static const unsigned char derived[10][32] = {
+      { /* 0 */
+        0x2c, 0xc3, 0x97, 0x83, 0xc2, 0x23, 0x15, 0x4f,
+        0xea, 0x8d, 0xfb, 0x7c, 0x1b, 0x16, 0x60, 0xf2,
+        0xac, 0x2d, 0xcb, 0xd1, 0xc1, 0xde, 0x82, 0x77,
+        0xb0, 0xb0, 0xdd, 0x39, 0xb7, 0xe5, 0x0d, 0x7d },
+      { /* 1 */
+        0xb3, 0xe2, 0xe3, 0x40, 0xa1, 0x17, 0xa4, 0x99,
+        0xc6, 0xcf, 0x23, 0x98, 0xa1, 0x9e, 0xe0, 0xd2,
+        0x9c, 0xca, 0x2b, 0xb7, 0x40, 0x4c, 0x73, 0x06,
+        0x33, 0x82, 0x69, 0x3b, 0xf6, 0x6c, 0xb0, 0x6c },
+      { /* 1023 */
+        0x74, 0xa1, 0x6c, 0x1c, 0x3d, 0x44, 0x36, 0x8a,
+        0x86, 0xe1, 0xca, 0x6d, 0xf6, 0x4b, 0xe6, 0xa2,
+        0xf6, 0x4c, 0xce, 0x8f, 0x09, 0x22, 0x07, 0x87,
+        0x45, 0x07, 0x22, 0xd8, 0x57, 0x25, 0xde, 0xa5 },
+      { /* 1024 */
+        0x73, 0x56, 0xcd, 0x77, 0x20, 0xd5, 0xb6, 0x6b,
+        0x6d, 0x06, 0x97, 0xeb, 0x31, 0x77, 0xd9, 0xf8,
+        0xd7, 0x3a, 0x4a, 0x5c, 0x5e, 0x96, 0x88, 0x96,
+        0xeb, 0x6a, 0x68, 0x96, 0x84, 0x30, 0x27, 0x06 },
+      { /* 1025 */
+        0xef, 0xfa, 0xa2, 0x45, 0xf0, 0x65, 0xfb, 0xf8,
+        0x2a, 0xc1, 0x86, 0x83, 0x9a, 0x24, 0x97, 0x07,
+        0xc3, 0xbd, 0xdf, 0x6d, 0x3f, 0xdd, 0xa2, 0x2d,
+        0x1b, 0x95, 0xa3, 0xc9, 0x70, 0x37, 0x9b, 0xcb },
+      { /* 2049 */
+        0x2e, 0xa4, 0x77, 0xc5, 0x51, 0x5c, 0xc3, 0xdd,
+        0x60, 0x65, 0x12, 0xee, 0x72, 0xbb, 0x3e, 0x0e,
+        0x75, 0x8c, 0xfa, 0xe7, 0x23, 0x28, 0x26, 0xf3,
+        0x5f, 0xb9, 0x8c, 0xa1, 0xbc, 0xbd, 0xf2, 0x73 },
+      { /* 8193 */
+        0xaf, 0x1e, 0x03, 0x46, 0xe3, 0x89, 0xb1, 0x7c,
+        0x23, 0x20, 0x02, 0x70, 0xa6, 0x4a, 0xa4, 0xe1,
+        0xea, 0xd9, 0x8c, 0x61, 0x69, 0x5d, 0x91, 0x7d,
+        0xe7, 0xd5, 0xb0, 0x04, 0x91, 0xc9, 0xb0, 0xf1 },
+      { /* 16385 */
+        0x3e, 0x5b, 0x2c, 0x02, 0xa5, 0x76, 0xa6, 0x5e,
+        0x8c, 0x7f, 0x37, 0x81, 0x5b, 0x7a, 0x06, 0xa3,
+        0x18, 0x34, 0xdf, 0x32, 0x46, 0x44, 0x10, 0x49,
+        0xf2, 0xdb, 0xf1, 0x13, 0x98, 0x27, 0x10, 0x72 },
+      { /* 31744 */
+        0x39, 0x77, 0x2a, 0xef, 0x80, 0xe0, 0xeb, 0xe6,
+        0x05, 0x96, 0x36, 0x1e, 0x45, 0xb0, 0x61, 0xe8,
+        0xf4, 0x17, 0x42, 0x9d, 0x52, 0x91, 0x71, 0xb6,
+        0x76, 0x44, 0x68, 0xc2, 0x29, 0x28, 0xe2, 0x8e },
+      { /* 102400 */
+        0x46, 0x52, 0xcf, 0xf7, 0xa3, 0xf3, 0x85, 0xa6,
+        0x10, 0x3b, 0x5c, 0x26, 0x0f, 0xc1, 0x59, 0x3e,
+        0x13, 0xc7, 0x78, 0xdb, 0xe6, 0x08, 0xef, 0xb0,
+        0x92, 0xfe, 0x7e, 0xe6, 0x9d, 0xf6, 0xe9, 0xc6 }
+   };
+
+   static const unsigned char xof[131] = {
+      0xbc, 0x3e, 0x3d, 0x41, 0xa1, 0x14, 0x6b, 0x06,
+      0x9a, 0xbf, 0xfa, 0xd3, 0xc0, 0xd4, 0x48, 0x60,
+      0xcf, 0x66, 0x43, 0x90, 0xaf, 0xce, 0x4d, 0x96,
+      0x61, 0xf7, 0x90, 0x2e, 0x79, 0x43, 0xe0, 0x85,
+      0xe0, 0x1c, 0x59, 0xda, 0xb9, 0x08, 0xc0, 0x4c,
+      0x33, 0x42, 0xb8, 0x16, 0x94, 0x1a, 0x26, 0xd6,
+      0x9c, 0x26, 0x05, 0xeb, 0xee, 0x5e, 0xc5, 0x29,
+      0x1c, 0xc5, 0x5e, 0x15, 0xb7, 0x61, 0x46, 0xe6,
+      0x74, 0x5f, 0x06, 0x01, 0x15, 0x6c, 0x35, 0x96,
+      0xcb, 0x75, 0x06, 0x5a, 0x9c, 0x57, 0xf3, 0x55,
+      0x85, 0xa5, 0x2e, 0x1a, 0xc7, 0x0f, 0x69, 0x13,
+      0x1c, 0x23, 0xd6, 0x11, 0xce, 0x11, 0xee, 0x4a,
+      0xb1, 0xec, 0x2c, 0x00, 0x90, 0x12, 0xd2, 0x36,
+      0x64, 0x8e, 0x77, 0xbe, 0x92, 0x95, 0xdd, 0x04,
+      0x26, 0xf2, 0x9b, 0x76, 0x4d, 0x65, 0xde, 0x58,
+      0xeb, 0x7d, 0x01, 0xdd, 0x42, 0x24, 0x82, 0x04,
+      0xf4, 0x5f, 0x8e
+   };
+#ifdef LTC_BLAKE3_MT
+   static const unsigned char large[32] = {
+      0x1a, 0xde, 0xda, 0xd9, 0x73, 0x5f, 0x56, 0x5a,
+      0xc6, 0xe2, 0x2d, 0xab, 0x20, 0x3d, 0xb6, 0x3b,
+      0x96, 0x0c, 0x27, 0x09, 0x8f, 0x2c, 0x0f, 0x0f,
+      0xda, 0x9a, 0xdf, 0x92, 0x38, 0xd4, 0xc0, 0xc9
+   };
+   const unsigned long maxlen = 1uL << 23;
+#else
+   const unsigned long maxlen = 102400;
+#endif
+   unsigned char tmp[131], *msg;
+   unsigned long i, n, len;
+   hash_state md;
+   int err = CRYPT_FAIL_TESTVECTOR;
+
+   if ((msg = XMALLOC(maxlen)) == NULL) {
+      return CRYPT_MEM;
+   }
+   for (i = 0; i < maxlen; i++) {
+      msg[i] = (unsigned char)(i % 251);
+   }
+
+   for (i = 0; i < 10; i++) {
+      blake3_init(&md);
+      blake3_process(&md, msg, lens[i]);
+      blake3_done(&md, tmp);
+      if (compare_testvector(tmp, 32, hash[i], 32, "BLAKE3", i)) goto LBL_ERR;
+
+      blake3_init_keyed(&md, key, sizeof(key));
+      blake3_process(&md, msg, lens[i]);
+      blake3_done(&md, tmp);
+      if (compare_testvector(tmp, 32, keyed[i], 32, "BLAKE3 keyed", i)) goto LBL_ERR;
+
+      blake3_init_derive_key(&md, (const unsigned char *)context, sizeof(context) - 1);
+      blake3_process(&md, msg, lens[i]);
+      blake3_done(&md, tmp);
+      if (compare_testvector(tmp, 32, derived[i], 32, "BLAKE3 derive_key", i)) goto LBL_ERR;
+   }
+
+   /* the extended output in three parts */
+   blake3_init(&md);
+   blake3_process(&md, msg, 102400);
+   blake3_xof_done(&md, tmp, 1);
+   blake3_xof_done(&md, tmp + 1, 64);
+   blake3_xof_done(&md, tmp + 65, 66);
+   if (compare_testvector(tmp, 131, xof, 131, "BLAKE3 XOF", 0)) goto LBL_ERR;
+
+   /* processing in pieces must not change the result */
+   for (i = 0; i < 5; i++) {
+      blake3_init(&md);
+      for (n = 0; n < 102400; n += len) {
+         len = MIN(102400 - n, pieces[i]);
+         blake3_process(&md, msg + n, len);
+      }
+      blake3_done(&md, tmp);
+      if (compare_testvector(tmp, 32, hash[9], 32, "BLAKE3 pieces", i)) goto LBL_ERR;
+   }
+
+#ifdef LTC_BLAKE3_MT
+   blake3_init(&md);
+   blake3_process(&md, msg, maxlen);
+   blake3_done(&md, tmp);
+   if (compare_testvector(tmp, 32, large, 32, "BLAKE3 threads", 0)) goto LBL_ERR;
+#endif
+
+   err = CRYPT_OK;
+LBL_ERR:
+   XFREE(msg);
+   return err;
+#endif
+}
+
+#endif
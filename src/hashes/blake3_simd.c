@@ -0,0 +1,304 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file blake3_simd.c
+  BLAKE3 compression of many chunks resp. parent nodes with AVX2 and AVX-512
+
+  Every register holds the same state word of 8 resp. 16 inputs, the
+  message blocks are transposed on load and the chaining values on store.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_BLAKE3) && defined(LTC_BLAKE3_SIMD)
+
+static const ulong32 s_blake3_simd_IV[4] = {
+   0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL
+};
+
+static const unsigned char s_blake3_simd_schedule[7][16] = {
+   { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+   { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+   { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+   { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+   { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+   { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+   { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+};
+
+/**
+  Check whether the CPU supports AVX2
+  @return 1 if supported, 0 otherwise
+*/
+int blake3_avx2_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX2) == LTC_CPU_AVX2;
+}
+
+/**
+  Check whether the CPU supports AVX-512
+  @return 1 if supported, 0 otherwise
+*/
+int blake3_avx512_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX512F) == LTC_CPU_AVX512F;
+}
+
+/* the flags of block b of blocks */
+static ulong32 s_blake3_simd_flags(unsigned long b, unsigned long blocks, unsigned long flags,
+                                   unsigned long flags_start, unsigned long flags_end)
+{
+   if (b == 0) flags |= flags_start;
+   if (b == blocks - 1) flags |= flags_end;
+   return (ulong32)flags;
+}
+
+/* rotations by 16 and 8 are byte shuffles, by 12 and 7 shifts */
+#define BLAKE3_AVX2_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+#define BLAKE3_AVX2_G(a, b, c, d, x, y)                                                                                \
+   do {                                                                                                                \
+      a = _mm256_add_epi32(_mm256_add_epi32(a, b), x);                                                                 \
+      d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), r16);                                                            \
+      c = _mm256_add_epi32(c, d);                                                                                      \
+      b = BLAKE3_AVX2_ROR(_mm256_xor_si256(b, c), 12);                                                                 \
+      a = _mm256_add_epi32(_mm256_add_epi32(a, b), y);                                                                 \
+      d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), r8);                                                             \
+      c = _mm256_add_epi32(c, d);                                                                                      \
+      b = BLAKE3_AVX2_ROR(_mm256_xor_si256(b, c), 7);                                                                  \
+   } while (0)
+
+/* transpose the 8x8 matrix of 32-bit words in r[0..7] */
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_blake3_avx2_transpose(__m256i *r)
+{
+   __m256i t0, t1, t2, t3, t4, t5, t6, t7, u0, u1, u2, u3, u4, u5, u6, u7;
+
+   t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+   t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+   t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+   t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+   t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+   t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+   t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+   t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+   u0 = _mm256_unpacklo_epi64(t0, t2);
+   u1 = _mm256_unpackhi_epi64(t0, t2);
+   u2 = _mm256_unpacklo_epi64(t1, t3);
+   u3 = _mm256_unpackhi_epi64(t1, t3);
+   u4 = _mm256_unpacklo_epi64(t4, t6);
+   u5 = _mm256_unpackhi_epi64(t4, t6);
+   u6 = _mm256_unpacklo_epi64(t5, t7);
+   u7 = _mm256_unpackhi_epi64(t5, t7);
+   r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+   r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+   r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+   r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+   r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+   r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+   r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+   r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/**
+  Hash 8 inputs of the same number of blocks
+  @param in           The 8 inputs
+  @param blocks       The number of blocks of 64 bytes of each input
+  @param key          The key words, i.e. the initial chaining value
+  @param counter      The counter of the first input
+  @param inc          Whether the counter is incremented from one input to the next
+  @param flags        The flags of every block
+  @param flags_start  The additional flags of the first block
+  @param flags_end    The additional flags of the last block
+  @param out          [out] The 8 chaining values of 32 bytes
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+void blake3_avx2_hash8(const unsigned char * const *in, unsigned long blocks, const ulong32 *key, ulong64 counter,
+                       int inc, unsigned long flags, unsigned long flags_start, unsigned long flags_end,
+                       unsigned char *out)
+{
+   const __m256i r16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+   const __m256i r8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+                                       1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+   __m256i m[16], v[16], h[8], ctr_lo, ctr_hi;
+   ulong32 lo[8], hi[8];
+   const unsigned char *s;
+   unsigned long b, i, j;
+
+   for (j = 0; j < 8; ++j) {
+      lo[j] = (ulong32)(counter + (inc ? j : 0));
+      hi[j] = (ulong32)((counter + (inc ? j : 0)) >> 32);
+      h[j] = _mm256_set1_epi32((int)key[j]);
+   }
+   ctr_lo = _mm256_loadu_si256((const __m256i *)lo);
+   ctr_hi = _mm256_loadu_si256((const __m256i *)hi);
+
+   for (b = 0; b < blocks; ++b) {
+      for (j = 0; j < 8; ++j) {
+         m[j] = _mm256_loadu_si256((const __m256i *)(in[j] + b * 64));
+         m[j + 8] = _mm256_loadu_si256((const __m256i *)(in[j] + b * 64 + 32));
+      }
+      s_blake3_avx2_transpose(m);
+      s_blake3_avx2_transpose(m + 8);
+
+      for (j = 0; j < 8; ++j) {
+         v[j] = h[j];
+      }
+      for (j = 0; j < 4; ++j) {
+         v[j + 8] = _mm256_set1_epi32((int)s_blake3_simd_IV[j]);
+      }
+      v[12] = ctr_lo;
+      v[13] = ctr_hi;
+      v[14] = _mm256_set1_epi32(64);
+      v[15] = _mm256_set1_epi32((int)s_blake3_simd_flags(b, blocks, flags, flags_start, flags_end));
+
+      for (i = 0; i < 7; ++i) {
+         s = s_blake3_simd_schedule[i];
+         BLAKE3_AVX2_G(v[0], v[4], v[ 8], v[12], m[s[ 0]], m[s[ 1]]);
+         BLAKE3_AVX2_G(v[1], v[5], v[ 9], v[13], m[s[ 2]], m[s[ 3]]);
+         BLAKE3_AVX2_G(v[2], v[6], v[10], v[14], m[s[ 4]], m[s[ 5]]);
+         BLAKE3_AVX2_G(v[3], v[7], v[11], v[15], m[s[ 6]], m[s[ 7]]);
+         BLAKE3_AVX2_G(v[0], v[5], v[10], v[15], m[s[ 8]], m[s[ 9]]);
+         BLAKE3_AVX2_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+         BLAKE3_AVX2_G(v[2], v[7], v[ 8], v[13], m[s[12]], m[s[13]]);
+         BLAKE3_AVX2_G(v[3], v[4], v[ 9], v[14], m[s[14]], m[s[15]]);
+      }
+
+      for (j = 0; j < 8; ++j) {
+         h[j] = _mm256_xor_si256(v[j], v[j + 8]);
+      }
+   }
+
+   s_blake3_avx2_transpose(h);
+   for (j = 0; j < 8; ++j) {
+      _mm256_storeu_si256((__m256i *)(out + j * 32), h[j]);
+   }
+}
+
+#undef BLAKE3_AVX2_G
+#undef BLAKE3_AVX2_ROR
+
+#define BLAKE3_AVX512_G(a, b, c, d, x, y)                                                                              \
+   do {                                                                                                                \
+      a = _mm512_add_epi32(_mm512_add_epi32(a, b), x);                                                                 \
+      d = _mm512_ror_epi32(_mm512_xor_si512(d, a), 16);                                                                \
+      c = _mm512_add_epi32(c, d);                                                                                      \
+      b = _mm512_ror_epi32(_mm512_xor_si512(b, c), 12);                                                                \
+      a = _mm512_add_epi32(_mm512_add_epi32(a, b), y);                                                                 \
+      d = _mm512_ror_epi32(_mm512_xor_si512(d, a), 8);                                                                 \
+      c = _mm512_add_epi32(c, d);                                                                                      \
+      b = _mm512_ror_epi32(_mm512_xor_si512(b, c), 7);                                                                 \
+   } while (0)
+
+/* transpose the 16x16 matrix of 32-bit words in x[0..15] */
+LTC_ATTRIBUTE((__target__("avx512f")))
+static void s_blake3_avx512_transpose(__m512i *x)
+{
+   __m512i t0, t1, t2, t3;
+   int i, k;
+
+   /* transpose the 4x4 blocks within the 128 bit lanes */
+   for (k = 0; k < 4; k++) {
+      t0 = _mm512_unpacklo_epi32(x[4*k+0], x[4*k+1]);
+      t1 = _mm512_unpacklo_epi32(x[4*k+2], x[4*k+3]);
+      t2 = _mm512_unpackhi_epi32(x[4*k+0], x[4*k+1]);
+      t3 = _mm512_unpackhi_epi32(x[4*k+2], x[4*k+3]);
+      x[4*k+0] = _mm512_unpacklo_epi64(t0, t1);
+      x[4*k+1] = _mm512_unpackhi_epi64(t0, t1);
+      x[4*k+2] = _mm512_unpacklo_epi64(t2, t3);
+      x[4*k+3] = _mm512_unpackhi_epi64(t2, t3);
+   }
+   /* transpose the 4x4 matrix of 128 bit lanes */
+   for (i = 0; i < 4; i++) {
+      t0 = _mm512_shuffle_i32x4(x[i], x[4+i], 0x44);
+      t1 = _mm512_shuffle_i32x4(x[8+i], x[12+i], 0x44);
+      t2 = _mm512_shuffle_i32x4(x[i], x[4+i], 0xee);
+      t3 = _mm512_shuffle_i32x4(x[8+i], x[12+i], 0xee);
+      x[i]    = _mm512_shuffle_i32x4(t0, t1, 0x88);
+      x[4+i]  = _mm512_shuffle_i32x4(t0, t1, 0xdd);
+      x[8+i]  = _mm512_shuffle_i32x4(t2, t3, 0x88);
+      x[12+i] = _mm512_shuffle_i32x4(t2, t3, 0xdd);
+   }
+}
+
+/**
+  Hash 16 inputs of the same number of blocks
+  @param in           The 16 inputs
+  @param blocks       The number of blocks of 64 bytes of each input
+  @param key          The key words, i.e. the initial chaining value
+  @param counter      The counter of the first input
+  @param inc          Whether the counter is incremented from one input to the next
+  @param flags        The flags of every block
+  @param flags_start  The additional flags of the first block
+  @param flags_end    The additional flags of the last block
+  @param out          [out] The 16 chaining values of 32 bytes
+*/
+LTC_ATTRIBUTE((__target__("avx512f")))
+void blake3_avx512_hash16(const unsigned char * const *in, unsigned long blocks, const ulong32 *key, ulong64 counter,
+                          int inc, unsigned long flags, unsigned long flags_start, unsigned long flags_end,
+                          unsigned char *out)
+{
+   __m512i m[16], v[16], h[16], ctr_lo, ctr_hi;
+   ulong32 lo[16], hi[16];
+   const unsigned char *s;
+   unsigned long b, i, j;
+
+   for (j = 0; j < 16; ++j) {
+      lo[j] = (ulong32)(counter + (inc ? j : 0));
+      hi[j] = (ulong32)((counter + (inc ? j : 0)) >> 32);
+   }
+   for (j = 0; j < 8; ++j) {
+      h[j] = _mm512_set1_epi32((int)key[j]);
+   }
+   ctr_lo = _mm512_loadu_si512((const void *)lo);
+   ctr_hi = _mm512_loadu_si512((const void *)hi);
+
+   for (b = 0; b < blocks; ++b) {
+      for (j = 0; j < 16; ++j) {
+         m[j] = _mm512_loadu_si512((const void *)(in[j] + b * 64));
+      }
+      s_blake3_avx512_transpose(m);
+
+      for (j = 0; j < 8; ++j) {
+         v[j] = h[j];
+      }
+      for (j = 0; j < 4; ++j) {
+         v[j + 8] = _mm512_set1_epi32((int)s_blake3_simd_IV[j]);
+      }
+      v[12] = ctr_lo;
+      v[13] = ctr_hi;
+      v[14] = _mm512_set1_epi32(64);
+      v[15] = _mm512_set1_epi32((int)s_blake3_simd_flags(b, blocks, flags, flags_start, flags_end));
+
+      for (i = 0; i < 7; ++i) {
+         s = s_blake3_simd_schedule[i];
+         BLAKE3_AVX512_G(v[0], v[4], v[ 8], v[12], m[s[ 0]], m[s[ 1]]);
+         BLAKE3_AVX512_G(v[1], v[5], v[ 9], v[13], m[s[ 2]], m[s[ 3]]);
+         BLAKE3_AVX512_G(v[2], v[6], v[10], v[14], m[s[ 4]], m[s[ 5]]);
+         BLAKE3_AVX512_G(v[3], v[7], v[11], v[15], m[s[ 6]], m[s[ 7]]);
+         BLAKE3_AVX512_G(v[0], v[5], v[10], v[15], m[s[ 8]], m[s[ 9]]);
+         BLAKE3_AVX512_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+         BLAKE3_AVX512_G(v[2], v[7], v[ 8], v[13], m[s[12]], m[s[13]]);
+         BLAKE3_AVX512_G(v[3], v[4], v[ 9], v[14], m[s[14]], m[s[15]]);
+      }
+
+      for (j = 0; j < 8; ++j) {
+         h[j] = _mm512_xor_si512(v[j], v[j + 8]);
+      }
+   }
+
+   /* the lower half of row j of the transposed matrix is the chaining value of input j */
+   for (j = 8; j < 16; ++j) {
+      h[j] = _mm512_setzero_si512();
+   }
+   s_blake3_avx512_transpose(h);
+   for (j = 0; j < 16; ++j) {
+      _mm256_storeu_si256((__m256i *)(out + j * 32), _mm512_castsi512_si256(h[j]));
+   }
+}
+
+#undef BLAKE3_AVX512_G
+
+#endif
@@ -8,6 +8,17 @@
    Hash open files, Tom St Denis
 */
 
+struct s_hash_filehandle {
+    hash_state md;
+    int hash;
+};
+
+static int s_hash_filehandle_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+    struct s_hash_filehandle *h = ctx;
+    return hash_descriptor[h->hash].process(&h->md, in, inlen);
+}
+
 /**
   Hash data from an open file handle.
   @param hash   The index of the hash you want to use
@@ -18,47 +29,37 @@
 */
 int hash_filehandle(int hash, FILE *in, unsigned char *out, unsigned long *outlen)
 {
-    hash_state md;
-    unsigned char *buf;
-    size_t x;
+    struct s_hash_filehandle h;
     int err;
 
     LTC_ARGCHK(out    != NULL);
     LTC_ARGCHK(outlen != NULL);
     LTC_ARGCHK(in     != NULL);
 
-    if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-        return CRYPT_MEM;
-    }
-
     if ((err = hash_is_valid(hash)) != CRYPT_OK) {
-        goto LBL_ERR;
+        return err;
     }
 
     if (*outlen < hash_descriptor[hash].hashsize) {
        *outlen = hash_descriptor[hash].hashsize;
-       err = CRYPT_BUFFER_OVERFLOW;
-       goto LBL_ERR;
+       return CRYPT_BUFFER_OVERFLOW;
     }
-    if ((err = hash_descriptor[hash].init(&md)) != CRYPT_OK) {
+    h.hash = hash;
+    if ((err = hash_descriptor[hash].init(&h.md)) != CRYPT_OK) {
        goto LBL_ERR;
     }
 
-    do {
-        x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-        if ((err = hash_descriptor[hash].process(&md, buf, (unsigned long)x)) != CRYPT_OK) {
-           goto LBL_CLEANBUF;
-        }
-    } while (x == LTC_FILE_READ_BUFSIZE);
-    if ((err = hash_descriptor[hash].done(&md, out)) == CRYPT_OK) {
+    if ((err = file_process(in, s_hash_filehandle_process, &h)) != CRYPT_OK) {
+       goto LBL_ERR;
+    }
+    if ((err = hash_descriptor[hash].done(&h.md, out)) == CRYPT_OK) {
        *outlen = hash_descriptor[hash].hashsize;
     }
 
-LBL_CLEANBUF:
-    zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
-    XFREE(buf);
+#ifdef LTC_CLEAN_STACK
+    zeromem(&h, sizeof(h));
+#endif
     return err;
 }
 #endif /* #ifndef LTC_NO_FILE */
-
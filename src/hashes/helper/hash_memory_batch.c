@@ -0,0 +1,92 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+#ifdef LTC_HASH_HELPERS
+/**
+  @file hash_memory_batch.c
+  Hash many independent messages at once
+*/
+
+/**
+  Hash many independent messages and store their digests one after the other.
+  With LTC_SHA2_MULTIBUF and a CPU with AVX2 the SHA-2 hashes process
+  8 (SHA-224/256) resp. 4 (SHA-384/512) messages in parallel, otherwise the
+  messages are hashed one by one.
+  @param hash   The index of the hash you wish to use
+  @param in     The messages
+  @param inlen  The lengths of the messages (octets)
+  @param n      The number of messages
+  @param out    [out] Where to store the digests, the digest of in[i] starts at out + i * hashsize
+  @param outlen [in/out] Max size and resulting size of all digests (n * hashsize)
+  @return CRYPT_OK if successful
+*/
+int hash_memory_batch(int hash, const unsigned char * const *in, const unsigned long *inlen, unsigned long n,
+                      unsigned char *out, unsigned long *outlen)
+{
+    hash_state   *md;
+    unsigned long x, hashsize;
+    int           err;
+
+    LTC_ARGCHK(in     != NULL);
+    LTC_ARGCHK(inlen  != NULL);
+    LTC_ARGCHK(out    != NULL);
+    LTC_ARGCHK(outlen != NULL);
+
+    if ((err = hash_is_valid(hash)) != CRYPT_OK) {
+        return err;
+    }
+
+    hashsize = hash_descriptor[hash].hashsize;
+    if (hashsize != 0 && n > ULONG_MAX / hashsize) {
+       return CRYPT_OVERFLOW;
+    }
+    if (*outlen < n * hashsize) {
+       *outlen = n * hashsize;
+       return CRYPT_BUFFER_OVERFLOW;
+    }
+    for (x = 0; x < n; x++) {
+       if (in[x] == NULL) {
+          return CRYPT_INVALID_ARG;
+       }
+    }
+    *outlen = n * hashsize;
+
+#ifdef LTC_SHA2_MULTIBUF
+#ifdef LTC_SHA256
+    if (sha256_mb_avx2_is_supported(hash)) {
+       return sha256_mb_avx2_memory(hash, in, inlen, n, out);
+    }
+#endif
+#ifdef LTC_SHA512
+    if (sha512_mb_avx2_is_supported(hash)) {
+       return sha512_mb_avx2_memory(hash, in, inlen, n, out);
+    }
+#endif
+#endif
+
+    md = XMALLOC(sizeof(hash_state));
+    if (md == NULL) {
+       return CRYPT_MEM;
+    }
+
+    for (x = 0; x < n; x++) {
+       if ((err = hash_descriptor[hash].init(md)) != CRYPT_OK) {
+          goto LBL_ERR;
+       }
+       if ((err = hash_descriptor[hash].process(md, in[x], inlen[x])) != CRYPT_OK) {
+          goto LBL_ERR;
+       }
+       if ((err = hash_descriptor[hash].done(md, out + x * hashsize)) != CRYPT_OK) {
+          goto LBL_ERR;
+       }
+    }
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+    zeromem(md, sizeof(hash_state));
+#endif
+    XFREE(md);
+
+    return err;
+}
+#endif /* #ifdef LTC_HASH_HELPERS */
@@ -0,0 +1,448 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+#ifdef LTC_HASH_HELPERS
+/**
+  @file hash_tree.c
+  Hash a message as a tree of fixed-size chunks
+
+  The leaves are H(0x00 || chunk), the inner nodes H(0x01 || left || right),
+  a node without a sibling is moved up a level unchanged.  This is the
+  Merkle Tree Hash of RFC 6962 with the chunks as its entries.  All levels
+  are kept, so changed chunks only need their path to the root rehashed.
+  With LTC_PTHREAD the nodes of a level are hashed by a set of threads,
+  which is started once per call and waits between the levels.
+*/
+
+/* a level is only hashed by several threads if it has at least this many inner nodes */
+#define HASH_TREE_MT_MIN_NODES  1024
+
+/* the nodes of one level which have to be (re)hashed, the job is reused for all levels */
+struct s_hash_tree_job {
+   const hash_tree_state *tree;
+   const unsigned char *in;
+   unsigned long inlen;
+   unsigned long level;          /* offset of the level in tree->node (in nodes) */
+   unsigned long child;          /* offset of the level below, the leaves have none */
+   unsigned long children;       /* number of nodes in the level below */
+   const unsigned long *list;    /* the indices of the nodes, NULL for all of them */
+   unsigned long count;
+   unsigned long next;
+   unsigned long batch;
+   int err;
+#ifdef LTC_PTHREAD
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+   unsigned long round;          /* incremented for every level the workers take part in */
+   unsigned long active;         /* workers which didn't finish the current round yet */
+   int stop;
+#endif
+};
+
+static int s_hash_tree_digest(int hash, unsigned char prefix, const unsigned char *in, unsigned long inlen,
+                              unsigned char *out)
+{
+   hash_state md;
+   int err;
+
+   if ((err = hash_descriptor[hash].init(&md)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   if ((err = hash_descriptor[hash].process(&md, &prefix, 1)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   if ((err = hash_descriptor[hash].process(&md, in, inlen)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   err = hash_descriptor[hash].done(&md, out);
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(&md, sizeof(md));
+#endif
+   return err;
+}
+
+static int s_hash_tree_node(const struct s_hash_tree_job *job, unsigned long i)
+{
+   const hash_tree_state *tree = job->tree;
+   unsigned long hashsize = hash_descriptor[tree->hash].hashsize, off;
+   unsigned char *out = tree->node + (job->level + i) * hashsize;
+   const unsigned char *c;
+
+   if (job->level == 0) {
+      off = i * tree->chunklen;
+      return s_hash_tree_digest(tree->hash, 0x00, job->in + off, MIN(tree->chunklen, job->inlen - off), out);
+   }
+   c = tree->node + (job->child + 2 * i) * hashsize;
+   if (2 * i + 1 == job->children) {
+      XMEMCPY(out, c, hashsize);
+      return CRYPT_OK;
+   }
+   return s_hash_tree_digest(tree->hash, 0x01, c, 2 * hashsize, out);
+}
+
+/* take batches of nodes until all are done or one failed */
+static void s_hash_tree_work(struct s_hash_tree_job *job)
+{
+   unsigned long i, end;
+   int err = CRYPT_OK;
+
+   for (;;) {
+#ifdef LTC_PTHREAD
+      pthread_mutex_lock(&job->lock);
+#endif
+      if (err != CRYPT_OK && job->err == CRYPT_OK) {
+         job->err = err;
+      }
+      i = job->next;
+      if (job->err != CRYPT_OK) {
+         i = job->count;
+      }
+      end = MIN(job->count, i + job->batch);
+      job->next = MAX(job->next, end);
+#ifdef LTC_PTHREAD
+      pthread_mutex_unlock(&job->lock);
+#endif
+      if (i >= end) {
+         return;
+      }
+      for (; i < end && err == CRYPT_OK; ++i) {
+         err = s_hash_tree_node(job, job->list != NULL ? job->list[i] : i);
+      }
+   }
+}
+
+#ifdef LTC_PTHREAD
+/* a worker takes its share of every level for which a new round is started,
+ * in between it waits for the next round or until it is told to stop */
+static void* s_hash_tree_thread(void *arg)
+{
+   struct s_hash_tree_job *job = arg;
+   unsigned long round = 0;
+
+   for (;;) {
+      pthread_mutex_lock(&job->lock);
+      while (job->round == round && !job->stop) {
+         pthread_cond_wait(&job->cond, &job->lock);
+      }
+      round = job->round;
+      if (job->stop) {
+         pthread_mutex_unlock(&job->lock);
+         return NULL;
+      }
+      pthread_mutex_unlock(&job->lock);
+      s_hash_tree_work(job);
+      pthread_mutex_lock(&job->lock);
+      if (--job->active == 0) {
+         pthread_cond_broadcast(&job->cond);
+      }
+      pthread_mutex_unlock(&job->lock);
+   }
+}
+#endif
+
+/* hash the nodes of the current level, together with the workers if the level is large enough */
+static int s_hash_tree_run(struct s_hash_tree_job *job, unsigned long workers)
+{
+#ifdef LTC_PTHREAD
+   if (workers > 0 && (job->level == 0 || job->count >= HASH_TREE_MT_MIN_NODES)) {
+      pthread_mutex_lock(&job->lock);
+      job->round++;
+      job->active = workers;
+      pthread_cond_broadcast(&job->cond);
+      pthread_mutex_unlock(&job->lock);
+      s_hash_tree_work(job);
+      /* the next level needs all nodes of this one */
+      pthread_mutex_lock(&job->lock);
+      while (job->active > 0) {
+         pthread_cond_wait(&job->cond, &job->lock);
+      }
+      pthread_mutex_unlock(&job->lock);
+      return job->err;
+   }
+#else
+   LTC_UNUSED_PARAM(workers);
+#endif
+   s_hash_tree_work(job);
+   return job->err;
+}
+
+/* rehash the given leaves, resp. all if list is NULL, and every node above them */
+static int s_hash_tree_rehash(const hash_tree_state *tree, const unsigned char *in, unsigned long inlen,
+                              const unsigned long *list, unsigned long n)
+{
+   struct s_hash_tree_job job;
+   unsigned long *cur = NULL, *next = NULL, *tmp, level = 0, count = tree->chunks, i, m = 0, workers = 0;
+   unsigned char *mark = NULL;
+   int err;
+#ifdef LTC_PTHREAD
+   pthread_t *thread = NULL;
+#endif
+
+   if (list != NULL) {
+      /* there are at most as many distinct nodes per level as leaves */
+      m = MIN(n, count);
+      cur = XMALLOC(m * sizeof(*cur));
+      next = XMALLOC(m * sizeof(*next));
+      mark = XCALLOC(count, 1);
+      if (cur == NULL || next == NULL || mark == NULL) {
+         err = CRYPT_MEM;
+         goto LBL_ERR;
+      }
+      for (i = 0, m = 0; i < n; ++i) {
+         if (mark[list[i]] == 0) {
+            mark[list[i]] = 1;
+            cur[m++] = list[i];
+         }
+      }
+      for (i = 0; i < m; ++i) {
+         mark[cur[i]] = 0;
+      }
+   }
+
+   XMEMSET(&job, 0, sizeof(job));
+   job.tree = tree;
+   job.in = in;
+   job.inlen = inlen;
+   job.err = CRYPT_OK;
+   job.list = cur;
+   job.count = list != NULL ? m : count;
+   job.batch = MAX(65536 / tree->chunklen, 1);
+#ifdef LTC_PTHREAD
+   if (pthread_mutex_init(&job.lock, NULL) != 0) {
+      err = CRYPT_ERROR;
+      goto LBL_ERR;
+   }
+   if (pthread_cond_init(&job.cond, NULL) != 0) {
+      pthread_mutex_destroy(&job.lock);
+      err = CRYPT_ERROR;
+      goto LBL_ERR;
+   }
+   /* the leaves are the widest level, the same workers hash all levels of this call */
+   i = MIN(tree->threads, (job.count + job.batch - 1) / job.batch) - 1;
+   if (i > 0 && (thread = XCALLOC(i, sizeof(*thread))) != NULL) {
+      /* if a thread can't be created the others do its share */
+      for (; workers < i && pthread_create(&thread[workers], NULL, s_hash_tree_thread, &job) == 0; ++workers);
+   }
+#endif
+   for (;;) {
+      if ((err = s_hash_tree_run(&job, workers)) != CRYPT_OK) {
+         goto LBL_STOP;
+      }
+      if (count == 1) {
+         break;
+      }
+      /* the parents of the nodes just hashed, each once */
+      if (list != NULL) {
+         for (i = 0, m = 0; i < job.count; ++i) {
+            if (mark[cur[i] / 2] == 0) {
+               mark[cur[i] / 2] = 1;
+               next[m++] = cur[i] / 2;
+            }
+         }
+         for (i = 0; i < m; ++i) {
+            mark[next[i]] = 0;
+         }
+         tmp = cur;
+         cur = next;
+         next = tmp;
+      }
+      job.child = level;
+      job.children = count;
+      level += count;
+      count = (count + 1) / 2;
+      job.level = level;
+      job.list = cur;
+      job.count = list != NULL ? m : count;
+      job.next = 0;
+      job.batch = 256;
+   }
+   err = CRYPT_OK;
+
+LBL_STOP:
+#ifdef LTC_PTHREAD
+   pthread_mutex_lock(&job.lock);
+   job.stop = 1;
+   pthread_cond_broadcast(&job.cond);
+   pthread_mutex_unlock(&job.lock);
+   while (workers > 0) {
+      pthread_join(thread[--workers], NULL);
+   }
+   if (thread != NULL) XFREE(thread);
+   pthread_cond_destroy(&job.cond);
+   pthread_mutex_destroy(&job.lock);
+#endif
+LBL_ERR:
+   if (cur != NULL) XFREE(cur);
+   if (next != NULL) XFREE(next);
+   if (mark != NULL) XFREE(mark);
+   return err;
+}
+
+/**
+  Initialize a hash tree
+  @param tree      The hash tree to initialize
+  @param hash      The index of the hash of the nodes
+  @param chunklen  The size of the chunks, i.e. of the input of a leaf (octets)
+  @param threads   The maximum number of threads to hash with, 0 or 1 uses the calling thread only
+  @return CRYPT_OK if successful
+*/
+int hash_tree_init(hash_tree_state *tree, int hash, unsigned long chunklen, unsigned long threads)
+{
+   int err;
+
+   LTC_ARGCHK(tree != NULL);
+
+   if ((err = hash_is_valid(hash)) != CRYPT_OK) {
+      return err;
+   }
+   if (chunklen == 0) {
+      return CRYPT_INVALID_ARG;
+   }
+   XMEMSET(tree, 0, sizeof(*tree));
+   tree->hash = hash;
+   tree->chunklen = chunklen;
+   tree->threads = MAX(threads, 1);
+   return CRYPT_OK;
+}
+
+/**
+  Hash a message into the tree, all nodes are hashed from scratch
+  @param tree   The hash tree
+  @param in     The message
+  @param inlen  The length of the message (octets)
+  @return CRYPT_OK if successful
+*/
+int hash_tree_build(hash_tree_state *tree, const unsigned char *in, unsigned long inlen)
+{
+   unsigned long chunks, nodes, count, hashsize;
+   unsigned char *p;
+   int err;
+
+   LTC_ARGCHK(tree != NULL);
+   LTC_ARGCHK(in != NULL || inlen == 0);
+
+   if ((err = hash_is_valid(tree->hash)) != CRYPT_OK) {
+      return err;
+   }
+   hashsize = hash_descriptor[tree->hash].hashsize;
+
+   chunks = inlen / tree->chunklen + (inlen % tree->chunklen != 0);
+   for (nodes = 0, count = chunks; count > 1; count = (count + 1) / 2) {
+      nodes += count;
+   }
+   nodes += count;
+   if (nodes > ULONG_MAX / hashsize) {
+      return CRYPT_OVERFLOW;
+   }
+   if (nodes != tree->nodes) {
+      p = XREALLOC(tree->node, MAX(nodes * hashsize, 1));
+      if (p == NULL) {
+         return CRYPT_MEM;
+      }
+      tree->node = p;
+   }
+   tree->chunks = chunks;
+   tree->nodes = nodes;
+   if (chunks == 0) {
+      return CRYPT_OK;
+   }
+
+   return s_hash_tree_rehash(tree, in, inlen, NULL, 0);
+}
+
+/**
+  Rehash the tree after some chunks of the message changed
+
+     The message must still have the same number of chunks.
+
+  @param tree     The hash tree, built with hash_tree_build()
+  @param in       The changed message
+  @param inlen    The length of the message (octets)
+  @param changed  The indices of the changed chunks
+  @param n        The number of changed chunks
+  @return CRYPT_OK if successful
+*/
+int hash_tree_update(hash_tree_state *tree, const unsigned char *in, unsigned long inlen,
+                     const unsigned long *changed, unsigned long n)
+{
+   unsigned long i;
+   int err;
+
+   LTC_ARGCHK(tree != NULL);
+   LTC_ARGCHK(in != NULL || inlen == 0);
+   LTC_ARGCHK(changed != NULL || n == 0);
+
+   if ((err = hash_is_valid(tree->hash)) != CRYPT_OK) {
+      return err;
+   }
+   if (inlen / tree->chunklen + (inlen % tree->chunklen != 0) != tree->chunks) {
+      return CRYPT_INVALID_ARG;
+   }
+   for (i = 0; i < n; ++i) {
+      if (changed[i] >= tree->chunks) {
+         return CRYPT_INVALID_ARG;
+      }
+   }
+   if (n == 0) {
+      return CRYPT_OK;
+   }
+   return s_hash_tree_rehash(tree, in, inlen, changed, n);
+}
+
+/**
+  Get the root of the tree
+  @param tree    The hash tree, built with hash_tree_build()
+  @param out     [out] The root
+  @param outlen  [in/out] Max size and resulting size of the root
+  @return CRYPT_OK if successful
+*/
+int hash_tree_root(const hash_tree_state *tree, unsigned char *out, unsigned long *outlen)
+{
+   hash_state md;
+   unsigned long hashsize;
+   int err;
+
+   LTC_ARGCHK(tree   != NULL);
+   LTC_ARGCHK(out    != NULL);
+   LTC_ARGCHK(outlen != NULL);
+
+   if ((err = hash_is_valid(tree->hash)) != CRYPT_OK) {
+      return err;
+   }
+   hashsize = hash_descriptor[tree->hash].hashsize;
+   if (*outlen < hashsize) {
+      *outlen = hashsize;
+      return CRYPT_BUFFER_OVERFLOW;
+   }
+   if (tree->chunks == 0) {
+      /* the tree of the empty message is the hash of nothing */
+      if ((err = hash_descriptor[tree->hash].init(&md)) != CRYPT_OK) {
+         return err;
+      }
+      if ((err = hash_descriptor[tree->hash].done(&md, out)) != CRYPT_OK) {
+         return err;
+      }
+   } else {
+      XMEMCPY(out, tree->node + (tree->nodes - 1) * hashsize, hashsize);
+   }
+   *outlen = hashsize;
+   return CRYPT_OK;
+}
+
+/**
+  Free the memory of a hash tree
+  @param tree   The hash tree
+*/
+void hash_tree_free(hash_tree_state *tree)
+{
+   LTC_ARGCHKVD(tree != NULL);
+
+   if (tree->node != NULL) {
+      XFREE(tree->node);
+   }
+   XMEMSET(tree, 0, sizeof(*tree));
+}
+
+#endif
@@ -0,0 +1,45 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+#ifdef LTC_HASH_HELPERS
+/**
+  @file hash_tree_memory.c
+  Hash a block of memory as a tree of fixed-size chunks
+*/
+
+/**
+  Hash a block of memory as a tree of fixed-size chunks and store the root
+  @param hash      The index of the hash of the nodes
+  @param chunklen  The size of the chunks (octets)
+  @param threads   The maximum number of threads to hash with
+  @param in        The data you wish to hash
+  @param inlen     The length of the data to hash (octets)
+  @param out       [out] Where to store the root
+  @param outlen    [in/out] Max size and resulting size of the root
+  @return CRYPT_OK if successful
+*/
+int hash_tree_memory(int hash, unsigned long chunklen, unsigned long threads,
+                     const unsigned char *in, unsigned long inlen,
+                           unsigned char *out, unsigned long *outlen)
+{
+   hash_tree_state tree;
+   int err;
+
+   LTC_ARGCHK(in != NULL || inlen == 0);
+   LTC_ARGCHK(out    != NULL);
+   LTC_ARGCHK(outlen != NULL);
+
+   if ((err = hash_tree_init(&tree, hash, chunklen, threads)) != CRYPT_OK) {
+      return err;
+   }
+   if ((err = hash_tree_build(&tree, in, inlen)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+   err = hash_tree_root(&tree, out, outlen);
+LBL_ERR:
+   hash_tree_free(&tree);
+   return err;
+}
+
+#endif
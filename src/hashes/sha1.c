@@ -149,6 +149,26 @@ static int s_sha1_compress(hash_state *md, const unsigned char *buf)
 }
 #endif
 
+/* compress the complete blocks in buf, with the SHA extensions if available */
+static int s_sha1_compress_nblocks(hash_state *md, const unsigned char *buf, unsigned long blocks)
+{
+   int err;
+
+#ifdef LTC_SHA_NI
+   if (sha1_shani_is_supported()) {
+      sha1_shani_compress(md->sha1.state, buf, blocks);
+      return CRYPT_OK;
+   }
+#endif
+   for (; blocks > 0; blocks--) {
+      if ((err = s_sha1_compress(md, buf)) != CRYPT_OK) {
+         return err;
+      }
+      buf += 64;
+   }
+   return CRYPT_OK;
+}
+
 /**
    Initialize the hash state
    @param md   The hash state you wish to initialize
@@ -174,7 +194,7 @@ int sha1_init(hash_state * md)
    @param inlen  The length of the data (octets)
    @return CRYPT_OK if successful
 */
-HASH_PROCESS(sha1_process, s_sha1_compress, sha1, 64)
+HASH_PROCESS_NBLOCKS(sha1_process, s_sha1_compress_nblocks, sha1, 64)
 
 /**
    Terminate the hash to get the digest
@@ -207,7 +227,7 @@ int sha1_done(hash_state * md, unsigned char *out)
         while (md->sha1.curlen < 64) {
             md->sha1.buf[md->sha1.curlen++] = (unsigned char)0;
         }
-        s_sha1_compress(md, md->sha1.buf);
+        s_sha1_compress_nblocks(md, md->sha1.buf, 1);
         md->sha1.curlen = 0;
     }
 
@@ -218,7 +238,7 @@ int sha1_done(hash_state * md, unsigned char *out)
 
     /* store length */
     STORE64H(md->sha1.length, md->sha1.buf+56);
-    s_sha1_compress(md, md->sha1.buf);
+    s_sha1_compress_nblocks(md, md->sha1.buf, 1);
 
     /* copy output */
     for (i = 0; i < 5; i++) {
@@ -252,11 +272,16 @@ int  sha1_test(void)
       { 0x84, 0x98, 0x3E, 0x44, 0x1C, 0x3B, 0xD2, 0x6E,
         0xBA, 0xAE, 0x4A, 0xA1, 0xF9, 0x51, 0x29, 0xE5,
         0xE5, 0x46, 0x70, 0xF1 }
-    }
+    },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+      { 0xa4, 0x9b, 0x24, 0x46, 0xa0, 0x2c, 0x64, 0x5b,
+        0xf4, 0x19, 0xf9, 0x95, 0xb6, 0x70, 0x91, 0x25,
+        0x3a, 0x04, 0xa2, 0x59 }
+    },
   };
 
   int i;
-  unsigned char tmp[20];
+  unsigned char tmp[20], buf[1000];
   hash_state md;
 
   for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0]));  i++) {
@@ -267,6 +292,24 @@ int  sha1_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
+
+  /* one million times 'a', passed in pieces which aren't a multiple of the block size */
+  {
+     static const unsigned char hash[20] = {
+        0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4,
+        0xf6, 0x1e, 0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31,
+        0x65, 0x34, 0x01, 0x6f
+     };
+     XMEMSET(buf, 'a', sizeof(buf));
+     sha1_init(&md);
+     for (i = 0; i < 1000; i++) {
+        sha1_process(&md, buf, sizeof(buf));
+     }
+     sha1_done(&md, tmp);
+     if (compare_testvector(tmp, sizeof(tmp), hash, sizeof(hash), "SHA1 million a", 0)) {
+        return CRYPT_FAIL_TESTVECTOR;
+     }
+  }
   return CRYPT_OK;
   #endif
 }
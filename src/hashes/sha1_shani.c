@@ -0,0 +1,117 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha1_shani.c
+  SHA-1 compression with the Intel SHA extensions
+
+  Every sha1rnds4 does four rounds, E is carried by sha1nexte in two
+  registers alternately, the message schedule is computed with
+  sha1msg1/sha1msg2 four words at a time.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_SHA1) && defined(LTC_SHA_NI)
+
+/**
+  Check whether the CPU supports the SHA extensions (and SSE4.1)
+  @return 1 if supported, 0 otherwise
+*/
+int sha1_shani_is_supported(void)
+{
+   const ulong32 need = LTC_CPU_SHA | LTC_CPU_SSE41;
+   return (ltc_cpu_features() & need) == need;
+}
+
+/* four rounds with the message words m, en gets A for the E of the next four rounds */
+#define SHA1_SHANI_RNDS4(ec, en, m, f)             \
+   do {                                            \
+      ec = _mm_sha1nexte_epu32(ec, m);             \
+      en = abcd;                                   \
+      abcd = _mm_sha1rnds4_epu32(abcd, ec, f);     \
+   } while (0)
+
+/* four rounds with m1, and the next steps of the message schedule:
+ * m2 gets the following four words, m0 and m3 are prepared for later ones */
+#define SHA1_SHANI_STEP(ec, en, m0, m1, m2, m3, f) \
+   do {                                            \
+      SHA1_SHANI_RNDS4(ec, en, m1, f);             \
+      m2 = _mm_sha1msg2_epu32(m2, m1);             \
+      m0 = _mm_sha1msg1_epu32(m0, m1);             \
+      m3 = _mm_xor_si128(m3, m1);                  \
+   } while (0)
+
+/**
+  Compress blocks of 64 bytes with the SHA extensions
+  @param state   The SHA-1 state (5 words)
+  @param buf     The blocks to compress
+  @param blocks  The number of blocks
+*/
+LTC_ATTRIBUTE((__target__("sha,sse4.1")))
+void sha1_shani_compress(ulong32 *state, const unsigned char *buf, unsigned long blocks)
+{
+   const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+   __m128i abcd, abcd_save, e0, e1, e_save, m0, m1, m2, m3;
+
+   /* A is in the highest lane, as is E */
+   abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+   e0   = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+   while (blocks-- > 0) {
+      abcd_save = abcd;
+      e_save    = e0;
+
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf +  0)), bswap);
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 16)), bswap);
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 32)), bswap);
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 48)), bswap);
+
+      /* rounds 0-15 */
+      e0   = _mm_add_epi32(e0, m0);
+      e1   = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      SHA1_SHANI_RNDS4(e1, e0, m1, 0);
+      m0 = _mm_sha1msg1_epu32(m0, m1);
+      SHA1_SHANI_RNDS4(e0, e1, m2, 0);
+      m1 = _mm_sha1msg1_epu32(m1, m2);
+      m0 = _mm_xor_si128(m0, m2);
+      SHA1_SHANI_STEP(e1, e0, m2, m3, m0, m1, 0);
+
+      /* rounds 16-67 */
+      SHA1_SHANI_STEP(e0, e1, m3, m0, m1, m2, 0);
+      SHA1_SHANI_STEP(e1, e0, m0, m1, m2, m3, 1);
+      SHA1_SHANI_STEP(e0, e1, m1, m2, m3, m0, 1);
+      SHA1_SHANI_STEP(e1, e0, m2, m3, m0, m1, 1);
+      SHA1_SHANI_STEP(e0, e1, m3, m0, m1, m2, 1);
+      SHA1_SHANI_STEP(e1, e0, m0, m1, m2, m3, 1);
+      SHA1_SHANI_STEP(e0, e1, m1, m2, m3, m0, 2);
+      SHA1_SHANI_STEP(e1, e0, m2, m3, m0, m1, 2);
+      SHA1_SHANI_STEP(e0, e1, m3, m0, m1, m2, 2);
+      SHA1_SHANI_STEP(e1, e0, m0, m1, m2, m3, 2);
+      SHA1_SHANI_STEP(e0, e1, m1, m2, m3, m0, 2);
+      SHA1_SHANI_STEP(e1, e0, m2, m3, m0, m1, 3);
+      SHA1_SHANI_STEP(e0, e1, m3, m0, m1, m2, 3);
+
+      /* rounds 68-79, the last words of the message schedule */
+      SHA1_SHANI_RNDS4(e1, e0, m1, 3);
+      m2 = _mm_sha1msg2_epu32(m2, m1);
+      m3 = _mm_xor_si128(m3, m1);
+      SHA1_SHANI_RNDS4(e0, e1, m2, 3);
+      m3 = _mm_sha1msg2_epu32(m3, m2);
+      SHA1_SHANI_RNDS4(e1, e0, m3, 3);
+
+      /* feedback */
+      e0   = _mm_sha1nexte_epu32(e0, e_save);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+      buf += 64;
+   }
+
+   _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+   state[4] = (ulong32)_mm_extract_epi32(e0, 3);
+}
+
+#undef SHA1_SHANI_RNDS4
+#undef SHA1_SHANI_STEP
+
+#endif
@@ -188,6 +188,26 @@ static int s_sha256_compress(hash_state * md, const unsigned char *buf)
 }
 #endif
 
+/* compress the complete blocks in buf, with the SHA extensions if available */
+static int s_sha256_compress_nblocks(hash_state *md, const unsigned char *buf, unsigned long blocks)
+{
+   int err;
+
+#ifdef LTC_SHA_NI
+   if (sha256_shani_is_supported()) {
+      sha256_shani_compress(md->sha256.state, buf, blocks);
+      return CRYPT_OK;
+   }
+#endif
+   for (; blocks > 0; blocks--) {
+      if ((err = s_sha256_compress(md, buf)) != CRYPT_OK) {
+         return err;
+      }
+      buf += 64;
+   }
+   return CRYPT_OK;
+}
+
 /**
    Initialize the hash state
    @param md   The hash state you wish to initialize
@@ -217,7 +237,7 @@ int sha256_init(hash_state * md)
    @param inlen  The length of the data (octets)
    @return CRYPT_OK if successful
 */
-HASH_PROCESS(sha256_process,s_sha256_compress, sha256, 64)
+HASH_PROCESS_NBLOCKS(sha256_process, s_sha256_compress_nblocks, sha256, 64)
 
 /**
    Terminate the hash to get the digest
@@ -251,7 +271,7 @@ int sha256_done(hash_state * md, unsigned char *out)
         while (md->sha256.curlen < 64) {
             md->sha256.buf[md->sha256.curlen++] = (unsigned char)0;
         }
-        s_sha256_compress(md, md->sha256.buf);
+        s_sha256_compress_nblocks(md, md->sha256.buf, 1);
         md->sha256.curlen = 0;
     }
 
@@ -262,7 +282,7 @@ int sha256_done(hash_state * md, unsigned char *out)
 
     /* store length */
     STORE64H(md->sha256.length, md->sha256.buf+56);
-    s_sha256_compress(md, md->sha256.buf);
+    s_sha256_compress_nblocks(md, md->sha256.buf, 1);
 
     /* copy output */
     for (i = 0; i < 8; i++) {
@@ -299,10 +319,16 @@ int  sha256_test(void)
         0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
         0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 }
     },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+      { 0xcf, 0x5b, 0x16, 0xa7, 0x78, 0xaf, 0x83, 0x80,
+        0x03, 0x6c, 0xe5, 0x9e, 0x7b, 0x04, 0x92, 0x37,
+        0x0b, 0x24, 0x9b, 0x11, 0xe8, 0xf0, 0x7a, 0x51,
+        0xaf, 0xac, 0x45, 0x03, 0x7a, 0xfe, 0xe9, 0xd1 }
+    },
   };
 
   int i;
-  unsigned char tmp[32];
+  unsigned char tmp[32], buf[1000];
   hash_state md;
 
   for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++) {
@@ -313,6 +339,25 @@ int  sha256_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
+
+  /* one million times 'a', passed in pieces which aren't a multiple of the block size */
+  {
+     static const unsigned char hash[32] = {
+        0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92,
+        0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+        0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+        0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+     };
+     XMEMSET(buf, 'a', sizeof(buf));
+     sha256_init(&md);
+     for (i = 0; i < 1000; i++) {
+        sha256_process(&md, buf, sizeof(buf));
+     }
+     sha256_done(&md, tmp);
+     if (compare_testvector(tmp, sizeof(tmp), hash, sizeof(hash), "SHA256 million a", 0)) {
+        return CRYPT_FAIL_TESTVECTOR;
+     }
+  }
   return CRYPT_OK;
  #endif
 }
@@ -0,0 +1,287 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha256_mb_avx2.c
+  SHA-224/256 of 8 independent messages at once with AVX2 (multi-buffer)
+
+  Every 32 bit lane of the vectors holds a word of another message, the
+  blocks of the 8 messages are transposed when they're loaded.  A lane
+  whose message is finished gets the next message of the batch, so
+  messages of different lengths keep all lanes busy.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_SHA256) && defined(LTC_SHA2_MULTIBUF)
+
+#define SHA256_MB_LANES 8
+
+static const ulong32 s_sha256_mb_K[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL,
+    0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL, 0xd807aa98UL, 0x12835b01UL,
+    0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL,
+    0xc19bf174UL, 0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+    0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL, 0x983e5152UL,
+    0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL,
+    0x06ca6351UL, 0x14292967UL, 0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL,
+    0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL,
+    0xd6990624UL, 0xf40e3585UL, 0x106aa070UL, 0x19a4c116UL, 0x1e376c08UL,
+    0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL,
+    0x682e6ff3UL, 0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+    0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+/* the block of an idle lane */
+static const unsigned char s_sha256_mb_zero[64] = { 0 };
+
+/**
+  Check whether SHA-224/256 of hash_memory_batch() is done by the multi-buffer implementation
+  @param hash  The index of the hash
+  @return 1 if it is, 0 otherwise
+*/
+int sha256_mb_avx2_is_supported(int hash)
+{
+#ifdef LTC_SHA_NI
+   /* a single message with the SHA extensions is at least as fast */
+   if (sha256_shani_is_supported()) {
+      return 0;
+   }
+#endif
+   if ((ltc_cpu_features() & LTC_CPU_AVX2) != LTC_CPU_AVX2) {
+      return 0;
+   }
+   if (hash_descriptor[hash].init == sha256_init) {
+      return 1;
+   }
+#ifdef LTC_SHA224
+   if (hash_descriptor[hash].init == sha224_init) {
+      return 1;
+   }
+#endif
+   return 0;
+}
+
+#define SHA256_MB_ROR(x, n)  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define SHA256_MB_S0(x)      _mm256_xor_si256(_mm256_xor_si256(SHA256_MB_ROR(x, 2), SHA256_MB_ROR(x, 13)), SHA256_MB_ROR(x, 22))
+#define SHA256_MB_S1(x)      _mm256_xor_si256(_mm256_xor_si256(SHA256_MB_ROR(x, 6), SHA256_MB_ROR(x, 11)), SHA256_MB_ROR(x, 25))
+#define SHA256_MB_G0(x)      _mm256_xor_si256(_mm256_xor_si256(SHA256_MB_ROR(x, 7), SHA256_MB_ROR(x, 18)), _mm256_srli_epi32(x, 3))
+#define SHA256_MB_G1(x)      _mm256_xor_si256(_mm256_xor_si256(SHA256_MB_ROR(x, 17), SHA256_MB_ROR(x, 19)), _mm256_srli_epi32(x, 10))
+
+/* round t of all lanes, W[i] is computed from the previous 16 words first if t >= 16 */
+#define SHA256_MB_RND(a, b, c, d, e, f, g, h, i)                                                      \
+   do {                                                                                               \
+      if (t > 0) {                                                                                    \
+         W[i] = _mm256_add_epi32(_mm256_add_epi32(SHA256_MB_G1(W[((i) + 14) & 15]), W[((i) + 9) & 15]), \
+                                 _mm256_add_epi32(SHA256_MB_G0(W[((i) + 1) & 15]), W[i]));            \
+      }                                                                                               \
+      t0 = _mm256_add_epi32(_mm256_add_epi32(h, SHA256_MB_S1(e)),                                     \
+                            _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g))));        \
+      t0 = _mm256_add_epi32(t0, _mm256_add_epi32(W[i], _mm256_set1_epi32((int)s_sha256_mb_K[t + (i)]))); \
+      t1 = _mm256_add_epi32(SHA256_MB_S0(a),                                                          \
+                            _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(a, b), c), _mm256_and_si256(a, b))); \
+      d = _mm256_add_epi32(d, t0);                                                                    \
+      h = _mm256_add_epi32(t0, t1);                                                                   \
+   } while (0)
+
+/* r0..r7 are 8 words of the lanes 0..7 and become word 0..7 of all lanes */
+#define SHA256_MB_TRANSPOSE(r0, r1, r2, r3, r4, r5, r6, r7)                                           \
+   do {                                                                                               \
+      __m256i u0, u1, u2, u3, u4, u5, u6, u7;                                                         \
+      u0 = _mm256_unpacklo_epi32(r0, r1); u1 = _mm256_unpackhi_epi32(r0, r1);                         \
+      u2 = _mm256_unpacklo_epi32(r2, r3); u3 = _mm256_unpackhi_epi32(r2, r3);                         \
+      u4 = _mm256_unpacklo_epi32(r4, r5); u5 = _mm256_unpackhi_epi32(r4, r5);                         \
+      u6 = _mm256_unpacklo_epi32(r6, r7); u7 = _mm256_unpackhi_epi32(r6, r7);                         \
+      r0 = _mm256_unpacklo_epi64(u0, u2); r1 = _mm256_unpackhi_epi64(u0, u2);                         \
+      r2 = _mm256_unpacklo_epi64(u1, u3); r3 = _mm256_unpackhi_epi64(u1, u3);                         \
+      r4 = _mm256_unpacklo_epi64(u4, u6); r5 = _mm256_unpackhi_epi64(u4, u6);                         \
+      r6 = _mm256_unpacklo_epi64(u5, u7); r7 = _mm256_unpackhi_epi64(u5, u7);                         \
+      u0 = _mm256_permute2x128_si256(r0, r4, 0x20); u4 = _mm256_permute2x128_si256(r0, r4, 0x31);     \
+      u1 = _mm256_permute2x128_si256(r1, r5, 0x20); u5 = _mm256_permute2x128_si256(r1, r5, 0x31);     \
+      u2 = _mm256_permute2x128_si256(r2, r6, 0x20); u6 = _mm256_permute2x128_si256(r2, r6, 0x31);     \
+      u3 = _mm256_permute2x128_si256(r3, r7, 0x20); u7 = _mm256_permute2x128_si256(r3, r7, 0x31);     \
+      r0 = u0; r1 = u1; r2 = u2; r3 = u3; r4 = u4; r5 = u5; r6 = u6; r7 = u7;                         \
+   } while (0)
+
+/* compress one block of every lane, st[] holds word i of lane j in st[8*i+j] */
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_sha256_mb_avx2_compress(ulong32 *st, const unsigned char * const *blk)
+{
+   const __m256i bswap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                         12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+   __m256i W[16], S[8], a, b, c, d, e, f, g, h, t0, t1;
+   int i, t;
+
+   for (i = 0; i < 8; i++) {
+      W[i]     = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)blk[i]), bswap);
+      W[i + 8] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(blk[i] + 32)), bswap);
+   }
+   SHA256_MB_TRANSPOSE(W[0], W[1], W[2], W[3], W[4], W[5], W[6], W[7]);
+   SHA256_MB_TRANSPOSE(W[8], W[9], W[10], W[11], W[12], W[13], W[14], W[15]);
+
+   for (i = 0; i < 8; i++) {
+      S[i] = _mm256_loadu_si256((const __m256i *)(st + 8 * i));
+   }
+   a = S[0]; b = S[1]; c = S[2]; d = S[3];
+   e = S[4]; f = S[5]; g = S[6]; h = S[7];
+
+   for (t = 0; t < 64; t += 16) {
+      SHA256_MB_RND(a, b, c, d, e, f, g, h,  0);
+      SHA256_MB_RND(h, a, b, c, d, e, f, g,  1);
+      SHA256_MB_RND(g, h, a, b, c, d, e, f,  2);
+      SHA256_MB_RND(f, g, h, a, b, c, d, e,  3);
+      SHA256_MB_RND(e, f, g, h, a, b, c, d,  4);
+      SHA256_MB_RND(d, e, f, g, h, a, b, c,  5);
+      SHA256_MB_RND(c, d, e, f, g, h, a, b,  6);
+      SHA256_MB_RND(b, c, d, e, f, g, h, a,  7);
+      SHA256_MB_RND(a, b, c, d, e, f, g, h,  8);
+      SHA256_MB_RND(h, a, b, c, d, e, f, g,  9);
+      SHA256_MB_RND(g, h, a, b, c, d, e, f, 10);
+      SHA256_MB_RND(f, g, h, a, b, c, d, e, 11);
+      SHA256_MB_RND(e, f, g, h, a, b, c, d, 12);
+      SHA256_MB_RND(d, e, f, g, h, a, b, c, 13);
+      SHA256_MB_RND(c, d, e, f, g, h, a, b, 14);
+      SHA256_MB_RND(b, c, d, e, f, g, h, a, 15);
+   }
+
+   /* feedback */
+   S[0] = _mm256_add_epi32(S[0], a); S[1] = _mm256_add_epi32(S[1], b);
+   S[2] = _mm256_add_epi32(S[2], c); S[3] = _mm256_add_epi32(S[3], d);
+   S[4] = _mm256_add_epi32(S[4], e); S[5] = _mm256_add_epi32(S[5], f);
+   S[6] = _mm256_add_epi32(S[6], g); S[7] = _mm256_add_epi32(S[7], h);
+   for (i = 0; i < 8; i++) {
+      _mm256_storeu_si256((__m256i *)(st + 8 * i), S[i]);
+   }
+}
+
+#undef SHA256_MB_ROR
+#undef SHA256_MB_S0
+#undef SHA256_MB_S1
+#undef SHA256_MB_G0
+#undef SHA256_MB_G1
+#undef SHA256_MB_RND
+#undef SHA256_MB_TRANSPOSE
+
+/* a message in a lane: the complete blocks are read from the message,
+ * the rest and the padding (one or two blocks) from tail[] */
+typedef struct {
+   const unsigned char *in;
+   unsigned long full, ntail, left, idx;
+   unsigned char tail[128];
+} sha256_mb_lane;
+
+static void s_sha256_mb_start(sha256_mb_lane *l, ulong32 *st, int j, const ulong32 *iv,
+                              const unsigned char *in, unsigned long inlen, unsigned long idx)
+{
+   unsigned long rest, n;
+   int i;
+
+   l->in   = in;
+   l->full = inlen / 64;
+   l->idx  = idx;
+   rest    = inlen % 64;
+   n       = rest < 56 ? 64 : 128;
+   XMEMCPY(l->tail, in + 64 * l->full, rest);
+   l->tail[rest] = 0x80;
+   zeromem(l->tail + rest + 1, n - rest - 1 - 8);
+   STORE64H((ulong64)inlen * 8, l->tail + n - 8);
+   l->ntail = n / 64;
+   l->left  = l->full + l->ntail;
+
+   for (i = 0; i < 8; i++) {
+      st[8 * i + j] = iv[i];
+   }
+}
+
+/**
+  Hash many messages with SHA-224/256, 8 at a time
+  @param hash   The index of the hash (sha224 or sha256)
+  @param in     The messages
+  @param inlen  The lengths of the messages (octets)
+  @param n      The number of messages
+  @param out    [out] Where to store the digests, one after the other
+  @return CRYPT_OK if successful
+*/
+int sha256_mb_avx2_memory(int hash, const unsigned char * const *in, const unsigned long *inlen,
+                          unsigned long n, unsigned char *out)
+{
+   sha256_mb_lane *lane;
+   const unsigned char *blk[SHA256_MB_LANES];
+   ulong32 st[8 * SHA256_MB_LANES], iv[8];
+   unsigned char digest[32];
+   unsigned long next, active, hashsize;
+   hash_state md;
+   int i, j, err;
+
+   if ((err = hash_descriptor[hash].init(&md)) != CRYPT_OK) {
+      return err;
+   }
+   for (i = 0; i < 8; i++) {
+      iv[i] = md.sha256.state[i];
+   }
+   hashsize = hash_descriptor[hash].hashsize;
+
+   lane = XMALLOC(SHA256_MB_LANES * sizeof(*lane));
+   if (lane == NULL) {
+      return CRYPT_MEM;
+   }
+
+   next = 0;
+   active = 0;
+   for (j = 0; j < SHA256_MB_LANES; j++) {
+      lane[j].left = 0;
+      if (next < n) {
+         s_sha256_mb_start(&lane[j], st, j, iv, in[next], inlen[next], next);
+         next++;
+         active++;
+      }
+   }
+
+   while (active > 0) {
+      for (j = 0; j < SHA256_MB_LANES; j++) {
+         if (lane[j].left == 0) {
+            blk[j] = s_sha256_mb_zero;
+         } else if (lane[j].full > 0) {
+            blk[j] = lane[j].in;
+         } else {
+            blk[j] = lane[j].tail + 64 * (lane[j].ntail - lane[j].left);
+         }
+      }
+      s_sha256_mb_avx2_compress(st, blk);
+
+      for (j = 0; j < SHA256_MB_LANES; j++) {
+         if (lane[j].left == 0) {
+            continue;
+         }
+         if (lane[j].full > 0) {
+            lane[j].in += 64;
+            lane[j].full--;
+         }
+         if (--lane[j].left > 0) {
+            continue;
+         }
+         /* the message is done */
+         for (i = 0; i < 8; i++) {
+            STORE32H(st[8 * i + j], digest + 4 * i);
+         }
+         XMEMCPY(out + hashsize * lane[j].idx, digest, hashsize);
+         active--;
+         if (next < n) {
+            s_sha256_mb_start(&lane[j], st, j, iv, in[next], inlen[next], next);
+            next++;
+            active++;
+         }
+      }
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(lane, SHA256_MB_LANES * sizeof(*lane));
+   zeromem(st, sizeof(st));
+   zeromem(digest, sizeof(digest));
+#endif
+   XFREE(lane);
+   return CRYPT_OK;
+}
+
+#endif
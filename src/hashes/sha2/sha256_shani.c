@@ -0,0 +1,121 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha256_shani.c
+  SHA-256 compression with the Intel SHA extensions
+
+  The state is kept as ABEF and CDGH in two registers as sha256rnds2 expects
+  it, every sha256rnds2 does two rounds, the message schedule is computed
+  with sha256msg1/sha256msg2 four words at a time.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_SHA256) && defined(LTC_SHA_NI)
+
+static const ulong32 s_sha256_shani_K[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL,
+    0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL, 0xd807aa98UL, 0x12835b01UL,
+    0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL,
+    0xc19bf174UL, 0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+    0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL, 0x983e5152UL,
+    0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL,
+    0x06ca6351UL, 0x14292967UL, 0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL,
+    0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL,
+    0xd6990624UL, 0xf40e3585UL, 0x106aa070UL, 0x19a4c116UL, 0x1e376c08UL,
+    0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL,
+    0x682e6ff3UL, 0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+    0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+/**
+  Check whether the CPU supports the SHA extensions (and SSE4.1)
+  @return 1 if supported, 0 otherwise
+*/
+int sha256_shani_is_supported(void)
+{
+   const ulong32 need = LTC_CPU_SHA | LTC_CPU_SSE41;
+   return (ltc_cpu_features() & need) == need;
+}
+
+/* four rounds with the message words m, k is the index of the round constants */
+#define SHA256_SHANI_RNDS4(m, k)                                                          \
+   do {                                                                                   \
+      msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i *)(s_sha256_shani_K + (k)))); \
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);                                      \
+      msg = _mm_shuffle_epi32(msg, 0x0E);                                                 \
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, msg);                                      \
+   } while (0)
+
+/* m0 = next four words of the message schedule, c.f. W[i] of sha256.c */
+#define SHA256_SHANI_SCHED(m0, m1, m2, m3)                                                \
+   do {                                                                                   \
+      m0 = _mm_sha256msg1_epu32(m0, m1);                                                  \
+      m0 = _mm_add_epi32(m0, _mm_alignr_epi8(m3, m2, 4));                                 \
+      m0 = _mm_sha256msg2_epu32(m0, m3);                                                  \
+   } while (0)
+
+/**
+  Compress blocks of 64 bytes with the SHA extensions
+  @param state   The SHA-256 state (8 words)
+  @param buf     The blocks to compress
+  @param blocks  The number of blocks
+*/
+LTC_ATTRIBUTE((__target__("sha,sse4.1")))
+void sha256_shani_compress(ulong32 *state, const unsigned char *buf, unsigned long blocks)
+{
+   const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+   __m128i abef, cdgh, abef_save, cdgh_save, msg, m0, m1, m2, m3, t;
+   int i;
+
+   /* state[] is ABCD EFGH, the rounds want ABEF and CDGH */
+   t    = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0xB1);       /* CDAB */
+   cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(state + 4)), 0x1B); /* EFGH */
+   abef = _mm_alignr_epi8(t, cdgh, 8);
+   cdgh = _mm_blend_epi16(cdgh, t, 0xF0);
+
+   while (blocks-- > 0) {
+      abef_save = abef;
+      cdgh_save = cdgh;
+
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf +  0)), bswap);
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 16)), bswap);
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 32)), bswap);
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 48)), bswap);
+
+      SHA256_SHANI_RNDS4(m0,  0);
+      SHA256_SHANI_RNDS4(m1,  4);
+      SHA256_SHANI_RNDS4(m2,  8);
+      SHA256_SHANI_RNDS4(m3, 12);
+      for (i = 16; i < 64; i += 16) {
+         SHA256_SHANI_SCHED(m0, m1, m2, m3);
+         SHA256_SHANI_RNDS4(m0, i);
+         SHA256_SHANI_SCHED(m1, m2, m3, m0);
+         SHA256_SHANI_RNDS4(m1, i + 4);
+         SHA256_SHANI_SCHED(m2, m3, m0, m1);
+         SHA256_SHANI_RNDS4(m2, i + 8);
+         SHA256_SHANI_SCHED(m3, m0, m1, m2);
+         SHA256_SHANI_RNDS4(m3, i + 12);
+      }
+
+      /* feedback */
+      abef = _mm_add_epi32(abef, abef_save);
+      cdgh = _mm_add_epi32(cdgh, cdgh_save);
+      buf += 64;
+   }
+
+   /* back to ABCD EFGH */
+   t    = _mm_shuffle_epi32(abef, 0x1B);  /* FEBA */
+   cdgh = _mm_shuffle_epi32(cdgh, 0xB1);  /* DCHG */
+   abef = _mm_blend_epi16(t, cdgh, 0xF0); /* DCBA */
+   cdgh = _mm_alignr_epi8(cdgh, t, 8);    /* HGFE */
+   _mm_storeu_si128((__m128i *)state, abef);
+   _mm_storeu_si128((__m128i *)(state + 4), cdgh);
+}
+
+#undef SHA256_SHANI_RNDS4
+#undef SHA256_SHANI_SCHED
+
+#endif
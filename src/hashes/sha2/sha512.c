@@ -159,6 +159,26 @@ static int s_sha512_compress(hash_state * md, const unsigned char *buf)
 }
 #endif
 
+/* compress the complete blocks in buf, with the SIMD message schedule if available */
+static int s_sha512_compress_nblocks(hash_state *md, const unsigned char *buf, unsigned long blocks)
+{
+   int err;
+
+#ifdef LTC_SHA512_SIMD
+   if (sha512_simd_is_supported()) {
+      sha512_simd_compress(md->sha512.state, buf, blocks);
+      return CRYPT_OK;
+   }
+#endif
+   for (; blocks > 0; blocks--) {
+      if ((err = s_sha512_compress(md, buf)) != CRYPT_OK) {
+         return err;
+      }
+      buf += 128;
+   }
+   return CRYPT_OK;
+}
+
 /**
    Initialize the hash state
    @param md   The hash state you wish to initialize
@@ -187,7 +207,7 @@ int sha512_init(hash_state * md)
    @param inlen  The length of the data (octets)
    @return CRYPT_OK if successful
 */
-HASH_PROCESS(sha512_process, s_sha512_compress, sha512, 128)
+HASH_PROCESS_NBLOCKS(sha512_process, s_sha512_compress_nblocks, sha512, 128)
 
 /**
    Terminate the hash to get the digest
@@ -220,7 +240,7 @@ int sha512_done(hash_state * md, unsigned char *out)
         while (md->sha512.curlen < 128) {
             md->sha512.buf[md->sha512.curlen++] = (unsigned char)0;
         }
-        s_sha512_compress(md, md->sha512.buf);
+        s_sha512_compress_nblocks(md, md->sha512.buf, 1);
         md->sha512.curlen = 0;
     }
 
@@ -234,7 +254,7 @@ int sha512_done(hash_state * md, unsigned char *out)
 
     /* store length */
     STORE64H(md->sha512.length, md->sha512.buf+120);
-    s_sha512_compress(md, md->sha512.buf);
+    s_sha512_compress_nblocks(md, md->sha512.buf, 1);
 
     /* copy output */
     for (i = 0; i < 8; i++) {
@@ -282,7 +302,7 @@ int  sha512_test(void)
   };
 
   int i;
-  unsigned char tmp[64];
+  unsigned char tmp[64], buf[1000];
   hash_state md;
 
   for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++) {
@@ -293,6 +313,29 @@ int  sha512_test(void)
          return CRYPT_FAIL_TESTVECTOR;
       }
   }
+
+  /* one million times 'a', passed in pieces which aren't a multiple of the block size */
+  {
+     static const unsigned char hash[64] = {
+        0xe7, 0x18, 0x48, 0x3d, 0x0c, 0xe7, 0x69, 0x64,
+        0x4e, 0x2e, 0x42, 0xc7, 0xbc, 0x15, 0xb4, 0x63,
+        0x8e, 0x1f, 0x98, 0xb1, 0x3b, 0x20, 0x44, 0x28,
+        0x56, 0x32, 0xa8, 0x03, 0xaf, 0xa9, 0x73, 0xeb,
+        0xde, 0x0f, 0xf2, 0x44, 0x87, 0x7e, 0xa6, 0x0a,
+        0x4c, 0xb0, 0x43, 0x2c, 0xe5, 0x77, 0xc3, 0x1b,
+        0xeb, 0x00, 0x9c, 0x5c, 0x2c, 0x49, 0xaa, 0x2e,
+        0x4e, 0xad, 0xb2, 0x17, 0xad, 0x8c, 0xc0, 0x9b
+     };
+     XMEMSET(buf, 'a', sizeof(buf));
+     sha512_init(&md);
+     for (i = 0; i < 1000; i++) {
+        sha512_process(&md, buf, sizeof(buf));
+     }
+     sha512_done(&md, tmp);
+     if (compare_testvector(tmp, sizeof(tmp), hash, sizeof(hash), "SHA512 million a", 0)) {
+        return CRYPT_FAIL_TESTVECTOR;
+     }
+  }
   return CRYPT_OK;
   #endif
 }
@@ -0,0 +1,311 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha512_mb_avx2.c
+  SHA-384/512 (and SHA-512/t) of 4 independent messages at once with AVX2 (multi-buffer)
+
+  Every 64 bit lane of the vectors holds a word of another message, the
+  blocks of the 4 messages are transposed when they're loaded.  A lane
+  whose message is finished gets the next message of the batch, so
+  messages of different lengths keep all lanes busy.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_SHA512) && defined(LTC_SHA2_MULTIBUF)
+
+#define SHA512_MB_LANES 4
+
+static const ulong64 s_sha512_mb_K[80] = {
+CONST64(0x428a2f98d728ae22), CONST64(0x7137449123ef65cd),
+CONST64(0xb5c0fbcfec4d3b2f), CONST64(0xe9b5dba58189dbbc),
+CONST64(0x3956c25bf348b538), CONST64(0x59f111f1b605d019),
+CONST64(0x923f82a4af194f9b), CONST64(0xab1c5ed5da6d8118),
+CONST64(0xd807aa98a3030242), CONST64(0x12835b0145706fbe),
+CONST64(0x243185be4ee4b28c), CONST64(0x550c7dc3d5ffb4e2),
+CONST64(0x72be5d74f27b896f), CONST64(0x80deb1fe3b1696b1),
+CONST64(0x9bdc06a725c71235), CONST64(0xc19bf174cf692694),
+CONST64(0xe49b69c19ef14ad2), CONST64(0xefbe4786384f25e3),
+CONST64(0x0fc19dc68b8cd5b5), CONST64(0x240ca1cc77ac9c65),
+CONST64(0x2de92c6f592b0275), CONST64(0x4a7484aa6ea6e483),
+CONST64(0x5cb0a9dcbd41fbd4), CONST64(0x76f988da831153b5),
+CONST64(0x983e5152ee66dfab), CONST64(0xa831c66d2db43210),
+CONST64(0xb00327c898fb213f), CONST64(0xbf597fc7beef0ee4),
+CONST64(0xc6e00bf33da88fc2), CONST64(0xd5a79147930aa725),
+CONST64(0x06ca6351e003826f), CONST64(0x142929670a0e6e70),
+CONST64(0x27b70a8546d22ffc), CONST64(0x2e1b21385c26c926),
+CONST64(0x4d2c6dfc5ac42aed), CONST64(0x53380d139d95b3df),
+CONST64(0x650a73548baf63de), CONST64(0x766a0abb3c77b2a8),
+CONST64(0x81c2c92e47edaee6), CONST64(0x92722c851482353b),
+CONST64(0xa2bfe8a14cf10364), CONST64(0xa81a664bbc423001),
+CONST64(0xc24b8b70d0f89791), CONST64(0xc76c51a30654be30),
+CONST64(0xd192e819d6ef5218), CONST64(0xd69906245565a910),
+CONST64(0xf40e35855771202a), CONST64(0x106aa07032bbd1b8),
+CONST64(0x19a4c116b8d2d0c8), CONST64(0x1e376c085141ab53),
+CONST64(0x2748774cdf8eeb99), CONST64(0x34b0bcb5e19b48a8),
+CONST64(0x391c0cb3c5c95a63), CONST64(0x4ed8aa4ae3418acb),
+CONST64(0x5b9cca4f7763e373), CONST64(0x682e6ff3d6b2b8a3),
+CONST64(0x748f82ee5defb2fc), CONST64(0x78a5636f43172f60),
+CONST64(0x84c87814a1f0ab72), CONST64(0x8cc702081a6439ec),
+CONST64(0x90befffa23631e28), CONST64(0xa4506cebde82bde9),
+CONST64(0xbef9a3f7b2c67915), CONST64(0xc67178f2e372532b),
+CONST64(0xca273eceea26619c), CONST64(0xd186b8c721c0c207),
+CONST64(0xeada7dd6cde0eb1e), CONST64(0xf57d4f7fee6ed178),
+CONST64(0x06f067aa72176fba), CONST64(0x0a637dc5a2c898a6),
+CONST64(0x113f9804bef90dae), CONST64(0x1b710b35131c471b),
+CONST64(0x28db77f523047d84), CONST64(0x32caab7b40c72493),
+CONST64(0x3c9ebe0a15c9bebc), CONST64(0x431d67c49c100d4c),
+CONST64(0x4cc5d4becb3e42b6), CONST64(0x597f299cfc657e2a),
+CONST64(0x5fcb6fab3ad6faec), CONST64(0x6c44198c4a475817)
+};
+
+/* the block of an idle lane */
+static const unsigned char s_sha512_mb_zero[128] = { 0 };
+
+/**
+  Check whether the SHA-512 family of hash_memory_batch() is done by the multi-buffer implementation
+  @param hash  The index of the hash
+  @return 1 if it is, 0 otherwise
+*/
+int sha512_mb_avx2_is_supported(int hash)
+{
+   if ((ltc_cpu_features() & LTC_CPU_AVX2) != LTC_CPU_AVX2) {
+      return 0;
+   }
+   if (hash_descriptor[hash].init == sha512_init) {
+      return 1;
+   }
+#ifdef LTC_SHA384
+   if (hash_descriptor[hash].init == sha384_init) {
+      return 1;
+   }
+#endif
+#ifdef LTC_SHA512_256
+   if (hash_descriptor[hash].init == sha512_256_init) {
+      return 1;
+   }
+#endif
+#ifdef LTC_SHA512_224
+   if (hash_descriptor[hash].init == sha512_224_init) {
+      return 1;
+   }
+#endif
+   return 0;
+}
+
+#define SHA512_MB_ROR(x, n)  _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#define SHA512_MB_S0(x)      _mm256_xor_si256(_mm256_xor_si256(SHA512_MB_ROR(x, 28), SHA512_MB_ROR(x, 34)), SHA512_MB_ROR(x, 39))
+#define SHA512_MB_S1(x)      _mm256_xor_si256(_mm256_xor_si256(SHA512_MB_ROR(x, 14), SHA512_MB_ROR(x, 18)), SHA512_MB_ROR(x, 41))
+#define SHA512_MB_G0(x)      _mm256_xor_si256(_mm256_xor_si256(SHA512_MB_ROR(x, 1), SHA512_MB_ROR(x, 8)), _mm256_srli_epi64(x, 7))
+#define SHA512_MB_G1(x)      _mm256_xor_si256(_mm256_xor_si256(SHA512_MB_ROR(x, 19), SHA512_MB_ROR(x, 61)), _mm256_srli_epi64(x, 6))
+
+/* round t of all lanes, W[i] is computed from the previous 16 words first if t >= 16 */
+#define SHA512_MB_RND(a, b, c, d, e, f, g, h, i)                                                      \
+   do {                                                                                               \
+      if (t > 0) {                                                                                    \
+         W[i] = _mm256_add_epi64(_mm256_add_epi64(SHA512_MB_G1(W[((i) + 14) & 15]), W[((i) + 9) & 15]), \
+                                 _mm256_add_epi64(SHA512_MB_G0(W[((i) + 1) & 15]), W[i]));            \
+      }                                                                                               \
+      t0 = _mm256_add_epi64(_mm256_add_epi64(h, SHA512_MB_S1(e)),                                     \
+                            _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g))));        \
+      t0 = _mm256_add_epi64(t0, _mm256_add_epi64(W[i], _mm256_set1_epi64x((long long)s_sha512_mb_K[t + (i)]))); \
+      t1 = _mm256_add_epi64(SHA512_MB_S0(a),                                                          \
+                            _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(a, b), c), _mm256_and_si256(a, b))); \
+      d = _mm256_add_epi64(d, t0);                                                                    \
+      h = _mm256_add_epi64(t0, t1);                                                                   \
+   } while (0)
+
+/* r0..r3 are 4 words of the lanes 0..3 and become word 0..3 of all lanes */
+#define SHA512_MB_TRANSPOSE(r0, r1, r2, r3)                                                           \
+   do {                                                                                               \
+      __m256i u0, u1, u2, u3;                                                                         \
+      u0 = _mm256_unpacklo_epi64(r0, r1); u1 = _mm256_unpackhi_epi64(r0, r1);                         \
+      u2 = _mm256_unpacklo_epi64(r2, r3); u3 = _mm256_unpackhi_epi64(r2, r3);                         \
+      r0 = _mm256_permute2x128_si256(u0, u2, 0x20); r1 = _mm256_permute2x128_si256(u1, u3, 0x20);     \
+      r2 = _mm256_permute2x128_si256(u0, u2, 0x31); r3 = _mm256_permute2x128_si256(u1, u3, 0x31);     \
+   } while (0)
+
+/* compress one block of every lane, st[] holds word i of lane j in st[4*i+j] */
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_sha512_mb_avx2_compress(ulong64 *st, const unsigned char * const *blk)
+{
+   const __m256i bswap = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+   __m256i W[16], S[8], a, b, c, d, e, f, g, h, t0, t1;
+   int i, t;
+
+   for (i = 0; i < 16; i++) {
+      W[i] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(blk[i & 3] + 32 * (i >> 2))), bswap);
+   }
+   SHA512_MB_TRANSPOSE(W[0], W[1], W[2], W[3]);
+   SHA512_MB_TRANSPOSE(W[4], W[5], W[6], W[7]);
+   SHA512_MB_TRANSPOSE(W[8], W[9], W[10], W[11]);
+   SHA512_MB_TRANSPOSE(W[12], W[13], W[14], W[15]);
+
+   for (i = 0; i < 8; i++) {
+      S[i] = _mm256_loadu_si256((const __m256i *)(st + 4 * i));
+   }
+   a = S[0]; b = S[1]; c = S[2]; d = S[3];
+   e = S[4]; f = S[5]; g = S[6]; h = S[7];
+
+   for (t = 0; t < 80; t += 16) {
+      SHA512_MB_RND(a, b, c, d, e, f, g, h,  0);
+      SHA512_MB_RND(h, a, b, c, d, e, f, g,  1);
+      SHA512_MB_RND(g, h, a, b, c, d, e, f,  2);
+      SHA512_MB_RND(f, g, h, a, b, c, d, e,  3);
+      SHA512_MB_RND(e, f, g, h, a, b, c, d,  4);
+      SHA512_MB_RND(d, e, f, g, h, a, b, c,  5);
+      SHA512_MB_RND(c, d, e, f, g, h, a, b,  6);
+      SHA512_MB_RND(b, c, d, e, f, g, h, a,  7);
+      SHA512_MB_RND(a, b, c, d, e, f, g, h,  8);
+      SHA512_MB_RND(h, a, b, c, d, e, f, g,  9);
+      SHA512_MB_RND(g, h, a, b, c, d, e, f, 10);
+      SHA512_MB_RND(f, g, h, a, b, c, d, e, 11);
+      SHA512_MB_RND(e, f, g, h, a, b, c, d, 12);
+      SHA512_MB_RND(d, e, f, g, h, a, b, c, 13);
+      SHA512_MB_RND(c, d, e, f, g, h, a, b, 14);
+      SHA512_MB_RND(b, c, d, e, f, g, h, a, 15);
+   }
+
+   /* feedback */
+   S[0] = _mm256_add_epi64(S[0], a); S[1] = _mm256_add_epi64(S[1], b);
+   S[2] = _mm256_add_epi64(S[2], c); S[3] = _mm256_add_epi64(S[3], d);
+   S[4] = _mm256_add_epi64(S[4], e); S[5] = _mm256_add_epi64(S[5], f);
+   S[6] = _mm256_add_epi64(S[6], g); S[7] = _mm256_add_epi64(S[7], h);
+   for (i = 0; i < 8; i++) {
+      _mm256_storeu_si256((__m256i *)(st + 4 * i), S[i]);
+   }
+}
+
+#undef SHA512_MB_ROR
+#undef SHA512_MB_S0
+#undef SHA512_MB_S1
+#undef SHA512_MB_G0
+#undef SHA512_MB_G1
+#undef SHA512_MB_RND
+#undef SHA512_MB_TRANSPOSE
+
+/* a message in a lane: the complete blocks are read from the message,
+ * the rest and the padding (one or two blocks) from tail[] */
+typedef struct {
+   const unsigned char *in;
+   unsigned long full, ntail, left, idx;
+   unsigned char tail[256];
+} sha512_mb_lane;
+
+static void s_sha512_mb_start(sha512_mb_lane *l, ulong64 *st, int j, const ulong64 *iv,
+                              const unsigned char *in, unsigned long inlen, unsigned long idx)
+{
+   unsigned long rest, n;
+   int i;
+
+   l->in   = in;
+   l->full = inlen / 128;
+   l->idx  = idx;
+   rest    = inlen % 128;
+   n       = rest < 112 ? 128 : 256;
+   XMEMCPY(l->tail, in + 128 * l->full, rest);
+   l->tail[rest] = 0x80;
+   /* the upper 64 bits of the 128 bit length are always zero */
+   zeromem(l->tail + rest + 1, n - rest - 1 - 8);
+   STORE64H((ulong64)inlen * 8, l->tail + n - 8);
+   l->ntail = n / 128;
+   l->left  = l->full + l->ntail;
+
+   for (i = 0; i < 8; i++) {
+      st[4 * i + j] = iv[i];
+   }
+}
+
+/**
+  Hash many messages with one of the SHA-512 family, 4 at a time
+  @param hash   The index of the hash (sha384, sha512, sha512-224 or sha512-256)
+  @param in     The messages
+  @param inlen  The lengths of the messages (octets)
+  @param n      The number of messages
+  @param out    [out] Where to store the digests, one after the other
+  @return CRYPT_OK if successful
+*/
+int sha512_mb_avx2_memory(int hash, const unsigned char * const *in, const unsigned long *inlen,
+                          unsigned long n, unsigned char *out)
+{
+   sha512_mb_lane *lane;
+   const unsigned char *blk[SHA512_MB_LANES];
+   ulong64 st[8 * SHA512_MB_LANES], iv[8];
+   unsigned char digest[64];
+   unsigned long next, active, hashsize;
+   hash_state md;
+   int i, j, err;
+
+   if ((err = hash_descriptor[hash].init(&md)) != CRYPT_OK) {
+      return err;
+   }
+   for (i = 0; i < 8; i++) {
+      iv[i] = md.sha512.state[i];
+   }
+   hashsize = hash_descriptor[hash].hashsize;
+
+   lane = XMALLOC(SHA512_MB_LANES * sizeof(*lane));
+   if (lane == NULL) {
+      return CRYPT_MEM;
+   }
+
+   next = 0;
+   active = 0;
+   for (j = 0; j < SHA512_MB_LANES; j++) {
+      lane[j].left = 0;
+      if (next < n) {
+         s_sha512_mb_start(&lane[j], st, j, iv, in[next], inlen[next], next);
+         next++;
+         active++;
+      }
+   }
+
+   while (active > 0) {
+      for (j = 0; j < SHA512_MB_LANES; j++) {
+         if (lane[j].left == 0) {
+            blk[j] = s_sha512_mb_zero;
+         } else if (lane[j].full > 0) {
+            blk[j] = lane[j].in;
+         } else {
+            blk[j] = lane[j].tail + 128 * (lane[j].ntail - lane[j].left);
+         }
+      }
+      s_sha512_mb_avx2_compress(st, blk);
+
+      for (j = 0; j < SHA512_MB_LANES; j++) {
+         if (lane[j].left == 0) {
+            continue;
+         }
+         if (lane[j].full > 0) {
+            lane[j].in += 128;
+            lane[j].full--;
+         }
+         if (--lane[j].left > 0) {
+            continue;
+         }
+         /* the message is done */
+         for (i = 0; i < 8; i++) {
+            STORE64H(st[4 * i + j], digest + 8 * i);
+         }
+         XMEMCPY(out + hashsize * lane[j].idx, digest, hashsize);
+         active--;
+         if (next < n) {
+            s_sha512_mb_start(&lane[j], st, j, iv, in[next], inlen[next], next);
+            next++;
+            active++;
+         }
+      }
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(lane, SHA512_MB_LANES * sizeof(*lane));
+   zeromem(st, sizeof(st));
+   zeromem(digest, sizeof(digest));
+#endif
+   XFREE(lane);
+   return CRYPT_OK;
+}
+
+#endif
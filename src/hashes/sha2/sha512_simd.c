@@ -0,0 +1,255 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha512_simd.c
+  SHA-384/512 compression with the message schedule computed by SSSE3 resp. AVX2
+
+  The words W[16..79] are computed two at a time (W[t-2] is the closest
+  dependency) and stored with the round constants added, so the rounds
+  only read W[t]+K[t].  With AVX2 the upper half of the vectors computes
+  the schedule of the following block, i.e. two blocks share the work,
+  and the rounds may use the rotate of BMI2.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_SHA512) && defined(LTC_SHA512_SIMD)
+
+static const ulong64 s_sha512_simd_K[80] = {
+CONST64(0x428a2f98d728ae22), CONST64(0x7137449123ef65cd),
+CONST64(0xb5c0fbcfec4d3b2f), CONST64(0xe9b5dba58189dbbc),
+CONST64(0x3956c25bf348b538), CONST64(0x59f111f1b605d019),
+CONST64(0x923f82a4af194f9b), CONST64(0xab1c5ed5da6d8118),
+CONST64(0xd807aa98a3030242), CONST64(0x12835b0145706fbe),
+CONST64(0x243185be4ee4b28c), CONST64(0x550c7dc3d5ffb4e2),
+CONST64(0x72be5d74f27b896f), CONST64(0x80deb1fe3b1696b1),
+CONST64(0x9bdc06a725c71235), CONST64(0xc19bf174cf692694),
+CONST64(0xe49b69c19ef14ad2), CONST64(0xefbe4786384f25e3),
+CONST64(0x0fc19dc68b8cd5b5), CONST64(0x240ca1cc77ac9c65),
+CONST64(0x2de92c6f592b0275), CONST64(0x4a7484aa6ea6e483),
+CONST64(0x5cb0a9dcbd41fbd4), CONST64(0x76f988da831153b5),
+CONST64(0x983e5152ee66dfab), CONST64(0xa831c66d2db43210),
+CONST64(0xb00327c898fb213f), CONST64(0xbf597fc7beef0ee4),
+CONST64(0xc6e00bf33da88fc2), CONST64(0xd5a79147930aa725),
+CONST64(0x06ca6351e003826f), CONST64(0x142929670a0e6e70),
+CONST64(0x27b70a8546d22ffc), CONST64(0x2e1b21385c26c926),
+CONST64(0x4d2c6dfc5ac42aed), CONST64(0x53380d139d95b3df),
+CONST64(0x650a73548baf63de), CONST64(0x766a0abb3c77b2a8),
+CONST64(0x81c2c92e47edaee6), CONST64(0x92722c851482353b),
+CONST64(0xa2bfe8a14cf10364), CONST64(0xa81a664bbc423001),
+CONST64(0xc24b8b70d0f89791), CONST64(0xc76c51a30654be30),
+CONST64(0xd192e819d6ef5218), CONST64(0xd69906245565a910),
+CONST64(0xf40e35855771202a), CONST64(0x106aa07032bbd1b8),
+CONST64(0x19a4c116b8d2d0c8), CONST64(0x1e376c085141ab53),
+CONST64(0x2748774cdf8eeb99), CONST64(0x34b0bcb5e19b48a8),
+CONST64(0x391c0cb3c5c95a63), CONST64(0x4ed8aa4ae3418acb),
+CONST64(0x5b9cca4f7763e373), CONST64(0x682e6ff3d6b2b8a3),
+CONST64(0x748f82ee5defb2fc), CONST64(0x78a5636f43172f60),
+CONST64(0x84c87814a1f0ab72), CONST64(0x8cc702081a6439ec),
+CONST64(0x90befffa23631e28), CONST64(0xa4506cebde82bde9),
+CONST64(0xbef9a3f7b2c67915), CONST64(0xc67178f2e372532b),
+CONST64(0xca273eceea26619c), CONST64(0xd186b8c721c0c207),
+CONST64(0xeada7dd6cde0eb1e), CONST64(0xf57d4f7fee6ed178),
+CONST64(0x06f067aa72176fba), CONST64(0x0a637dc5a2c898a6),
+CONST64(0x113f9804bef90dae), CONST64(0x1b710b35131c471b),
+CONST64(0x28db77f523047d84), CONST64(0x32caab7b40c72493),
+CONST64(0x3c9ebe0a15c9bebc), CONST64(0x431d67c49c100d4c),
+CONST64(0x4cc5d4becb3e42b6), CONST64(0x597f299cfc657e2a),
+CONST64(0x5fcb6fab3ad6faec), CONST64(0x6c44198c4a475817)
+};
+
+/**
+  Check whether the CPU supports SSSE3 (the minimum for sha512_simd_compress())
+  @return 1 if supported, 0 otherwise
+*/
+int sha512_simd_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_SSSE3) == LTC_CPU_SSSE3;
+}
+
+/* the 80 rounds with WK[t] = W[t] + K[t] */
+static LTC_INLINE void s_sha512_simd_rounds(ulong64 *state, const ulong64 *WK)
+{
+   ulong64 a, b, c, d, e, f, g, h, t0, t1;
+   int i;
+
+   a = state[0]; b = state[1]; c = state[2]; d = state[3];
+   e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+#define SHA512_SIMD_RND(a, b, c, d, e, f, g, h, i)                                     \
+   t0 = h + (ROR64c(e, 14) ^ ROR64c(e, 18) ^ ROR64c(e, 41)) + (g ^ (e & (f ^ g))) + WK[i]; \
+   t1 = (ROR64c(a, 28) ^ ROR64c(a, 34) ^ ROR64c(a, 39)) + (((a | b) & c) | (a & b));   \
+   d += t0;                                                                            \
+   h  = t0 + t1;
+
+   for (i = 0; i < 80; i += 8) {
+      SHA512_SIMD_RND(a, b, c, d, e, f, g, h, i + 0);
+      SHA512_SIMD_RND(h, a, b, c, d, e, f, g, i + 1);
+      SHA512_SIMD_RND(g, h, a, b, c, d, e, f, i + 2);
+      SHA512_SIMD_RND(f, g, h, a, b, c, d, e, i + 3);
+      SHA512_SIMD_RND(e, f, g, h, a, b, c, d, i + 4);
+      SHA512_SIMD_RND(d, e, f, g, h, a, b, c, i + 5);
+      SHA512_SIMD_RND(c, d, e, f, g, h, a, b, i + 6);
+      SHA512_SIMD_RND(b, c, d, e, f, g, h, a, i + 7);
+   }
+#undef SHA512_SIMD_RND
+
+   state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+   state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/* X[k] = W[2k..2k+1] of the next two words, X[] is a ring of the last 16 words:
+ * W[t] = Gamma1(W[t-2]) + W[t-7] + Gamma0(W[t-15]) + W[t-16]
+ * the SHA512_SIMD_V* operations are defined for the vector width */
+#define SHA512_SIMD_ROR(x, n)   SHA512_SIMD_VOR(SHA512_SIMD_VSRL(x, n), SHA512_SIMD_VSLL(x, 64 - (n)))
+#define SHA512_SIMD_SCHED(X, k)                                                                        \
+   do {                                                                                                \
+      w15 = SHA512_SIMD_VALIGNR(X[((k) + 1) & 7], X[k], 8);                                            \
+      w7  = SHA512_SIMD_VALIGNR(X[((k) + 5) & 7], X[((k) + 4) & 7], 8);                                \
+      w2  = X[((k) + 7) & 7];                                                                          \
+      w15 = SHA512_SIMD_VXOR(SHA512_SIMD_VXOR(SHA512_SIMD_ROR(w15, 1), SHA512_SIMD_ROR(w15, 8)),       \
+                             SHA512_SIMD_VSRL(w15, 7));                                                \
+      w2  = SHA512_SIMD_VXOR(SHA512_SIMD_VXOR(SHA512_SIMD_ROR(w2, 19), SHA512_SIMD_ROR(w2, 61)),       \
+                             SHA512_SIMD_VSRL(w2, 6));                                                 \
+      X[k] = SHA512_SIMD_VADD(SHA512_SIMD_VADD(X[k], w15), SHA512_SIMD_VADD(w7, w2));                  \
+      SHA512_SIMD_VSTORE(X[k], t + 2 * (k));                                                           \
+   } while (0)
+#define SHA512_SIMD_SCHED16(X)                                                                         \
+   do {                                                                                                \
+      SHA512_SIMD_SCHED(X, 0); SHA512_SIMD_SCHED(X, 1); SHA512_SIMD_SCHED(X, 2); SHA512_SIMD_SCHED(X, 3); \
+      SHA512_SIMD_SCHED(X, 4); SHA512_SIMD_SCHED(X, 5); SHA512_SIMD_SCHED(X, 6); SHA512_SIMD_SCHED(X, 7); \
+   } while (0)
+
+#define SHA512_SIMD_VOR      _mm_or_si128
+#define SHA512_SIMD_VXOR     _mm_xor_si128
+#define SHA512_SIMD_VADD     _mm_add_epi64
+#define SHA512_SIMD_VSRL     _mm_srli_epi64
+#define SHA512_SIMD_VSLL     _mm_slli_epi64
+#define SHA512_SIMD_VALIGNR  _mm_alignr_epi8
+/* WK[i..i+1] = x + K[i..i+1] */
+#define SHA512_SIMD_VSTORE(x, i)                                                                       \
+   _mm_storeu_si128((__m128i *)(WK + (i)), _mm_add_epi64(x, _mm_loadu_si128((const __m128i *)(s_sha512_simd_K + (i)))))
+
+/* schedule of one block into WK[0..79] */
+LTC_ATTRIBUTE((__target__("ssse3")))
+static LTC_INLINE void s_sha512_simd_sched_ssse3(const unsigned char *buf, ulong64 *WK)
+{
+   const __m128i bswap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+   __m128i X[8], w15, w7, w2;
+   int k, t;
+
+   for (k = 0; k < 8; k++) {
+      X[k] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buf + 16 * k)), bswap);
+      SHA512_SIMD_VSTORE(X[k], 2 * k);
+   }
+   for (t = 16; t < 80; t += 16) {
+      SHA512_SIMD_SCHED16(X);
+   }
+}
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_sha512_simd_compress_ssse3(ulong64 *state, const unsigned char *buf, unsigned long blocks)
+{
+   ulong64 WK[80];
+
+   for (; blocks > 0; blocks--) {
+      s_sha512_simd_sched_ssse3(buf, WK);
+      s_sha512_simd_rounds(state, WK);
+      buf += 128;
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(WK, sizeof(WK));
+#endif
+}
+
+#undef SHA512_SIMD_VOR
+#undef SHA512_SIMD_VXOR
+#undef SHA512_SIMD_VADD
+#undef SHA512_SIMD_VSRL
+#undef SHA512_SIMD_VSLL
+#undef SHA512_SIMD_VALIGNR
+#undef SHA512_SIMD_VSTORE
+#define SHA512_SIMD_VOR      _mm256_or_si256
+#define SHA512_SIMD_VXOR     _mm256_xor_si256
+#define SHA512_SIMD_VADD     _mm256_add_epi64
+#define SHA512_SIMD_VSRL     _mm256_srli_epi64
+#define SHA512_SIMD_VSLL     _mm256_slli_epi64
+#define SHA512_SIMD_VALIGNR  _mm256_alignr_epi8
+/* WK0[i..i+1] resp. WK1[i..i+1] = x + K[i..i+1] */
+#define SHA512_SIMD_VSTORE(x, i)                                                                       \
+   do {                                                                                                \
+      wk = _mm256_add_epi64(x, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(s_sha512_simd_K + (i))))); \
+      _mm_storeu_si128((__m128i *)(WK0 + (i)), _mm256_castsi256_si128(wk));                            \
+      _mm_storeu_si128((__m128i *)(WK1 + (i)), _mm256_extracti128_si256(wk, 1));                       \
+   } while (0)
+
+/* schedule of two blocks into WK0[0..79] and WK1[0..79] */
+LTC_ATTRIBUTE((__target__("avx2")))
+static LTC_INLINE void s_sha512_simd_sched_avx2(const unsigned char *buf, ulong64 *WK0, ulong64 *WK1)
+{
+   const __m256i bswap = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+   __m256i X[8], w15, w7, w2, wk;
+   int k, t;
+
+   for (k = 0; k < 8; k++) {
+      X[k] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(buf + 16 * k))),
+                                     _mm_loadu_si128((const __m128i *)(buf + 128 + 16 * k)), 1);
+      X[k] = _mm256_shuffle_epi8(X[k], bswap);
+      SHA512_SIMD_VSTORE(X[k], 2 * k);
+   }
+   for (t = 16; t < 80; t += 16) {
+      SHA512_SIMD_SCHED16(X);
+   }
+}
+
+LTC_ATTRIBUTE((__target__("avx2,bmi2")))
+static void s_sha512_simd_compress_avx2(ulong64 *state, const unsigned char *buf, unsigned long blocks)
+{
+   ulong64 WK[2][80];
+
+   for (; blocks > 1; blocks -= 2) {
+      s_sha512_simd_sched_avx2(buf, WK[0], WK[1]);
+      s_sha512_simd_rounds(state, WK[0]);
+      s_sha512_simd_rounds(state, WK[1]);
+      buf += 256;
+   }
+   if (blocks > 0) {
+      s_sha512_simd_sched_ssse3(buf, WK[0]);
+      s_sha512_simd_rounds(state, WK[0]);
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(WK, sizeof(WK));
+#endif
+}
+
+#undef SHA512_SIMD_ROR
+#undef SHA512_SIMD_SCHED
+#undef SHA512_SIMD_SCHED16
+#undef SHA512_SIMD_VSTORE
+#undef SHA512_SIMD_VOR
+#undef SHA512_SIMD_VXOR
+#undef SHA512_SIMD_VADD
+#undef SHA512_SIMD_VSRL
+#undef SHA512_SIMD_VSLL
+#undef SHA512_SIMD_VALIGNR
+
+/**
+  Compress blocks of 128 bytes, with AVX2 if the CPU supports it, otherwise with SSSE3
+  @param state   The SHA-512 state (8 words)
+  @param buf     The blocks to compress
+  @param blocks  The number of blocks
+*/
+void sha512_simd_compress(ulong64 *state, const unsigned char *buf, unsigned long blocks)
+{
+   const ulong32 avx2 = LTC_CPU_AVX2 | LTC_CPU_BMI2;
+
+   if ((ltc_cpu_features() & avx2) == avx2) {
+      s_sha512_simd_compress_avx2(state, buf, blocks);
+   } else {
+      s_sha512_simd_compress_ssse3(state, buf, blocks);
+   }
+}
+
+#endif
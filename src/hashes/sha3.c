@@ -146,6 +146,7 @@ static const ulong64 s_keccakf_rndc[24] = {
    CONST64(0x0000000080000001), CONST64(0x8000000080008008)
 };
 
+#ifdef LTC_SMALL_CODE
 static const unsigned s_keccakf_rotc[24] = {
    1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
 };
@@ -154,12 +155,12 @@ static const unsigned s_keccakf_piln[24] = {
    10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
 };
 
-static void s_keccakf(ulong64 s[25])
+static void s_keccakp(ulong64 s[25], int rounds)
 {
    int i, j, round;
    ulong64 t, bc[5];
 
-   for(round = 0; round < SHA3_KECCAK_ROUNDS; round++) {
+   for(round = SHA3_KECCAK_ROUNDS - rounds; round < SHA3_KECCAK_ROUNDS; round++) {
       /* Theta */
       for(i = 0; i < 5; i++) {
          bc[i] = s[i] ^ s[i + 5] ^ s[i + 10] ^ s[i + 15] ^ s[i + 20];
@@ -192,6 +193,107 @@ static void s_keccakf(ulong64 s[25])
    }
 }
 
+#else
+
+/* One round from the lanes A.. to the lanes E.., the rows are named b g k m s and the columns a e i o u.
+ * The lanes 1, 2, 8, 12, 17 and 20 are kept complemented ("lane complementing", c.f. the Keccak
+ * implementation overview), which turns most of the NOTs of Chi into ORs. */
+#define SHA3_KECCAK_ROUND(A, E, i) \
+   do { \
+      Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+      Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+      Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+      Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+      Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+      Da = Cu ^ ROL64c(Ce, 1);                    \
+      De = Ca ^ ROL64c(Ci, 1);                    \
+      Di = Ce ^ ROL64c(Co, 1);                    \
+      Do = Ci ^ ROL64c(Cu, 1);                    \
+      Du = Co ^ ROL64c(Ca, 1);                    \
+      Ba = A##ba ^ Da;                            \
+      Be = ROL64c((A##ge ^ De), 44);              \
+      Bi = ROL64c((A##ki ^ Di), 43);              \
+      Bo = ROL64c((A##mo ^ Do), 21);              \
+      Bu = ROL64c((A##su ^ Du), 14);              \
+      E##ba = Ba ^ (Be | Bi);                     \
+      E##be = Be ^ (~Bi | Bo);                    \
+      E##bi = Bi ^ (Bo & Bu);                     \
+      E##bo = Bo ^ (Bu | Ba);                     \
+      E##bu = Bu ^ (Ba & Be);                     \
+      Ba = ROL64c((A##bo ^ Do), 28);              \
+      Be = ROL64c((A##gu ^ Du), 20);              \
+      Bi = ROL64c((A##ka ^ Da), 3);               \
+      Bo = ROL64c((A##me ^ De), 45);              \
+      Bu = ROL64c((A##si ^ Di), 61);              \
+      E##ga = Ba ^ (Be | Bi);                     \
+      E##ge = Be ^ (Bi & Bo);                     \
+      E##gi = Bi ^ (Bo | ~Bu);                    \
+      E##go = Bo ^ (Bu | Ba);                     \
+      E##gu = Bu ^ (Ba & Be);                     \
+      Ba = ROL64c((A##be ^ De), 1);               \
+      Be = ROL64c((A##gi ^ Di), 6);               \
+      Bi = ROL64c((A##ko ^ Do), 25);              \
+      Bo = ROL64c((A##mu ^ Du), 8);               \
+      Bu = ROL64c((A##sa ^ Da), 18);              \
+      E##ka = Ba ^ (Be | Bi);                     \
+      E##ke = Be ^ (Bi & Bo);                     \
+      E##ki = Bi ^ (~Bo & Bu);                    \
+      E##ko = ~Bo ^ (Bu | Ba);                    \
+      E##ku = Bu ^ (Ba & Be);                     \
+      Ba = ROL64c((A##bu ^ Du), 27);              \
+      Be = ROL64c((A##ga ^ Da), 36);              \
+      Bi = ROL64c((A##ke ^ De), 10);              \
+      Bo = ROL64c((A##mi ^ Di), 15);              \
+      Bu = ROL64c((A##so ^ Do), 56);              \
+      E##ma = Ba ^ (Be & Bi);                     \
+      E##me = Be ^ (Bi | Bo);                     \
+      E##mi = Bi ^ (~Bo | Bu);                    \
+      E##mo = ~Bo ^ (Bu & Ba);                    \
+      E##mu = Bu ^ (Ba | Be);                     \
+      Ba = ROL64c((A##bi ^ Di), 62);              \
+      Be = ROL64c((A##go ^ Do), 55);              \
+      Bi = ROL64c((A##ku ^ Du), 39);              \
+      Bo = ROL64c((A##ma ^ Da), 41);              \
+      Bu = ROL64c((A##se ^ De), 2);               \
+      E##sa = Ba ^ (~Be & Bi);                    \
+      E##se = ~Be ^ (Bi | Bo);                    \
+      E##si = Bi ^ (Bo & Bu);                     \
+      E##so = Bo ^ (Bu | Ba);                     \
+      E##su = Bu ^ (Ba & Be);                     \
+      E##ba ^= s_keccakf_rndc[i];                 \
+   } while (0)
+
+static void s_keccakp(ulong64 s[25], int rounds)
+{
+   ulong64 Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki,
+           Ako, Aku, Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+   ulong64 Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki,
+           Eko, Eku, Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+   ulong64 Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu;
+   int i;
+
+   Aba = s[0]; Abe = ~s[1]; Abi = ~s[2]; Abo = s[3]; Abu = s[4];
+   Aga = s[5]; Age = s[6]; Agi = s[7]; Ago = ~s[8]; Agu = s[9];
+   Aka = s[10]; Ake = s[11]; Aki = ~s[12]; Ako = s[13]; Aku = s[14];
+   Ama = s[15]; Ame = s[16]; Ami = ~s[17]; Amo = s[18]; Amu = s[19];
+   Asa = ~s[20]; Ase = s[21]; Asi = s[22]; Aso = s[23]; Asu = s[24];
+
+   for (i = SHA3_KECCAK_ROUNDS - rounds; i < SHA3_KECCAK_ROUNDS; i += 2) {
+      SHA3_KECCAK_ROUND(A, E, i);
+      SHA3_KECCAK_ROUND(E, A, i + 1);
+   }
+
+   s[0] = Aba; s[1] = ~Abe; s[2] = ~Abi; s[3] = Abo; s[4] = Abu;
+   s[5] = Aga; s[6] = Age; s[7] = Agi; s[8] = ~Ago; s[9] = Agu;
+   s[10] = Aka; s[11] = Ake; s[12] = ~Aki; s[13] = Ako; s[14] = Aku;
+   s[15] = Ama; s[16] = Ame; s[17] = ~Ami; s[18] = Amo; s[19] = Amu;
+   s[20] = ~Asa; s[21] = Ase; s[22] = Asi; s[23] = Aso; s[24] = Asu;
+}
+
+#undef SHA3_KECCAK_ROUND
+
+#endif
+
 static LTC_INLINE int ss_done(hash_state *md, unsigned char *hash, ulong64 pad)
 {
    unsigned i;
@@ -201,7 +303,7 @@ static LTC_INLINE int ss_done(hash_state *md, unsigned char *hash, ulong64 pad)
 
    md->sha3.s[md->sha3.word_index] ^= (md->sha3.saved ^ (pad << (md->sha3.byte_index * 8)));
    md->sha3.s[SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words - 1] ^= CONST64(0x8000000000000000);
-   s_keccakf(md->sha3.s);
+   s_keccakp(md->sha3.s, md->sha3.rounds);
 
    /* store sha3.s[] as little-endian bytes into sha3.sb */
    for(i = 0; i < SHA3_KECCAK_SPONGE_WORDS; i++) {
@@ -219,6 +321,7 @@ int sha3_224_init(hash_state *md)
    LTC_ARGCHK(md != NULL);
    XMEMSET(&md->sha3, 0, sizeof(md->sha3));
    md->sha3.capacity_words = 2 * 224 / (8 * sizeof(ulong64));
+   md->sha3.rounds = SHA3_KECCAK_ROUNDS;
    return CRYPT_OK;
 }
 
@@ -227,6 +330,7 @@ int sha3_256_init(hash_state *md)
    LTC_ARGCHK(md != NULL);
    XMEMSET(&md->sha3, 0, sizeof(md->sha3));
    md->sha3.capacity_words = 2 * 256 / (8 * sizeof(ulong64));
+   md->sha3.rounds = SHA3_KECCAK_ROUNDS;
    return CRYPT_OK;
 }
 
@@ -235,6 +339,7 @@ int sha3_384_init(hash_state *md)
    LTC_ARGCHK(md != NULL);
    XMEMSET(&md->sha3, 0, sizeof(md->sha3));
    md->sha3.capacity_words = 2 * 384 / (8 * sizeof(ulong64));
+   md->sha3.rounds = SHA3_KECCAK_ROUNDS;
    return CRYPT_OK;
 }
 
@@ -243,6 +348,7 @@ int sha3_512_init(hash_state *md)
    LTC_ARGCHK(md != NULL);
    XMEMSET(&md->sha3, 0, sizeof(md->sha3));
    md->sha3.capacity_words = 2 * 512 / (8 * sizeof(ulong64));
+   md->sha3.rounds = SHA3_KECCAK_ROUNDS;
    return CRYPT_OK;
 }
 
@@ -253,6 +359,109 @@ int sha3_shake_init(hash_state *md, int num)
    if (num != 128 && num != 256) return CRYPT_INVALID_ARG;
    XMEMSET(&md->sha3, 0, sizeof(md->sha3));
    md->sha3.capacity_words = (unsigned short)(2 * num / (8 * sizeof(ulong64)));
+   md->sha3.rounds = SHA3_KECCAK_ROUNDS;
+   md->sha3.xof_pad = 0x1F;
+   return CRYPT_OK;
+}
+
+/**
+   Encode x as in NIST SP 800-185, the length byte first
+   @param x    The value to encode
+   @param out  [out] The encoding (at most 9 bytes)
+   @return The length of the encoding
+*/
+unsigned long sha3_left_encode(ulong64 x, unsigned char *out)
+{
+   unsigned char tmp[8];
+   unsigned long n = 0, i;
+
+   do {
+      tmp[n++] = (unsigned char)(x & 255);
+      x >>= 8;
+   } while (x != 0);
+   out[0] = (unsigned char)n;
+   for (i = 0; i < n; i++) {
+      out[1 + i] = tmp[n - 1 - i];
+   }
+   return n + 1;
+}
+
+/**
+   Encode x as in NIST SP 800-185, the length byte last
+   @param x    The value to encode
+   @param out  [out] The encoding (at most 9 bytes)
+   @return The length of the encoding
+*/
+unsigned long sha3_right_encode(ulong64 x, unsigned char *out)
+{
+   unsigned long n = sha3_left_encode(x, out);
+
+   XMEMMOVE(out, out + 1, n - 1);
+   out[n - 1] = (unsigned char)(n - 1);
+   return n;
+}
+
+/**
+   Initialize cSHAKE128 resp. cSHAKE256 [NIST SP 800-185]
+   @param md         The hash state you wish to initialize
+   @param num        The security strength, 128 or 256
+   @param name       The function name N (may be NULL if namelen is 0)
+   @param namelen    The length of N (octets)
+   @param custom     The customization string S (may be NULL if customlen is 0)
+   @param customlen  The length of S (octets)
+   @return CRYPT_OK if successful
+*/
+int sha3_cshake_init(hash_state *md, int num, const unsigned char *name, unsigned long namelen,
+                     const unsigned char *custom, unsigned long customlen)
+{
+   unsigned char buf[9];
+   unsigned long len, total, rate;
+   int err;
+
+   LTC_ARGCHK(name   != NULL || namelen   == 0);
+   LTC_ARGCHK(custom != NULL || customlen == 0);
+
+   if ((err = sha3_shake_init(md, num)) != CRYPT_OK) return err;
+   /* with an empty N and S cSHAKE is SHAKE */
+   if (namelen == 0 && customlen == 0) return CRYPT_OK;
+
+   md->sha3.xof_pad = 0x04;
+   rate = (SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words) * 8;
+   /* bytepad(encode_string(N) || encode_string(S), rate) */
+   total = len = sha3_left_encode(rate, buf);
+   sha3_process(md, buf, len);
+   total += len = sha3_left_encode((ulong64)namelen * 8, buf);
+   sha3_process(md, buf, len);
+   sha3_process(md, name, namelen);
+   total += len = sha3_left_encode((ulong64)customlen * 8, buf);
+   sha3_process(md, buf, len);
+   sha3_process(md, custom, customlen);
+   total = (total + namelen + customlen) % rate;
+   if (total != 0) {
+      XMEMSET(buf, 0, sizeof(buf));
+      for (total = rate - total; total > 0; total -= len) {
+         len = MIN(total, sizeof(buf));
+         sha3_process(md, buf, len);
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Initialize TurboSHAKE128 resp. TurboSHAKE256 [RFC 9861], i.e. SHAKE with 12 rounds
+   @param md      The hash state you wish to initialize
+   @param num     The security strength, 128 or 256
+   @param domain  The domain separation byte D, 0x01 to 0x7F
+   @return CRYPT_OK if successful
+*/
+int sha3_turboshake_init(hash_state *md, int num, unsigned char domain)
+{
+   int err;
+
+   if (domain < 0x01 || domain > 0x7F) return CRYPT_INVALID_ARG;
+   if ((err = sha3_shake_init(md, num)) != CRYPT_OK) return err;
+   md->sha3.rounds = SHA3_KECCAK_ROUNDS / 2;
+   md->sha3.xof_pad = domain;
    return CRYPT_OK;
 }
 #endif
@@ -262,7 +471,7 @@ int sha3_process(hash_state *md, const unsigned char *in, unsigned long inlen)
    /* 0...7 -- how much is needed to have a word */
    unsigned old_tail = (8 - md->sha3.byte_index) & 7;
 
-   unsigned long words;
+   unsigned long words, rate;
    unsigned tail;
    unsigned long i;
 
@@ -283,7 +492,7 @@ int sha3_process(hash_state *md, const unsigned char *in, unsigned long inlen)
       md->sha3.byte_index = 0;
       md->sha3.saved = 0;
       if(++md->sha3.word_index == (SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words)) {
-         s_keccakf(md->sha3.s);
+         s_keccakp(md->sha3.s, md->sha3.rounds);
          md->sha3.word_index = 0;
       }
    }
@@ -292,12 +501,25 @@ int sha3_process(hash_state *md, const unsigned char *in, unsigned long inlen)
    words = inlen / sizeof(ulong64);
    tail = inlen - words * sizeof(ulong64);
 
+   /* whole blocks while the sponge is at the start of a block */
+   if (md->sha3.word_index == 0) {
+      rate = SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words;
+      for (; words >= rate; words -= rate) {
+         for (i = 0; i < rate; i++, in += sizeof(ulong64)) {
+            ulong64 t;
+            LOAD64L(t, in);
+            md->sha3.s[i] ^= t;
+         }
+         s_keccakp(md->sha3.s, md->sha3.rounds);
+      }
+   }
+
    for(i = 0; i < words; i++, in += sizeof(ulong64)) {
       ulong64 t;
       LOAD64L(t, in);
       md->sha3.s[md->sha3.word_index] ^= t;
       if(++md->sha3.word_index == (SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words)) {
-         s_keccakf(md->sha3.s);
+         s_keccakp(md->sha3.s, md->sha3.rounds);
          md->sha3.word_index = 0;
       }
    }
@@ -336,9 +558,9 @@ int sha3_shake_done(hash_state *md, unsigned char *out, unsigned long outlen)
 
    if (!md->sha3.xof_flag) {
       /* shake_xof operation must be done only once */
-      md->sha3.s[md->sha3.word_index] ^= (md->sha3.saved ^ (CONST64(0x1F) << (md->sha3.byte_index * 8)));
+      md->sha3.s[md->sha3.word_index] ^= (md->sha3.saved ^ ((ulong64)md->sha3.xof_pad << (md->sha3.byte_index * 8)));
       md->sha3.s[SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words - 1] ^= CONST64(0x8000000000000000);
-      s_keccakf(md->sha3.s);
+      s_keccakp(md->sha3.s, md->sha3.rounds);
       /* store sha3.s[] as little-endian bytes into sha3.sb */
       for(i = 0; i < SHA3_KECCAK_SPONGE_WORDS; i++) {
          STORE64L(md->sha3.s[i], md->sha3.sb + i * 8);
@@ -349,7 +571,7 @@ int sha3_shake_done(hash_state *md, unsigned char *out, unsigned long outlen)
 
    for (idx = 0; idx < outlen; idx++) {
       if(md->sha3.byte_index >= (SHA3_KECCAK_SPONGE_WORDS - md->sha3.capacity_words) * 8) {
-         s_keccakf(md->sha3.s);
+         s_keccakp(md->sha3.s, md->sha3.rounds);
          /* store sha3.s[] as little-endian bytes into sha3.sb */
          for(i = 0; i < SHA3_KECCAK_SPONGE_WORDS; i++) {
             STORE64L(md->sha3.s[i], md->sha3.sb + i * 8);
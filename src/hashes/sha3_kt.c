@@ -0,0 +1,132 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha3_kt.c
+  KangarooTwelve KT128 and KT256 [RFC 9861]
+
+  The input is cut into chunks of 8192 bytes, all but the first are hashed
+  independently with TurboSHAKE into chaining values which are absorbed by
+  the final node.  With LTC_SHA3_X4 four chunks are hashed at once.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_SHA3
+
+#define SHA3_KT_CHUNK 8192
+
+/* S = M || C || length_encode(|C|) in three parts */
+struct s_kt_input {
+   const unsigned char *part[3];
+   unsigned long len[3];
+};
+
+/* absorb len bytes of S starting at off */
+static void s_kt_absorb(hash_state *md, const struct s_kt_input *S, unsigned long off, unsigned long len)
+{
+   unsigned long i, n;
+
+   for (i = 0; i < 3 && len > 0; i++) {
+      if (off >= S->len[i]) {
+         off -= S->len[i];
+         continue;
+      }
+      n = MIN(S->len[i] - off, len);
+      sha3_process(md, S->part[i] + off, n);
+      len -= n;
+      off = 0;
+   }
+}
+
+/* length_encode() of RFC 9861, x = 0 is encoded as the single byte 0 */
+static unsigned long s_kt_length_encode(unsigned long x, unsigned char *out)
+{
+   if (x == 0) {
+      out[0] = 0;
+      return 1;
+   }
+   return sha3_right_encode(x, out);
+}
+
+/**
+  Compute KT128 resp. KT256 of a message
+  @param num        The security strength, 128 (KT128) or 256 (KT256)
+  @param in         The message M
+  @param inlen      The length of M (octets)
+  @param custom     The customization string C (may be NULL if customlen is 0)
+  @param customlen  The length of C (octets)
+  @param out        [out] The output
+  @param outlen     The length of the output (octets)
+  @return CRYPT_OK if successful
+*/
+int sha3_kt_memory(int num, const unsigned char *in, unsigned long inlen,
+                   const unsigned char *custom, unsigned long customlen,
+                   unsigned char *out, const unsigned long *outlen)
+{
+   static const unsigned char marker[8] = { 0x03, 0, 0, 0, 0, 0, 0, 0 };
+   static const unsigned char terminator[2] = { 0xFF, 0xFF };
+   hash_state md, leaf;
+   struct s_kt_input S;
+   unsigned char enc[9], cv[4 * 64];
+   unsigned long total, off, len, n, cvlen;
+   int err;
+
+   LTC_ARGCHK(in     != NULL || inlen     == 0);
+   LTC_ARGCHK(custom != NULL || customlen == 0);
+   LTC_ARGCHK(out    != NULL);
+   LTC_ARGCHK(outlen != NULL);
+
+   if (num != 128 && num != 256) return CRYPT_INVALID_ARG;
+   if (inlen > ULONG_MAX - sizeof(enc) || customlen > ULONG_MAX - sizeof(enc) - inlen) return CRYPT_OVERFLOW;
+
+   cvlen = (unsigned long)num / 4;
+   S.part[0] = in;
+   S.len[0]  = inlen;
+   S.part[1] = custom;
+   S.len[1]  = customlen;
+   S.part[2] = enc;
+   S.len[2]  = s_kt_length_encode(customlen, enc);
+   total = inlen + customlen + S.len[2];
+
+   if (total <= SHA3_KT_CHUNK) {
+      /* a single node */
+      if ((err = sha3_turboshake_init(&md, num, 0x07)) != CRYPT_OK) return err;
+      s_kt_absorb(&md, &S, 0, total);
+   } else {
+      /* the final node: S_0 || 03 00^7 || CV_1 .. CV_n-1 || length_encode(n-1) || FF FF */
+      if ((err = sha3_turboshake_init(&md, num, 0x06)) != CRYPT_OK) return err;
+      s_kt_absorb(&md, &S, 0, SHA3_KT_CHUNK);
+      sha3_process(&md, marker, sizeof(marker));
+      for (off = SHA3_KT_CHUNK, n = 0; off < total; off += len) {
+#ifdef LTC_SHA3_X4
+         if (inlen - MIN(off, inlen) >= 4 * SHA3_KT_CHUNK && sha3_x4_avx2_is_supported()) {
+            len = 4 * SHA3_KT_CHUNK;
+            sha3_x4_avx2_sponge(in + off, SHA3_KT_CHUNK, 200 - cvlen, 0x0B, 12, cv, cvlen);
+            sha3_process(&md, cv, 4 * cvlen);
+            n += 4;
+            continue;
+         }
+#endif
+         len = MIN(total - off, SHA3_KT_CHUNK);
+         if ((err = sha3_turboshake_init(&leaf, num, 0x0B)) != CRYPT_OK) goto LBL_ERR;
+         s_kt_absorb(&leaf, &S, off, len);
+         sha3_turboshake_done(&leaf, cv, cvlen);
+         sha3_process(&md, cv, cvlen);
+         n++;
+      }
+      sha3_process(&md, enc, s_kt_length_encode(n, enc));
+      sha3_process(&md, terminator, sizeof(terminator));
+   }
+   err = sha3_turboshake_done(&md, out, *outlen);
+
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(&md, sizeof(md));
+   zeromem(&leaf, sizeof(leaf));
+   zeromem(cv, sizeof(cv));
+#endif
+   return err;
+}
+
+#endif
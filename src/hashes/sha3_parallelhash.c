@@ -0,0 +1,106 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha3_parallelhash.c
+  ParallelHash128/256 and ParallelHashXOF128/256 [NIST SP 800-185]
+
+  The input is cut into blocks of a chosen length which are hashed
+  independently with SHAKE, the results are absorbed by cSHAKE.  With
+  LTC_SHA3_X4 four blocks are hashed at once.
+*/
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_SHA3
+
+static int s_parallelhash(int num, unsigned long blocklen, const unsigned char *in, unsigned long inlen,
+                          const unsigned char *custom, unsigned long customlen,
+                          unsigned char *out, const unsigned long *outlen, int xof)
+{
+   static const unsigned char name[12] = { 'P', 'a', 'r', 'a', 'l', 'l', 'e', 'l', 'H', 'a', 's', 'h' };
+   hash_state md, leaf;
+   unsigned char enc[9], z[4 * 64];
+   unsigned long off, len, n, zlen;
+   int err;
+
+   LTC_ARGCHK(in     != NULL || inlen     == 0);
+   LTC_ARGCHK(custom != NULL || customlen == 0);
+   LTC_ARGCHK(out    != NULL);
+   LTC_ARGCHK(outlen != NULL);
+
+   if (blocklen == 0) return CRYPT_INVALID_ARG;
+   if ((err = sha3_cshake_init(&md, num, name, sizeof(name), custom, customlen)) != CRYPT_OK) return err;
+   zlen = (unsigned long)num / 4;
+
+   /* left_encode(B) || z_0 .. z_n-1 || right_encode(n) || right_encode(L) */
+   sha3_process(&md, enc, sha3_left_encode(blocklen, enc));
+   for (off = 0, n = 0; off < inlen; off += len) {
+#ifdef LTC_SHA3_X4
+      if ((inlen - off) / 4 >= blocklen && sha3_x4_avx2_is_supported()) {
+         len = 4 * blocklen;
+         sha3_x4_avx2_sponge(in + off, blocklen, 200 - zlen, 0x1F, 24, z, zlen);
+         sha3_process(&md, z, 4 * zlen);
+         n += 4;
+         continue;
+      }
+#endif
+      len = MIN(inlen - off, blocklen);
+      if ((err = sha3_shake_init(&leaf, num)) != CRYPT_OK) goto LBL_ERR;
+      sha3_shake_process(&leaf, in + off, len);
+      sha3_shake_done(&leaf, z, zlen);
+      sha3_process(&md, z, zlen);
+      n++;
+   }
+   sha3_process(&md, enc, sha3_right_encode(n, enc));
+   sha3_process(&md, enc, sha3_right_encode(xof ? 0 : (ulong64)*outlen * 8, enc));
+   err = sha3_cshake_done(&md, out, *outlen);
+
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(&md, sizeof(md));
+   zeromem(&leaf, sizeof(leaf));
+   zeromem(z, sizeof(z));
+#endif
+   return err;
+}
+
+/**
+  Compute ParallelHash128 resp. ParallelHash256 of a message
+  @param num        The security strength, 128 or 256
+  @param blocklen   The block size B (octets)
+  @param in         The message X
+  @param inlen      The length of X (octets)
+  @param custom     The customization string S (may be NULL if customlen is 0)
+  @param customlen  The length of S (octets)
+  @param out        [out] The output
+  @param outlen     The length of the output L (octets)
+  @return CRYPT_OK if successful
+*/
+int sha3_parallelhash_memory(int num, unsigned long blocklen, const unsigned char *in, unsigned long inlen,
+                             const unsigned char *custom, unsigned long customlen,
+                             unsigned char *out, const unsigned long *outlen)
+{
+   return s_parallelhash(num, blocklen, in, inlen, custom, customlen, out, outlen, 0);
+}
+
+/**
+  Compute ParallelHashXOF128 resp. ParallelHashXOF256 of a message
+  @param num        The security strength, 128 or 256
+  @param blocklen   The block size B (octets)
+  @param in         The message X
+  @param inlen      The length of X (octets)
+  @param custom     The customization string S (may be NULL if customlen is 0)
+  @param customlen  The length of S (octets)
+  @param out        [out] The output
+  @param outlen     The length of the output (octets)
+  @return CRYPT_OK if successful
+*/
+int sha3_parallelhash_xof_memory(int num, unsigned long blocklen, const unsigned char *in, unsigned long inlen,
+                                 const unsigned char *custom, unsigned long customlen,
+                                 unsigned char *out, const unsigned long *outlen)
+{
+   return s_parallelhash(num, blocklen, in, inlen, custom, customlen, out, outlen, 1);
+}
+
+#endif
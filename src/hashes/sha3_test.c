@@ -388,6 +388,344 @@ int sha3_shake_test(void)
 #endif
 }
 
+int sha3_turboshake_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* RFC 9861, M = ptn(len) */
+   static const struct {
+      int num;
+      unsigned long len;
+      unsigned char domain;
+      unsigned long outlen;
+      unsigned char out[64];
+   } tests[] = {
+      { 128, 0, 0x1F, 32,
+        { 0x1e, 0x41, 0x5f, 0x1c, 0x59, 0x83, 0xaf, 0xf2,
+          0x16, 0x92, 0x17, 0x27, 0x7d, 0x17, 0xbb, 0x53,
+          0x8c, 0xd9, 0x45, 0xa3, 0x97, 0xdd, 0xec, 0x54,
+          0x1f, 0x1c, 0xe4, 0x1a, 0xf2, 0xc1, 0xb7, 0x4c }
+      },
+      { 128, 289, 0x1F, 32,
+        { 0x96, 0xc7, 0x7c, 0x27, 0x9e, 0x01, 0x26, 0xf7,
+          0xfc, 0x07, 0xc9, 0xb0, 0x7f, 0x5c, 0xda, 0xe1,
+          0xe0, 0xbe, 0x60, 0xbd, 0xbe, 0x10, 0x62, 0x00,
+          0x40, 0xe7, 0x5d, 0x72, 0x23, 0xa6, 0x24, 0xd2 }
+      },
+      { 128, 289, 0x06, 32,
+        { 0xf6, 0x03, 0x92, 0xc7, 0x29, 0xdc, 0x79, 0x28,
+          0xe8, 0xb2, 0xe3, 0x6f, 0xed, 0x5b, 0xff, 0x8a,
+          0x5a, 0x42, 0x75, 0xcf, 0x37, 0x7c, 0xa1, 0x96,
+          0x48, 0x3a, 0x8c, 0xb6, 0xec, 0xae, 0x8a, 0x13 }
+      },
+      { 256, 0, 0x1F, 64,
+        { 0x36, 0x7a, 0x32, 0x9d, 0xaf, 0xea, 0x87, 0x1c,
+          0x78, 0x02, 0xec, 0x67, 0xf9, 0x05, 0xae, 0x13,
+          0xc5, 0x76, 0x95, 0xdc, 0x2c, 0x66, 0x63, 0xc6,
+          0x10, 0x35, 0xf5, 0x9a, 0x18, 0xf8, 0xe7, 0xdb,
+          0x11, 0xed, 0xc0, 0xe1, 0x2e, 0x91, 0xea, 0x60,
+          0xeb, 0x6b, 0x32, 0xdf, 0x06, 0xdd, 0x7f, 0x00,
+          0x2f, 0xba, 0xfa, 0xbb, 0x6e, 0x13, 0xec, 0x1c,
+          0xc2, 0x0d, 0x99, 0x55, 0x47, 0x60, 0x0d, 0xb0 }
+      },
+      { 256, 289, 0x01, 64,
+        { 0xa4, 0x8c, 0x93, 0x87, 0x70, 0xf9, 0x16, 0xb0,
+          0x9d, 0x76, 0x4e, 0x29, 0xe2, 0x27, 0x9b, 0x90,
+          0xd5, 0xfa, 0x3d, 0xd0, 0xe0, 0x06, 0xee, 0x8d,
+          0x6c, 0x2e, 0xb0, 0xdb, 0x88, 0x93, 0x52, 0x5e,
+          0xdf, 0xa2, 0xc0, 0xd2, 0x0c, 0x40, 0xd4, 0x94,
+          0x78, 0xaa, 0x2d, 0x35, 0x5f, 0xe5, 0x45, 0xc6,
+          0x04, 0xee, 0x60, 0x74, 0x73, 0xfa, 0x72, 0x7b,
+          0xd8, 0x35, 0x4c, 0x0a, 0x8c, 0x3e, 0xda, 0xb1 }
+      },
+   };
+   unsigned char buf[289], hash[64];
+   unsigned long i;
+   hash_state c;
+
+   for (i = 0; i < sizeof(buf); i++) {
+      buf[i] = (unsigned char)(i % 251);
+   }
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      if (sha3_turboshake_init(&c, tests[i].num, tests[i].domain) != CRYPT_OK) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+      /* in two steps, the second one doesn't start at a word boundary */
+      sha3_turboshake_process(&c, buf, tests[i].len / 3);
+      sha3_turboshake_process(&c, buf + tests[i].len / 3, tests[i].len - tests[i].len / 3);
+      sha3_turboshake_done(&c, hash, tests[i].outlen);
+      if (compare_testvector(hash, tests[i].outlen, tests[i].out, tests[i].outlen, "TurboSHAKE", (int)i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
+int sha3_cshake_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* NIST SP 800-185 samples, X = 00 01 02 .. */
+   static const struct {
+      int num;
+      unsigned long len;
+      const char *custom;
+      unsigned long outlen;
+      unsigned char out[64];
+   } tests[] = {
+      { 128, 4, "Email Signature", 32,
+        { 0xc1, 0xc3, 0x69, 0x25, 0xb6, 0x40, 0x9a, 0x04,
+          0xf1, 0xb5, 0x04, 0xfc, 0xbc, 0xa9, 0xd8, 0x2b,
+          0x40, 0x17, 0x27, 0x7c, 0xb5, 0xed, 0x2b, 0x20,
+          0x65, 0xfc, 0x1d, 0x38, 0x14, 0xd5, 0xaa, 0xf5 }
+      },
+      { 128, 200, "Email Signature", 32,
+        { 0xc5, 0x22, 0x1d, 0x50, 0xe4, 0xf8, 0x22, 0xd9,
+          0x6a, 0x2e, 0x88, 0x81, 0xa9, 0x61, 0x42, 0x0f,
+          0x29, 0x4b, 0x7b, 0x24, 0xfe, 0x3d, 0x20, 0x94,
+          0xba, 0xed, 0x2c, 0x65, 0x24, 0xcc, 0x16, 0x6b }
+      },
+      { 256, 4, "Email Signature", 64,
+        { 0xd0, 0x08, 0x82, 0x8e, 0x2b, 0x80, 0xac, 0x9d,
+          0x22, 0x18, 0xff, 0xee, 0x1d, 0x07, 0x0c, 0x48,
+          0xb8, 0xe4, 0xc8, 0x7b, 0xff, 0x32, 0xc9, 0x69,
+          0x9d, 0x5b, 0x68, 0x96, 0xee, 0xe0, 0xed, 0xd1,
+          0x64, 0x02, 0x0e, 0x2b, 0xe0, 0x56, 0x08, 0x58,
+          0xd9, 0xc0, 0x0c, 0x03, 0x7e, 0x34, 0xa9, 0x69,
+          0x37, 0xc5, 0x61, 0xa7, 0x4c, 0x41, 0x2b, 0xb4,
+          0xc7, 0x46, 0x46, 0x95, 0x27, 0x28, 0x1c, 0x8c }
+      },
+      { 256, 200, "Email Signature", 64,
+        { 0x07, 0xdc, 0x27, 0xb1, 0x1e, 0x51, 0xfb, 0xac,
+          0x75, 0xbc, 0x7b, 0x3c, 0x1d, 0x98, 0x3e, 0x8b,
+          0x4b, 0x85, 0xfb, 0x1d, 0xef, 0xaf, 0x21, 0x89,
+          0x12, 0xac, 0x86, 0x43, 0x02, 0x73, 0x09, 0x17,
+          0x27, 0xf4, 0x2b, 0x17, 0xed, 0x1d, 0xf6, 0x3e,
+          0x8e, 0xc1, 0x18, 0xf0, 0x4b, 0x23, 0x63, 0x3c,
+          0x1d, 0xfb, 0x15, 0x74, 0xc8, 0xfb, 0x55, 0xcb,
+          0x45, 0xda, 0x8e, 0x25, 0xaf, 0xb0, 0x92, 0xbb }
+      },
+   };
+   unsigned char buf[200], hash[64];
+   unsigned long i;
+   hash_state c;
+
+   for (i = 0; i < sizeof(buf); i++) {
+      buf[i] = (unsigned char)i;
+   }
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      if (sha3_cshake_init(&c, tests[i].num, NULL, 0, (const unsigned char *)tests[i].custom,
+                           (unsigned long)XSTRLEN(tests[i].custom)) != CRYPT_OK) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+      sha3_cshake_process(&c, buf, tests[i].len);
+      sha3_cshake_done(&c, hash, tests[i].outlen);
+      if (compare_testvector(hash, tests[i].outlen, tests[i].out, tests[i].outlen, "cSHAKE", (int)i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
+int sha3_kt_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* RFC 9861, M = ptn(inlen) and C = ptn(customlen) */
+   static const struct {
+      int num;
+      unsigned long inlen, customlen, outlen;
+      unsigned char out[64];
+   } tests[] = {
+      { 128, 0, 0, 32,
+        { 0x1a, 0xc2, 0xd4, 0x50, 0xfc, 0x3b, 0x42, 0x05,
+          0xd1, 0x9d, 0xa7, 0xbf, 0xca, 0x1b, 0x37, 0x51,
+          0x3c, 0x08, 0x03, 0x57, 0x7a, 0xc7, 0x16, 0x7f,
+          0x06, 0xfe, 0x2c, 0xe1, 0xf0, 0xef, 0x39, 0xe5 }
+      },
+      { 128, 289, 0, 32,
+        { 0x0c, 0x31, 0x5e, 0xbc, 0xde, 0xdb, 0xf6, 0x14,
+          0x26, 0xde, 0x7d, 0xcf, 0x8f, 0xb7, 0x25, 0xd1,
+          0xe7, 0x46, 0x75, 0xd7, 0xf5, 0x32, 0x7a, 0x50,
+          0x67, 0xf3, 0x67, 0xb1, 0x08, 0xec, 0xb6, 0x7c }
+      },
+      { 128, 83521, 0, 32,
+        { 0x87, 0x01, 0x04, 0x5e, 0x22, 0x20, 0x53, 0x45,
+          0xff, 0x4d, 0xda, 0x05, 0x55, 0x5c, 0xbb, 0x5c,
+          0x3a, 0xf1, 0xa7, 0x71, 0xc2, 0xb8, 0x9b, 0xae,
+          0xf3, 0x7d, 0xb4, 0x3d, 0x99, 0x98, 0xb9, 0xfe }
+      },
+      { 128, 0, 41, 32,
+        { 0x76, 0xf0, 0x6e, 0x60, 0xfb, 0xa3, 0x74, 0x14,
+          0xe0, 0xdc, 0x56, 0xd9, 0xd1, 0xe5, 0xd0, 0x3b,
+          0x2d, 0x38, 0xc6, 0x72, 0xb7, 0x0c, 0x8c, 0x51,
+          0xd2, 0xe0, 0x0a, 0x4f, 0xa9, 0x59, 0xf1, 0xaa }
+      },
+      { 128, 100000, 41, 32,
+        { 0x67, 0x6c, 0x71, 0x4c, 0x29, 0x07, 0x16, 0xb7,
+          0xe3, 0xdb, 0x56, 0x74, 0xaf, 0x51, 0x4a, 0xe8,
+          0xc4, 0x21, 0xa3, 0x62, 0x80, 0x01, 0xf8, 0x0f,
+          0x97, 0xc5, 0x28, 0xe1, 0x0b, 0x6f, 0x8b, 0x57 }
+      },
+      { 128, 8191, 8189, 32,
+        { 0x1d, 0xdd, 0xc8, 0x89, 0xb3, 0x8b, 0xc1, 0xd3,
+          0xe8, 0xb5, 0x3b, 0x5a, 0xf7, 0xa1, 0x0d, 0x16,
+          0xde, 0x67, 0x71, 0x9b, 0x16, 0x5e, 0x84, 0xe4,
+          0x68, 0xa4, 0x69, 0xc5, 0xd8, 0x9a, 0x86, 0xba }
+      },
+      { 256, 0, 0, 64,
+        { 0xb2, 0x3d, 0x2e, 0x9c, 0xea, 0x9f, 0x49, 0x04,
+          0xe0, 0x2b, 0xec, 0x06, 0x81, 0x7f, 0xc1, 0x0c,
+          0xe3, 0x8c, 0xe8, 0xe9, 0x3e, 0xf4, 0xc8, 0x9e,
+          0x65, 0x37, 0x07, 0x6a, 0xf8, 0x64, 0x64, 0x04,
+          0xe3, 0xe8, 0xb6, 0x81, 0x07, 0xb8, 0x83, 0x3a,
+          0x5d, 0x30, 0x49, 0x0a, 0xa3, 0x34, 0x82, 0x35,
+          0x3f, 0xd4, 0xad, 0xc7, 0x14, 0x8e, 0xcb, 0x78,
+          0x28, 0x55, 0x00, 0x3a, 0xae, 0xbd, 0xe4, 0xa9 }
+      },
+      { 256, 83521, 0, 64,
+        { 0xb0, 0x62, 0x75, 0xd2, 0x84, 0xcd, 0x1c, 0xf2,
+          0x05, 0xbc, 0xbe, 0x57, 0xdc, 0xcd, 0x3e, 0xc1,
+          0xff, 0x66, 0x86, 0xe3, 0xed, 0x15, 0x77, 0x63,
+          0x83, 0xe1, 0xf2, 0xfa, 0x3c, 0x6a, 0xc8, 0xf0,
+          0x8b, 0xf8, 0xa1, 0x62, 0x82, 0x9d, 0xb1, 0xa4,
+          0x4b, 0x2a, 0x43, 0xff, 0x83, 0xdd, 0x89, 0xc3,
+          0xcf, 0x1c, 0xeb, 0x61, 0xed, 0xe6, 0x59, 0x76,
+          0x6d, 0x5c, 0xcf, 0x81, 0x7a, 0x62, 0xba, 0x8d }
+      },
+      { 256, 100000, 1681, 64,
+        { 0x77, 0x62, 0x4d, 0x5d, 0x16, 0xf8, 0x5f, 0x59,
+          0x5f, 0xd6, 0xbc, 0xc3, 0xd9, 0xb7, 0x0b, 0x18,
+          0xe2, 0x76, 0x51, 0x70, 0x6d, 0x04, 0x89, 0x6d,
+          0xa4, 0x60, 0xf4, 0x4d, 0xc5, 0x10, 0xc9, 0x80,
+          0x14, 0xbd, 0x4c, 0x06, 0x65, 0x8a, 0x9c, 0x59,
+          0x46, 0xfe, 0x53, 0xdf, 0x0e, 0x7e, 0x11, 0xf1,
+          0x35, 0xca, 0x5d, 0x00, 0x89, 0xab, 0x99, 0x9b,
+          0x09, 0x87, 0x18, 0x89, 0x4f, 0x11, 0x17, 0xb9 }
+      },
+   };
+   unsigned char *buf, hash[64];
+   unsigned long i, len;
+   int err = CRYPT_OK;
+
+   if ((buf = XMALLOC(100000)) == NULL) {
+      return CRYPT_MEM;
+   }
+   for (i = 0; i < 100000; i++) {
+      buf[i] = (unsigned char)(i % 251);
+   }
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      len = tests[i].outlen;
+      if ((err = sha3_kt_memory(tests[i].num, buf, tests[i].inlen, buf, tests[i].customlen, hash, &len)) != CRYPT_OK) {
+         break;
+      }
+      if (compare_testvector(hash, len, tests[i].out, tests[i].outlen, "KangarooTwelve", (int)i)) {
+         err = CRYPT_FAIL_TESTVECTOR;
+         break;
+      }
+   }
+   XFREE(buf);
+   return err;
+#endif
+}
+
+int sha3_parallelhash_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* the first ones are NIST SP 800-185 samples with X = 00 .. 07 10 .. 17 20 .. 27,
+    * the longer ones use X[i] = i % 251 */
+   static const struct {
+      int num, xof;
+      unsigned long len, blocklen;
+      const char *custom;
+      unsigned long outlen;
+      unsigned char out[64];
+   } tests[] = {
+      { 128, 0, 24, 8, "", 32,
+        { 0xba, 0x8d, 0xc1, 0xd1, 0xd9, 0x79, 0x33, 0x1d,
+          0x3f, 0x81, 0x36, 0x03, 0xc6, 0x7f, 0x72, 0x60,
+          0x9a, 0xb5, 0xe4, 0x4b, 0x94, 0xa0, 0xb8, 0xf9,
+          0xaf, 0x46, 0x51, 0x44, 0x54, 0xa2, 0xb4, 0xf5 }
+      },
+      { 128, 0, 24, 8, "Parallel Data", 32,
+        { 0xfc, 0x48, 0x4d, 0xcb, 0x3f, 0x84, 0xdc, 0xee,
+          0xdc, 0x35, 0x34, 0x38, 0x15, 0x1b, 0xee, 0x58,
+          0x15, 0x7d, 0x6e, 0xfe, 0xd0, 0x44, 0x5a, 0x81,
+          0xf1, 0x65, 0xe4, 0x95, 0x79, 0x5b, 0x72, 0x06 }
+      },
+      { 256, 0, 24, 8, "Parallel Data", 64,
+        { 0xcd, 0xf1, 0x52, 0x89, 0xb5, 0x4f, 0x62, 0x12,
+          0xb4, 0xbc, 0x27, 0x05, 0x28, 0xb4, 0x95, 0x26,
+          0x00, 0x6d, 0xd9, 0xb5, 0x4e, 0x2b, 0x6a, 0xdd,
+          0x1e, 0xf6, 0x90, 0x0d, 0xda, 0x39, 0x63, 0xbb,
+          0x33, 0xa7, 0x24, 0x91, 0xf2, 0x36, 0x96, 0x9c,
+          0xa8, 0xaf, 0xae, 0xa2, 0x9c, 0x68, 0x2d, 0x47,
+          0xa3, 0x93, 0xc0, 0x65, 0xb3, 0x8e, 0x29, 0xfa,
+          0xe6, 0x51, 0xa2, 0x09, 0x1c, 0x83, 0x31, 0x10 }
+      },
+      { 128, 0, 1000, 64, "", 32,
+        { 0x6b, 0x0d, 0xa4, 0xc1, 0xf5, 0x71, 0xee, 0x30,
+          0x39, 0xa4, 0xc2, 0xb7, 0xc5, 0x74, 0x15, 0x78,
+          0x86, 0x9c, 0xfb, 0xfc, 0xea, 0xc5, 0x9a, 0x98,
+          0xdb, 0xbb, 0x36, 0xa2, 0x8d, 0xec, 0x23, 0x6c }
+      },
+      { 128, 1, 24, 8, "", 32,
+        { 0xfe, 0x47, 0xd6, 0x61, 0xe4, 0x9f, 0xfe, 0x5b,
+          0x7d, 0x99, 0x99, 0x22, 0xc0, 0x62, 0x35, 0x67,
+          0x50, 0xca, 0xf5, 0x52, 0x98, 0x5b, 0x8e, 0x8c,
+          0xe6, 0x66, 0x7f, 0x27, 0x27, 0xc3, 0xc8, 0xd3 }
+      },
+      { 256, 1, 1000, 100, "Parallel Data", 64,
+        { 0x33, 0x96, 0x5c, 0x31, 0xb0, 0xaf, 0xd1, 0xb8,
+          0xfe, 0xbe, 0x51, 0x0d, 0x11, 0x8b, 0x20, 0xb9,
+          0x1a, 0xd8, 0x5c, 0x89, 0xe4, 0x72, 0x65, 0xc3,
+          0x01, 0x7a, 0xf3, 0x93, 0x72, 0x90, 0xf4, 0x25,
+          0x7a, 0x74, 0xfd, 0xb7, 0x05, 0x1c, 0x1f, 0xf3,
+          0x2e, 0x72, 0x71, 0x6e, 0xfd, 0x09, 0x15, 0xac,
+          0x59, 0xf9, 0x78, 0xb3, 0x9f, 0x61, 0x2e, 0xd0,
+          0x61, 0x40, 0x9d, 0x85, 0xaa, 0x91, 0x71, 0x43 }
+      },
+   };
+   static const unsigned char x[24] = {
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x10, 0x11, 0x12, 0x13,
+      0x14, 0x15, 0x16, 0x17, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27
+   };
+   unsigned char buf[1000], hash[64];
+   const unsigned char *in;
+   unsigned long i, len;
+   int err;
+
+   for (i = 0; i < sizeof(buf); i++) {
+      buf[i] = (unsigned char)(i % 251);
+   }
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      in = tests[i].len == sizeof(x) ? x : buf;
+      len = tests[i].outlen;
+      if (tests[i].xof) {
+         err = sha3_parallelhash_xof_memory(tests[i].num, tests[i].blocklen, in, tests[i].len,
+                                            (const unsigned char *)tests[i].custom, (unsigned long)XSTRLEN(tests[i].custom), hash, &len);
+      } else {
+         err = sha3_parallelhash_memory(tests[i].num, tests[i].blocklen, in, tests[i].len,
+                                        (const unsigned char *)tests[i].custom, (unsigned long)XSTRLEN(tests[i].custom), hash, &len);
+      }
+      if (err != CRYPT_OK) {
+         return err;
+      }
+      if (compare_testvector(hash, len, tests[i].out, tests[i].outlen, "ParallelHash", (int)i)) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
 #endif
 
 #ifdef LTC_KECCAK
@@ -0,0 +1,231 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file sha3_x4_avx2.c
+  Four Keccak sponges in parallel with AVX2
+
+  Every 256-bit register holds the same lane of four Keccak states, so a
+  single run of the rounds permutes all four.  Used for the leaves of
+  KangarooTwelve and ParallelHash which are independent messages of the
+  same length.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_SHA3) && defined(LTC_SHA3_X4)
+
+static const ulong64 s_sha3_x4_rndc[24] = {
+   CONST64(0x0000000000000001), CONST64(0x0000000000008082),
+   CONST64(0x800000000000808a), CONST64(0x8000000080008000),
+   CONST64(0x000000000000808b), CONST64(0x0000000080000001),
+   CONST64(0x8000000080008081), CONST64(0x8000000000008009),
+   CONST64(0x000000000000008a), CONST64(0x0000000000000088),
+   CONST64(0x0000000080008009), CONST64(0x000000008000000a),
+   CONST64(0x000000008000808b), CONST64(0x800000000000008b),
+   CONST64(0x8000000000008089), CONST64(0x8000000000008003),
+   CONST64(0x8000000000008002), CONST64(0x8000000000000080),
+   CONST64(0x000000000000800a), CONST64(0x800000008000000a),
+   CONST64(0x8000000080008081), CONST64(0x8000000000008080),
+   CONST64(0x0000000080000001), CONST64(0x8000000080008008)
+};
+
+/**
+  Check whether the CPU supports AVX2
+  @return 1 if supported, 0 otherwise
+*/
+int sha3_x4_avx2_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX2) == LTC_CPU_AVX2;
+}
+
+#define SHA3_X4_ROL(x, n) _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n)))
+
+/* one round from the lanes A.. to the lanes E.., named as in sha3.c */
+#define SHA3_X4_ROUND(A, E, i) \
+   do { \
+      Ca = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A##ba, A##ga), A##ka), A##ma), A##sa); \
+      Ce = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A##be, A##ge), A##ke), A##me), A##se); \
+      Ci = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A##bi, A##gi), A##ki), A##mi), A##si); \
+      Co = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A##bo, A##go), A##ko), A##mo), A##so); \
+      Cu = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A##bu, A##gu), A##ku), A##mu), A##su); \
+      Da = _mm256_xor_si256(Cu, SHA3_X4_ROL(Ce, 1));                                                                  \
+      De = _mm256_xor_si256(Ca, SHA3_X4_ROL(Ci, 1));                                                                  \
+      Di = _mm256_xor_si256(Ce, SHA3_X4_ROL(Co, 1));                                                                  \
+      Do = _mm256_xor_si256(Ci, SHA3_X4_ROL(Cu, 1));                                                                  \
+      Du = _mm256_xor_si256(Co, SHA3_X4_ROL(Ca, 1));                                                                  \
+      Ba = _mm256_xor_si256(A##ba, Da);                                                                               \
+      Be = SHA3_X4_ROL(_mm256_xor_si256(A##ge, De), 44);                                                              \
+      Bi = SHA3_X4_ROL(_mm256_xor_si256(A##ki, Di), 43);                                                              \
+      Bo = SHA3_X4_ROL(_mm256_xor_si256(A##mo, Do), 21);                                                              \
+      Bu = SHA3_X4_ROL(_mm256_xor_si256(A##su, Du), 14);                                                              \
+      E##ba = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                      \
+      E##be = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                      \
+      E##bi = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                      \
+      E##bo = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                      \
+      E##bu = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                      \
+      Ba = SHA3_X4_ROL(_mm256_xor_si256(A##bo, Do), 28);                                                              \
+      Be = SHA3_X4_ROL(_mm256_xor_si256(A##gu, Du), 20);                                                              \
+      Bi = SHA3_X4_ROL(_mm256_xor_si256(A##ka, Da), 3);                                                               \
+      Bo = SHA3_X4_ROL(_mm256_xor_si256(A##me, De), 45);                                                              \
+      Bu = SHA3_X4_ROL(_mm256_xor_si256(A##si, Di), 61);                                                              \
+      E##ga = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                      \
+      E##ge = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                      \
+      E##gi = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                      \
+      E##go = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                      \
+      E##gu = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                      \
+      Ba = SHA3_X4_ROL(_mm256_xor_si256(A##be, De), 1);                                                               \
+      Be = SHA3_X4_ROL(_mm256_xor_si256(A##gi, Di), 6);                                                               \
+      Bi = SHA3_X4_ROL(_mm256_xor_si256(A##ko, Do), 25);                                                              \
+      Bo = SHA3_X4_ROL(_mm256_xor_si256(A##mu, Du), 8);                                                               \
+      Bu = SHA3_X4_ROL(_mm256_xor_si256(A##sa, Da), 18);                                                              \
+      E##ka = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                      \
+      E##ke = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                      \
+      E##ki = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                      \
+      E##ko = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                      \
+      E##ku = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                      \
+      Ba = SHA3_X4_ROL(_mm256_xor_si256(A##bu, Du), 27);                                                              \
+      Be = SHA3_X4_ROL(_mm256_xor_si256(A##ga, Da), 36);                                                              \
+      Bi = SHA3_X4_ROL(_mm256_xor_si256(A##ke, De), 10);                                                              \
+      Bo = SHA3_X4_ROL(_mm256_xor_si256(A##mi, Di), 15);                                                              \
+      Bu = SHA3_X4_ROL(_mm256_xor_si256(A##so, Do), 56);                                                              \
+      E##ma = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                      \
+      E##me = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                      \
+      E##mi = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                      \
+      E##mo = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                      \
+      E##mu = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                      \
+      Ba = SHA3_X4_ROL(_mm256_xor_si256(A##bi, Di), 62);                                                              \
+      Be = SHA3_X4_ROL(_mm256_xor_si256(A##go, Do), 55);                                                              \
+      Bi = SHA3_X4_ROL(_mm256_xor_si256(A##ku, Du), 39);                                                              \
+      Bo = SHA3_X4_ROL(_mm256_xor_si256(A##ma, Da), 41);                                                              \
+      Bu = SHA3_X4_ROL(_mm256_xor_si256(A##se, De), 2);                                                               \
+      E##sa = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                      \
+      E##se = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                      \
+      E##si = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                      \
+      E##so = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                      \
+      E##su = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                      \
+      E##ba = _mm256_xor_si256(E##ba, _mm256_set1_epi64x((long long)s_sha3_x4_rndc[i]));                              \
+   } while (0)
+
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_sha3_x4_permute(__m256i *s, int rounds)
+{
+   __m256i Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki,
+           Ako, Aku, Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+   __m256i Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki,
+           Eko, Eku, Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+   __m256i Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu;
+   int i;
+
+   Aba = s[0]; Abe = s[1]; Abi = s[2]; Abo = s[3]; Abu = s[4];
+   Aga = s[5]; Age = s[6]; Agi = s[7]; Ago = s[8]; Agu = s[9];
+   Aka = s[10]; Ake = s[11]; Aki = s[12]; Ako = s[13]; Aku = s[14];
+   Ama = s[15]; Ame = s[16]; Ami = s[17]; Amo = s[18]; Amu = s[19];
+   Asa = s[20]; Ase = s[21]; Asi = s[22]; Aso = s[23]; Asu = s[24];
+
+   for (i = 24 - rounds; i < 24; i += 2) {
+      SHA3_X4_ROUND(A, E, i);
+      SHA3_X4_ROUND(E, A, i + 1);
+   }
+
+   s[0] = Aba; s[1] = Abe; s[2] = Abi; s[3] = Abo; s[4] = Abu;
+   s[5] = Aga; s[6] = Age; s[7] = Agi; s[8] = Ago; s[9] = Agu;
+   s[10] = Aka; s[11] = Ake; s[12] = Aki; s[13] = Ako; s[14] = Aku;
+   s[15] = Ama; s[16] = Ame; s[17] = Ami; s[18] = Amo; s[19] = Amu;
+   s[20] = Asa; s[21] = Ase; s[22] = Asi; s[23] = Aso; s[24] = Asu;
+}
+
+#undef SHA3_X4_ROUND
+#undef SHA3_X4_ROL
+
+/* XOR rw words of the four blocks p[0..3] into the states */
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_sha3_x4_absorb(__m256i *s, const unsigned char * const *p, unsigned long rw)
+{
+   __m256i a0, a1, a2, a3, t0, t1, t2, t3;
+   ulong64 w0, w1, w2, w3;
+   unsigned long w;
+
+   /* transpose 4x4 words */
+   for (w = 0; w + 4 <= rw; w += 4) {
+      a0 = _mm256_loadu_si256((const __m256i *)(p[0] + 8 * w));
+      a1 = _mm256_loadu_si256((const __m256i *)(p[1] + 8 * w));
+      a2 = _mm256_loadu_si256((const __m256i *)(p[2] + 8 * w));
+      a3 = _mm256_loadu_si256((const __m256i *)(p[3] + 8 * w));
+      t0 = _mm256_unpacklo_epi64(a0, a1);
+      t1 = _mm256_unpackhi_epi64(a0, a1);
+      t2 = _mm256_unpacklo_epi64(a2, a3);
+      t3 = _mm256_unpackhi_epi64(a2, a3);
+      s[w    ] = _mm256_xor_si256(s[w    ], _mm256_permute2x128_si256(t0, t2, 0x20));
+      s[w + 1] = _mm256_xor_si256(s[w + 1], _mm256_permute2x128_si256(t1, t3, 0x20));
+      s[w + 2] = _mm256_xor_si256(s[w + 2], _mm256_permute2x128_si256(t0, t2, 0x31));
+      s[w + 3] = _mm256_xor_si256(s[w + 3], _mm256_permute2x128_si256(t1, t3, 0x31));
+   }
+   for (; w < rw; w++) {
+      LOAD64L(w0, p[0] + 8 * w);
+      LOAD64L(w1, p[1] + 8 * w);
+      LOAD64L(w2, p[2] + 8 * w);
+      LOAD64L(w3, p[3] + 8 * w);
+      s[w] = _mm256_xor_si256(s[w], _mm256_set_epi64x((long long)w3, (long long)w2, (long long)w1, (long long)w0));
+   }
+}
+
+/**
+  Absorb four messages of the same length and squeeze their outputs
+  @param in      The four messages, one after the other
+  @param inlen   The length of each message (octets)
+  @param rate    The rate of the sponge (octets, a multiple of 8)
+  @param pad     The domain separation and padding byte, e.g. 0x1F for SHAKE
+  @param rounds  The rounds of Keccak-p, 24 or 12
+  @param out     [out] The four outputs, one after the other
+  @param outlen  The length of each output (octets, at most rate)
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+void sha3_x4_avx2_sponge(const unsigned char *in, unsigned long inlen, unsigned long rate, unsigned char pad,
+                         int rounds, unsigned char *out, unsigned long outlen)
+{
+   __m256i s[25];
+   unsigned char last[4][200], buf[32];
+   const unsigned char *p[4];
+   unsigned long off, left, w, i, n;
+
+   for (i = 0; i < 25; i++) {
+      s[i] = _mm256_setzero_si256();
+   }
+
+   for (off = 0; inlen - off >= rate; off += rate) {
+      for (i = 0; i < 4; i++) {
+         p[i] = in + i * inlen + off;
+      }
+      s_sha3_x4_absorb(s, p, rate / 8);
+      s_sha3_x4_permute(s, rounds);
+   }
+
+   /* the padded last block */
+   left = inlen - off;
+   XMEMSET(last, 0, sizeof(last));
+   for (i = 0; i < 4; i++) {
+      XMEMCPY(last[i], in + i * inlen + off, left);
+      last[i][left]     ^= pad;
+      last[i][rate - 1] ^= 0x80;
+      p[i] = last[i];
+   }
+   s_sha3_x4_absorb(s, p, rate / 8);
+   s_sha3_x4_permute(s, rounds);
+
+   for (w = 0; 8 * w < outlen; w++) {
+      _mm256_storeu_si256((__m256i *)buf, s[w]);
+      n = MIN(outlen - 8 * w, 8);
+      for (i = 0; i < 4; i++) {
+         XMEMCPY(out + i * outlen + 8 * w, buf + 8 * i, n);
+      }
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(s, sizeof(s));
+   zeromem(last, sizeof(last));
+   zeromem(buf, sizeof(buf));
+#endif
+}
+
+#endif
@@ -39,6 +39,10 @@ struct rijndael_key {
    ulong32 *eK;
    ulong32 *dK;
    int Nr;
+#ifdef LTC_AES_BITSLICE
+   /* the round keys of aesbs_setup() for the single-block code, encryption and decryption */
+   unsigned char vK[2][15][16];
+#endif
 };
 #endif
 
@@ -487,7 +491,8 @@ extern struct ltc_cipher_descriptor {
        @param ct      Ciphertext
        @param blocks  The number of complete blocks to process
        @param IV      The initial value (input/output)
-       @param mode    little or big endian counter (mode=0 or mode=1)
+       @param mode    little or big endian counter (CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN)
+                      ORed with the width of the counter in octets (0 means the full block is the counter)
        @param skey    The scheduled key context
        @return CRYPT_OK if successful
    */
@@ -529,7 +534,7 @@ extern struct ltc_cipher_descriptor {
        @param tag        [out] The destination tag
        @param taglen     [in/out] The max size and resulting size of the authentication tag
        @param direction  Encrypt or Decrypt direction (0 or 1)
-       @return CRYPT_OK if successful
+       @return CRYPT_OK if successful, CRYPT_NOP if ccm_memory() has to use the generic implementation
    */
    int (*accel_ccm_memory)(
        const unsigned char *key,    unsigned long keylen,
@@ -554,7 +559,7 @@ extern struct ltc_cipher_descriptor {
        @param tag        [out] The MAC tag
        @param taglen     [in/out] The MAC tag length
        @param direction  Encrypt or Decrypt mode (GCM_ENCRYPT or GCM_DECRYPT)
-       @return CRYPT_OK on success
+       @return CRYPT_OK on success, CRYPT_NOP if gcm_memory() has to use the generic implementation
    */
    int (*accel_gcm_memory)(
        const unsigned char *key,    unsigned long keylen,
@@ -741,12 +746,81 @@ int aesni_is_supported(void);
 int aesni_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
 int aesni_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey);
 int aesni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetric_key *skey);
+int aesni_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+int aesni_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey);
+int aesni_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aesni_accel_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aesni_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+int aesni_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+int aesni_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+#if defined(LTC_CCM_MODE)
+int aesni_accel_ccm_memory(const unsigned char *key,    unsigned long keylen,
+                           symmetric_key       *uskey,
+                           const unsigned char *nonce,  unsigned long noncelen,
+                           const unsigned char *header, unsigned long headerlen,
+                                 unsigned char *pt,     unsigned long ptlen,
+                                 unsigned char *ct,
+                                 unsigned char *tag,    unsigned long *taglen,
+                                           int  direction);
+#endif
+#if defined(LTC_GCM_MODE)
+int aesni_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                           const unsigned char *IV,     unsigned long IVlen,
+                           const unsigned char *adata,  unsigned long adatalen,
+                                 unsigned char *pt,     unsigned long ptlen,
+                                 unsigned char *ct,
+                                 unsigned char *tag,    unsigned long *taglen,
+                                           int direction);
+#endif
 int aesni_test(void);
 void aesni_done(symmetric_key *skey);
 int aesni_keysize(int *keysize);
 extern const struct ltc_cipher_descriptor aesni_desc;
 #endif
 
+#if defined(LTC_AES_VAES)
+int vaes512_is_supported(void);
+int vaes512_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+int vaes512_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey);
+int vaes512_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+int vaes512_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+int vaes512_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+#if defined(LTC_GCM_MODE)
+int vaes512_accel_gcm_memory(const unsigned char *key,    unsigned long keylen,
+                             const unsigned char *IV,     unsigned long IVlen,
+                             const unsigned char *adata,  unsigned long adatalen,
+                                   unsigned char *pt,     unsigned long ptlen,
+                                   unsigned char *ct,
+                                   unsigned char *tag,    unsigned long *taglen,
+                                             int direction);
+#endif
+int vaes256_is_supported(void);
+int vaes256_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+int vaes256_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey);
+int vaes256_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+int vaes256_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+int vaes256_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+int vaes_test(void);
+#endif
+
+#if defined(LTC_AES_BITSLICE)
+int aesbs_is_supported(void);
+int aesbs_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
+int aesbs_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey);
+int aesbs_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetric_key *skey);
+int aesbs_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+int aesbs_accel_ecb_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, symmetric_key *skey);
+int aesbs_accel_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aesbs_accel_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aesbs_accel_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+int aesbs_accel_xts_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+int aesbs_accel_xts_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *tweak, const symmetric_key *skey1, const symmetric_key *skey2);
+int aesbs_test(void);
+void aesbs_done(symmetric_key *skey);
+int aesbs_keysize(int *keysize);
+extern const struct ltc_cipher_descriptor aesbs_desc;
+#endif
+
 #ifdef LTC_XTEA
 int xtea_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
 int xtea_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey);
@@ -1078,6 +1152,18 @@ int chacha_memory(const unsigned char *key,    unsigned long keylen,  unsigned l
 
 #endif /* LTC_CHACHA */
 
+#ifdef LTC_XCHACHA20
+
+int xchacha20_setup(chacha_state *st, const unsigned char *key,   unsigned long keylen,
+                                      const unsigned char *nonce, unsigned long noncelen,
+                                      int rounds);
+int xchacha20_test(void);
+int xchacha20_memory(const unsigned char *key,    unsigned long keylen,   unsigned long rounds,
+                     const unsigned char *nonce,  unsigned long noncelen,
+                     const unsigned char *datain, unsigned long datalen,  unsigned char *dataout);
+
+#endif /* LTC_XCHACHA20 */
+
 #ifdef LTC_SALSA20
 
 typedef struct {
@@ -150,6 +150,11 @@
 /* disable all file related functions */
 /* #define LTC_NO_FILE */
 
+/* map files into memory in the *_file() and *_filehandle() functions instead of
+ * reading them and, with LTC_PTHREAD, read files which can't be mapped in a
+ * separate thread, requires a POSIX system */
+/* #define LTC_FILE_MMAP */
+
 /* disable all forms of ASM */
 /* #define LTC_NO_ASM */
 
@@ -213,6 +218,10 @@
 
 /* stream ciphers */
 #define LTC_CHACHA
+/* Compute 4, 8 or 16 ChaCha blocks in parallel with SSSE3, AVX2 or AVX-512 if the CPU
+ * supports it, requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_CHACHA_SIMD */
+#define LTC_XCHACHA20
 #define LTC_SALSA20
 #define LTC_XSALSA20
 #define LTC_SOSEMANUK
@@ -273,6 +282,34 @@
 #define LTC_RIPEMD320
 #define LTC_BLAKE2S
 #define LTC_BLAKE2B
+/* The parallel modes BLAKE2sp and BLAKE2bp, their states grow hash_state
+ * to almost 1KB, which is why they aren't enabled by default */
+/* #define LTC_BLAKE2SP */
+/* #define LTC_BLAKE2BP */
+/* BLAKE3 keeps a stack of 55 chaining values, which grows hash_state
+ * to about 2KB, so it isn't enabled by default either */
+/* #define LTC_BLAKE3 */
+/* Use the SHA extensions for SHA-1 and SHA-224/256 if the CPU supports them,
+ * requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_SHA_NI */
+/* Hash 8 SHA-224/256 resp. 4 SHA-384/512 messages in parallel with AVX2 in
+ * hash_memory_batch() if the CPU supports it, requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_SHA2_MULTIBUF */
+/* Compute the message schedule of SHA-384/512 with SSSE3 resp. AVX2 if the CPU supports it,
+ * requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_SHA512_SIMD */
+/* Hash four leaves of KangarooTwelve and ParallelHash in parallel with AVX2 if the CPU supports it,
+ * requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_SHA3_X4 */
+/* Compress BLAKE2s with SSE4.1 and BLAKE2b with AVX2, and the leaves of BLAKE2sp resp.
+ * BLAKE2bp 8 resp. 4 at a time with AVX2 if the CPU supports it,
+ * requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_BLAKE2_SIMD */
+/* Compress 8 resp. 16 chunks of BLAKE3 at once with AVX2 resp. AVX-512 if the CPU supports it,
+ * requires LTC_BLAKE3 and GCC or clang on x86_32 or x86_64 */
+/* #define LTC_BLAKE3_SIMD */
+/* Split large inputs of BLAKE3 over up to LTC_BLAKE3_MT_THREADS threads, requires LTC_BLAKE3 and LTC_PTHREAD */
+/* #define LTC_BLAKE3_MT */
 
 #define LTC_HASH_HELPERS
 
@@ -289,8 +326,14 @@
 #define LTC_F9_MODE
 #define LTC_PELICAN
 #define LTC_POLY1305
+/* Process 4 blocks in parallel with AVX2 if the CPU supports it,
+ * requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_POLY1305_AVX2 */
 #define LTC_BLAKE2SMAC
 #define LTC_BLAKE2BMAC
+/* require LTC_BLAKE2SP resp. LTC_BLAKE2BP */
+/* #define LTC_BLAKE2SPMAC */
+/* #define LTC_BLAKE2BPMAC */
 
 /* ---> Encrypt + Authenticate Modes <--- */
 
@@ -300,18 +343,26 @@
 #define LTC_OCB3_MODE
 #define LTC_CCM_MODE
 #define LTC_GCM_MODE
+#define LTC_GCM_SIV_MODE
 #define LTC_CHACHA20POLY1305_MODE
 
 /* Use 64KiB tables */
-#ifndef LTC_NO_TABLES
+#if !defined(LTC_NO_TABLES) && !defined(LTC_GCM_TABLES_4BIT)
    #define LTC_GCM_TABLES
 #endif
 
+/* Use a 256 byte table of H (Shoup's 4 bit method) instead of the 64KiB tables */
+/* #define LTC_GCM_TABLES_4BIT */
+
 /* USE SSE2? requires GCC works on x86_32 and x86_64*/
 #ifdef LTC_GCM_TABLES
 /* #define LTC_GCM_TABLES_SSE2 */
 #endif
 
+/* Use the carry-less multiplication (PCLMULQDQ) for GHASH if the CPU supports it,
+ * requires GCC or clang on x86_32 or x86_64 */
+/* #define LTC_GCM_PCLMUL */
+
 #endif /* LTC_NO_MACS */
 
 
@@ -631,6 +682,18 @@
    #error LTC_CLEAN_STACK is considered as broken
 #endif
 
+#if defined(LTC_AES_VAES) && !defined(LTC_AES_NI)
+   #error LTC_AES_VAES requires LTC_AES_NI
+#endif
+
+#if defined(LTC_AES_BITSLICE) && !defined(LTC_RIJNDAEL)
+   #error LTC_AES_BITSLICE requires LTC_RIJNDAEL
+#endif
+
+#if defined(LTC_GCM_TABLES) && defined(LTC_GCM_TABLES_4BIT)
+   #error LTC_GCM_TABLES and LTC_GCM_TABLES_4BIT are mutually exclusive
+#endif
+
 #if defined(LTC_PBES) && !defined(LTC_PKCS_5)
    #error LTC_PBES requires LTC_PKCS_5
 #endif
@@ -655,6 +718,10 @@
    #error LTC_EAX_MODE requires CTR and LTC_OMAC mode
 #endif
 
+#if defined(LTC_GCM_SIV_MODE) && !(defined(LTC_CTR_MODE) && defined(LTC_GCM_MODE))
+   #error LTC_GCM_SIV_MODE requires CTR and LTC_GCM_MODE
+#endif
+
 #if defined(LTC_YARROW) && !defined(LTC_CTR_MODE)
    #error LTC_YARROW requires LTC_CTR_MODE chaining mode to be defined!
 #endif
@@ -679,6 +746,10 @@
    #error LTC_CHACHA20_PRNG requires LTC_CHACHA
 #endif
 
+#if defined(LTC_XCHACHA20) && !defined(LTC_CHACHA)
+   #error LTC_XCHACHA20 requires LTC_CHACHA
+#endif
+
 #if defined(LTC_XSALSA20) && !defined(LTC_SALSA20)
    #error LTC_XSALSA20 requires LTC_SALSA20
 #endif
@@ -699,6 +770,38 @@
    #error LTC_BLAKE2BMAC requires LTC_BLAKE2B
 #endif
 
+#if defined(LTC_BLAKE2SP) && !defined(LTC_BLAKE2S)
+   #error LTC_BLAKE2SP requires LTC_BLAKE2S
+#endif
+
+#if defined(LTC_BLAKE2BP) && !defined(LTC_BLAKE2B)
+   #error LTC_BLAKE2BP requires LTC_BLAKE2B
+#endif
+
+#if defined(LTC_BLAKE2SPMAC) && !defined(LTC_BLAKE2SP)
+   #error LTC_BLAKE2SPMAC requires LTC_BLAKE2SP
+#endif
+
+#if defined(LTC_BLAKE2BPMAC) && !defined(LTC_BLAKE2BP)
+   #error LTC_BLAKE2BPMAC requires LTC_BLAKE2BP
+#endif
+
+#if (defined(LTC_BLAKE3_SIMD) || defined(LTC_BLAKE3_MT)) && !defined(LTC_BLAKE3)
+   #error LTC_BLAKE3_SIMD and LTC_BLAKE3_MT require LTC_BLAKE3
+#endif
+
+#if defined(LTC_BLAKE3_MT) && !defined(LTC_PTHREAD)
+   #error LTC_BLAKE3_MT requires LTC_PTHREAD
+#endif
+
+#if defined(LTC_BLAKE3_MT) && !defined(LTC_BLAKE3_MT_THREADS)
+   #define LTC_BLAKE3_MT_THREADS 8
+#endif
+
+#if defined(LTC_FILE_MMAP) && !defined(LTC_NO_FILE) && !(defined(__unix__) || defined(__APPLE__))
+   #error LTC_FILE_MMAP requires a POSIX system
+#endif
+
 #if defined(LTC_SPRNG) && !defined(LTC_RNG_GET_BYTES)
    #error LTC_SPRNG requires LTC_RNG_GET_BYTES
 #endif
@@ -7,10 +7,12 @@ struct sha3_state {
     ulong64 saved;                  /* the portion of the input message that we didn't consume yet */
     ulong64 s[25];
     unsigned char sb[25 * 8];       /* used for storing `ulong64 s[25]` as little-endian bytes */
-    unsigned short byte_index;      /* 0..7--the next byte after the set one (starts from 0; 0--none are buffered) */
     unsigned short word_index;      /* 0..24--the next word to integrate input (starts from 0) */
     unsigned short capacity_words;  /* the double size of the hash output in words (e.g. 16 for Keccak 512) */
-    unsigned short xof_flag;
+    unsigned char byte_index;       /* 0..7--the next byte after the set one (starts from 0; 0--none are buffered) */
+    unsigned char xof_flag;
+    unsigned char xof_pad;          /* the domain separation bits of the XOF, 0x1F for SHAKE */
+    unsigned char rounds;           /* the rounds of Keccak-p, 24 except for TurboSHAKE */
 };
 #endif
 
@@ -141,6 +143,47 @@ struct blake2b_state {
 };
 #endif
 
+#ifdef LTC_BLAKE2SP
+struct blake2sp_state {
+    ulong32 h[8][8];
+    ulong64 t[8];
+    unsigned char buf[8][64];
+    unsigned long buflen[8];
+    unsigned long cur;
+    unsigned long outlen;
+    unsigned long keylen;
+};
+#endif
+
+#ifdef LTC_BLAKE2BP
+struct blake2bp_state {
+    ulong64 h[4][8];
+    ulong64 t[4];
+    unsigned char buf[4][128];
+    unsigned long buflen[4];
+    unsigned long cur;
+    unsigned long outlen;
+    unsigned long keylen;
+};
+#endif
+
+#ifdef LTC_BLAKE3
+struct blake3_state {
+    ulong64 chunk_counter;          /* the current chunk, resp. the next output block once finalized */
+    ulong32 key[8];
+    ulong32 cv[8];                  /* the chaining value of the current chunk, resp. of the root node */
+    unsigned char buf[64];          /* the last block of the current chunk, resp. of the root node */
+    unsigned char xof[64];
+    unsigned char cv_stack[55 * 32];
+    unsigned long buflen;
+    unsigned long blocks;
+    unsigned long flags;
+    unsigned long cv_stack_len;
+    unsigned long xof_pos;
+    unsigned short xof_flag;
+};
+#endif
+
 typedef union Hash_state {
     char dummy[1];
 #ifdef LTC_CHC_HASH
@@ -191,6 +234,15 @@ typedef union Hash_state {
 #ifdef LTC_BLAKE2B
     struct blake2b_state blake2b;
 #endif
+#ifdef LTC_BLAKE2SP
+    struct blake2sp_state blake2sp;
+#endif
+#ifdef LTC_BLAKE2BP
+    struct blake2bp_state blake2bp;
+#endif
+#ifdef LTC_BLAKE3
+    struct blake3_state blake3;
+#endif
 
     void *data;
 } hash_state;
@@ -283,6 +335,26 @@ int sha3_shake_init(hash_state *md, int num);
 int sha3_shake_done(hash_state *md, unsigned char *out, unsigned long outlen);
 int sha3_shake_test(void);
 int sha3_shake_memory(int num, const unsigned char *in, unsigned long inlen, unsigned char *out, const unsigned long *outlen);
+int sha3_cshake_init(hash_state *md, int num, const unsigned char *name, unsigned long namelen,
+                     const unsigned char *custom, unsigned long customlen);
+#define sha3_cshake_process(a,b,c) sha3_process(a,b,c)
+#define sha3_cshake_done(a,b,c) sha3_shake_done(a,b,c)
+int sha3_cshake_test(void);
+int sha3_turboshake_init(hash_state *md, int num, unsigned char domain);
+#define sha3_turboshake_process(a,b,c) sha3_process(a,b,c)
+#define sha3_turboshake_done(a,b,c) sha3_shake_done(a,b,c)
+int sha3_turboshake_test(void);
+int sha3_kt_memory(int num, const unsigned char *in, unsigned long inlen,
+                   const unsigned char *custom, unsigned long customlen,
+                   unsigned char *out, const unsigned long *outlen);
+int sha3_kt_test(void);
+int sha3_parallelhash_memory(int num, unsigned long blocklen, const unsigned char *in, unsigned long inlen,
+                             const unsigned char *custom, unsigned long customlen,
+                             unsigned char *out, const unsigned long *outlen);
+int sha3_parallelhash_xof_memory(int num, unsigned long blocklen, const unsigned char *in, unsigned long inlen,
+                                 const unsigned char *custom, unsigned long customlen,
+                                 unsigned char *out, const unsigned long *outlen);
+int sha3_parallelhash_test(void);
 #endif
 
 #ifdef LTC_KECCAK
@@ -414,6 +486,37 @@ int blake2b_process(hash_state * md, const unsigned char *in, unsigned long inle
 int blake2b_done(hash_state * md, unsigned char *out);
 #endif
 
+#ifdef LTC_BLAKE2SP
+extern const struct ltc_hash_descriptor blake2sp_256_desc;
+int blake2sp_256_init(hash_state * md);
+int blake2sp_256_test(void);
+
+int blake2sp_init(hash_state * md, unsigned long outlen, const unsigned char *key, unsigned long keylen);
+int blake2sp_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int blake2sp_done(hash_state * md, unsigned char *out);
+#endif
+
+#ifdef LTC_BLAKE2BP
+extern const struct ltc_hash_descriptor blake2bp_512_desc;
+int blake2bp_512_init(hash_state * md);
+int blake2bp_512_test(void);
+
+int blake2bp_init(hash_state * md, unsigned long outlen, const unsigned char *key, unsigned long keylen);
+int blake2bp_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int blake2bp_done(hash_state * md, unsigned char *out);
+#endif
+
+#ifdef LTC_BLAKE3
+extern const struct ltc_hash_descriptor blake3_desc;
+int blake3_init(hash_state * md);
+int blake3_init_keyed(hash_state * md, const unsigned char *key, unsigned long keylen);
+int blake3_init_derive_key(hash_state * md, const unsigned char *context, unsigned long contextlen);
+int blake3_process(hash_state * md, const unsigned char *in, unsigned long inlen);
+int blake3_done(hash_state * md, unsigned char *out);
+int blake3_xof_done(hash_state * md, unsigned char *out, unsigned long outlen);
+int blake3_test(void);
+#endif
+
 #ifdef LTC_MD5
 int md5_init(hash_state * md);
 int md5_process(hash_state * md, const unsigned char *in, unsigned long inlen);
@@ -502,6 +605,29 @@ int hash_memory(int hash,
 int hash_memory_multi(int hash, unsigned char *out, unsigned long *outlen,
                       const unsigned char *in, unsigned long inlen, ...)
                       LTC_NULL_TERMINATED;
+int hash_memory_batch(int hash, const unsigned char * const *in, const unsigned long *inlen, unsigned long n,
+                            unsigned char *out, unsigned long *outlen);
+
+/** a hash tree over chunks of fixed size, see hash_tree_init() */
+typedef struct {
+    int hash;
+    unsigned long chunklen;
+    unsigned long threads;
+    unsigned long chunks;
+    unsigned long nodes;
+    /** the digests of all nodes, level by level starting with the leaves */
+    unsigned char *node;
+} hash_tree_state;
+
+int hash_tree_init(hash_tree_state *tree, int hash, unsigned long chunklen, unsigned long threads);
+int hash_tree_build(hash_tree_state *tree, const unsigned char *in, unsigned long inlen);
+int hash_tree_update(hash_tree_state *tree, const unsigned char *in, unsigned long inlen,
+                     const unsigned long *changed, unsigned long n);
+int hash_tree_root(const hash_tree_state *tree, unsigned char *out, unsigned long *outlen);
+void hash_tree_free(hash_tree_state *tree);
+int hash_tree_memory(int hash, unsigned long chunklen, unsigned long threads,
+                     const unsigned char *in, unsigned long inlen,
+                           unsigned char *out, unsigned long *outlen);
 
 #ifndef LTC_NO_FILE
 int hash_filehandle(int hash, FILE *in, unsigned char *out, unsigned long *outlen);
@@ -151,6 +151,34 @@ int blake2bmac_file(const char *fname, const unsigned char *key, unsigned long k
 int blake2bmac_test(void);
 #endif /* LTC_BLAKE2BMAC */
 
+#ifdef LTC_BLAKE2SPMAC
+typedef hash_state blake2spmac_state;
+int blake2spmac_init(blake2spmac_state *st, unsigned long outlen, const unsigned char *key, unsigned long keylen);
+int blake2spmac_process(blake2spmac_state *st, const unsigned char *in, unsigned long inlen);
+int blake2spmac_done(blake2spmac_state *st, unsigned char *mac, unsigned long *maclen);
+int blake2spmac_memory(const unsigned char *key, unsigned long keylen, const unsigned char *in, unsigned long inlen, unsigned char *mac, unsigned long *maclen);
+int blake2spmac_memory_multi(const unsigned char *key, unsigned long keylen,
+                                   unsigned char *mac, unsigned long *maclen,
+                             const unsigned char *in,  unsigned long inlen, ...)
+                             LTC_NULL_TERMINATED;
+int blake2spmac_file(const char *fname, const unsigned char *key, unsigned long keylen, unsigned char *mac, unsigned long *maclen);
+int blake2spmac_test(void);
+#endif /* LTC_BLAKE2SPMAC */
+
+#ifdef LTC_BLAKE2BPMAC
+typedef hash_state blake2bpmac_state;
+int blake2bpmac_init(blake2bpmac_state *st, unsigned long outlen, const unsigned char *key, unsigned long keylen);
+int blake2bpmac_process(blake2bpmac_state *st, const unsigned char *in, unsigned long inlen);
+int blake2bpmac_done(blake2bpmac_state *st, unsigned char *mac, unsigned long *maclen);
+int blake2bpmac_memory(const unsigned char *key, unsigned long keylen, const unsigned char *in, unsigned long inlen, unsigned char *mac, unsigned long *maclen);
+int blake2bpmac_memory_multi(const unsigned char *key, unsigned long keylen,
+                                   unsigned char *mac, unsigned long *maclen,
+                             const unsigned char *in,  unsigned long inlen, ...)
+                             LTC_NULL_TERMINATED;
+int blake2bpmac_file(const char *fname, const unsigned char *key, unsigned long keylen, unsigned char *mac, unsigned long *maclen);
+int blake2bpmac_test(void);
+#endif /* LTC_BLAKE2BPMAC */
+
 
 #ifdef LTC_PELICAN
 
@@ -247,6 +275,20 @@ int f9_test(void);
  * ENC+AUTH modes
  */
 
+/** One packet of a batch call, e.g. gcm_memory_batch() */
+typedef struct {
+   const unsigned char *nonce;      /* the nonce resp. IV */
+   unsigned long        noncelen;   /* length of the nonce */
+   const unsigned char *aad;        /* the additional authenticated data */
+   unsigned long        aadlen;     /* length of the AAD */
+   const unsigned char *in;         /* the plaintext (encrypt) or ciphertext (decrypt) */
+   unsigned long        inlen;      /* length of the input, the output has the same length */
+   unsigned char       *out;        /* [out] the ciphertext (encrypt) or plaintext (decrypt), may be `in` */
+   unsigned char       *tag;        /* [out] the tag (encrypt) or the tag to compare against (decrypt) */
+   unsigned long        taglen;     /* [in/out] length of the tag */
+   int                  err;        /* [out] the result of this packet, CRYPT_ERROR if the tag didn't match */
+} ltc_aead_packet;
+
 #ifdef LTC_EAX_MODE
 
 #if !(defined(LTC_OMAC) && defined(LTC_CTR_MODE))
@@ -372,6 +414,7 @@ int ocb3_init(ocb3_state *ocb, int cipher,
              const unsigned char *key, unsigned long keylen,
              const unsigned char *nonce, unsigned long noncelen,
              unsigned long taglen);
+int ocb3_reset(ocb3_state *ocb, const unsigned char *nonce, unsigned long noncelen, unsigned long taglen);
 
 int ocb3_encrypt(ocb3_state *ocb, const unsigned char *pt, unsigned long ptlen, unsigned char *ct);
 int ocb3_decrypt(ocb3_state *ocb, const unsigned char *ct, unsigned long ctlen, unsigned char *pt);
@@ -397,6 +440,11 @@ int ocb3_decrypt_verify_memory(int cipher,
     const unsigned char *tag,    unsigned long taglen,
           int           *stat);
 
+int ocb3_memory_batch(int cipher,
+                      const unsigned char *key, unsigned long keylen,
+                      ltc_aead_packet *pkt,     unsigned long npkt,
+                      int direction);
+
 int ocb3_test(void);
 
 #endif /* LTC_OCB3_MODE */
@@ -480,27 +528,50 @@ extern const unsigned char gcm_shift_table[];
 #define LTC_GCM_MODE_TEXT  2
 
 typedef struct {
-   unsigned char       H[16],        /* multiplier */
-                       X[16],        /* accumulator */
+   unsigned char       X[16],        /* accumulator */
                        Y[16],        /* counter */
                        Y_0[16],      /* initial counter */
                        buf[16];      /* buffer for stuff */
 
+   int                 ivmode,       /* Which mode is the IV in? */
+                       mode,         /* mode the GCM code is in */
+                       buflen;       /* length of data in buf */
+
+   ulong64             totlen,       /* 64-bit counter used for IV and AAD */
+                       pttotlen;     /* 64-bit counter for the PT */
+
+   struct gcm_htable  *ht;           /* shared key tables, or NULL */
+
+   /* the key and its tables, a state which uses shared key tables
+    * doesn't touch anything from here on, see GCM_SHARED_STATE_SIZE */
+   unsigned char       H[16];        /* multiplier */
+
 #ifdef LTC_GCM_TABLES
+#ifdef LTC_GCM_TABLES_SSE2
+   unsigned char       PC[16][256][16] LTC_ALIGN(16);  /* 16 tables of 8x128 */
+#else
    unsigned char       PC[16][256][16];  /* 16 tables of 8x128 */
 #endif
+#endif
+#ifdef LTC_GCM_TABLES_4BIT
+   ulong64             M[16][2];     /* H times the 4 bit values (Shoup) */
+#endif
+#ifdef LTC_GCM_PCLMUL
+   unsigned char       PH[8][16];    /* H^1..H^8 byte-reflected for the carry-less multiplication */
+   int                 pclmul;       /* use the carry-less multiplication? */
+#endif
 
    symmetric_key       K;
 
-   int                 cipher,       /* which cipher */
-                       ivmode,       /* Which mode is the IV in? */
-                       mode,         /* mode the GCM code is in */
-                       buflen;       /* length of data in buf */
-
-   ulong64             totlen,       /* 64-bit counter used for IV and AAD */
-                       pttotlen;     /* 64-bit counter for the PT */
+   int                 cipher;       /* which cipher */
 } gcm_state;
 
+/** The size of a gcm_state which is only used with gcm_init_htable() */
+#define GCM_SHARED_STATE_SIZE offsetof(gcm_state, H)
+
+/** A read-only set of GCM key tables which can be shared by many states */
+typedef struct gcm_htable gcm_htable;
+
 void gcm_mult_h(const gcm_state *gcm, unsigned char *I);
 
 int gcm_init(gcm_state *gcm, int cipher,
@@ -508,6 +579,12 @@ int gcm_init(gcm_state *gcm, int cipher,
 
 int gcm_reset(gcm_state *gcm);
 
+int gcm_htable_new(gcm_htable **ht, int cipher,
+                   const unsigned char *key, int keylen);
+int gcm_htable_ref(gcm_htable *ht);
+void gcm_htable_free(gcm_htable *ht);
+int gcm_init_htable(gcm_state *gcm, gcm_htable *ht);
+
 int gcm_add_iv(gcm_state *gcm,
                const unsigned char *IV,     unsigned long IVlen);
 
@@ -530,10 +607,31 @@ int gcm_memory(      int           cipher,
                      unsigned char *ct,
                      unsigned char *tag,    unsigned long *taglen,
                                int direction);
+int gcm_memory_batch(int cipher,
+                     const unsigned char *key, unsigned long keylen,
+                     ltc_aead_packet *pkt,     unsigned long npkt,
+                     int direction);
 int gcm_test(void);
 
 #endif /* LTC_GCM_MODE */
 
+#ifdef LTC_GCM_SIV_MODE
+
+#define GCM_SIV_ENCRYPT LTC_ENCRYPT
+#define GCM_SIV_DECRYPT LTC_DECRYPT
+
+int gcm_siv_memory(      int           cipher,
+                   const unsigned char *key,    unsigned long keylen,
+                   const unsigned char *nonce,  unsigned long noncelen,
+                   const unsigned char *adata,  unsigned long adatalen,
+                   const unsigned char *in,     unsigned long inlen,
+                         unsigned char *out,
+                         unsigned char *tag,    unsigned long *taglen,
+                                   int direction);
+int gcm_siv_test(void);
+
+#endif /* LTC_GCM_SIV_MODE */
+
 #ifdef LTC_CHACHA20POLY1305_MODE
 
 typedef struct {
@@ -542,6 +640,8 @@ typedef struct {
    ulong64 aadlen;
    ulong64 ctlen;
    int aadflg, openssh_compat;
+   unsigned char key[32];  /* XChaCha20 derives a new subkey for every nonce */
+   unsigned long keylen;
 } chacha20poly1305_state;
 
 #define CHACHA20POLY1305_ENCRYPT          LTC_ENCRYPT
@@ -562,6 +662,9 @@ int chacha20poly1305_memory(const unsigned char *key, unsigned long keylen,
                                   unsigned char *out,
                                   unsigned char *tag, unsigned long *taglen,
                             int direction);
+int chacha20poly1305_memory_batch(const unsigned char *key, unsigned long keylen,
+                                  ltc_aead_packet *pkt,     unsigned long npkt,
+                                  int direction);
 int chacha20poly1305_test(void);
 
 #endif /* LTC_CHACHA20POLY1305_MODE */
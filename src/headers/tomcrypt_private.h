@@ -118,6 +118,12 @@ int blowfish_setup_with_data(const unsigned char *key, int keylen,
                              const unsigned char *data, int datalen,
                              symmetric_key *skey);
 
+#if defined(LTC_CHACHA) && defined(LTC_CHACHA_SIMD)
+int chacha_simd_is_supported(void);
+unsigned long chacha_simd_crypt(const ulong32 *input, int rounds, const unsigned char *in, unsigned char *out, unsigned long blocks);
+unsigned long chacha_simd_keystream_lanes(const ulong32 *input, int rounds, const ulong32 *words, unsigned char *out, unsigned long blocks);
+#endif
+
 /* tomcrypt_hash.h */
 
 /* a simple macro for making hash "process" functions */
@@ -162,10 +168,181 @@ int func_name (hash_state * md, const unsigned char *in, unsigned long inlen)
 }
 
 
+/* like HASH_PROCESS but compress_n_name gets all complete blocks of the input at once */
+#define HASH_PROCESS_NBLOCKS(func_name, compress_n_name, state_var, block_size)             \
+int func_name (hash_state * md, const unsigned char *in, unsigned long inlen)               \
+{                                                                                           \
+    unsigned long n, blocks;                                                                \
+    int           err;                                                                      \
+    LTC_ARGCHK(md != NULL);                                                                 \
+    LTC_ARGCHK(in != NULL);                                                                 \
+    if (md-> state_var .curlen > sizeof(md-> state_var .buf)) {                             \
+       return CRYPT_INVALID_ARG;                                                            \
+    }                                                                                       \
+    if (((md-> state_var .length + inlen * 8) < md-> state_var .length)                     \
+          || ((inlen * 8) < inlen)) {                                                       \
+      return CRYPT_HASH_OVERFLOW;                                                           \
+    }                                                                                       \
+    while (inlen > 0) {                                                                     \
+        if (md-> state_var .curlen == 0 && inlen >= block_size) {                           \
+           blocks = inlen / block_size;                                                     \
+           if ((err = compress_n_name (md, in, blocks)) != CRYPT_OK) {                      \
+              return err;                                                                   \
+           }                                                                                \
+           md-> state_var .length += blocks * block_size * 8;                               \
+           in             += blocks * block_size;                                           \
+           inlen          -= blocks * block_size;                                           \
+        } else {                                                                            \
+           n = MIN(inlen, (block_size - md-> state_var .curlen));                           \
+           XMEMCPY(md-> state_var .buf + md-> state_var.curlen, in, (size_t)n);             \
+           md-> state_var .curlen += n;                                                     \
+           in             += n;                                                             \
+           inlen          -= n;                                                             \
+           if (md-> state_var .curlen == block_size) {                                      \
+              if ((err = compress_n_name (md, md-> state_var .buf, 1)) != CRYPT_OK) {       \
+                 return err;                                                                \
+              }                                                                             \
+              md-> state_var .length += 8*block_size;                                       \
+              md-> state_var .curlen = 0;                                                   \
+           }                                                                                \
+       }                                                                                    \
+    }                                                                                       \
+    return CRYPT_OK;                                                                        \
+}
+
+#ifdef LTC_SHA3
+unsigned long sha3_left_encode(ulong64 x, unsigned char *out);
+unsigned long sha3_right_encode(ulong64 x, unsigned char *out);
+#ifdef LTC_SHA3_X4
+int sha3_x4_avx2_is_supported(void);
+void sha3_x4_avx2_sponge(const unsigned char *in, unsigned long inlen, unsigned long rate, unsigned char pad,
+                         int rounds, unsigned char *out, unsigned long outlen);
+#endif
+#endif
+
+#if defined(LTC_SHA512) && defined(LTC_SHA512_SIMD)
+int sha512_simd_is_supported(void);
+void sha512_simd_compress(ulong64 *state, const unsigned char *buf, unsigned long blocks);
+#endif
+
+#ifdef LTC_BLAKE2S
+void blake2s_init_h(ulong32 *h, const unsigned char *P);
+void blake2s_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f);
+#ifdef LTC_BLAKE2_SIMD
+int blake2s_sse41_is_supported(void);
+void blake2s_sse41_compress(ulong32 *h, const unsigned char *buf, const ulong32 *t, const ulong32 *f);
+int blake2s_avx2_is_supported(void);
+void blake2s_avx2_compress8(ulong32 *h, const unsigned char *in, ulong64 t);
+#endif
+#endif
+
+#ifdef LTC_BLAKE2B
+void blake2b_init_h(ulong64 *h, const unsigned char *P);
+void blake2b_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f);
+#ifdef LTC_BLAKE2_SIMD
+int blake2b_avx2_is_supported(void);
+void blake2b_avx2_compress(ulong64 *h, const unsigned char *buf, const ulong64 *t, const ulong64 *f);
+void blake2b_avx2_compress4(ulong64 *h, const unsigned char *in, ulong64 t);
+#endif
+#endif
+
+#if defined(LTC_BLAKE3) && defined(LTC_BLAKE3_SIMD)
+int blake3_avx2_is_supported(void);
+void blake3_avx2_hash8(const unsigned char * const *in, unsigned long blocks, const ulong32 *key, ulong64 counter,
+                       int inc, unsigned long flags, unsigned long flags_start, unsigned long flags_end,
+                       unsigned char *out);
+int blake3_avx512_is_supported(void);
+void blake3_avx512_hash16(const unsigned char * const *in, unsigned long blocks, const ulong32 *key, ulong64 counter,
+                          int inc, unsigned long flags, unsigned long flags_start, unsigned long flags_end,
+                          unsigned char *out);
+#endif
+
+#ifdef LTC_SHA2_MULTIBUF
+#ifdef LTC_SHA256
+int sha256_mb_avx2_is_supported(int hash);
+int sha256_mb_avx2_memory(int hash, const unsigned char * const *in, const unsigned long *inlen,
+                          unsigned long n, unsigned char *out);
+#endif
+#ifdef LTC_SHA512
+int sha512_mb_avx2_is_supported(int hash);
+int sha512_mb_avx2_memory(int hash, const unsigned char * const *in, const unsigned long *inlen,
+                          unsigned long n, unsigned char *out);
+#endif
+#endif
+
+#ifdef LTC_SHA_NI
+#ifdef LTC_SHA1
+int sha1_shani_is_supported(void);
+void sha1_shani_compress(ulong32 *state, const unsigned char *buf, unsigned long blocks);
+#endif
+#ifdef LTC_SHA256
+int sha256_shani_is_supported(void);
+void sha256_shani_compress(ulong32 *state, const unsigned char *buf, unsigned long blocks);
+#endif
+#endif
+
+
 /* tomcrypt_mac.h */
 
+/* number of blocks OCB3 hands to the multi-block ECB of the cipher at once */
+#define OCB3_PAR 8
+
+#define OCB3_INT_ENCRYPT 0
+#define OCB3_INT_DECRYPT 1
+#define OCB3_INT_AAD     2
+
 int ocb3_int_ntz(unsigned long x);
 void ocb3_int_xor_blocks(unsigned char *out, const unsigned char *block_a, const unsigned char *block_b, unsigned long block_len);
+int ocb3_int_process_blocks(ocb3_state *ocb, unsigned char *offset, unsigned long *index,
+                            const unsigned char *in, unsigned char *out, unsigned char *sum,
+                            unsigned long blocks, int mode);
+
+/* ChaCha20-Poly1305 en-/decrypts and authenticates in chunks of this size (a multiple of 64) */
+#ifndef CHACHA20POLY1305_CHUNK
+#define CHACHA20POLY1305_CHUNK 4096
+#endif
+
+/* number of keystream blocks chacha20poly1305_memory_batch() computes at once (a multiple of 4) */
+#ifndef CHACHA20POLY1305_BATCH_BLOCKS
+#define CHACHA20POLY1305_BATCH_BLOCKS 64
+#endif
+#if CHACHA20POLY1305_BATCH_BLOCKS < 4 || CHACHA20POLY1305_BATCH_BLOCKS % 4 != 0
+   #error CHACHA20POLY1305_BATCH_BLOCKS has to be a multiple of 4
+#endif
+
+#if defined(LTC_POLY1305) && defined(LTC_POLY1305_AVX2)
+int poly1305_avx2_is_supported(void);
+unsigned long poly1305_avx2_blocks(poly1305_state *st, const unsigned char *in, unsigned long inlen);
+#endif
+
+#if defined(LTC_GCM_MODE) && defined(LTC_GCM_PCLMUL)
+int gcm_pclmul_is_supported(void);
+void gcm_pclmul_init(gcm_state *gcm);
+void gcm_pclmul_mult_h(const gcm_state *gcm, unsigned char *I);
+void gcm_pclmul_ghash(gcm_state *gcm, const unsigned char *in, unsigned long blocks);
+void gcm_pclmul_powers(const unsigned char *H, unsigned char (*PH)[16]);
+void gcm_pclmul_polyval(const unsigned char (*PH)[16], unsigned char *X, const unsigned char *in, unsigned long blocks);
+#endif
+
+#ifdef LTC_GCM_MODE
+/* number of counter blocks gcm_memory_batch() encrypts at once */
+#ifndef GCM_BATCH_BLOCKS
+#define GCM_BATCH_BLOCKS 128
+#endif
+/* packets of at least this size are given to the one-pass GCM of the cipher, if it has one */
+#ifndef GCM_BATCH_STITCH_MIN
+#define GCM_BATCH_STITCH_MIN 256
+#endif
+
+struct gcm_htable {
+   gcm_state gcm;                    /* initialized state which owns the key tables */
+   ulong32   refs;                   /* number of references */
+   LTC_MUTEX_TYPE(lock)
+};
+
+/* the state which holds the key and the tables of `gcm`, i.e. the state itself or the shared one */
+#define gcm_key_state(gcm)           ((gcm)->ht != NULL ? (const gcm_state*)&(gcm)->ht->gcm : (const gcm_state*)(gcm))
+#endif
 
 
 /* tomcrypt_math.h */
@@ -244,6 +421,39 @@ void ocb3_int_xor_blocks(unsigned char *out, const unsigned char *block_a, const
 
 /* tomcrypt_misc.h */
 
+/* x86 instruction set extensions, c.f. ltc_cpu_features() */
+#define LTC_CPU_SSE2         0x0001uL
+#define LTC_CPU_SSSE3        0x0002uL
+#define LTC_CPU_SSE41        0x0004uL
+#define LTC_CPU_AES          0x0008uL
+#define LTC_CPU_PCLMUL       0x0010uL
+#define LTC_CPU_AVX          0x0020uL
+#define LTC_CPU_AVX2         0x0040uL
+#define LTC_CPU_BMI2         0x0080uL
+#define LTC_CPU_SHA          0x0100uL
+#define LTC_CPU_VAES         0x0200uL
+#define LTC_CPU_VPCLMUL      0x0400uL
+#define LTC_CPU_AVX512F      0x0800uL
+#define LTC_CPU_AVX512BW     0x1000uL
+#define LTC_CPU_AVX512VL     0x2000uL
+
+ulong32 ltc_cpu_features(void);
+
+/* the intrinsics of the SIMD implementations,
+ * `-Wsystem-headers` complains about the AVX-512 reduction helpers in there */
+#if defined(LTC_CHACHA_SIMD) || defined(LTC_POLY1305_AVX2) || defined(LTC_SHA_NI) || defined(LTC_SHA2_MULTIBUF) || \
+    defined(LTC_SHA512_SIMD) || defined(LTC_SHA3_X4) || defined(LTC_BLAKE2_SIMD) || defined(LTC_BLAKE3_SIMD) || \
+    defined(LTC_AES_VAES)
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeclaration-after-statement"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
 typedef enum {
    /** Use `\r\n` as line separator */
    BASE64_PEM_CRLF = 1,
@@ -352,6 +562,11 @@ struct get_char {
 /* others */
 
 void copy_or_zeromem(const unsigned char* src, unsigned char* dest, unsigned long len, int coz);
+
+#ifndef LTC_NO_FILE
+typedef int (*file_process_cb)(void *ctx, const unsigned char *in, unsigned long inlen);
+int file_process(FILE *in, file_process_cb cb, void *ctx);
+#endif /* LTC_NO_FILE */
 void password_free(struct password *pw, const struct password_ctx *ctx);
 
 int pbes_decrypt(const pbes_arg  *arg, unsigned char *dec_data, unsigned long *dec_size);
@@ -5,6 +5,13 @@
 
 #ifdef LTC_BLAKE2BMAC
 
+#ifndef LTC_NO_FILE
+static int s_blake2bmac_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return blake2bmac_process(ctx, in, inlen);
+}
+#endif
+
 /**
   BLAKE2B MAC a file
   @param fname    The name of the file you wish to BLAKE2B MAC
@@ -26,8 +33,6 @@ int blake2bmac_file(const char *fname, const unsigned char *key, unsigned long k
 #else
    blake2bmac_state st;
    FILE *in;
-   unsigned char *buf;
-   size_t x;
    int err;
 
    LTC_ARGCHK(fname  != NULL);
@@ -35,10 +40,6 @@ int blake2bmac_file(const char *fname, const unsigned char *key, unsigned long k
    LTC_ARGCHK(mac    != NULL);
    LTC_ARGCHK(maclen != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = blake2bmac_init(&st, *maclen, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
@@ -49,28 +50,22 @@ int blake2bmac_file(const char *fname, const unsigned char *key, unsigned long k
       goto LBL_ERR;
    }
 
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = blake2bmac_process(&st, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
+   if ((err = file_process(in, s_blake2bmac_file_process, &st)) != CRYPT_OK) {
+      fclose(in);
+      goto LBL_ERR;
+   }
 
    if (fclose(in) != 0) {
       err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
+      goto LBL_ERR;
    }
 
    err = blake2bmac_done(&st, mac, maclen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&st, sizeof(blake2bmac_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
@@ -0,0 +1,56 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2BPMAC
+
+/**
+   Initialize an BLAKE2BP MAC context.
+   @param st       The BLAKE2BP MAC state
+   @param outlen   The size of the MAC output (octets)
+   @param key      The secret key
+   @param keylen   The length of the secret key (octets)
+   @return CRYPT_OK if successful
+*/
+int blake2bpmac_init(blake2bpmac_state *st, unsigned long outlen, const unsigned char *key, unsigned long keylen)
+{
+   LTC_ARGCHK(st  != NULL);
+   LTC_ARGCHK(key != NULL);
+   return blake2bp_init(st, outlen, key, keylen);
+}
+
+/**
+  Process data through BLAKE2BP MAC
+  @param st      The BLAKE2BP MAC state
+  @param in      The data to send through HMAC
+  @param inlen   The length of the data to HMAC (octets)
+  @return CRYPT_OK if successful
+*/
+int blake2bpmac_process(blake2bpmac_state *st, const unsigned char *in, unsigned long inlen)
+{
+   if (inlen == 0) return CRYPT_OK; /* nothing to do */
+   LTC_ARGCHK(st != NULL);
+   LTC_ARGCHK(in != NULL);
+   return blake2bp_process(st, in, inlen);
+}
+
+/**
+   Terminate a BLAKE2BP MAC session
+   @param st      The BLAKE2BP MAC state
+   @param mac     [out] The destination of the BLAKE2BP MAC authentication tag
+   @param maclen  [in/out]  The max size and resulting size of the BLAKE2BP MAC authentication tag
+   @return CRYPT_OK if successful
+*/
+int blake2bpmac_done(blake2bpmac_state *st, unsigned char *mac, unsigned long *maclen)
+{
+   LTC_ARGCHK(st     != NULL);
+   LTC_ARGCHK(mac    != NULL);
+   LTC_ARGCHK(maclen != NULL);
+   LTC_ARGCHK(*maclen >= st->blake2bp.outlen);
+
+   *maclen = st->blake2bp.outlen;
+   return blake2bp_done(st, mac);
+}
+
+#endif
@@ -0,0 +1,73 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2BPMAC
+
+#ifndef LTC_NO_FILE
+static int s_blake2bpmac_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return blake2bpmac_process(ctx, in, inlen);
+}
+#endif
+
+/**
+  BLAKE2BP MAC a file
+  @param fname    The name of the file you wish to BLAKE2BP MAC
+  @param key      The secret key
+  @param keylen   The length of the secret key
+  @param mac      [out] The BLAKE2BP MAC authentication tag
+  @param maclen   [in/out]  The max size and resulting size of the authentication tag
+  @return CRYPT_OK if successful, CRYPT_NOP if file support has been disabled
+*/
+int blake2bpmac_file(const char *fname, const unsigned char *key, unsigned long keylen, unsigned char *mac, unsigned long *maclen)
+{
+#ifdef LTC_NO_FILE
+   LTC_UNUSED_PARAM(fname);
+   LTC_UNUSED_PARAM(key);
+   LTC_UNUSED_PARAM(keylen);
+   LTC_UNUSED_PARAM(mac);
+   LTC_UNUSED_PARAM(maclen);
+   return CRYPT_NOP;
+#else
+   blake2bpmac_state st;
+   FILE *in;
+   int err;
+
+   LTC_ARGCHK(fname  != NULL);
+   LTC_ARGCHK(key    != NULL);
+   LTC_ARGCHK(mac    != NULL);
+   LTC_ARGCHK(maclen != NULL);
+
+   if ((err = blake2bpmac_init(&st, *maclen, key, keylen)) != CRYPT_OK) {
+      goto LBL_ERR;
+   }
+
+   in = fopen(fname, "rb");
+   if (in == NULL) {
+      err = CRYPT_FILE_NOTFOUND;
+      goto LBL_ERR;
+   }
+
+   if ((err = file_process(in, s_blake2bpmac_file_process, &st)) != CRYPT_OK) {
+      fclose(in);
+      goto LBL_ERR;
+   }
+
+   if (fclose(in) != 0) {
+      err = CRYPT_ERROR;
+      goto LBL_ERR;
+   }
+
+   err = blake2bpmac_done(&st, mac, maclen);
+
+LBL_ERR:
+#ifdef LTC_CLEAN_STACK
+   zeromem(&st, sizeof(blake2bpmac_state));
+#endif
+   return err;
+#endif
+}
+
+#endif
@@ -0,0 +1,66 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2BPMAC
+
+int blake2bpmac_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* key = 00 01 .. 3f, message = 00 01 .. ff 00 01 .., as in blake2bp-kat.txt for lengths up to 255 */
+   static const struct {
+      unsigned long len;
+      unsigned char mac[64];
+   } tests[] = {
+      {    0, { 0x9d, 0x94, 0x61, 0x07, 0x3e, 0x4e, 0xb6, 0x40, 0xa2, 0x55, 0x35, 0x7b, 0x83, 0x9f, 0x39, 0x4b, 0x83, 0x8c, 0x6f, 0xf5, 0x7c, 0x9b, 0x68, 0x6a, 0x3f, 0x76, 0x10, 0x7c, 0x10, 0x66, 0x72, 0x8f, 0x3c, 0x99, 0x56, 0xbd, 0x78, 0x5c, 0xbc, 0x3b, 0xf7, 0x9d, 0xc2, 0xab, 0x57, 0x8c, 0x5a, 0x0c, 0x06, 0x3b, 0x9d, 0x9c, 0x40, 0x58, 0x48, 0xde, 0x1d, 0xbe, 0x82, 0x1c, 0xd0, 0x5c, 0x94, 0x0a } },
+      {    1, { 0xff, 0x8e, 0x90, 0xa3, 0x7b, 0x94, 0x62, 0x39, 0x32, 0xc5, 0x9f, 0x75, 0x59, 0xf2, 0x60, 0x35, 0x02, 0x9c, 0x37, 0x67, 0x32, 0xcb, 0x14, 0xd4, 0x16, 0x02, 0x00, 0x1c, 0xbb, 0x73, 0xad, 0xb7, 0x92, 0x93, 0xa2, 0xdb, 0xda, 0x5f, 0x60, 0x70, 0x30, 0x25, 0x14, 0x4d, 0x15, 0x8e, 0x27, 0x35, 0x52, 0x95, 0x96, 0x25, 0x1c, 0x73, 0xc0, 0x34, 0x5c, 0xa6, 0xfc, 0xcb, 0x1f, 0xb1, 0xe9, 0x7e } },
+      {    3, { 0x30, 0x30, 0x2c, 0x3f, 0xc9, 0x99, 0x06, 0x5d, 0x10, 0xdc, 0x98, 0x2c, 0x8f, 0xee, 0xf4, 0x1b, 0xbb, 0x66, 0x42, 0x71, 0x8f, 0x62, 0x4a, 0xf6, 0xe3, 0xea, 0xbe, 0xa0, 0x83, 0xe7, 0xfe, 0x78, 0x53, 0x40, 0xdb, 0x4b, 0x08, 0x97, 0xef, 0xff, 0x39, 0xce, 0xe1, 0xdc, 0x1e, 0xb7, 0x37, 0xcd, 0x1e, 0xea, 0x0f, 0xe7, 0x53, 0x84, 0x98, 0x4e, 0x7d, 0x8f, 0x44, 0x6f, 0xaa, 0x68, 0x3b, 0x80 } },
+      {   64, { 0x22, 0xb8, 0x24, 0x9e, 0xaf, 0x72, 0x29, 0x64, 0xce, 0x42, 0x4f, 0x71, 0xa7, 0x4d, 0x03, 0x8f, 0xf9, 0xb6, 0x15, 0xfb, 0xa5, 0xc7, 0xc2, 0x2c, 0xb6, 0x27, 0x97, 0xf5, 0x39, 0x82, 0x24, 0xc3, 0xf0, 0x72, 0xeb, 0xc1, 0xda, 0xcb, 0xa3, 0x2f, 0xc6, 0xf6, 0x63, 0x60, 0xb3, 0xe1, 0x65, 0x8d, 0x0f, 0xa0, 0xda, 0x1e, 0xd1, 0xc1, 0xda, 0x66, 0x2a, 0x20, 0x37, 0xda, 0x82, 0x3a, 0x33, 0x83 } },
+      {  127, { 0x79, 0x26, 0x70, 0x88, 0x59, 0xe6, 0xe2, 0xab, 0x68, 0xf6, 0x04, 0xda, 0x69, 0xa9, 0xfb, 0x50, 0x87, 0xbb, 0x33, 0xf4, 0xe8, 0xd8, 0x95, 0x73, 0x0e, 0x30, 0x1a, 0xb2, 0xd7, 0xdf, 0x74, 0x8b, 0x67, 0xdf, 0x0b, 0x6b, 0x86, 0x22, 0xe5, 0x2d, 0xd5, 0x7d, 0x8d, 0x3a, 0xd8, 0x7d, 0x58, 0x20, 0xd4, 0xec, 0xfd, 0x24, 0x17, 0x8b, 0x2d, 0x2b, 0x78, 0xd6, 0x4f, 0x4f, 0xbd, 0x38, 0x75, 0x82 } },
+      {  128, { 0x92, 0x80, 0xf4, 0xd1, 0x15, 0x70, 0x32, 0xab, 0x31, 0x5c, 0x10, 0x0d, 0x63, 0x62, 0x83, 0xfb, 0xf4, 0xfb, 0xa2, 0xfb, 0xad, 0x0f, 0x8b, 0xc0, 0x20, 0x72, 0x1d, 0x76, 0xbc, 0x1c, 0x89, 0x73, 0xce, 0xd2, 0x88, 0x71, 0xcc, 0x90, 0x7d, 0xab, 0x60, 0xe5, 0x97, 0x56, 0x98, 0x7b, 0x0e, 0x0f, 0x86, 0x7f, 0xa2, 0xfe, 0x9d, 0x90, 0x41, 0xf2, 0xc9, 0x61, 0x80, 0x74, 0xe4, 0x4f, 0xe5, 0xe9 } },
+      {  129, { 0x55, 0x30, 0xc2, 0xd5, 0x9f, 0x14, 0x48, 0x72, 0xe9, 0x87, 0xe4, 0xe2, 0x58, 0xa7, 0xd8, 0xc3, 0x8c, 0xe8, 0x44, 0xe2, 0xcc, 0x2e, 0xed, 0x94, 0x0f, 0xfc, 0x68, 0x3b, 0x49, 0x88, 0x15, 0xe5, 0x3a, 0xdb, 0x1f, 0xaa, 0xf5, 0x68, 0x94, 0x61, 0x22, 0x80, 0x5a, 0xc3, 0xb8, 0xe2, 0xfe, 0xd4, 0x35, 0xfe, 0xd6, 0x16, 0x2e, 0x76, 0xf5, 0x64, 0xe5, 0x86, 0xba, 0x46, 0x44, 0x24, 0xe8, 0x85 } },
+      {  255, { 0x96, 0xfb, 0xcb, 0xb6, 0x0b, 0xd3, 0x13, 0xb8, 0x84, 0x50, 0x33, 0xe5, 0xbc, 0x05, 0x8a, 0x38, 0x02, 0x74, 0x38, 0x57, 0x2d, 0x7e, 0x79, 0x57, 0xf3, 0x68, 0x4f, 0x62, 0x68, 0xaa, 0xdd, 0x3a, 0xd0, 0x8d, 0x21, 0x76, 0x7e, 0xd6, 0x87, 0x86, 0x85, 0x33, 0x1b, 0xa9, 0x85, 0x71, 0x48, 0x7e, 0x12, 0x47, 0x0a, 0xad, 0x66, 0x93, 0x26, 0x71, 0x6e, 0x46, 0x66, 0x7f, 0x69, 0xf8, 0xd7, 0xe8 } },
+      {  256, { 0x99, 0x15, 0xa9, 0x7d, 0xc3, 0xdf, 0x81, 0x25, 0x1f, 0x17, 0x78, 0xdf, 0xc4, 0xfa, 0x02, 0xa2, 0xad, 0x8c, 0xfc, 0x8f, 0x89, 0xb5, 0x1a, 0xc1, 0x9e, 0x90, 0xa4, 0x5f, 0x37, 0x20, 0x69, 0x01, 0x5d, 0x8b, 0x4e, 0x87, 0x7b, 0x33, 0x0d, 0x7e, 0x53, 0xd1, 0xef, 0x63, 0x6f, 0xa7, 0xb6, 0xf8, 0x73, 0x6b, 0x2e, 0x04, 0x9a, 0xa9, 0x8d, 0x2f, 0x7c, 0x85, 0xc9, 0x61, 0x5d, 0xf9, 0xe2, 0xec } },
+      {  511, { 0xeb, 0x7b, 0x7b, 0xb4, 0xd5, 0x21, 0x70, 0x25, 0x70, 0x5e, 0x94, 0x9d, 0x98, 0xdb, 0x93, 0xee, 0x62, 0xe6, 0x4f, 0x6f, 0xb9, 0xe6, 0xf4, 0x51, 0x08, 0xa5, 0xf7, 0xeb, 0xe2, 0x90, 0x81, 0x61, 0x29, 0x4b, 0x0e, 0x8c, 0x90, 0x4a, 0xfa, 0x9d, 0x57, 0xc5, 0x06, 0xe9, 0xda, 0x3b, 0x02, 0x80, 0x6f, 0xd5, 0x76, 0x7a, 0xe5, 0x54, 0x98, 0xeb, 0x3b, 0xb8, 0xcd, 0x7f, 0x09, 0x1b, 0x57, 0x2d } },
+      {  512, { 0x14, 0xba, 0x32, 0xc1, 0xc8, 0x0b, 0xb3, 0x2c, 0x82, 0x82, 0xaa, 0x53, 0xf3, 0x41, 0xf4, 0x5d, 0xaa, 0xbd, 0xa1, 0x2b, 0xda, 0x41, 0xf7, 0xad, 0x8e, 0xc7, 0x5b, 0xaa, 0x74, 0x3a, 0x41, 0xad, 0xf2, 0x37, 0x6a, 0xd3, 0xde, 0x32, 0xfb, 0x57, 0x6d, 0x3e, 0xfd, 0xca, 0xdf, 0x3f, 0x59, 0xd2, 0x5b, 0x40, 0xb9, 0x15, 0x68, 0x1c, 0xc9, 0x0d, 0xee, 0x3a, 0x9b, 0x2c, 0xb0, 0x20, 0x61, 0xea } },
+      {  513, { 0x2d, 0x9a, 0xf8, 0x50, 0x3c, 0x1b, 0x10, 0x7a, 0xec, 0xe8, 0xec, 0xc7, 0x3f, 0x2c, 0x2a, 0x6e, 0xcf, 0xe3, 0xde, 0xf9, 0x43, 0xab, 0x27, 0x7b, 0xb3, 0x32, 0x36, 0x43, 0xb8, 0xbb, 0xd3, 0x36, 0x31, 0xe3, 0x4d, 0x0f, 0x09, 0x5a, 0x4a, 0xfb, 0x01, 0x93, 0xb2, 0xd4, 0x4b, 0xcd, 0x11, 0x38, 0x3d, 0x60, 0xad, 0x02, 0x04, 0x72, 0xb1, 0x9f, 0x28, 0xf3, 0xed, 0xf3, 0xdb, 0xcb, 0xdc, 0xda } },
+      {  640, { 0xb2, 0x07, 0xb2, 0x4f, 0x6c, 0xdd, 0x9d, 0xa0, 0xb0, 0x28, 0xe1, 0xae, 0x3b, 0xc7, 0x8a, 0x3d, 0x10, 0xb2, 0xd6, 0x4d, 0x9e, 0xf3, 0xa4, 0x8d, 0xd6, 0xa2, 0x8d, 0xc7, 0xe1, 0xb8, 0xf3, 0x1f, 0x8a, 0xa6, 0x06, 0xac, 0x18, 0x06, 0xf1, 0xda, 0x5f, 0xe8, 0x48, 0x33, 0xbf, 0x9f, 0xc7, 0x55, 0x5c, 0xf4, 0x58, 0x1e, 0x9d, 0xb4, 0xbe, 0xa9, 0xd2, 0xaa, 0xe8, 0x04, 0x0c, 0x14, 0x31, 0x74 } },
+      { 1000, { 0x10, 0xe1, 0x19, 0x19, 0x1d, 0xa5, 0x96, 0x4a, 0xfd, 0xbf, 0x01, 0x71, 0xf5, 0xe0, 0x62, 0xd4, 0x12, 0x3e, 0x6c, 0x97, 0xe7, 0x59, 0xd2, 0x0d, 0x03, 0x82, 0x5b, 0xe2, 0x2d, 0xeb, 0xc6, 0x94, 0x7e, 0xf6, 0xc0, 0x1f, 0x5f, 0xda, 0xc9, 0xeb, 0x36, 0xe3, 0xb0, 0x39, 0x55, 0xff, 0x28, 0xd6, 0x47, 0xca, 0xf5, 0x64, 0xf2, 0xcb, 0x2f, 0x20, 0x3a, 0x0c, 0xbc, 0x90, 0xe0, 0xdd, 0x4d, 0xc3 } },
+   };
+   unsigned char inp[1000], out[64], key[64];
+   unsigned long i, ilen, klen = sizeof(key), mlen = 64;
+   blake2bpmac_state st;
+
+   for (i = 0; i < sizeof(inp); i++) inp[i] = (unsigned char)i;
+   for (i = 0; i < sizeof(key); i++) key[i] = (unsigned char)i;
+
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      const unsigned char *mac = tests[i].mac;
+      unsigned long olen = mlen;
+      ilen = tests[i].len;
+      /* process piece by piece */
+      if (ilen > 15) {
+        blake2bpmac_init(&st, olen, key, klen);
+        blake2bpmac_process(&st, (unsigned char*)inp,      5);
+        blake2bpmac_process(&st, (unsigned char*)inp + 5,  4);
+        blake2bpmac_process(&st, (unsigned char*)inp + 9,  3);
+        blake2bpmac_process(&st, (unsigned char*)inp + 12, 2);
+        blake2bpmac_process(&st, (unsigned char*)inp + 14, 1);
+        blake2bpmac_process(&st, (unsigned char*)inp + 15, ilen - 15);
+        blake2bpmac_done(&st, out, &olen);
+        if (compare_testvector(out, olen, mac, mlen, "BLAKE2BP MAC multi", i) != 0) return CRYPT_FAIL_TESTVECTOR;
+      }
+      /* process in one go */
+      blake2bpmac_init(&st, olen, key, klen);
+      blake2bpmac_process(&st, (unsigned char*)inp, ilen);
+      blake2bpmac_done(&st, out, &olen);
+      if (compare_testvector(out, olen, mac, mlen, "BLAKE2BP MAC single", i) != 0) return CRYPT_FAIL_TESTVECTOR;
+   }
+   return CRYPT_OK;
+#endif
+}
+
+#endif
@@ -0,0 +1,66 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_BLAKE2SPMAC
+
+int blake2spmac_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* key = 00 01 .. 1f, message = 00 01 .. ff 00 01 .., as in blake2sp-kat.txt for lengths up to 255 */
+   static const struct {
+      unsigned long len;
+      unsigned char mac[32];
+   } tests[] = {
+      {    0, { 0x71, 0x5c, 0xb1, 0x38, 0x95, 0xae, 0xb6, 0x78, 0xf6, 0x12, 0x41, 0x60, 0xbf, 0xf2, 0x14, 0x65, 0xb3, 0x0f, 0x4f, 0x68, 0x74, 0x19, 0x3f, 0xc8, 0x51, 0xb4, 0x62, 0x10, 0x43, 0xf0, 0x9c, 0xc6 } },
+      {    1, { 0x40, 0x57, 0x8f, 0xfa, 0x52, 0xbf, 0x51, 0xae, 0x18, 0x66, 0xf4, 0x28, 0x4d, 0x3a, 0x15, 0x7f, 0xc1, 0xbc, 0xd3, 0x6a, 0xc1, 0x3c, 0xbd, 0xcb, 0x03, 0x77, 0xe4, 0xd0, 0xcd, 0x0b, 0x66, 0x03 } },
+      {    3, { 0x8d, 0xbc, 0xc0, 0x58, 0x9a, 0x3d, 0x17, 0x29, 0x6a, 0x7a, 0x58, 0xe2, 0xf1, 0xef, 0xf0, 0xe2, 0xaa, 0x42, 0x10, 0xb5, 0x8d, 0x1f, 0x88, 0xb8, 0x6d, 0x7b, 0xa5, 0xf2, 0x9d, 0xd3, 0xb5, 0x83 } },
+      {   64, { 0x1d, 0x37, 0x01, 0xa5, 0x66, 0x1b, 0xd3, 0x1a, 0xb2, 0x05, 0x62, 0xbd, 0x07, 0xb7, 0x4d, 0xd1, 0x9a, 0xc8, 0xf3, 0x52, 0x4b, 0x73, 0xce, 0x7b, 0xc9, 0x96, 0xb7, 0x88, 0xaf, 0xd2, 0xf3, 0x17 } },
+      {  127, { 0x44, 0xcb, 0x63, 0x11, 0xd0, 0x75, 0x0b, 0x7e, 0x33, 0xf7, 0x33, 0x3a, 0xa7, 0x8a, 0xac, 0xa9, 0xc3, 0x4a, 0xd5, 0xf7, 0x9c, 0x1b, 0x15, 0x91, 0xec, 0x33, 0x95, 0x1e, 0x69, 0xc4, 0xc4, 0x61 } },
+      {  128, { 0x0c, 0x6c, 0xe3, 0x2a, 0x3e, 0xa0, 0x56, 0x12, 0xc5, 0xf8, 0x09, 0x0f, 0x6a, 0x7e, 0x87, 0xf5, 0xab, 0x30, 0xe4, 0x1b, 0x70, 0x7d, 0xcb, 0xe5, 0x41, 0x55, 0x62, 0x0a, 0xd7, 0x70, 0xa3, 0x40 } },
+      {  129, { 0xc6, 0x59, 0x38, 0xdd, 0x3a, 0x05, 0x3c, 0x72, 0x9c, 0xf5, 0xb7, 0xc8, 0x9f, 0x39, 0x0b, 0xfe, 0xbb, 0x51, 0x12, 0x76, 0x6b, 0xb0, 0x0a, 0xa5, 0xfa, 0x31, 0x64, 0xdf, 0xdf, 0x3b, 0x56, 0x47 } },
+      {  255, { 0x0c, 0x8a, 0x36, 0x59, 0x7d, 0x74, 0x61, 0xc6, 0x3a, 0x94, 0x73, 0x28, 0x21, 0xc9, 0x41, 0x85, 0x6c, 0x66, 0x83, 0x76, 0x60, 0x6c, 0x86, 0xa5, 0x2d, 0xe0, 0xee, 0x41, 0x04, 0xc6, 0x15, 0xdb } },
+      {  256, { 0xe5, 0xf4, 0x67, 0x51, 0xed, 0x88, 0x8c, 0x5f, 0xb7, 0x43, 0x6c, 0x30, 0x88, 0xde, 0xa8, 0xd3, 0x98, 0x06, 0x6a, 0x43, 0xe5, 0x21, 0xcb, 0x13, 0x13, 0x34, 0x38, 0xf2, 0xc8, 0x0e, 0x60, 0xe5 } },
+      {  511, { 0x3e, 0x39, 0x48, 0xf0, 0xb6, 0x60, 0x23, 0x48, 0xb6, 0x99, 0xda, 0xb0, 0xea, 0x15, 0xc0, 0x78, 0x1f, 0xd6, 0x94, 0x18, 0x35, 0x31, 0x14, 0x2f, 0xb5, 0xbc, 0x88, 0x47, 0x7c, 0xac, 0xbe, 0x76 } },
+      {  512, { 0x32, 0x46, 0xbc, 0x18, 0xb4, 0x22, 0x53, 0xf5, 0x8d, 0x3b, 0xc2, 0x1d, 0xd5, 0x1c, 0x14, 0x29, 0x0c, 0x0b, 0x78, 0xd4, 0xd9, 0xd5, 0x27, 0x40, 0x87, 0xbf, 0xf2, 0xca, 0x29, 0x7c, 0x51, 0xfc } },
+      {  513, { 0x58, 0x3d, 0xc2, 0xf1, 0xf1, 0x06, 0xe8, 0xb8, 0x5f, 0xab, 0x47, 0x95, 0x37, 0x15, 0x76, 0xd7, 0x5e, 0xca, 0x0f, 0xad, 0x5a, 0x0c, 0xc5, 0xed, 0xe8, 0x1a, 0xd5, 0x4b, 0xd4, 0x05, 0xd8, 0x73 } },
+      {  640, { 0x2f, 0x45, 0x16, 0x13, 0x0e, 0x86, 0xc9, 0xb2, 0x4f, 0xa9, 0x1c, 0xe0, 0x09, 0x3d, 0xaf, 0x53, 0xd1, 0x6d, 0x90, 0xc8, 0x1a, 0xa0, 0x08, 0xdc, 0x4d, 0xc9, 0xea, 0x71, 0x6e, 0x32, 0x3e, 0x31 } },
+      { 1000, { 0x68, 0x6d, 0x69, 0x5f, 0x44, 0x9e, 0x51, 0x56, 0xd7, 0x0c, 0x54, 0xcd, 0x7c, 0x3f, 0x74, 0x0c, 0x92, 0x33, 0xdc, 0xa1, 0x72, 0xff, 0xca, 0xdb, 0xa9, 0x48, 0x84, 0x14, 0xda, 0x9c, 0x14, 0x15 } },
+   };
+   unsigned char inp[1000], out[32], key[32];
+   unsigned long i, ilen, klen = sizeof(key), mlen = 32;
+   blake2spmac_state st;
+
+   for (i = 0; i < sizeof(inp); i++) inp[i] = (unsigned char)i;
+   for (i = 0; i < sizeof(key); i++) key[i] = (unsigned char)i;
+
+   for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+      const unsigned char *mac = tests[i].mac;
+      unsigned long olen = mlen;
+      ilen = tests[i].len;
+      /* process piece by piece */
+      if (ilen > 15) {
+        blake2spmac_init(&st, olen, key, klen);
+        blake2spmac_process(&st, (unsigned char*)inp,      5);
+        blake2spmac_process(&st, (unsigned char*)inp + 5,  4);
+        blake2spmac_process(&st, (unsigned char*)inp + 9,  3);
+        blake2spmac_process(&st, (unsigned char*)inp + 12, 2);
+        blake2spmac_process(&st, (unsigned char*)inp + 14, 1);
+        blake2spmac_process(&st, (unsigned char*)inp + 15, ilen - 15);
+        blake2spmac_done(&st, out, &olen);
+        if (compare_testvector(out, olen, mac, mlen, "BLAKE2SP MAC multi", i) != 0) return CRYPT_FAIL_TESTVECTOR;
+      }
+      /* process in one go */
+      blake2spmac_init(&st, olen, key, klen);
+      blake2spmac_process(&st, (unsigned char*)inp, ilen);
+      blake2spmac_done(&st, out, &olen);
+      if (compare_testvector(out, olen, mac, mlen, "BLAKE2SP MAC single", i) != 0) return CRYPT_FAIL_TESTVECTOR;
+   }
+   return CRYPT_OK;
+#endif
+}
+
+#endif
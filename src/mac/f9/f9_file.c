@@ -9,6 +9,13 @@
 
 #ifdef LTC_F9_MODE
 
+#ifndef LTC_NO_FILE
+static int s_f9_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return f9_process(ctx, in, inlen);
+}
+#endif
+
 /**
    f9 a file
    @param cipher   The index of the cipher desired
@@ -33,21 +40,15 @@ int f9_file(int cipher,
    LTC_UNUSED_PARAM(outlen);
    return CRYPT_NOP;
 #else
-   size_t x;
    int err;
    f9_state f9;
    FILE *in;
-   unsigned char *buf;
 
    LTC_ARGCHK(key    != NULL);
    LTC_ARGCHK(fname  != NULL);
    LTC_ARGCHK(out    != NULL);
    LTC_ARGCHK(outlen != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = f9_init(&f9, cipher, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
@@ -58,28 +59,22 @@ int f9_file(int cipher,
       goto LBL_ERR;
    }
 
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = f9_process(&f9, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
+   if ((err = file_process(in, s_f9_file_process, &f9)) != CRYPT_OK) {
+      fclose(in);
+      goto LBL_ERR;
+   }
 
    if (fclose(in) != 0) {
       err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
+      goto LBL_ERR;
    }
 
    err = f9_done(&f9, out, outlen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&f9, sizeof(f9_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
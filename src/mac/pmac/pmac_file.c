@@ -9,6 +9,13 @@
 
 #ifdef LTC_PMAC
 
+#ifndef LTC_NO_FILE
+static int s_pmac_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return pmac_process(ctx, in, inlen);
+}
+#endif
+
 /**
    PMAC a file
    @param cipher       The index of the cipher desired
@@ -33,11 +40,9 @@ int pmac_file(int cipher,
    LTC_UNUSED_PARAM(outlen);
    return CRYPT_NOP;
 #else
-   size_t x;
    int err;
    pmac_state pmac;
    FILE *in;
-   unsigned char *buf;
 
 
    LTC_ARGCHK(key      != NULL);
@@ -45,10 +50,6 @@ int pmac_file(int cipher,
    LTC_ARGCHK(out      != NULL);
    LTC_ARGCHK(outlen   != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = pmac_init(&pmac, cipher, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
@@ -59,28 +60,22 @@ int pmac_file(int cipher,
       goto LBL_ERR;
    }
 
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = pmac_process(&pmac, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
+   if ((err = file_process(in, s_pmac_file_process, &pmac)) != CRYPT_OK) {
+      fclose(in);
+      goto LBL_ERR;
+   }
 
    if (fclose(in) != 0) {
       err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
+      goto LBL_ERR;
    }
 
    err = pmac_done(&pmac, out, outlen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&pmac, sizeof(pmac_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
@@ -10,6 +10,73 @@
 
 #ifdef LTC_POLY1305
 
+/* use 44 bit limbs and 128 bit products on 64 bit hosts */
+#if defined(ENDIAN_64BITWORD) && defined(__SIZEOF_INT128__) && !defined(LTC_POLY1305_NO_INT128)
+   #define LTC_POLY1305_DONNA64
+#endif
+
+#if defined(LTC_POLY1305_DONNA64)
+
+__extension__ typedef unsigned __int128 poly1305_uint128;
+
+/* internal only, the state keeps 26 bit limbs, they're converted to 44 bit limbs and back */
+static void s_poly1305_block(poly1305_state *st, const unsigned char *in, unsigned long inlen)
+{
+   const ulong64 hibit = (st->final) ? 0 : ((ulong64)1 << 40); /* 1 << 128 */
+   const ulong64 m44 = CONST64(0xfffffffffff), m42 = CONST64(0x3ffffffffff);
+   ulong64 r0,r1,r2;
+   ulong64 s1,s2;
+   ulong64 h0,h1,h2;
+   ulong64 t0,t1,c;
+   poly1305_uint128 d0,d1,d2;
+
+   /* r is fully reduced, h may be a bit above 2^26 in each limb, therefore add instead of or */
+   t0 = (ulong64)st->r[0] | ((ulong64)st->r[1] << 26) | ((ulong64)st->r[2] << 52);
+   t1 = ((ulong64)st->r[2] >> 12) | ((ulong64)st->r[3] << 14) | ((ulong64)st->r[4] << 40);
+   r0 = t0 & m44;
+   r1 = ((t0 >> 44) | (t1 << 20)) & m44;
+   r2 = (t1 >> 24) & m42;
+
+   s1 = r1 * (5 << 2);
+   s2 = r2 * (5 << 2);
+
+   h0 = (ulong64)st->h[0] + ((ulong64)(st->h[1] & 0x3ffff) << 26);
+   h1 = ((ulong64)st->h[1] >> 18) + ((ulong64)st->h[2] << 8) + ((ulong64)(st->h[3] & 0x3ff) << 34);
+   h2 = ((ulong64)st->h[3] >> 10) + ((ulong64)st->h[4] << 16);
+
+   while (inlen >= 16) {
+      /* h += in[i] */
+      LOAD64L(t0, in + 0);
+      LOAD64L(t1, in + 8);
+      h0 += t0 & m44;
+      h1 += ((t0 >> 44) | (t1 << 20)) & m44;
+      h2 += ((t1 >> 24) & m42) | hibit;
+
+      /* h *= r */
+      d0 = ((poly1305_uint128)h0 * r0) + ((poly1305_uint128)h1 * s2) + ((poly1305_uint128)h2 * s1);
+      d1 = ((poly1305_uint128)h0 * r1) + ((poly1305_uint128)h1 * r0) + ((poly1305_uint128)h2 * s2);
+      d2 = ((poly1305_uint128)h0 * r2) + ((poly1305_uint128)h1 * r1) + ((poly1305_uint128)h2 * r0);
+
+      /* (partial) h %= p */
+                              c = (ulong64)(d0 >> 44); h0 = (ulong64)d0 & m44;
+      d1 += c;                c = (ulong64)(d1 >> 44); h1 = (ulong64)d1 & m44;
+      d2 += c;                c = (ulong64)(d2 >> 42); h2 = (ulong64)d2 & m42;
+      h0 += c * 5;            c =          (h0 >> 44); h0 =          h0 & m44;
+      h1 += c;
+
+      in += 16;
+      inlen -= 16;
+   }
+
+   st->h[0] = (ulong32)(h0 & 0x3ffffff);
+   st->h[1] = (ulong32)((h0 >> 26) + ((h1 & 0xff) << 18));
+   st->h[2] = (ulong32)((h1 >> 8) & 0x3ffffff);
+   st->h[3] = (ulong32)((h1 >> 34) + ((h2 & 0xffff) << 10));
+   st->h[4] = (ulong32)(h2 >> 16);
+}
+
+#else
+
 /* internal only */
 static void s_poly1305_block(poly1305_state *st, const unsigned char *in, unsigned long inlen)
 {
@@ -73,6 +140,8 @@ static void s_poly1305_block(poly1305_state *st, const unsigned char *in, unsign
    st->h[4] = h4;
 }
 
+#endif
+
 /**
    Initialize an POLY1305 context.
    @param st       The POLY1305 state
@@ -142,6 +211,14 @@ int poly1305_process(poly1305_state *st, const unsigned char *in, unsigned long
    /* process full blocks */
    if (inlen >= 16) {
       unsigned long want = (inlen & ~(16 - 1));
+#if defined(LTC_POLY1305_AVX2)
+      if (want >= 512 && poly1305_avx2_is_supported()) {
+         i = poly1305_avx2_blocks(st, in, want);
+         in += i;
+         inlen -= i;
+         want -= i;
+      }
+#endif
       s_poly1305_block(st, in, want);
       in += want;
       inlen -= want;
@@ -0,0 +1,200 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file poly1305_avx2.c
+  Poly1305 with AVX2, 4 blocks in parallel
+
+  Every 64 bit lane keeps its own accumulator in five 26 bit limbs, lane j
+  absorbs the blocks 4i+j: A_j = A_j * r^4 + m_{4i+j}.  At the end lane j is
+  multiplied by r^(4-j) and the lanes are summed up, which gives the same
+  result as the serial h = (h + m_i) * r.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_POLY1305) && defined(LTC_POLY1305_AVX2)
+
+/**
+  Check whether the CPU supports AVX2
+  @return 1 if supported, 0 otherwise
+*/
+int poly1305_avx2_is_supported(void)
+{
+   return (ltc_cpu_features() & LTC_CPU_AVX2) == LTC_CPU_AVX2;
+}
+
+/* o = a * b mod p in 26 bit limbs, partially reduced */
+static void s_poly1305_mul(ulong32 *o, const ulong32 *a, const ulong32 *b)
+{
+   ulong64 d0, d1, d2, d3, d4;
+   ulong32 s1, s2, s3, s4, c;
+
+   s1 = b[1] * 5;
+   s2 = b[2] * 5;
+   s3 = b[3] * 5;
+   s4 = b[4] * 5;
+
+   d0 = ((ulong64)a[0] * b[0]) + ((ulong64)a[1] * s4) + ((ulong64)a[2] * s3) + ((ulong64)a[3] * s2) + ((ulong64)a[4] * s1);
+   d1 = ((ulong64)a[0] * b[1]) + ((ulong64)a[1] * b[0]) + ((ulong64)a[2] * s4) + ((ulong64)a[3] * s3) + ((ulong64)a[4] * s2);
+   d2 = ((ulong64)a[0] * b[2]) + ((ulong64)a[1] * b[1]) + ((ulong64)a[2] * b[0]) + ((ulong64)a[3] * s4) + ((ulong64)a[4] * s3);
+   d3 = ((ulong64)a[0] * b[3]) + ((ulong64)a[1] * b[2]) + ((ulong64)a[2] * b[1]) + ((ulong64)a[3] * b[0]) + ((ulong64)a[4] * s4);
+   d4 = ((ulong64)a[0] * b[4]) + ((ulong64)a[1] * b[3]) + ((ulong64)a[2] * b[2]) + ((ulong64)a[3] * b[1]) + ((ulong64)a[4] * b[0]);
+
+                 c = (ulong32)(d0 >> 26); o[0] = (ulong32)d0 & 0x3ffffff;
+   d1 += c;      c = (ulong32)(d1 >> 26); o[1] = (ulong32)d1 & 0x3ffffff;
+   d2 += c;      c = (ulong32)(d2 >> 26); o[2] = (ulong32)d2 & 0x3ffffff;
+   d3 += c;      c = (ulong32)(d3 >> 26); o[3] = (ulong32)d3 & 0x3ffffff;
+   d4 += c;      c = (ulong32)(d4 >> 26); o[4] = (ulong32)d4 & 0x3ffffff;
+   o[0] += c * 5; c = o[0] >> 26;         o[0] = o[0] & 0x3ffffff;
+   o[1] += c;
+}
+
+/* d = a * b mod p, per lane, b[] and s[] = 5 * b[] are the limbs of the multiplier */
+#define POLY1305_AVX2_MUL(d, a, b, s)                                                              \
+   d[0] = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(a[0], b[0]),           \
+                                                             _mm256_mul_epu32(a[1], s[4])),          \
+                                            _mm256_add_epi64(_mm256_mul_epu32(a[2], s[3]),           \
+                                                             _mm256_mul_epu32(a[3], s[2]))),         \
+                           _mm256_mul_epu32(a[4], s[1]));                                            \
+   d[1] = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(a[0], b[1]),           \
+                                                             _mm256_mul_epu32(a[1], b[0])),          \
+                                            _mm256_add_epi64(_mm256_mul_epu32(a[2], s[4]),           \
+                                                             _mm256_mul_epu32(a[3], s[3]))),         \
+                           _mm256_mul_epu32(a[4], s[2]));                                            \
+   d[2] = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(a[0], b[2]),           \
+                                                             _mm256_mul_epu32(a[1], b[1])),          \
+                                            _mm256_add_epi64(_mm256_mul_epu32(a[2], b[0]),           \
+                                                             _mm256_mul_epu32(a[3], s[4]))),         \
+                           _mm256_mul_epu32(a[4], s[3]));                                            \
+   d[3] = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(a[0], b[3]),           \
+                                                             _mm256_mul_epu32(a[1], b[2])),          \
+                                            _mm256_add_epi64(_mm256_mul_epu32(a[2], b[1]),           \
+                                                             _mm256_mul_epu32(a[3], b[0]))),         \
+                           _mm256_mul_epu32(a[4], s[4]));                                            \
+   d[4] = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(a[0], b[4]),           \
+                                                             _mm256_mul_epu32(a[1], b[3])),          \
+                                            _mm256_add_epi64(_mm256_mul_epu32(a[2], b[2]),           \
+                                                             _mm256_mul_epu32(a[3], b[1]))),         \
+                           _mm256_mul_epu32(a[4], b[0]));
+
+/* (partial) d %= p per lane, afterwards all limbs are below 2^26 except d[1] which is slightly above */
+LTC_ATTRIBUTE((__target__("avx2")))
+static LTC_INLINE void s_poly1305_avx2_carry(__m256i *d)
+{
+   const __m256i mask = _mm256_set1_epi64x(0x3ffffff);
+   __m256i c;
+
+   c = _mm256_srli_epi64(d[0], 26); d[0] = _mm256_and_si256(d[0], mask); d[1] = _mm256_add_epi64(d[1], c);
+   c = _mm256_srli_epi64(d[1], 26); d[1] = _mm256_and_si256(d[1], mask); d[2] = _mm256_add_epi64(d[2], c);
+   c = _mm256_srli_epi64(d[2], 26); d[2] = _mm256_and_si256(d[2], mask); d[3] = _mm256_add_epi64(d[3], c);
+   c = _mm256_srli_epi64(d[3], 26); d[3] = _mm256_and_si256(d[3], mask); d[4] = _mm256_add_epi64(d[4], c);
+   c = _mm256_srli_epi64(d[4], 26); d[4] = _mm256_and_si256(d[4], mask);
+   d[0] = _mm256_add_epi64(d[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+   c = _mm256_srli_epi64(d[0], 26); d[0] = _mm256_and_si256(d[0], mask); d[1] = _mm256_add_epi64(d[1], c);
+}
+
+/* split 4 blocks into 26 bit limbs, lane j holds block j */
+LTC_ATTRIBUTE((__target__("avx2")))
+static LTC_INLINE void s_poly1305_avx2_load(__m256i *m, const unsigned char *in)
+{
+   const __m256i mask = _mm256_set1_epi64x(0x3ffffff);
+   __m256i a, b, lo, hi;
+
+   a  = _mm256_loadu_si256((const __m256i*) in);
+   b  = _mm256_loadu_si256((const __m256i*) (in + 32));
+   /* the unpack works within the 128 bit lanes, i.e. returns the blocks in the order 0, 2, 1, 3 */
+   lo = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xd8);
+   hi = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xd8);
+
+   m[0] = _mm256_and_si256(lo, mask);
+   m[1] = _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask);
+   m[2] = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(lo, 52), _mm256_slli_epi64(hi, 12)), mask);
+   m[3] = _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask);
+   m[4] = _mm256_or_si256(_mm256_srli_epi64(hi, 40), _mm256_set1_epi64x(1 << 24));
+}
+
+/**
+  Process complete blocks, 64 bytes at a time
+  Must not be used for the final (padded) block.
+  @param st      The POLY1305 state
+  @param in      The data
+  @param inlen   The length of the data (octets)
+  @return The number of bytes processed, a multiple of 64
+*/
+LTC_ATTRIBUTE((__target__("avx2")))
+unsigned long poly1305_avx2_blocks(poly1305_state *st, const unsigned char *in, unsigned long inlen)
+{
+   ulong32 p[4][5], h[5], c;
+   ulong64 t[4];
+   __m256i a[5], d[5], m[5], r[5], s[5];
+   unsigned long n, i;
+   int x;
+
+   n = inlen & ~63uL;
+   if (n == 0) {
+      return 0;
+   }
+
+   /* p[i] = r^(i+1) */
+   for (x = 0; x < 5; x++) {
+      p[0][x] = st->r[x];
+   }
+   s_poly1305_mul(p[1], p[0], p[0]);
+   s_poly1305_mul(p[2], p[1], p[0]);
+   s_poly1305_mul(p[3], p[2], p[0]);
+
+   for (x = 0; x < 5; x++) {
+      r[x] = _mm256_set1_epi64x(p[3][x]);
+      s[x] = _mm256_set1_epi64x(p[3][x] * 5);
+   }
+
+   /* the first 4 blocks, lane 0 also gets h */
+   s_poly1305_avx2_load(a, in);
+   for (x = 0; x < 5; x++) {
+      a[x] = _mm256_add_epi64(a[x], _mm256_set_epi64x(0, 0, 0, st->h[x]));
+   }
+
+   /* A = A * r^4 + m */
+   for (i = 64; i < n; i += 64) {
+      POLY1305_AVX2_MUL(d, a, r, s)
+      s_poly1305_avx2_carry(d);
+      s_poly1305_avx2_load(m, in + i);
+      for (x = 0; x < 5; x++) {
+         a[x] = _mm256_add_epi64(d[x], m[x]);
+      }
+   }
+
+   /* A_j = A_j * r^(4-j) */
+   for (x = 0; x < 5; x++) {
+      r[x] = _mm256_set_epi64x(p[0][x], p[1][x], p[2][x], p[3][x]);
+      s[x] = _mm256_set_epi64x(p[0][x] * 5, p[1][x] * 5, p[2][x] * 5, p[3][x] * 5);
+   }
+   POLY1305_AVX2_MUL(d, a, r, s)
+   s_poly1305_avx2_carry(d);
+
+   /* h = sum of the lanes */
+   for (x = 0; x < 5; x++) {
+      _mm256_storeu_si256((__m256i*) t, d[x]);
+      h[x] = (ulong32)(t[0] + t[1] + t[2] + t[3]);
+   }
+                c = h[0] >> 26; h[0] &= 0x3ffffff;
+   h[1] +=     c; c = h[1] >> 26; h[1] &= 0x3ffffff;
+   h[2] +=     c; c = h[2] >> 26; h[2] &= 0x3ffffff;
+   h[3] +=     c; c = h[3] >> 26; h[3] &= 0x3ffffff;
+   h[4] +=     c; c = h[4] >> 26; h[4] &= 0x3ffffff;
+   h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3ffffff;
+   h[1] +=     c;
+   for (x = 0; x < 5; x++) {
+      st->h[x] = h[x];
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(p, sizeof(p));
+   zeromem(h, sizeof(h));
+   zeromem(t, sizeof(t));
+#endif
+   return n;
+}
+
+#endif
@@ -39,6 +39,74 @@ int poly1305_test(void)
    if ((err = poly1305_process(&st, (unsigned char*)m, mlen)) != CRYPT_OK)           return err;
    if ((err = poly1305_done(&st, out, &len)) != CRYPT_OK)                            return err;
    if (compare_testvector(out, len, tag, sizeof(tag), "POLY1305-TV2", 1) != 0)       return CRYPT_FAIL_TESTVECTOR;
+
+   /* https://tools.ietf.org/html/rfc7539#appendix-A.3 - test vectors #5 .. #9, corner cases of the reduction */
+   {
+      const struct {
+         unsigned char r0, s, m[48], tag0, tagrest;
+         unsigned long mlen;
+      } tv[] = {
+         { 2, 0x00, { 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff }, 0x03, 0x00, 16 },
+         { 2, 0xff, { 0x02 }, 0x03, 0x00, 16 },
+         { 1, 0x00, { 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+                      0xf0,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+                      0x11 }, 0x05, 0x00, 48 },
+         { 1, 0x00, { 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+                      0xfb,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,0xfe,
+                      0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01 }, 0x00, 0x00, 48 },
+         { 2, 0x00, { 0xfd,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff }, 0xfa, 0xff, 16 },
+      };
+      unsigned char key[32], exp[16];
+      int i;
+
+      for (i = 0; i < (int)(sizeof(tv)/sizeof(tv[0])); i++) {
+         XMEMSET(key, 0, 16);
+         XMEMSET(key + 16, tv[i].s, 16);
+         key[0] = tv[i].r0;
+         XMEMSET(exp, tv[i].tagrest, 16);
+         exp[0] = tv[i].tag0;
+         len = 16;
+         if ((err = poly1305_memory(key, 32, tv[i].m, tv[i].mlen, out, &len)) != CRYPT_OK) return err;
+         if (compare_testvector(out, len, exp, 16, "POLY1305-TV3", i) != 0)               return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+
+   /* long inputs (multi-block code), once with a pattern and once with all bits set in the key and the data */
+   {
+      const unsigned char tag4[] = { 0xf6, 0x13, 0x28, 0x6b, 0x1b, 0x98, 0xb5, 0xdc, 0x6a, 0x70, 0x5c, 0xd6, 0xbe, 0x00, 0x34, 0x18 };
+      const unsigned char tag5[] = { 0x25, 0xd4, 0x92, 0x6a, 0x53, 0xbb, 0x48, 0x0d, 0xa2, 0x28, 0xec, 0x61, 0xe0, 0xa3, 0x1a, 0x38 };
+      unsigned char key[32], buf[1024], tag2[16];
+      unsigned long i, j, l;
+
+      for (i = 0; i < 32; i++) key[i] = (unsigned char)(i * 13 + 1);
+      for (i = 0; i < 1000; i++) buf[i] = (unsigned char)(i * 7 + 3);
+      len = 16;
+      if ((err = poly1305_memory(key, 32, buf, 1000, out, &len)) != CRYPT_OK)         return err;
+      if (compare_testvector(out, len, tag4, sizeof(tag4), "POLY1305-TV4", 1) != 0)  return CRYPT_FAIL_TESTVECTOR;
+
+      /* 15 byte pieces never reach the multi-block code */
+      for (l = 7; l <= 1000; l += 111) {
+         len = 16;
+         if ((err = poly1305_init(&st, key, 32)) != CRYPT_OK)                         return err;
+         if ((err = poly1305_process(&st, buf, 7)) != CRYPT_OK)                       return err;
+         if ((err = poly1305_process(&st, buf + 7, l - 7)) != CRYPT_OK)               return err;
+         if ((err = poly1305_done(&st, out, &len)) != CRYPT_OK)                       return err;
+         if ((err = poly1305_init(&st, key, 32)) != CRYPT_OK)                         return err;
+         for (i = 0; i < l; i += j) {
+            j = MIN(15, l - i);
+            if ((err = poly1305_process(&st, buf + i, j)) != CRYPT_OK)                return err;
+         }
+         len = 16;
+         if ((err = poly1305_done(&st, tag2, &len)) != CRYPT_OK)                      return err;
+         if (compare_testvector(out, len, tag2, 16, "POLY1305-TV4", (int)l) != 0)     return CRYPT_FAIL_TESTVECTOR;
+      }
+
+      XMEMSET(key, 0xff, sizeof(key));
+      XMEMSET(buf, 0xff, sizeof(buf));
+      len = 16;
+      if ((err = poly1305_memory(key, 32, buf, sizeof(buf), out, &len)) != CRYPT_OK) return err;
+      if (compare_testvector(out, len, tag5, sizeof(tag5), "POLY1305-TV5", 1) != 0)  return CRYPT_FAIL_TESTVECTOR;
+   }
    return CRYPT_OK;
 #endif
 }
@@ -9,6 +9,13 @@
 
 #ifdef LTC_XCBC
 
+#ifndef LTC_NO_FILE
+static int s_xcbc_file_process(void *ctx, const unsigned char *in, unsigned long inlen)
+{
+   return xcbc_process(ctx, in, inlen);
+}
+#endif
+
 /**
    XCBC a file
    @param cipher   The index of the cipher desired
@@ -33,21 +40,15 @@ int xcbc_file(int cipher,
    LTC_UNUSED_PARAM(outlen);
    return CRYPT_NOP;
 #else
-   size_t x;
    int err;
    xcbc_state xcbc;
    FILE *in;
-   unsigned char *buf;
 
    LTC_ARGCHK(key      != NULL);
    LTC_ARGCHK(filename != NULL);
    LTC_ARGCHK(out      != NULL);
    LTC_ARGCHK(outlen   != NULL);
 
-   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
-      return CRYPT_MEM;
-   }
-
    if ((err = xcbc_init(&xcbc, cipher, key, keylen)) != CRYPT_OK) {
       goto LBL_ERR;
    }
@@ -58,28 +59,22 @@ int xcbc_file(int cipher,
       goto LBL_ERR;
    }
 
-   do {
-      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
-      if ((err = xcbc_process(&xcbc, buf, (unsigned long)x)) != CRYPT_OK) {
-         fclose(in);
-         goto LBL_CLEANBUF;
-      }
-   } while (x == LTC_FILE_READ_BUFSIZE);
+   if ((err = file_process(in, s_xcbc_file_process, &xcbc)) != CRYPT_OK) {
+      fclose(in);
+      goto LBL_ERR;
+   }
 
    if (fclose(in) != 0) {
       err = CRYPT_ERROR;
-      goto LBL_CLEANBUF;
+      goto LBL_ERR;
    }
 
    err = xcbc_done(&xcbc, out, outlen);
 
-LBL_CLEANBUF:
-   zeromem(buf, LTC_FILE_READ_BUFSIZE);
 LBL_ERR:
 #ifdef LTC_CLEAN_STACK
    zeromem(&xcbc, sizeof(xcbc_state));
 #endif
-   XFREE(buf);
    return err;
 #endif
 }
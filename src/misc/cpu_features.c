@@ -0,0 +1,105 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+/**
+  @file cpu_features.c
+  Run-time detection of the x86 instruction set extensions used by
+  the SIMD implementations
+*/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+static LTC_INLINE void s_cpuid(ulong32 leaf, ulong32 subleaf, ulong32 *regs)
+{
+   ulong32 a, b, c, d;
+
+   __asm__ volatile ("cpuid"
+        :"=a"(a), "=b"(b), "=c"(c), "=d"(d)
+        :"a"(leaf), "c"(subleaf)
+       );
+   regs[0] = a;
+   regs[1] = b;
+   regs[2] = c;
+   regs[3] = d;
+}
+
+static LTC_INLINE ulong32 s_xgetbv(void)
+{
+   ulong32 a, d;
+
+   __asm__ volatile ("xgetbv"
+        :"=a"(a), "=d"(d)
+        :"c"(0)
+       );
+   return a;
+}
+
+static ulong32 s_cpu_features(void)
+{
+   ulong32 regs[4], max_leaf, xcr0 = 0, features = 0;
+
+   s_cpuid(0, 0, regs);
+   max_leaf = regs[0];
+   if (max_leaf < 1) {
+      return 0;
+   }
+
+   s_cpuid(1, 0, regs);
+   if ((regs[3] >> 26) & 1) features |= LTC_CPU_SSE2;
+   if ((regs[2] >>  1) & 1) features |= LTC_CPU_PCLMUL;
+   if ((regs[2] >>  9) & 1) features |= LTC_CPU_SSSE3;
+   if ((regs[2] >> 19) & 1) features |= LTC_CPU_SSE41;
+   if ((regs[2] >> 25) & 1) features |= LTC_CPU_AES;
+   /* the AVX state has to be enabled by the OS, c.f. OSXSAVE and XCR0 */
+   if ((regs[2] >> 27) & 1) {
+      xcr0 = s_xgetbv();
+   }
+   if (((regs[2] >> 28) & 1) && (xcr0 & 0x06) == 0x06) {
+      features |= LTC_CPU_AVX;
+   }
+
+   if (max_leaf < 7) {
+      return features;
+   }
+
+   s_cpuid(7, 0, regs);
+   if ((regs[1] >> 29) & 1) features |= LTC_CPU_SHA;
+   if ((regs[1] >>  8) & 1) features |= LTC_CPU_BMI2;
+   if (features & LTC_CPU_AVX) {
+      if ((regs[1] >>  5) & 1) features |= LTC_CPU_AVX2;
+      if ((regs[2] >>  9) & 1) features |= LTC_CPU_VAES;
+      if ((regs[2] >> 10) & 1) features |= LTC_CPU_VPCLMUL;
+      /* the opmask and the upper halves of the ZMM registers */
+      if ((xcr0 & 0xe0) == 0xe0) {
+         if ((regs[1] >> 16) & 1) features |= LTC_CPU_AVX512F;
+         if ((regs[1] >> 30) & 1) features |= LTC_CPU_AVX512BW;
+         if ((regs[1] >> 31) & 1) features |= LTC_CPU_AVX512VL;
+      }
+   }
+
+   return features;
+}
+#else
+static ulong32 s_cpu_features(void)
+{
+   return 0;
+}
+#endif
+
+/**
+  Get the instruction set extensions supported by the CPU (and the OS)
+  The detection is only done on the first call.
+  @return A combination of the LTC_CPU_* flags
+*/
+ulong32 ltc_cpu_features(void)
+{
+   static int initialized = 0;
+   static ulong32 features = 0;
+
+   if (initialized == 0) {
+      features = s_cpu_features();
+      initialized = 1;
+   }
+
+   return features;
+}
@@ -132,7 +132,14 @@ const char *crypt_build_settings =
 #endif
    "Stream ciphers built-in:\n"
 #if defined(LTC_CHACHA)
-   "   ChaCha\n"
+   "   ChaCha"
+#if defined(LTC_CHACHA_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
+#endif
+#if defined(LTC_XCHACHA20)
+   "   XChaCha20\n"
 #endif
 #if defined(LTC_SALSA20)
    "   Salsa20\n"
@@ -155,34 +162,84 @@ const char *crypt_build_settings =
 
     "\nHashes built-in:\n"
 #if defined(LTC_SHA3)
-   "   SHA3\n"
+   "   SHA3"
+#if defined(LTC_SHA3_X4)
+   " (x4) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_KECCAK)
    "   KECCAK\n"
 #endif
 #if defined(LTC_SHA512)
-   "   SHA-512\n"
+   "   SHA-512"
+#if defined(LTC_SHA2_MULTIBUF)
+   " (multi-buffer) "
+#endif
+#if defined(LTC_SHA512_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_SHA384)
-   "   SHA-384\n"
+   "   SHA-384"
+#if defined(LTC_SHA2_MULTIBUF)
+   " (multi-buffer) "
+#endif
+#if defined(LTC_SHA512_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_SHA512_256)
-   "   SHA-512/256\n"
+   "   SHA-512/256"
+#if defined(LTC_SHA2_MULTIBUF)
+   " (multi-buffer) "
+#endif
+#if defined(LTC_SHA512_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_SHA256)
-   "   SHA-256\n"
+   "   SHA-256"
+#if defined(LTC_SHA_NI)
+   " (SHA-NI) "
+#endif
+#if defined(LTC_SHA2_MULTIBUF)
+   " (multi-buffer) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_SHA512_224)
-   "   SHA-512/224\n"
+   "   SHA-512/224"
+#if defined(LTC_SHA2_MULTIBUF)
+   " (multi-buffer) "
+#endif
+#if defined(LTC_SHA512_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_SHA224)
-   "   SHA-224\n"
+   "   SHA-224"
+#if defined(LTC_SHA_NI)
+   " (SHA-NI) "
+#endif
+#if defined(LTC_SHA2_MULTIBUF)
+   " (multi-buffer) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_TIGER)
    "   TIGER\n"
 #endif
 #if defined(LTC_SHA1)
-   "   SHA1\n"
+   "   SHA1"
+#if defined(LTC_SHA_NI)
+   " (SHA-NI) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_MD5)
    "   MD5\n"
@@ -209,10 +266,42 @@ const char *crypt_build_settings =
    "   WHIRLPOOL\n"
 #endif
 #if defined(LTC_BLAKE2S)
-   "   BLAKE2S\n"
+   "   BLAKE2S"
+#if defined(LTC_BLAKE2_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_BLAKE2B)
-   "   BLAKE2B\n"
+   "   BLAKE2B"
+#if defined(LTC_BLAKE2_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
+#endif
+#if defined(LTC_BLAKE2SP)
+   "   BLAKE2SP"
+#if defined(LTC_BLAKE2_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
+#endif
+#if defined(LTC_BLAKE2BP)
+   "   BLAKE2BP"
+#if defined(LTC_BLAKE2_SIMD)
+   " (SIMD) "
+#endif
+   "\n"
+#endif
+#if defined(LTC_BLAKE3)
+   "   BLAKE3"
+#if defined(LTC_BLAKE3_SIMD)
+   " (SIMD) "
+#endif
+#if defined(LTC_BLAKE3_MT)
+   " (threads) "
+#endif
+   "\n"
 #endif
 #if defined(LTC_CHC_HASH)
    "   CHC_HASH\n"
@@ -268,7 +357,11 @@ const char *crypt_build_settings =
     "   F9\n"
 #endif
 #if defined(LTC_POLY1305)
-    "   POLY1305\n"
+    "   POLY1305"
+#if defined(LTC_POLY1305_AVX2)
+    " (AVX2) "
+#endif
+    "\n"
 #endif
 #if defined(LTC_BLAKE2SMAC)
     "   BLAKE2S MAC\n"
@@ -276,6 +369,12 @@ const char *crypt_build_settings =
 #if defined(LTC_BLAKE2BMAC)
     "   BLAKE2B MAC\n"
 #endif
+#if defined(LTC_BLAKE2SPMAC)
+    "   BLAKE2SP MAC\n"
+#endif
+#if defined(LTC_BLAKE2BPMAC)
+    "   BLAKE2BP MAC\n"
+#endif
 
     "\nENC + AUTH modes:\n"
 #if defined(LTC_EAX_MODE)
@@ -297,9 +396,18 @@ const char *crypt_build_settings =
 #endif
 #if defined(LTC_GCM_TABLES_SSE2)
     " (SSE2) "
+#endif
+#if defined(LTC_GCM_TABLES_4BIT)
+    " (4bit tables) "
+#endif
+#if defined(LTC_GCM_PCLMUL)
+    " (PCLMUL) "
 #endif
    "\n"
 #endif
+#if defined(LTC_GCM_SIV_MODE)
+    "   GCM-SIV\n"
+#endif
 #if defined(LTC_CHACHA20POLY1305_MODE)
     "   CHACHA20POLY1305\n"
 #endif
@@ -430,6 +538,12 @@ const char *crypt_build_settings =
 #if defined(LTC_AES_NI)
     " AES-NI "
 #endif
+#if defined(LTC_AES_VAES)
+    " AES-VAES "
+#endif
+#if defined(LTC_AES_BITSLICE)
+    " AES-BITSLICE "
+#endif
 #if defined(LTC_BASE64)
     " BASE64 "
 #endif
@@ -525,6 +639,9 @@ const char *crypt_build_settings =
 #if defined(LTC_FILE_READ_BUFSIZE)
     " " NAME_VALUE(LTC_FILE_READ_BUFSIZE) " "
 #endif
+#if defined(LTC_FILE_MMAP)
+    " LTC_FILE_MMAP "
+#endif
 #if defined(LTC_FAST)
     " LTC_FAST "
 #endif
@@ -554,6 +671,9 @@ const char *crypt_build_settings =
 #if defined(LTC_PTHREAD)
     " LTC_PTHREAD "
 #endif
+#if defined(LTC_BLAKE3_MT_THREADS)
+    " " NAME_VALUE(LTC_BLAKE3_MT_THREADS) " "
+#endif
 #if defined(LTC_EASY)
     " LTC_EASY "
 #endif
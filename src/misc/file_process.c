@@ -0,0 +1,255 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+#include "tomcrypt_private.h"
+
+#ifndef LTC_NO_FILE
+/**
+  @file file_process.c
+  Feed the content of a file to a process function
+
+  With LTC_FILE_MMAP regular files are mapped into memory window by window
+  and handed to the process function without copying them, the kernel is
+  asked to read ahead the next window while the current one is processed.
+  Files which can't be mapped, e.g. pipes, are read in a separate thread
+  into two alternating buffers if LTC_PTHREAD is enabled as well.
+*/
+
+#ifdef LTC_FILE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* the size of the part of a file which is mapped at once */
+#define FILE_MMAP_WINDOW      (64UL * 1024 * 1024)
+/* the size of each of the two buffers of the reader thread */
+#define FILE_READER_BUFSIZE   MAX(256UL * 1024, LTC_FILE_READ_BUFSIZE)
+
+/* a hint for the kernel how a part of the file will be read, it's only
+ * a hint so systems without posix_fadvise() simply don't get it */
+static void s_file_advise(int fd, off_t off, off_t len, int willneed)
+{
+#if defined(POSIX_FADV_SEQUENTIAL)
+   (void)posix_fadvise(fd, off, len, willneed ? POSIX_FADV_WILLNEED : POSIX_FADV_SEQUENTIAL);
+#elif defined(F_RDADVISE)
+   /* macOS has no posix_fadvise(), but can be asked to read ahead */
+   struct radvisory ra;
+   if (willneed && len <= INT_MAX) {
+      ra.ra_offset = off;
+      ra.ra_count = (int)len;
+      (void)fcntl(fd, F_RDADVISE, &ra);
+   }
+#else
+   LTC_UNUSED_PARAM(fd);
+   LTC_UNUSED_PARAM(off);
+   LTC_UNUSED_PARAM(len);
+   LTC_UNUSED_PARAM(willneed);
+#endif
+}
+#endif
+
+static int s_file_process_read(FILE *in, file_process_cb cb, void *ctx)
+{
+   unsigned char *buf;
+   size_t x;
+   int err;
+
+   if ((buf = XMALLOC(LTC_FILE_READ_BUFSIZE)) == NULL) {
+      return CRYPT_MEM;
+   }
+   do {
+      x = fread(buf, 1, LTC_FILE_READ_BUFSIZE, in);
+      if ((err = cb(ctx, buf, (unsigned long)x)) != CRYPT_OK) {
+         break;
+      }
+   } while (x == LTC_FILE_READ_BUFSIZE);
+
+   zeromem(buf, LTC_FILE_READ_BUFSIZE);
+   XFREE(buf);
+   return err;
+}
+
+#ifdef LTC_FILE_MMAP
+/* process the rest of a regular file from its mapping and leave the
+ * stream behind the processed part, CRYPT_NOP if nothing could be mapped.
+ * A file which is already at its end is left to the caller's read loop. */
+static int s_file_process_mmap(FILE *in, file_process_cb cb, void *ctx)
+{
+   struct stat st;
+   off_t pos, off, end;
+   size_t len, skip;
+   long page;
+   unsigned char *p;
+   int fd, err = CRYPT_OK;
+
+   if ((fd = fileno(in)) < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      return CRYPT_NOP;
+   }
+   if ((pos = ftello(in)) < 0 || (page = sysconf(_SC_PAGESIZE)) <= 0) {
+      return CRYPT_NOP;
+   }
+   if (pos >= st.st_size) {
+      return CRYPT_OK;
+   }
+   end = st.st_size;
+   /* mappings have to start at a page boundary */
+   off = pos - pos % page;
+   skip = (size_t)(pos - off);
+   s_file_advise(fd, pos, end - pos, 0);
+
+   while (off < end) {
+      len = (size_t)MIN((off_t)FILE_MMAP_WINDOW, end - off);
+      p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, off);
+      if (p == MAP_FAILED) {
+         /* the caller reads the rest */
+         if (off + (off_t)skip == pos) {
+            return CRYPT_NOP;
+         }
+         break;
+      }
+      (void)posix_madvise(p, len, POSIX_MADV_SEQUENTIAL);
+      if (off + (off_t)len < end) {
+         s_file_advise(fd, off + (off_t)len, MIN((off_t)FILE_MMAP_WINDOW, end - off - (off_t)len), 1);
+      }
+      err = cb(ctx, p + skip, (unsigned long)(len - skip));
+      munmap(p, len);
+      if (err != CRYPT_OK) {
+         return err;
+      }
+      off += len;
+      skip = 0;
+   }
+   if (fseeko(in, off + skip, SEEK_SET) != 0) {
+      return CRYPT_ERROR;
+   }
+   return CRYPT_OK;
+}
+
+#ifdef LTC_PTHREAD
+struct s_file_reader {
+   FILE *in;
+   unsigned char *buf[2];
+   size_t len[2];
+   int full[2];
+   int stop;
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+};
+
+static void* s_file_reader_thread(void *arg)
+{
+   struct s_file_reader *r = arg;
+   size_t x;
+   int i = 0, stop;
+
+   do {
+      pthread_mutex_lock(&r->lock);
+      while (r->full[i] && !r->stop) {
+         pthread_cond_wait(&r->cond, &r->lock);
+      }
+      stop = r->stop;
+      pthread_mutex_unlock(&r->lock);
+      if (stop) {
+         break;
+      }
+      x = fread(r->buf[i], 1, FILE_READER_BUFSIZE, r->in);
+      pthread_mutex_lock(&r->lock);
+      r->len[i] = x;
+      r->full[i] = 1;
+      pthread_cond_signal(&r->cond);
+      pthread_mutex_unlock(&r->lock);
+      i ^= 1;
+   } while (x == FILE_READER_BUFSIZE);
+   return NULL;
+}
+
+/* read the file in a separate thread while the previous buffer is processed,
+ * CRYPT_NOP if the thread couldn't be started */
+static int s_file_process_thread(FILE *in, file_process_cb cb, void *ctx)
+{
+   struct s_file_reader r;
+   pthread_t thread;
+   size_t x;
+   int i = 0, err = CRYPT_NOP;
+
+   XMEMSET(&r, 0, sizeof(r));
+   r.in = in;
+   if ((r.buf[0] = XMALLOC(2 * FILE_READER_BUFSIZE)) == NULL) {
+      return CRYPT_MEM;
+   }
+   r.buf[1] = r.buf[0] + FILE_READER_BUFSIZE;
+   if (pthread_mutex_init(&r.lock, NULL) != 0) {
+      goto LBL_FREE;
+   }
+   if (pthread_cond_init(&r.cond, NULL) != 0) {
+      goto LBL_MUTEX;
+   }
+   if (pthread_create(&thread, NULL, s_file_reader_thread, &r) != 0) {
+      goto LBL_COND;
+   }
+
+   do {
+      pthread_mutex_lock(&r.lock);
+      while (!r.full[i]) {
+         pthread_cond_wait(&r.cond, &r.lock);
+      }
+      x = r.len[i];
+      pthread_mutex_unlock(&r.lock);
+      err = cb(ctx, r.buf[i], (unsigned long)x);
+      pthread_mutex_lock(&r.lock);
+      r.full[i] = 0;
+      if (err != CRYPT_OK) {
+         r.stop = 1;
+      }
+      pthread_cond_signal(&r.cond);
+      pthread_mutex_unlock(&r.lock);
+      i ^= 1;
+   } while (err == CRYPT_OK && x == FILE_READER_BUFSIZE);
+   pthread_join(thread, NULL);
+
+LBL_COND:
+   pthread_cond_destroy(&r.cond);
+LBL_MUTEX:
+   pthread_mutex_destroy(&r.lock);
+LBL_FREE:
+   zeromem(r.buf[0], 2 * FILE_READER_BUFSIZE);
+   XFREE(r.buf[0]);
+   return err;
+}
+#endif /* LTC_PTHREAD */
+#endif /* LTC_FILE_MMAP */
+
+/**
+  Process the content of a file, from the current position to its end
+  @param in     The FILE* handle of the file
+  @param cb     The function which processes the content, it may be called several times
+  @param ctx    The context passed to cb
+  @return CRYPT_OK if successful, else the first error returned by cb
+*/
+int file_process(FILE *in, file_process_cb cb, void *ctx)
+{
+#ifdef LTC_FILE_MMAP
+   int err;
+#endif
+
+   LTC_ARGCHK(in != NULL);
+   LTC_ARGCHK(cb != NULL);
+
+#ifdef LTC_FILE_MMAP
+   if ((err = s_file_process_mmap(in, cb, ctx)) != CRYPT_NOP) {
+      if (err != CRYPT_OK) {
+         return err;
+      }
+      /* anything which was appended in the meantime */
+      return s_file_process_read(in, cb, ctx);
+   }
+#ifdef LTC_PTHREAD
+   if ((err = s_file_process_thread(in, cb, ctx)) != CRYPT_NOP) {
+      return err;
+   }
+#endif
+#endif
+   return s_file_process_read(in, cb, ctx);
+}
+
+#endif /* LTC_NO_FILE */
@@ -79,7 +79,7 @@ static int s_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned lo
 */
 int ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long len, symmetric_CTR *ctr)
 {
-   int err, fr;
+   int err, fr, width;
 
    LTC_ARGCHK(pt != NULL);
    LTC_ARGCHK(ct != NULL);
@@ -114,7 +114,12 @@ int ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long len, s
      }
 
      if (len >= (unsigned long)ctr->blocklen) {
-       if ((err = cipher_descriptor[ctr->cipher].accel_ctr_encrypt(pt, ct, len/ctr->blocklen, ctr->ctr, ctr->mode, &ctr->key)) != CRYPT_OK) {
+       /* pass the width of the counter, 0 means the full block */
+       width = (ctr->mode == CTR_COUNTER_LITTLE_ENDIAN) ? ctr->ctrlen : ctr->blocklen - ctr->ctrlen;
+       if (width == ctr->blocklen) {
+          width = 0;
+       }
+       if ((err = cipher_descriptor[ctr->cipher].accel_ctr_encrypt(pt, ct, len/ctr->blocklen, ctr->ctr, ctr->mode | width, &ctr->key)) != CRYPT_OK) {
           return err;
        }
        pt += (len / ctr->blocklen) * ctr->blocklen;
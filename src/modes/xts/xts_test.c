@@ -197,6 +197,12 @@ int xts_test(void)
    symmetric_xts xts;
    int i, j, k, err, idx;
    unsigned long len;
+   int (*orig_enc)(const unsigned char *, unsigned char *,
+                   unsigned long , unsigned char *,
+                   const symmetric_key *, const symmetric_key *);
+   int (*orig_dec)(const unsigned char *, unsigned char *,
+                   unsigned long , unsigned char *,
+                   const symmetric_key *, const symmetric_key *);
 
    /* AES can be under rijndael or aes... try to find it */
    if ((idx = find_cipher("aes")) == -1) {
@@ -204,13 +210,22 @@ int xts_test(void)
          return CRYPT_NOP;
       }
    }
-   for (k = 0; k < 4; ++k) {
+   orig_enc = cipher_descriptor[idx].accel_xts_encrypt;
+   orig_dec = cipher_descriptor[idx].accel_xts_decrypt;
+   /* k == 4 runs the test vectors against the accelerators of the cipher, if any */
+   for (k = 0; k < 5; ++k) {
       cipher_descriptor[idx].accel_xts_encrypt = NULL;
       cipher_descriptor[idx].accel_xts_decrypt = NULL;
-      if (k & 0x1) {
+      if (k == 4) {
+         if (orig_enc == NULL && orig_dec == NULL) {
+            break;
+         }
+         cipher_descriptor[idx].accel_xts_encrypt = orig_enc;
+         cipher_descriptor[idx].accel_xts_decrypt = orig_dec;
+      } else if (k & 0x1) {
          cipher_descriptor[idx].accel_xts_encrypt = s_xts_test_accel_xts_encrypt;
       }
-      if (k & 0x2) {
+      if ((k < 4) && (k & 0x2)) {
          cipher_descriptor[idx].accel_xts_decrypt = s_xts_test_accel_xts_decrypt;
       }
       for (j = 0; j < 2; j++) {
@@ -222,14 +237,14 @@ int xts_test(void)
             if ((j == 1) && ((tests[i].PTLEN < 32) || (tests[i].PTLEN % 32))) {
                continue;
             }
-            if ((k > 0) && (j == 1)) {
+            if ((k > 0) && (k < 4) && (j == 1)) {
                continue;
             }
             len = tests[i].PTLEN / 2;
 
             err = xts_start(idx, tests[i].key1, tests[i].key2, tests[i].keylen / 2, 0, &xts);
             if (err != CRYPT_OK) {
-               return err;
+               goto LBL_RESTORE;
             }
 
             seq = tests[i].seqnum;
@@ -240,56 +255,103 @@ int xts_test(void)
             if (j == 0) {
                err = xts_encrypt(tests[i].PTX, tests[i].PTLEN, OUT, T, &xts);
                if (err != CRYPT_OK) {
-                  xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             } else {
                err = xts_encrypt(tests[i].PTX, len, OUT, T, &xts);
                if (err != CRYPT_OK) {
-                  xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
                err = xts_encrypt(&tests[i].PTX[len], len, &OUT[len], T, &xts);
                if (err != CRYPT_OK) {
-                  xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             }
 
             if (compare_testvector(OUT, tests[i].PTLEN, tests[i].CTX, tests[i].PTLEN, "XTS encrypt", i)) {
-               xts_done(&xts);
-               return CRYPT_FAIL_TESTVECTOR;
+               err = CRYPT_FAIL_TESTVECTOR;
+               goto LBL_ERR;
             }
 
             XMEMCPY(T, Torg, sizeof(T));
             if (j == 0) {
                err = xts_decrypt(tests[i].CTX, tests[i].PTLEN, OUT, T, &xts);
                if (err != CRYPT_OK) {
-                  xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             } else {
                err = xts_decrypt(tests[i].CTX, len, OUT, T, &xts);
                if (err != CRYPT_OK) {
-                  xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
                err = xts_decrypt(&tests[i].CTX[len], len, &OUT[len], T, &xts);
                if (err != CRYPT_OK) {
-                  xts_done(&xts);
-                  return err;
+                  goto LBL_ERR;
                }
             }
 
             if (compare_testvector(OUT, tests[i].PTLEN, tests[i].PTX, tests[i].PTLEN, "XTS decrypt", i)) {
-               xts_done(&xts);
-               return CRYPT_FAIL_TESTVECTOR;
+               err = CRYPT_FAIL_TESTVECTOR;
+               goto LBL_ERR;
             }
             xts_done(&xts);
          }
       }
    }
-   return CRYPT_OK;
+
+   /* compare the accelerators against the generic implementation,
+    * multi-block and with ciphertext stealing */
+   if (orig_enc != NULL && orig_dec != NULL) {
+      static const unsigned long lens[] = { 16 * 8, 16 * 9 + 5, 16 * 17 + 15, 16 * 32, 16 * 40 + 1 };
+      unsigned char pt[16 * 41], ct[2][16 * 41], tw[2][16];
+
+      for (i = 0; i < (int)sizeof(pt); i++) {
+         pt[i] = (unsigned char)(i * 7 + 3);
+      }
+      err = xts_start(idx, tests[0].key1, tests[0].key2, tests[0].keylen / 2, 0, &xts);
+      if (err != CRYPT_OK) {
+         goto LBL_RESTORE;
+      }
+      for (i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++) {
+         for (k = 0; k < 2; k++) {
+            cipher_descriptor[idx].accel_xts_encrypt = k == 0 ? orig_enc : NULL;
+            XMEMCPY(tw[k], Torg, sizeof(tw[k]));
+            if ((err = xts_encrypt(pt, lens[i], ct[k], tw[k], &xts)) != CRYPT_OK) {
+               goto LBL_ERR;
+            }
+         }
+         if (compare_testvector(ct[0], lens[i], ct[1], lens[i], "XTS accel encrypt", i) ||
+             compare_testvector(tw[0], 16, tw[1], 16, "XTS accel encrypt tweak", i)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_ERR;
+         }
+         for (k = 0; k < 2; k++) {
+            cipher_descriptor[idx].accel_xts_decrypt = k == 0 ? orig_dec : NULL;
+            XMEMCPY(tw[k], Torg, sizeof(tw[k]));
+            if ((err = xts_decrypt(ct[0], lens[i], ct[1], tw[k], &xts)) != CRYPT_OK) {
+               goto LBL_ERR;
+            }
+            if (compare_testvector(ct[1], lens[i], pt, lens[i], "XTS accel decrypt", i)) {
+               err = CRYPT_FAIL_TESTVECTOR;
+               goto LBL_ERR;
+            }
+         }
+         if (compare_testvector(tw[0], 16, tw[1], 16, "XTS accel decrypt tweak", i)) {
+            err = CRYPT_FAIL_TESTVECTOR;
+            goto LBL_ERR;
+         }
+      }
+      xts_done(&xts);
+   }
+   err = CRYPT_OK;
+   goto LBL_RESTORE;
+
+LBL_ERR:
+   xts_done(&xts);
+LBL_RESTORE:
+   cipher_descriptor[idx].accel_xts_encrypt = orig_enc;
+   cipher_descriptor[idx].accel_xts_decrypt = orig_dec;
+   return err;
 #endif
 }
 
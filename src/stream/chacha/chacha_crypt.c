@@ -65,6 +65,18 @@ int chacha_crypt(chacha_state *st, const unsigned char *in, unsigned long inlen,
       out += j;
       in  += j;
    }
+#if defined(LTC_CHACHA_SIMD)
+   if (inlen >= 256 && chacha_simd_is_supported()) {
+     /* the SIMD code doesn't carry or check the counter, stop before its low word wraps */
+     j = MIN(inlen / 64, 0xFFFFFFFFUL - st->input[12]);
+     j = chacha_simd_crypt(st->input, st->rounds, in, out, j);
+     st->input[12] += (ulong32)j;
+     inlen -= 64 * j;
+     if (inlen == 0) return CRYPT_OK;
+     out += 64 * j;
+     in  += 64 * j;
+   }
+#endif
    for (;;) {
      s_chacha_block(buf, st->input, st->rounds);
      if (st->ivlen == 8) {
@@ -0,0 +1,310 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/**
+  @file chacha_simd.c
+  ChaCha keystream via SSSE3, AVX2 or AVX-512 on x86
+
+  The blocks are computed "column-vectorized": vector register i holds the
+  state word i of 4, 8 resp. 16 consecutive blocks, which only differ in the
+  block counter (or in the state words 12..15 given per block, e.g. of the
+  nonces of different packets).  After the rounds the registers are
+  transposed back to the byte order of the blocks.
+*/
+
+#include "tomcrypt_private.h"
+
+#if defined(LTC_CHACHA) && defined(LTC_CHACHA_SIMD)
+
+#define CHACHA_SSSE3_FEATURES  (LTC_CPU_SSE2 | LTC_CPU_SSSE3)
+#define CHACHA_AVX2_FEATURES   (LTC_CPU_AVX2)
+#define CHACHA_AVX512_FEATURES (LTC_CPU_AVX512F)
+
+/**
+  Check whether the CPU supports at least the SSSE3 kernel
+  @return 1 if supported, 0 otherwise
+*/
+int chacha_simd_is_supported(void)
+{
+   return (ltc_cpu_features() & CHACHA_SSSE3_FEATURES) == CHACHA_SSSE3_FEATURES;
+}
+
+#define CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, a, b, c, d) \
+   x[a] = ADD(x[a], x[b]); x[d] = ROL16(XOR(x[d], x[a])); \
+   x[c] = ADD(x[c], x[d]); x[b] = ROL12(XOR(x[b], x[c])); \
+   x[a] = ADD(x[a], x[b]); x[d] = ROL8(XOR(x[d], x[a]));  \
+   x[c] = ADD(x[c], x[d]); x[b] = ROL7(XOR(x[b], x[c]));
+
+#define CHACHA_DOUBLEROUND(ADD, XOR, ROL16, ROL12, ROL8, ROL7)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 0, 4,  8, 12)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 1, 5,  9, 13)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 2, 6, 10, 14)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 3, 7, 11, 15)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 0, 5, 10, 15)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 1, 6, 11, 12)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 2, 7,  8, 13)        \
+   CHACHA_QR(ADD, XOR, ROL16, ROL12, ROL8, ROL7, 3, 4,  9, 14)
+
+/* ---- SSSE3, 4 blocks ---- */
+
+#define SSE_ROL16(v) _mm_shuffle_epi8(v, rot16)
+#define SSE_ROL8(v)  _mm_shuffle_epi8(v, rot8)
+#define SSE_ROL12(v) _mm_or_si128(_mm_slli_epi32(v, 12), _mm_srli_epi32(v, 20))
+#define SSE_ROL7(v)  _mm_or_si128(_mm_slli_epi32(v, 7), _mm_srli_epi32(v, 25))
+
+LTC_ATTRIBUTE((__target__("ssse3")))
+static void s_chacha_ssse3(const ulong32 *input, const ulong32 *words, int rounds, const unsigned char *in, unsigned char *out)
+{
+   __m128i x[16], s[16], rot16, rot8, t0, t1, t2, t3;
+   int i, g;
+
+   rot16 = _mm_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+   rot8  = _mm_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+   for (i = 0; i < 16; i++) {
+      s[i] = _mm_set1_epi32((int)input[i]);
+   }
+   if (words == NULL) {
+      s[12] = _mm_add_epi32(s[12], _mm_set_epi32(3, 2, 1, 0));
+   } else {
+      for (i = 0; i < 4; i++) {
+         s[12+i] = _mm_set_epi32((int)words[12+i], (int)words[8+i], (int)words[4+i], (int)words[i]);
+      }
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = s[i];
+   }
+   for (i = rounds; i > 0; i -= 2) {
+      CHACHA_DOUBLEROUND(_mm_add_epi32, _mm_xor_si128, SSE_ROL16, SSE_ROL12, SSE_ROL8, SSE_ROL7)
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = _mm_add_epi32(x[i], s[i]);
+   }
+
+   /* words 4g..4g+3 of the 4 blocks */
+   for (g = 0; g < 4; g++) {
+      t0 = _mm_unpacklo_epi32(x[4*g+0], x[4*g+1]);
+      t1 = _mm_unpacklo_epi32(x[4*g+2], x[4*g+3]);
+      t2 = _mm_unpackhi_epi32(x[4*g+0], x[4*g+1]);
+      t3 = _mm_unpackhi_epi32(x[4*g+2], x[4*g+3]);
+      x[4*g+0] = _mm_unpacklo_epi64(t0, t1);
+      x[4*g+1] = _mm_unpackhi_epi64(t0, t1);
+      x[4*g+2] = _mm_unpacklo_epi64(t2, t3);
+      x[4*g+3] = _mm_unpackhi_epi64(t2, t3);
+   }
+   for (i = 0; i < 4; i++) {
+      for (g = 0; g < 4; g++) {
+         t0 = x[4*g+i];
+         if (in != NULL) {
+            t0 = _mm_xor_si128(t0, _mm_loadu_si128((const __m128i*) (in + 64 * i + 16 * g)));
+         }
+         _mm_storeu_si128((__m128i*) (out + 64 * i + 16 * g), t0);
+      }
+   }
+}
+
+/* ---- AVX2, 8 blocks ---- */
+
+#define AVX2_ROL16(v) _mm256_shuffle_epi8(v, rot16)
+#define AVX2_ROL8(v)  _mm256_shuffle_epi8(v, rot8)
+#define AVX2_ROL12(v) _mm256_or_si256(_mm256_slli_epi32(v, 12), _mm256_srli_epi32(v, 20))
+#define AVX2_ROL7(v)  _mm256_or_si256(_mm256_slli_epi32(v, 7), _mm256_srli_epi32(v, 25))
+
+LTC_ATTRIBUTE((__target__("avx2")))
+static void s_chacha_avx2(const ulong32 *input, const ulong32 *words, int rounds, const unsigned char *in, unsigned char *out)
+{
+   __m256i x[16], s[16], rot16, rot8, t0, t1, t2, t3;
+   int i, g;
+
+   rot16 = _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                           13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+   rot8  = _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+                           14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+   for (i = 0; i < 16; i++) {
+      s[i] = _mm256_set1_epi32((int)input[i]);
+   }
+   if (words == NULL) {
+      s[12] = _mm256_add_epi32(s[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+   } else {
+      for (i = 0; i < 4; i++) {
+         s[12+i] = _mm256_i32gather_epi32((const int*) (words + i), _mm256_set_epi32(28, 24, 20, 16, 12, 8, 4, 0), 4);
+      }
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = s[i];
+   }
+   for (i = rounds; i > 0; i -= 2) {
+      CHACHA_DOUBLEROUND(_mm256_add_epi32, _mm256_xor_si256, AVX2_ROL16, AVX2_ROL12, AVX2_ROL8, AVX2_ROL7)
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = _mm256_add_epi32(x[i], s[i]);
+   }
+
+   /* transpose within the 128 bit lanes: lane 0 holds block i, lane 1 block i+4 */
+   for (g = 0; g < 4; g++) {
+      t0 = _mm256_unpacklo_epi32(x[4*g+0], x[4*g+1]);
+      t1 = _mm256_unpacklo_epi32(x[4*g+2], x[4*g+3]);
+      t2 = _mm256_unpackhi_epi32(x[4*g+0], x[4*g+1]);
+      t3 = _mm256_unpackhi_epi32(x[4*g+2], x[4*g+3]);
+      x[4*g+0] = _mm256_unpacklo_epi64(t0, t1);
+      x[4*g+1] = _mm256_unpackhi_epi64(t0, t1);
+      x[4*g+2] = _mm256_unpacklo_epi64(t2, t3);
+      x[4*g+3] = _mm256_unpackhi_epi64(t2, t3);
+   }
+   /* combine the words 8h..8h+7 of a block from the groups 2h and 2h+1 */
+   for (i = 0; i < 4; i++) {
+      for (g = 0; g < 4; g += 2) {
+         t0 = _mm256_permute2x128_si256(x[4*g+i], x[4*g+4+i], 0x20);
+         t1 = _mm256_permute2x128_si256(x[4*g+i], x[4*g+4+i], 0x31);
+         if (in != NULL) {
+            t0 = _mm256_xor_si256(t0, _mm256_loadu_si256((const __m256i*) (in + 64 * i + 16 * g)));
+            t1 = _mm256_xor_si256(t1, _mm256_loadu_si256((const __m256i*) (in + 64 * (i + 4) + 16 * g)));
+         }
+         _mm256_storeu_si256((__m256i*) (out + 64 * i + 16 * g), t0);
+         _mm256_storeu_si256((__m256i*) (out + 64 * (i + 4) + 16 * g), t1);
+      }
+   }
+}
+
+/* ---- AVX-512, 16 blocks ---- */
+
+#define AVX512_ROL16(v) _mm512_rol_epi32(v, 16)
+#define AVX512_ROL12(v) _mm512_rol_epi32(v, 12)
+#define AVX512_ROL8(v)  _mm512_rol_epi32(v, 8)
+#define AVX512_ROL7(v)  _mm512_rol_epi32(v, 7)
+
+LTC_ATTRIBUTE((__target__("avx512f")))
+static void s_chacha_avx512(const ulong32 *input, const ulong32 *words, int rounds, const unsigned char *in, unsigned char *out)
+{
+   __m512i x[16], s[16], t0, t1, t2, t3;
+   int i, k;
+
+   for (i = 0; i < 16; i++) {
+      s[i] = _mm512_set1_epi32((int)input[i]);
+   }
+   if (words == NULL) {
+      s[12] = _mm512_add_epi32(s[12], _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+   } else {
+      for (i = 0; i < 4; i++) {
+         s[12+i] = _mm512_i32gather_epi32(_mm512_set_epi32(60, 56, 52, 48, 44, 40, 36, 32, 28, 24, 20, 16, 12, 8, 4, 0),
+                                          (const void*) (words + i), 4);
+      }
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = s[i];
+   }
+   for (i = rounds; i > 0; i -= 2) {
+      CHACHA_DOUBLEROUND(_mm512_add_epi32, _mm512_xor_si512, AVX512_ROL16, AVX512_ROL12, AVX512_ROL8, AVX512_ROL7)
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = _mm512_add_epi32(x[i], s[i]);
+   }
+
+   /* transpose within the 128 bit lanes: lane k holds block i+4k */
+   for (k = 0; k < 4; k++) {
+      t0 = _mm512_unpacklo_epi32(x[4*k+0], x[4*k+1]);
+      t1 = _mm512_unpacklo_epi32(x[4*k+2], x[4*k+3]);
+      t2 = _mm512_unpackhi_epi32(x[4*k+0], x[4*k+1]);
+      t3 = _mm512_unpackhi_epi32(x[4*k+2], x[4*k+3]);
+      x[4*k+0] = _mm512_unpacklo_epi64(t0, t1);
+      x[4*k+1] = _mm512_unpackhi_epi64(t0, t1);
+      x[4*k+2] = _mm512_unpacklo_epi64(t2, t3);
+      x[4*k+3] = _mm512_unpackhi_epi64(t2, t3);
+   }
+   /* transpose the 128 bit lanes of the four groups, so each register holds one block */
+   for (i = 0; i < 4; i++) {
+      t0 = _mm512_shuffle_i32x4(x[i], x[4+i], 0x44);
+      t1 = _mm512_shuffle_i32x4(x[8+i], x[12+i], 0x44);
+      t2 = _mm512_shuffle_i32x4(x[i], x[4+i], 0xee);
+      t3 = _mm512_shuffle_i32x4(x[8+i], x[12+i], 0xee);
+      x[i]    = _mm512_shuffle_i32x4(t0, t1, 0x88);
+      x[4+i]  = _mm512_shuffle_i32x4(t0, t1, 0xdd);
+      x[8+i]  = _mm512_shuffle_i32x4(t2, t3, 0x88);
+      x[12+i] = _mm512_shuffle_i32x4(t2, t3, 0xdd);
+   }
+   for (i = 0; i < 16; i++) {
+      t0 = x[i];
+      if (in != NULL) {
+         t0 = _mm512_xor_si512(t0, _mm512_loadu_si512((const void*) (in + 64 * i)));
+      }
+      _mm512_storeu_si512((void*) (out + 64 * i), t0);
+   }
+}
+
+/**
+  XOR the keystream of consecutive blocks into the data
+  The block counter in input[12] is incremented per block in 32 bit,
+  the caller has to make sure it doesn't wrap.
+  @param input   The ChaCha state words, input[12] is the counter of the first block
+  @param rounds  The number of rounds
+  @param in      The plaintext (or ciphertext)
+  @param out     [out] The ciphertext (or plaintext)
+  @param blocks  The number of 64 byte blocks available
+  @return The number of blocks processed, a multiple of 4
+*/
+unsigned long chacha_simd_crypt(const ulong32 *input, int rounds, const unsigned char *in, unsigned char *out, unsigned long blocks)
+{
+   ulong32 tmp[16], features;
+   unsigned long done = 0;
+
+   features = ltc_cpu_features();
+   XMEMCPY(tmp, input, sizeof(tmp));
+
+   if ((features & CHACHA_AVX512_FEATURES) == CHACHA_AVX512_FEATURES) {
+      for (; blocks - done >= 16; done += 16, tmp[12] += 16) {
+         s_chacha_avx512(tmp, NULL, rounds, in + 64 * done, out + 64 * done);
+      }
+   }
+   if ((features & CHACHA_AVX2_FEATURES) == CHACHA_AVX2_FEATURES) {
+      for (; blocks - done >= 8; done += 8, tmp[12] += 8) {
+         s_chacha_avx2(tmp, NULL, rounds, in + 64 * done, out + 64 * done);
+      }
+   }
+   if ((features & CHACHA_SSSE3_FEATURES) == CHACHA_SSSE3_FEATURES) {
+      for (; blocks - done >= 4; done += 4, tmp[12] += 4) {
+         s_chacha_ssse3(tmp, NULL, rounds, in + 64 * done, out + 64 * done);
+      }
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(tmp, sizeof(tmp));
+#endif
+   return done;
+}
+
+/**
+  Compute the raw keystream of blocks which have their own state words 12..15,
+  e.g. the blocks of packets with different nonces
+  @param input   The ChaCha state words, only input[0..11] are used
+  @param rounds  The number of rounds
+  @param words   The state words 12..15 of every block, 4 per block
+  @param out     [out] The keystream
+  @param blocks  The number of 64 byte blocks available
+  @return The number of blocks processed, a multiple of 4
+*/
+unsigned long chacha_simd_keystream_lanes(const ulong32 *input, int rounds, const ulong32 *words, unsigned char *out, unsigned long blocks)
+{
+   ulong32 features;
+   unsigned long done = 0;
+
+   features = ltc_cpu_features();
+
+   if ((features & CHACHA_AVX512_FEATURES) == CHACHA_AVX512_FEATURES) {
+      for (; blocks - done >= 16; done += 16) {
+         s_chacha_avx512(input, words + 4 * done, rounds, NULL, out + 64 * done);
+      }
+   }
+   if ((features & CHACHA_AVX2_FEATURES) == CHACHA_AVX2_FEATURES) {
+      for (; blocks - done >= 8; done += 8) {
+         s_chacha_avx2(input, words + 4 * done, rounds, NULL, out + 64 * done);
+      }
+   }
+   if ((features & CHACHA_SSSE3_FEATURES) == CHACHA_SSSE3_FEATURES) {
+      for (; blocks - done >= 4; done += 4) {
+         s_chacha_ssse3(input, words + 4 * done, rounds, NULL, out + 64 * done);
+      }
+   }
+
+   return done;
+}
+
+#endif
@@ -67,6 +67,51 @@ int chacha_test(void)
                             n + 4, sizeof(n) - 4, 1, (unsigned char*)pt, len, out)) != CRYPT_OK)  return err;
    if (compare_testvector(out, len, ct, sizeof(ct), "CHACHA-TV5", 1))                      return CRYPT_FAIL_TESTVECTOR;
 
+   /* long inputs in one go (multi-block code) must match 61 byte pieces (single blocks),
+    * also across the 32-bit counter boundary with the 64-bit counter */
+   {
+      unsigned char buf[28 * 64 + 13], out2[28 * 64 + 13];
+      unsigned long i, j;
+      ulong64 ctr;
+
+      for (i = 0; i < sizeof(buf); i++) buf[i] = (unsigned char)(i * 29 + 7);
+      for (ctr = 1; ctr != 0; ctr = (ctr == 1) ? CONST64(0xFFFFFFF9) : 0) {
+         for (len = 4 * 64; len <= sizeof(buf); len += 3 * 64 + 5) {
+            if ((err = chacha_setup(&st, k, sizeof(k), 20)) != CRYPT_OK)                   return err;
+            if ((err = chacha_ivctr64(&st, n + 4, sizeof(n) - 4, ctr)) != CRYPT_OK)        return err;
+            if ((err = chacha_crypt(&st, buf, 3, out2)) != CRYPT_OK)                       return err;
+            if ((err = chacha_crypt(&st, buf + 3, len - 3, out2 + 3)) != CRYPT_OK)         return err;
+            if ((err = chacha_setup(&st, k, sizeof(k), 20)) != CRYPT_OK)                   return err;
+            if ((err = chacha_ivctr64(&st, n + 4, sizeof(n) - 4, ctr)) != CRYPT_OK)        return err;
+            for (i = 0; i < len; i += j) {
+               j = MIN(61, len - i);
+               if ((err = chacha_crypt(&st, buf + i, j, buf + i)) != CRYPT_OK)             return err;
+            }
+            if (compare_testvector(out2, len, buf, len, "CHACHA-TV6", (int)len))           return CRYPT_FAIL_TESTVECTOR;
+            /* decrypt in place */
+            if ((err = chacha_setup(&st, k, sizeof(k), 20)) != CRYPT_OK)                   return err;
+            if ((err = chacha_ivctr64(&st, n + 4, sizeof(n) - 4, ctr)) != CRYPT_OK)        return err;
+            if ((err = chacha_crypt(&st, buf, len, buf)) != CRYPT_OK)                      return err;
+            for (i = 0; i < len; i++) {
+               if (buf[i] != (unsigned char)(i * 29 + 7))                                  return CRYPT_FAIL_TESTVECTOR;
+            }
+         }
+      }
+
+      /* the 32-bit counter must not wrap, the block with counter 0xFFFFFFFF is never used */
+      XMEMSET(buf, 0, sizeof(buf));
+      if ((err = chacha_setup(&st, k, sizeof(k), 20)) != CRYPT_OK)                         return err;
+      if ((err = chacha_ivctr32(&st, n, sizeof(n), 0xFFFFFFF0UL)) != CRYPT_OK)             return err;
+      if (chacha_crypt(&st, buf, 17 * 64, out2) != CRYPT_OVERFLOW)                         return CRYPT_FAIL_TESTVECTOR;
+      if ((err = chacha_setup(&st, k, sizeof(k), 20)) != CRYPT_OK)                         return err;
+      if ((err = chacha_ivctr32(&st, n, sizeof(n), 0xFFFFFFF0UL)) != CRYPT_OK)             return err;
+      for (i = 0; i < 15; i++) {
+         if ((err = chacha_crypt(&st, buf + 64 * i, 64, buf + 64 * i)) != CRYPT_OK)        return err;
+      }
+      if (chacha_crypt(&st, buf + 64 * i, 64, buf + 64 * i) != CRYPT_OVERFLOW)             return CRYPT_FAIL_TESTVECTOR;
+      if (compare_testvector(out2, 15 * 64, buf, 15 * 64, "CHACHA-TV7", 1))                return CRYPT_FAIL_TESTVECTOR;
+   }
+
    return CRYPT_OK;
 #endif
 }
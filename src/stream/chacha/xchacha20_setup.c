@@ -0,0 +1,104 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+/* The implementation is based on:
+ * "XChaCha: eXtended-nonce ChaCha and AEAD_XChaCha20_Poly1305",
+ * https://datatracker.ietf.org/doc/html/draft-irtf-cfrg-xchacha-03
+ * "Extending the Salsa20 nonce", https://cr.yp.to/snuffle/xsalsa-20081128.pdf
+ */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_XCHACHA20
+
+static const char * const constants = "expand 32-byte k";
+
+#define QUARTERROUND(a,b,c,d) \
+  x[a] += x[b]; x[d] = ROL(x[d] ^ x[a], 16); \
+  x[c] += x[d]; x[b] = ROL(x[b] ^ x[c], 12); \
+  x[a] += x[b]; x[d] = ROL(x[d] ^ x[a],  8); \
+  x[c] += x[d]; x[b] = ROL(x[b] ^ x[c],  7);
+
+/* HChaCha20 is the chacha doubleround without the final addition */
+static void s_xchacha20_hchacha20(ulong32 *x, int rounds)
+{
+   int i;
+
+   for (i = rounds; i > 0; i -= 2) {
+      QUARTERROUND(0, 4, 8,12)
+      QUARTERROUND(1, 5, 9,13)
+      QUARTERROUND(2, 6,10,14)
+      QUARTERROUND(3, 7,11,15)
+      QUARTERROUND(0, 5,10,15)
+      QUARTERROUND(1, 6,11,12)
+      QUARTERROUND(2, 7, 8,13)
+      QUARTERROUND(3, 4, 9,14)
+   }
+}
+
+#undef QUARTERROUND
+
+/**
+   Initialize an XChaCha20 context
+
+   The subkey is derived with HChaCha20 from the key and the first 16 bytes of the
+   nonce, the last 8 bytes of the nonce are used as IV with a 32 bit counter which
+   starts at zero (i.e. the IETF variant with a 96 bit nonce of 4 zero bytes + IV).
+   @param st        [out] The destination of the XChaCha20 state
+   @param key       The secret key
+   @param keylen    The length of the secret key, must be 32 (octets)
+   @param nonce     The nonce
+   @param noncelen  The length of the nonce, must be 24 (octets)
+   @param rounds    Number of rounds (must be evenly divisible by 2, default is 20)
+   @return CRYPT_OK if successful, CRYPT_INVALID_KEYSIZE if the key isn't 32 bytes long
+*/
+int xchacha20_setup(chacha_state *st, const unsigned char *key, unsigned long keylen,
+                                      const unsigned char *nonce, unsigned long noncelen,
+                                      int rounds)
+{
+   ulong32 x[16];
+   int i;
+
+   LTC_ARGCHK(st        != NULL);
+   LTC_ARGCHK(key       != NULL);
+   LTC_ARGCHK(nonce     != NULL);
+   LTC_ARGCHK(noncelen  == 24);
+   if (rounds == 0) rounds = 20;
+   LTC_ARGCHK(rounds % 2 == 0);     /* number of rounds must be evenly divisible by 2 */
+   if (keylen != 32) return CRYPT_INVALID_KEYSIZE;
+
+   /* load the state to "hash" the key */
+   for (i = 0; i < 4; ++i) {
+      LOAD32L(x[i], constants + 4 * i);
+   }
+   for (i = 0; i < 8; ++i) {
+      LOAD32L(x[i + 4], key + 4 * i);
+   }
+   for (i = 0; i < 4; ++i) {
+      LOAD32L(x[i + 12], nonce + 4 * i);
+   }
+
+   s_xchacha20_hchacha20(x, rounds);
+
+   /* the subkey is made of the first and the last row */
+   for (i = 0; i < 4; ++i) {
+      LOAD32L(st->input[i], constants + 4 * i);
+      st->input[i + 4] = x[i];
+      st->input[i + 8] = x[i + 12];
+   }
+   st->input[12] = 0;
+   st->input[13] = 0;
+   LOAD32L(st->input[14], nonce + 16);
+   LOAD32L(st->input[15], nonce + 20);
+   st->rounds = rounds;
+   st->ksleft = 0;
+   st->ivlen  = 24;           /* set switch to say nonce/IV has been loaded */
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(x, sizeof(x));
+#endif
+
+   return CRYPT_OK;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis */
+/* SPDX-License-Identifier: Unlicense */
+
+#include "tomcrypt_private.h"
+
+#ifdef LTC_XCHACHA20
+
+int xchacha20_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   /* https://datatracker.ietf.org/doc/html/draft-irtf-cfrg-xchacha-03#section-2.2.1 */
+   {
+      unsigned char key[]    = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+                                 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f };
+      unsigned char nonce[]  = { 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00, 0x31, 0x41, 0x59, 0x27,
+                                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+      unsigned char subkey[] = { 0x82, 0x41, 0x3b, 0x42, 0x27, 0xb2, 0x7b, 0xfe, 0xd3, 0x0e, 0x42, 0x50, 0x8a, 0x87, 0x7d, 0x73,
+                                 0xa0, 0xf9, 0xe4, 0xd5, 0x8a, 0x74, 0xa8, 0x53, 0xc1, 0x2e, 0xc4, 0x13, 0x26, 0xd3, 0xec, 0xdc };
+      unsigned char out[32];
+      chacha_state st;
+      int i, err;
+
+      /* HChaCha20, the subkey ends up in the key words of the state */
+      if ((err = xchacha20_setup(&st, key, sizeof(key), nonce, sizeof(nonce), 20)) != CRYPT_OK) return err;
+      for (i = 0; i < 8; i++) {
+         STORE32L(st.input[i + 4], out + 4 * i);
+      }
+      if ((err = chacha_done(&st)) != CRYPT_OK) return err;
+      if (compare_testvector(out, sizeof(out), subkey, sizeof(subkey), "XCHACHA20-TV1", 1)) return CRYPT_FAIL_TESTVECTOR;
+   }
+   /* https://datatracker.ietf.org/doc/html/draft-irtf-cfrg-xchacha-03#appendix-A.3.2 */
+   {
+      unsigned char key[]   = { 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+                                0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f };
+      unsigned char nonce[] = { 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f,
+                                0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x58 };
+      const char *pt = "The dhole (pronounced \"dole\") is also known as the Asiatic wild dog, red dog, and whistling dog. "
+                       "It is about the size of a German shepherd but looks more like a long-legged fox. This highly elusive "
+                       "and skilled jumper is classified with wolves, coyotes, jackals, and foxes in the taxonomic family Canidae.";
+      unsigned char ct[]    = { 0x45, 0x59, 0xAB, 0xBA, 0x4E, 0x48, 0xC1, 0x61, 0x02, 0xE8, 0xBB, 0x2C, 0x05, 0xE6, 0x94, 0x7F,
+                                0x50, 0xA7, 0x86, 0xDE, 0x16, 0x2F, 0x9B, 0x0B, 0x7E, 0x59, 0x2A, 0x9B, 0x53, 0xD0, 0xD4, 0xE9,
+                                0x8D, 0x8D, 0x64, 0x10, 0xD5, 0x40, 0xA1, 0xA6, 0x37, 0x5B, 0x26, 0xD8, 0x0D, 0xAC, 0xE4, 0xFA,
+                                0xB5, 0x23, 0x84, 0xC7, 0x31, 0xAC, 0xBF, 0x16, 0xA5, 0x92, 0x3C, 0x0C, 0x48, 0xD3, 0x57, 0x5D,
+                                0x4D, 0x0D, 0x2C, 0x67, 0x3B, 0x66, 0x6F, 0xAA, 0x73, 0x10, 0x61, 0x27, 0x77, 0x01, 0x09, 0x3A,
+                                0x6B, 0xF7, 0xA1, 0x58, 0xA8, 0x86, 0x42, 0x92, 0xA4, 0x1C, 0x48, 0xE3, 0xA9, 0xB4, 0xC0, 0xDA,
+                                0xEC, 0xE0, 0xF8, 0xD9, 0x8D, 0x0D, 0x7E, 0x05, 0xB3, 0x7A, 0x30, 0x7B, 0xBB, 0x66, 0x33, 0x31,
+                                0x64, 0xEC, 0x9E, 0x1B, 0x24, 0xEA, 0x0D, 0x6C, 0x3F, 0xFD, 0xDC, 0xEC, 0x4F, 0x68, 0xE7, 0x44,
+                                0x30, 0x56, 0x19, 0x3A, 0x03, 0xC8, 0x10, 0xE1, 0x13, 0x44, 0xCA, 0x06, 0xD8, 0xED, 0x8A, 0x2B,
+                                0xFB, 0x1E, 0x8D, 0x48, 0xCF, 0xA6, 0xBC, 0x0E, 0xB4, 0xE2, 0x46, 0x4B, 0x74, 0x81, 0x42, 0x40,
+                                0x7C, 0x9F, 0x43, 0x1A, 0xEE, 0x76, 0x99, 0x60, 0xE1, 0x5B, 0xA8, 0xB9, 0x68, 0x90, 0x46, 0x6E,
+                                0xF2, 0x45, 0x75, 0x99, 0x85, 0x23, 0x85, 0xC6, 0x61, 0xF7, 0x52, 0xCE, 0x20, 0xF9, 0xDA, 0x0C,
+                                0x09, 0xAB, 0x6B, 0x19, 0xDF, 0x74, 0xE7, 0x6A, 0x95, 0x96, 0x74, 0x46, 0xF8, 0xD0, 0xFD, 0x41,
+                                0x5E, 0x7B, 0xEE, 0x2A, 0x12, 0xA1, 0x14, 0xC2, 0x0E, 0xB5, 0x29, 0x2A, 0xE7, 0xA3, 0x49, 0xAE,
+                                0x57, 0x78, 0x20, 0xD5, 0x52, 0x0A, 0x1F, 0x3F, 0xB6, 0x2A, 0x17, 0xCE, 0x6A, 0x7E, 0x68, 0xFA,
+                                0x7C, 0x79, 0x11, 0x1D, 0x88, 0x60, 0x92, 0x0B, 0xC0, 0x48, 0xEF, 0x43, 0xFE, 0x84, 0x48, 0x6C,
+                                0xCB, 0x87, 0xC2, 0x5F, 0x0A, 0xE0, 0x45, 0xF0, 0xCC, 0xE1, 0xE7, 0x98, 0x9A, 0x9A, 0xA2, 0x20,
+                                0xA2, 0x8B, 0xDD, 0x48, 0x27, 0xE7, 0x51, 0xA2, 0x4A, 0x6D, 0x5C, 0x62, 0xD7, 0x90, 0xA6, 0x63,
+                                0x93, 0xB9, 0x31, 0x11, 0xC1, 0xA5, 0x5D, 0xD7, 0x42, 0x1A, 0x10, 0x18, 0x49, 0x74, 0xC7, 0xC5 };
+      unsigned long ptlen = XSTRLEN(pt);
+      unsigned char out[400];
+      chacha_state st;
+      int err;
+
+      if (ptlen != sizeof(ct)) return CRYPT_FAIL_TESTVECTOR;
+
+      /* in two pieces */
+      if ((err = xchacha20_setup(&st, key, sizeof(key), nonce, sizeof(nonce), 20)) != CRYPT_OK) return err;
+      if ((err = chacha_crypt(&st, (const unsigned char *)pt, 35, out)) != CRYPT_OK) return err;
+      if ((err = chacha_crypt(&st, (const unsigned char *)pt + 35, ptlen - 35, out + 35)) != CRYPT_OK) return err;
+      if ((err = chacha_done(&st)) != CRYPT_OK) return err;
+      if (compare_testvector(out, ptlen, ct, sizeof(ct), "XCHACHA20-TV2", 1)) return CRYPT_FAIL_TESTVECTOR;
+
+      /* round trip with a single function call */
+      if ((err = xchacha20_memory(key, sizeof(key), 20, nonce, sizeof(nonce), ct, sizeof(ct), out)) != CRYPT_OK) return err;
+      if (compare_testvector(out, ptlen, pt, ptlen, "XCHACHA20-TV3", 1)) return CRYPT_FAIL_TESTVECTOR;
+   }
+
+   return CRYPT_OK;
+#endif
+}
+
+#endif
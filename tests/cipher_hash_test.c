@@ -18,8 +18,18 @@ int cipher_hash_test(void)
    if (aesni_is_supported()) {
       DO(aesni_test());
    }
+#if defined(LTC_AES_VAES)
+   if (vaes256_is_supported()) {
+      DO(vaes_test());
+   }
+#endif
    DO(rijndael_test());
 #endif
+#if defined(LTC_AES_BITSLICE)
+   if (aesbs_is_supported()) {
+      DO(aesbs_test());
+   }
+#endif
 #if defined(LTC_RIJNDAEL)
 #ifndef ENCRYPT_ONLY
    DO(aes_test());
@@ -32,6 +42,9 @@ int cipher_hash_test(void)
 #ifdef LTC_CHACHA
    DO(chacha_test());
 #endif
+#ifdef LTC_XCHACHA20
+   DO(xchacha20_test());
+#endif
 #ifdef LTC_SALSA20
    DO(salsa20_test());
 #endif
@@ -59,6 +72,10 @@ int cipher_hash_test(void)
 #ifdef LTC_SHA3
    /* SHAKE128 + SHAKE256 tests are a bit special */
    DOX(sha3_shake_test(), "sha3_shake");
+   DOX(sha3_cshake_test(), "sha3_cshake");
+   DOX(sha3_turboshake_test(), "sha3_turboshake");
+   DOX(sha3_kt_test(), "sha3_kt");
+   DOX(sha3_parallelhash_test(), "sha3_parallelhash");
 #endif
 
    return 0;
@@ -4,6 +4,88 @@
 
 #include <tomcrypt_test.h>
 
+#if !defined(LTC_NO_FILE) && defined(LTC_FILE_MMAP) && defined(LTC_PTHREAD)
+#include <unistd.h>
+
+struct s_pipe_writer {
+   int fd;
+   const unsigned char *data;
+   size_t len;
+};
+
+static void* s_pipe_writer_thread(void *arg)
+{
+   struct s_pipe_writer *w = arg;
+   size_t off = 0;
+   ssize_t x;
+
+   while (off < w->len) {
+      if ((x = write(w->fd, w->data + off, w->len - off)) <= 0) {
+         break;
+      }
+      off += (size_t)x;
+   }
+   close(w->fd);
+   return NULL;
+}
+
+/* a pipe can't be mapped, file_process() reads it in a separate thread into two alternating buffers */
+static int s_file_test_pipe(int hash)
+{
+   struct s_pipe_writer w;
+   pthread_t thread;
+   unsigned char *data, out[2][MAXBLOCKSIZE], tmp[256];
+   unsigned long len[2];
+   size_t x;
+   int fds[2], err = CRYPT_ERROR;
+   FILE *in;
+
+   /* several buffers of the reader thread, the last one partial */
+   w.len = 3 * 256 * 1024 + 123;
+   if ((data = XMALLOC(w.len)) == NULL) {
+      return CRYPT_MEM;
+   }
+   for (x = 0; x < w.len; x++) {
+      data[x] = (unsigned char)(x * 31 + (x >> 11));
+   }
+   w.data = data;
+
+   if (pipe(fds) != 0) {
+      goto LBL_FREE;
+   }
+   if ((in = fdopen(fds[0], "rb")) == NULL) {
+      close(fds[0]);
+      close(fds[1]);
+      goto LBL_FREE;
+   }
+   w.fd = fds[1];
+   if (pthread_create(&thread, NULL, s_pipe_writer_thread, &w) != 0) {
+      close(fds[1]);
+      fclose(in);
+      goto LBL_FREE;
+   }
+   len[0] = sizeof(out[0]);
+   err = hash_filehandle(hash, in, out[0], &len[0]);
+   /* don't let the writer run into a closed pipe if that failed */
+   while (fread(tmp, 1, sizeof(tmp), in) > 0);
+   fclose(in);
+   pthread_join(thread, NULL);
+   if (err != CRYPT_OK) {
+      goto LBL_FREE;
+   }
+
+   len[1] = sizeof(out[1]);
+   if ((err = hash_memory(hash, data, w.len, out[1], &len[1])) != CRYPT_OK) {
+      goto LBL_FREE;
+   }
+   err = do_compare_testvector(out[0], len[0], out[1], len[1], "hash_filehandle pipe", 1);
+
+LBL_FREE:
+   XFREE(data);
+   return err;
+}
+#endif
+
 int file_test(void)
 {
 #ifdef LTC_NO_FILE
@@ -39,6 +121,30 @@ int file_test(void)
    DO(hash_file(isha256, fname, buf, &len));
    DO(do_compare_testvector(buf, len, exp_sha256, 32, "hash_file", 1));
 
+   /* hash_filehandle() starts at the current position, which needn't be aligned */
+   {
+      unsigned char data[2048], exp[32];
+      unsigned long datalen;
+
+      if ((in = fopen(fname, "rb")) == NULL)                                    return CRYPT_FILE_NOTFOUND;
+      datalen = (unsigned long)fread(data, 1, sizeof(data), in);
+      if (datalen < 100 || datalen == sizeof(data) || fseek(in, 99, SEEK_SET) != 0) {
+         fclose(in);
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+      len = sizeof(buf);
+      err = hash_filehandle(isha256, in, buf, &len);
+      fclose(in);
+      DO(err);
+      len = sizeof(exp);
+      DO(hash_memory(isha256, data + 99, datalen - 99, exp, &len));
+      DO(do_compare_testvector(buf, len, exp, len, "hash_filehandle", 2));
+   }
+
+#if defined(LTC_FILE_MMAP) && defined(LTC_PTHREAD)
+   DO(s_file_test_pipe(isha256));
+#endif
+
 #ifdef LTC_HMAC
    {
       unsigned char exp_hmacsha256[32] = { 0xE4, 0x07, 0x74, 0x95, 0xF1, 0xF8, 0x5B, 0xB5, 0xF1, 0x4F, 0x7D, 0x4F, 0x59, 0x8E, 0x4B, 0xBC,
@@ -104,6 +210,22 @@ int file_test(void)
       DO(do_compare_testvector(buf, len, exp_blake2bmac, 16, "exp_blake2bmac_file", 1));
    }
 #endif
+#ifdef LTC_BLAKE2SPMAC
+   {
+      unsigned char exp_blake2spmac[16]  = { 0x63, 0x53, 0x7b, 0xf3, 0x77, 0xb0, 0x64, 0xb8, 0x3a, 0x23, 0x36, 0x19, 0x36, 0xd4, 0x62, 0x88 };
+      len = 16;
+      DO(blake2spmac_file(fname, key, 32, buf, &len));
+      DO(do_compare_testvector(buf, len, exp_blake2spmac, 16, "exp_blake2spmac_file", 1));
+   }
+#endif
+#ifdef LTC_BLAKE2BPMAC
+   {
+      unsigned char exp_blake2bpmac[16]  = { 0x4c, 0x9d, 0x3a, 0x44, 0x25, 0xc1, 0x01, 0x29, 0x57, 0x7a, 0x8f, 0xc2, 0xac, 0x15, 0xba, 0x05 };
+      len = 16;
+      DO(blake2bpmac_file(fname, key, 32, buf, &len));
+      DO(do_compare_testvector(buf, len, exp_blake2bpmac, 16, "exp_blake2bpmac_file", 1));
+   }
+#endif
 
    return CRYPT_OK;
 #endif
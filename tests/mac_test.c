@@ -35,6 +35,9 @@ int mac_test(void)
 #ifdef LTC_GCM_MODE
    DO(gcm_test());
 #endif
+#ifdef LTC_GCM_SIV_MODE
+   DO(gcm_siv_test());
+#endif
 #ifdef LTC_PELICAN
    DO(pelican_test());
 #endif
@@ -49,6 +52,12 @@ int mac_test(void)
 #endif
 #ifdef LTC_BLAKE2BMAC
    DO(blake2bmac_test());
+#endif
+#ifdef LTC_BLAKE2SPMAC
+   DO(blake2spmac_test());
+#endif
+#ifdef LTC_BLAKE2BPMAC
+   DO(blake2bpmac_test());
 #endif
    return 0;
 }
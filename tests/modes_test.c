@@ -85,6 +85,41 @@ int modes_test(void)
       fprintf(stderr, "CBC failed");
       return 1;
    }
+
+   /* an accelerator has to give the same result as chaining the blocks one by one */
+   if (cipher_descriptor[cipher_idx].accel_cbc_encrypt != NULL && cipher_descriptor[cipher_idx].accel_cbc_decrypt != NULL) {
+      unsigned char cbc_pt[16 * 19], cbc_ct[2][sizeof(cbc_pt)], cbc_dec[sizeof(cbc_pt)], cbc_iv[16];
+      symmetric_key skey;
+      unsigned long k;
+
+      ENSURE(yarrow_read(cbc_pt, sizeof(cbc_pt), &yarrow_prng) == sizeof(cbc_pt));
+      DO(ret = cbc_start(cipher_idx, iv, key, 16, 0, &cbc));
+      DO(ret = cbc_encrypt(cbc_pt, cbc_ct[0], 16, &cbc));
+      DO(ret = cbc_encrypt(cbc_pt + 16, cbc_ct[0] + 16, sizeof(cbc_pt) - 16, &cbc));
+      DO(ret = cbc_setiv(iv, 16, &cbc));
+      DO(ret = cbc_decrypt(cbc_ct[0], cbc_dec, sizeof(cbc_dec), &cbc));
+      COMPARE_TESTVECTOR(cbc_dec, sizeof(cbc_dec), cbc_pt, sizeof(cbc_pt), "cbc-accel-enc-dec", 0);
+      /* in-place */
+      XMEMCPY(cbc_dec, cbc_ct[0], sizeof(cbc_dec));
+      DO(ret = cbc_setiv(iv, 16, &cbc));
+      DO(ret = cbc_decrypt(cbc_dec, cbc_dec, sizeof(cbc_dec), &cbc));
+      COMPARE_TESTVECTOR(cbc_dec, sizeof(cbc_dec), cbc_pt, sizeof(cbc_pt), "cbc-accel-in-place", 0);
+
+      /* the reference chains the blocks by hand, the descriptor is
+       * shared with the other tests when they run in parallel */
+      DO(ret = cipher_descriptor[cipher_idx].setup(key, 16, 0, &skey));
+      XMEMCPY(cbc_iv, iv, 16);
+      for (l = 0; l < sizeof(cbc_pt); l += 16) {
+         for (k = 0; k < 16; k++) {
+            cbc_iv[k] ^= cbc_pt[l + k];
+         }
+         DO(ret = cipher_descriptor[cipher_idx].ecb_encrypt(cbc_iv, cbc_iv, &skey));
+         XMEMCPY(cbc_ct[1] + l, cbc_iv, 16);
+      }
+      cipher_descriptor[cipher_idx].done(&skey);
+      COMPARE_TESTVECTOR(cbc_ct[0], sizeof(cbc_ct[0]), cbc_ct[1], sizeof(cbc_ct[1]), "cbc-accel-vs-generic", 0);
+      DO(ret = cbc_done(&cbc));
+   }
 #endif
 
 #ifdef LTC_CFB_MODE
@@ -44,6 +44,150 @@ int multi_test(void)
       return CRYPT_FAIL_TESTVECTOR;
    }
 
+   /* hash_memory_batch() of messages of different lengths */
+   {
+      static const char *hashes[] = { "sha224", "sha256", "sha384", "sha512", "sha512-224", "sha512-256", "md5" };
+      static const unsigned long lens[] = { 0, 1, 55, 56, 63, 64, 65, 111, 112, 119, 127,
+                                            128, 129, 200, 239, 240, 255, 256, 500, 900, 3 };
+      unsigned char msg[1000], digests[21 * 64], tmp[64];
+      const unsigned char *in[21];
+      unsigned long inlen[21];
+      int h, i, idx;
+
+      for (i = 0; i < (int)sizeof(msg); i++) {
+         msg[i] = (unsigned char)(i * 7 + 3);
+      }
+      for (i = 0; i < 21; i++) {
+         in[i] = msg + i;
+         inlen[i] = lens[i];
+      }
+      for (h = 0; h < (int)(sizeof(hashes) / sizeof(hashes[0])); h++) {
+         if ((idx = find_hash(hashes[h])) == -1) {
+            continue;
+         }
+         len = sizeof(digests);
+         DO(hash_memory_batch(idx, in, inlen, 21, digests, &len));
+         if (len != 21 * hash_descriptor[idx].hashsize) {
+            printf("Failed: %d %s %lu\n", __LINE__, hashes[h], len);
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+         for (i = 0; i < 21; i++) {
+            len2 = sizeof(tmp);
+            DO(hash_memory(idx, in[i], inlen[i], tmp, &len2));
+            if (compare_testvector(digests + i * len2, len2, tmp, len2, hashes[h], i)) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+         }
+         /* a single message, i.e. most lanes stay idle */
+         len = sizeof(digests);
+         DO(hash_memory_batch(idx, in + 20, inlen + 20, 1, digests, &len));
+         if (compare_testvector(digests, len, tmp, len2, hashes[h], 21)) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+   }
+
+   /* hash_tree_memory() and the incremental hash tree, SHA-256 roots as of RFC 6962 */
+   {
+      static const struct {
+         unsigned long inlen, chunklen;
+         unsigned char root[32];
+      } tv[] = {
+         { 0, 64,
+           { 0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14,
+             0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+             0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+             0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55 } },
+         { 1, 64,
+           { 0x58, 0x3c, 0x7d, 0xfb, 0x7b, 0x30, 0x55, 0xd9,
+             0x94, 0x65, 0x54, 0x40, 0x32, 0xa5, 0x71, 0xe1,
+             0x0a, 0x13, 0x4b, 0x1b, 0x6f, 0x76, 0x94, 0x22,
+             0xbb, 0xb7, 0x1f, 0xd7, 0xfa, 0x16, 0x7a, 0x5d } },
+         { 64, 64,
+           { 0xd7, 0xb0, 0x8e, 0x9a, 0xc5, 0xd2, 0x72, 0xbf,
+             0xe8, 0x6b, 0xd0, 0xc1, 0x6c, 0x03, 0x3d, 0xef,
+             0xd3, 0xcc, 0x6b, 0xac, 0xad, 0xd0, 0x56, 0x22,
+             0xf6, 0x3b, 0xdc, 0xb0, 0xb0, 0x28, 0x6c, 0x4f } },
+         { 65, 64,
+           { 0x78, 0x48, 0xed, 0x6a, 0x3b, 0xf4, 0xf6, 0x45,
+             0x5a, 0xd5, 0x59, 0x95, 0x6a, 0x40, 0xda, 0x76,
+             0x74, 0x04, 0x5b, 0xa8, 0x4f, 0xc9, 0x26, 0x36,
+             0x2d, 0x18, 0x10, 0x07, 0x71, 0xfc, 0xb0, 0x03 } },
+         { 1000, 64,
+           { 0x92, 0x3c, 0x8c, 0x47, 0x92, 0xda, 0x34, 0x1f,
+             0x45, 0x29, 0x46, 0xf8, 0x2d, 0x39, 0x5c, 0x94,
+             0xbf, 0xfd, 0x25, 0x86, 0x2a, 0x4d, 0x55, 0x82,
+             0x00, 0xca, 0x7f, 0x64, 0x96, 0x2e, 0xa7, 0xa0 } },
+         { 5000, 100,
+           { 0x56, 0xd8, 0x03, 0xb0, 0x41, 0xcb, 0xd4, 0x49,
+             0xac, 0xb9, 0x33, 0xdf, 0x5c, 0xe1, 0xf5, 0x9f,
+             0x0f, 0xbc, 0xec, 0x8f, 0x1b, 0x27, 0xb1, 0x7f,
+             0x2d, 0xfd, 0x11, 0x1c, 0x9c, 0x56, 0x5a, 0x6d } },
+         { 5000, 1,
+           { 0x0e, 0x92, 0xaa, 0x2c, 0x9d, 0x6c, 0x23, 0x62,
+             0xf5, 0x9e, 0x46, 0x2e, 0xb2, 0x19, 0xb6, 0x2d,
+             0x46, 0x57, 0x7a, 0xd2, 0xee, 0x5c, 0x6e, 0x31,
+             0xa3, 0xf1, 0x83, 0x2c, 0x5f, 0x7f, 0x98, 0x0b } },
+      };
+      /* the roots after flipping the octets 0, 1234, 1299 and 4999 */
+      static const unsigned char updated[2][32] = {
+         { 0xd4, 0xd2, 0xbe, 0xfb, 0x34, 0x02, 0x8e, 0x86,
+           0xcd, 0xc3, 0x98, 0xf2, 0x73, 0xb2, 0xd5, 0xe7,
+           0xcb, 0x9d, 0xf6, 0x63, 0x0f, 0x9f, 0xb8, 0xa5,
+           0x86, 0x9c, 0x12, 0xdf, 0x39, 0x0c, 0x08, 0x4e },
+         { 0x62, 0xc3, 0x58, 0x48, 0x44, 0x15, 0xaf, 0x00,
+           0x99, 0x1f, 0x1f, 0x89, 0x0e, 0x66, 0x35, 0x71,
+           0x8f, 0xf9, 0xc1, 0x91, 0x49, 0xe1, 0x68, 0x25,
+           0xe3, 0xe1, 0xc7, 0x0d, 0x8c, 0xe4, 0xb1, 0xe4 }
+      };
+      static const unsigned long flip[] = { 0, 1234, 1299, 4999 };
+      static unsigned char msg[5000];
+      unsigned char root[32];
+      unsigned long changed[5], i, t, n;
+      hash_tree_state tree;
+      int idx = find_hash("sha256"), err;
+
+      for (i = 0; i < sizeof(msg); i++) {
+         msg[i] = (unsigned char)(i * 7 + 3);
+      }
+      for (i = 0; i < sizeof(tv) / sizeof(tv[0]); i++) {
+         for (t = 1; t <= 4; t += 3) {
+            len = sizeof(root);
+            DO(hash_tree_memory(idx, tv[i].chunklen, t, msg, tv[i].inlen, root, &len));
+            if (compare_testvector(root, len, tv[i].root, sizeof(tv[i].root), "hash_tree_memory", (int)(i * 10 + t))) {
+               return CRYPT_FAIL_TESTVECTOR;
+            }
+         }
+      }
+      for (i = 0; i < 2; i++) {
+         DO(hash_tree_init(&tree, idx, i == 0 ? 100 : 1, 4));
+         if ((err = hash_tree_build(&tree, msg, sizeof(msg))) != CRYPT_OK)                  goto LBL_TREE;
+         for (n = 0; n < 4; n++) {
+            msg[flip[n]] ^= 0xff;
+            changed[n] = flip[n] / tree.chunklen;
+         }
+         /* a chunk may be given more than once */
+         changed[4] = changed[0];
+         err = hash_tree_update(&tree, msg, sizeof(msg), changed, 5);
+         for (n = 0; n < 4; n++) {
+            msg[flip[n]] ^= 0xff;
+         }
+         if (err != CRYPT_OK)                                                                goto LBL_TREE;
+         len = sizeof(root);
+         if ((err = hash_tree_root(&tree, root, &len)) != CRYPT_OK)                         goto LBL_TREE;
+         /* the number of chunks must not change */
+         if (hash_tree_update(&tree, msg, sizeof(msg) - 100, changed, 5) == CRYPT_OK) {
+            err = CRYPT_FAIL_TESTVECTOR;
+         }
+LBL_TREE:
+         hash_tree_free(&tree);
+         DO(err);
+         if (compare_testvector(root, sizeof(root), updated[i], sizeof(updated[i]), "hash_tree_update", (int)i)) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+   }
+
 #ifdef LTC_HMAC
    len = sizeof(buf[0]);
    hmac_memory(find_hash("sha256"), key, 16, (unsigned char*)"hello", 5, buf[0], &len);
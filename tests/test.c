@@ -107,7 +107,7 @@ static void *run(void *arg)
 static void s_unregister_all(void)
 {
 #ifdef LTC_RIJNDAEL
-   /* `aesni_desc` is not registered, i.e. also shouldn't be unregistered */
+   /* `aesni_desc` and `aesbs_desc` are not registered, i.e. also shouldn't be unregistered */
 #ifdef ENCRYPT_ONLY
    /* alternative would be
     * unregister_cipher(&rijndael_enc_desc);
@@ -262,6 +262,15 @@ static void s_unregister_all(void)
   unregister_hash(&blake2b_384_desc);
   unregister_hash(&blake2b_512_desc);
 #endif
+#ifdef LTC_BLAKE2SP
+  unregister_hash(&blake2sp_256_desc);
+#endif
+#ifdef LTC_BLAKE2BP
+  unregister_hash(&blake2bp_512_desc);
+#endif
+#ifdef LTC_BLAKE3
+  unregister_hash(&blake3_desc);
+#endif
 #ifdef LTC_CHC_HASH
   unregister_hash(&chc_desc);
 #endif